@@ -10,9 +10,24 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "asiosys.h"
 #include "asio.h"
 #include "asiodrivers.h"
+#include "ASIOConvertKernels.h"
+#include "ASIODSPKernels.h"
+#include "ASIOConvertMatrix.h"
+#include "ASIODenormals.h"
+#include "ASIOMeter.h"
+#include "ASIOAnalyzer.h"
+#include "ASIOBiquadBank.h"
+#include "ASIOFilterDesign.h"
+#include "ASIOConvolver.h"
+#include "ASIOTelemetry.h"
+#include "ASIOProfiler.h"
+#include "ASIOGraph.h"
+#include <vector>
+#include <atomic>
 
 // name of the ASIO device to be used
 #define ASIO_DRIVER_NAME    "Focusrite USB ASIO"
@@ -27,6 +42,25 @@ enum {
 	kMaxOutputChannels = 32
 };
 
+// one channel of the buffer switch, the converter and both buffer halves
+// are resolved in create_asio_buffers()
+typedef struct ChannelConversion
+{
+	ASIOChannelConverter convert;
+	ASIOChannelState state;
+	void*          source[2];
+	void*          dest[2];
+
+	// outputs whose converter keeps silence silent. A producer that fills the host
+	// buffer sets written for that buffer switch, an output nobody wrote is silence:
+	// the host buffer is cleared once and converted into each half once, after that
+	// both halves are known silent and left alone until the channel is written again.
+	bool           elide;
+	bool           written;
+	bool           hostSilent;		// the host buffer holds zeros
+	long           silentHalves;	// bit 0 and 1, device halves that hold silence
+} ChannelConversion;
+
 
 // internal data storage
 typedef struct DriverInfo
@@ -44,7 +78,7 @@ typedef struct DriverInfo
 	long           preferredSize;
 	long           granularity;
 
-	// ASIOGetSampleRate()
+	// ASIOGetSampleRate(), and changedRate from the main loop while the driver is stopped
 	ASIOSampleRate sampleRate;
 
 	// ASIOOutputReady()
@@ -63,15 +97,80 @@ typedef struct DriverInfo
 	ASIOChannelInfo channelInfos[kMaxInputChannels + kMaxOutputChannels]; // channel info's
 	// The above two arrays share the same indexing, as the data in them are linked together
 
-	// Information from ASIOGetSamplePosition()
-	// data is converted to double floats for easier use, however 64 bit integer can be used, too
-	double         nanoSeconds;
-	double         samples;
-	double         tcSamples;	// time code samples
-
-	// bufferSwitchTimeInfo()
-	ASIOTime       tInfo;			// time info state
-	unsigned long  sysRefTime;      // system reference time, when bufferSwitch() was called
+	// create_asio_buffers(), the host side samples of each channel and the
+	// conversion from or to the device format, same indexing as above
+	char*          hostBuffers[kMaxInputChannels + kMaxOutputChannels];
+	ChannelConversion conversions[kMaxInputChannels + kMaxOutputChannels];
+
+	// bufferSwitchTimeInfo(), output halves the buffer switch had to fill and those it
+	// skipped because they held silence already. Only the callback writes them.
+	std::atomic<unsigned long long> outputHalves;
+	std::atomic<unsigned long long> silentSkips;
+
+	// setup_processing(), levels of the float32 host buffers, same indexing
+	ASIOMeter      meter;
+
+	// main(), "-analyze" runs a spectrum analyzer on the inputs. setup_processing()
+	// sets it up with the device buffers of both halves, its worker runs while the
+	// driver does.
+	bool           analyze;
+	ASIOAnalyzer   analyzer;
+	const void*    analyzerSources[2][kMaxInputChannels];
+
+	// create_asio_buffers(), the float32 processing of the inputs. With any of the
+	// options below the inputs are converted into inputSamples and the graph runs them
+	// through the filters into the host buffers, and with "-monitor" on to the outputs.
+	bool           useGraph;
+	ASIOGraph      graph;
+	float*         inputSamples[kMaxInputChannels];
+
+	// main(), "-workers n" spreads the graph over n pinned workers and the buffer
+	// switch thread, they run while the driver does
+	long           graphWorkers;
+
+	// main(), "-highpass" removes rumble and dc from the float32 inputs, 4th order
+	// Butterworth at 20 Hz, a bank and a node of the graph per kLanes inputs
+	bool           highpass;
+	ASIOBiquadBank highpassFilters[(kMaxInputChannels + ASIOBiquadBank::kLanes - 1) / ASIOBiquadBank::kLanes];
+
+	// main(), "-convolve" puts the float32 inputs into a room of 2 s after the highpass.
+	// The inputs are split over a convolver per thread of the graph, each a node with a
+	// worker of its own for the tail that runs while the driver does.
+	bool           convolve;
+	ASIOConvolver  convolvers[ASIOGraph::kMaxThreads];
+	long           numConvolvers;
+
+	// main(), "-monitor" sends the processed inputs 6 dB down to the outputs of the
+	// same number, setup_processing() sets how many there are
+	bool           monitor;
+	long           monitorChannels;
+
+	// main(), float32 host samples or float64 with "-double"
+	ASIOHostSampleFormat hostFormat;
+
+	// main(), "-dither", "-shape1" and "-shape2" requantize the integer outputs
+	bool           dither;
+	ASIONoiseShaping noiseShaping;
+
+	// main(), "-denormals" keeps gradual underflow in the buffer switch
+	bool           denormals;
+
+	// create_asio_buffers(), FTZ and DAZ as far as the cpu has them. The buffer
+	// switch sets it on the driver's thread, DSP threads when they start.
+	long           denormalMode;
+
+	// bufferSwitchTimeInfo(), the time info state of the latest buffer and the positions
+	// from it, converted to double floats for easier use. Any thread takes a consistent
+	// snapshot without disturbing the callback.
+	ASIOTelemetry  telemetry;
+
+	// setup_processing(), how much of preferredSize / sampleRate the buffer switch
+	// takes, its period and the buffers the driver went on without it
+	ASIOProfiler   profiler;
+
+	// sampleRateChanged(), the rate the driver switched to for the main loop, 0 when
+	// there is none
+	std::atomic<double> changedRate;
 
 	// Signal the end of processing in this example
 	bool           stopped;
@@ -90,6 +189,10 @@ bool loadAsioDriver(char* name);
 int main(int argc, char* argv[]);
 long init_asio_static_data(DriverInfo* asioDriverInfo);
 ASIOError create_asio_buffers(DriverInfo* asioDriverInfo);
+ASIOError setup_processing(DriverInfo* asioDriverInfo);
+long start_processing(DriverInfo* asioDriverInfo);
+void stop_processing(DriverInfo* asioDriverInfo, long meterReader);
+void dispose_host_buffers(DriverInfo* asioDriverInfo);
 unsigned long get_sys_reference_time();
 
 
@@ -165,32 +268,37 @@ const double twoRaisedTo32 = 4294967296.;
 
 ASIOTime* bufferSwitchTimeInfo(ASIOTime* timeInfo, long index, ASIOBool processNow)
 {	// the actual processing callback.
-	// Beware that this is normally in a seperate thread, hence be sure that you take care
-	// about thread synchronization. This is omitted here for simplicity.
+	// Beware that this is normally in a seperate thread, the main loop only sees its
+	// state through the telemetry snapshot and atomic counters.
 	static long processedSamples = 0;
+	asioDriverInfo.profiler.enter(ASIO64toDouble(timeInfo->timeInfo.samplePosition),
+		(timeInfo->timeInfo.flags & kSamplePositionValid) != 0);
 
 	// store the timeInfo for later use
-	asioDriverInfo.tInfo = *timeInfo;
+	ASIOTelemetrySnapshot t;
+	t.time = *timeInfo;
+	t.index = index;
 
 	// get the time stamp of the buffer, not necessary if no
 	// synchronization to other media is required
 	if (timeInfo->timeInfo.flags & kSystemTimeValid)
-		asioDriverInfo.nanoSeconds = ASIO64toDouble(timeInfo->timeInfo.systemTime);
+		t.nanoSeconds = ASIO64toDouble(timeInfo->timeInfo.systemTime);
 	else
-		asioDriverInfo.nanoSeconds = 0;
+		t.nanoSeconds = 0;
 
 	if (timeInfo->timeInfo.flags & kSamplePositionValid)
-		asioDriverInfo.samples = ASIO64toDouble(timeInfo->timeInfo.samplePosition);
+		t.samples = ASIO64toDouble(timeInfo->timeInfo.samplePosition);
 	else
-		asioDriverInfo.samples = 0;
+		t.samples = 0;
 
 	if (timeInfo->timeCode.flags & kTcValid)
-		asioDriverInfo.tcSamples = ASIO64toDouble(timeInfo->timeCode.timeCodeSamples);
+		t.tcSamples = ASIO64toDouble(timeInfo->timeCode.timeCodeSamples);
 	else
-		asioDriverInfo.tcSamples = 0;
+		t.tcSamples = 0;
 
 	// get the system reference time
-	asioDriverInfo.sysRefTime = get_sys_reference_time();
+	t.sysRefTime = get_sys_reference_time();
+	asioDriverInfo.telemetry.publish(t);
 
 #if WINDOWS && _DEBUG
 	// a few debug messages for the Windows device driver developer
@@ -198,73 +306,81 @@ ASIOTime* bufferSwitchTimeInfo(ASIOTime* timeInfo, long index, ASIOBool processN
 	// the event notification.
 	static double last_samples = 0;
 	wchar_t tmp[128];
-	swprintf(tmp, 128, L"diff: %d / %d ms / %d ms / %d samples                 \n", asioDriverInfo.sysRefTime - (long)(asioDriverInfo.nanoSeconds / 1000000.0), asioDriverInfo.sysRefTime, (long)(asioDriverInfo.nanoSeconds / 1000000.0), (long)(asioDriverInfo.samples - last_samples));
+	swprintf(tmp, 128, L"diff: %d / %d ms / %d ms / %d samples                 \n", t.sysRefTime - (long)(t.nanoSeconds / 1000000.0), t.sysRefTime, (long)(t.nanoSeconds / 1000000.0), (long)(t.samples - last_samples));
 	OutputDebugString(tmp);
-	last_samples = asioDriverInfo.samples;
+	last_samples = t.samples;
 #endif
 
 	// buffer size in samples
 	long buffSize = asioDriverInfo.preferredSize;
 
-	// perform the processing
-	for (int i = 0; i < asioDriverInfo.inputBuffers + asioDriverInfo.outputBuffers; i++)
-	{
-		if (asioDriverInfo.bufferInfos[i].isInput == false)
-		{
-			// OK do processing for the outputs only
-			switch (asioDriverInfo.channelInfos[i].type)
-			{
-			case ASIOSTInt16LSB:
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 2);
-				break;
-			case ASIOSTInt24LSB:		// used for 20 bits as well
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 3);
-				break;
-			case ASIOSTInt32LSB:
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 4);
-				break;
-			case ASIOSTFloat32LSB:		// IEEE 754 32 bit float, as found on Intel x86 architecture
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 4);
-				break;
-			case ASIOSTFloat64LSB: 		// IEEE 754 64 bit double float, as found on Intel x86 architecture
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 8);
-				break;
+	// the driver's thread, cheap when it is already set
+	ASIOSetDenormalMode(asioDriverInfo.denormalMode);
 
-				// these are used for 32 bit data buffer, with different alignment of the data inside
-				// 32 bit PCI bus systems can more easily used with these
-			case ASIOSTInt32LSB16:		// 32 bit data with 18 bit alignment
-			case ASIOSTInt32LSB18:		// 32 bit data with 18 bit alignment
-			case ASIOSTInt32LSB20:		// 32 bit data with 20 bit alignment
-			case ASIOSTInt32LSB24:		// 32 bit data with 24 bit alignment
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 4);
-				break;
+	// the device input as it is to the spectrum analyzer, a copy into its ring
+	if (asioDriverInfo.analyze)
+		asioDriverInfo.analyzer.push(asioDriverInfo.analyzerSources[index], buffSize);
 
-			case ASIOSTInt16MSB:
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 2);
-				break;
-			case ASIOSTInt24MSB:		// used for 20 bits as well
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 3);
-				break;
-			case ASIOSTInt32MSB:
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 4);
-				break;
-			case ASIOSTFloat32MSB:		// IEEE 754 32 bit float, as found on Intel x86 architecture
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 4);
-				break;
-			case ASIOSTFloat64MSB: 		// IEEE 754 64 bit double float, as found on Intel x86 architecture
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 8);
-				break;
+	// perform the processing, inputs are converted to the host format, run through
+	// the graph and the host outputs converted to the device format, one call per
+	// channel. Silent outputs are only converted until both halves hold their silence,
+	// see ChannelConversion.
+	for (int i = 0; i < asioDriverInfo.inputBuffers; i++)
+	{
+		ChannelConversion* c = &asioDriverInfo.conversions[i];
+		c->convert(&c->state, c->source[index], c->dest[index], buffSize);
+	}
+	if (asioDriverInfo.useGraph)
+	{
+		asioDriverInfo.graph.process(buffSize);
+		for (long i = 0; i < asioDriverInfo.monitorChannels; i++)
+			asioDriverInfo.conversions[asioDriverInfo.inputBuffers + i].written = true;
+	}
 
-				// these are used for 32 bit data buffer, with different alignment of the data inside
-				// 32 bit PCI bus systems can more easily used with these
-			case ASIOSTInt32MSB16:		// 32 bit data with 18 bit alignment
-			case ASIOSTInt32MSB18:		// 32 bit data with 18 bit alignment
-			case ASIOSTInt32MSB20:		// 32 bit data with 20 bit alignment
-			case ASIOSTInt32MSB24:		// 32 bit data with 24 bit alignment
-				memset(asioDriverInfo.bufferInfos[i].buffers[index], 0, buffSize * 4);
-				break;
+	unsigned long long skips = 0;
+	for (int i = asioDriverInfo.inputBuffers; i < asioDriverInfo.inputBuffers + asioDriverInfo.outputBuffers; i++)
+	{
+		ChannelConversion* c = &asioDriverInfo.conversions[i];
+		if (c->elide && !c->written)
+		{
+			if (c->silentHalves & (1 << index))
+			{
+				skips++;
+				continue;
+			}
+			if (!c->hostSilent)
+			{
+				memset(c->source[index], 0, buffSize *
+					(asioDriverInfo.hostFormat == kASIOHostFloat64 ? sizeof(double) : sizeof(float)));
+				c->hostSilent = true;
 			}
+			c->convert(&c->state, c->source[index], c->dest[index], buffSize);
+			c->silentHalves |= 1 << index;
+			continue;
 		}
+		c->convert(&c->state, c->source[index], c->dest[index], buffSize);
+		if (c->elide)
+		{
+			c->silentHalves &= ~(1 << index);
+			c->hostSilent = false;
+			c->written = false;
+		}
+	}
+	if (asioDriverInfo.outputBuffers > 0)
+	{
+		asioDriverInfo.outputHalves.store(asioDriverInfo.outputHalves.load(std::memory_order_relaxed) +
+			asioDriverInfo.outputBuffers, std::memory_order_relaxed);
+		if (skips)
+			asioDriverInfo.silentSkips.store(asioDriverInfo.silentSkips.load(std::memory_order_relaxed) + skips,
+				std::memory_order_relaxed);
+	}
+
+	// levels of what came in and what goes out, for the main loop
+	if (asioDriverInfo.hostFormat == kASIOHostFloat32)
+	{
+		for (int i = 0; i < asioDriverInfo.inputBuffers + asioDriverInfo.outputBuffers; i++)
+			asioDriverInfo.meter.process(i, (const float*)asioDriverInfo.hostBuffers[i], buffSize);
+		asioDriverInfo.meter.publish();
 	}
 
 	// finally if the driver supports the ASIOOutputReady() optimization, do it here, all data are in place
@@ -276,6 +392,7 @@ ASIOTime* bufferSwitchTimeInfo(ASIOTime* timeInfo, long index, ASIOBool processN
 	else
 		processedSamples += buffSize;
 
+	asioDriverInfo.profiler.leave();
 	return 0L;
 }
 
@@ -283,7 +400,7 @@ ASIOTime* bufferSwitchTimeInfo(ASIOTime* timeInfo, long index, ASIOBool processN
 void bufferSwitch(long index, ASIOBool processNow)
 {	// the actual processing callback.
 	// Beware that this is normally in a seperate thread, hence be sure that you take care
-	// about thread synchronization. This is omitted here for simplicity.
+	// about thread synchronization, bufferSwitchTimeInfo() does.
 
 	// as this is a "back door" into the bufferSwitchTimeInfo a timeInfo needs to be created
 	// though it will only set the timeInfo.samplePosition and timeInfo.systemTime fields and the according flags
@@ -308,6 +425,10 @@ void sampleRateChanged(ASIOSampleRate sRate)
 	// might not have even changed, maybe only the sample rate status of an
 	// AES/EBU or S/PDIF digital input at the audio device.
 	// You might have to update time/sample related conversion routines, etc.
+	// This comes from a thread of the driver, the main loop stops the buffers and
+	// sets the processing up for the new rate.
+	if (sRate > 0.)
+		asioDriverInfo.changedRate.store(sRate);
 }
 
 //----------------------------------------------------------------------------------
@@ -376,6 +497,187 @@ long asioMessages(long selector, long value, void* message, double* opt)
 
 
 //----------------------------------------------------------------------------------
+static void skip_conversion(ASIOChannelState*, const void*, void*, long)
+{
+}
+
+// the nodes of the graph, the inputs of one bank or convolver each
+static void highpass_node(void* state, const float* const* inputs, float* const* outputs, long frames)
+{
+	((ASIOBiquadBank*)state)->process(inputs, outputs, frames);
+}
+
+static void convolve_node(void* state, const float* const* inputs, float* const* outputs, long frames)
+{
+	((ASIOConvolver*)state)->process(inputs, outputs, frames);
+}
+
+// everything in the processing that depends on the sample rate: the profiler, the
+// meters, the highpass, the convolvers and the analyzer, and the graph between them.
+// Allocates, only while the driver is stopped and none of their threads runs.
+ASIOError setup_processing(DriverInfo* asioDriverInfo)
+{
+	long i;
+	asioDriverInfo->profiler.setup(asioDriverInfo->sampleRate, asioDriverInfo->preferredSize);
+	asioDriverInfo->meter.setup(asioDriverInfo->inputBuffers + asioDriverInfo->outputBuffers, asioDriverInfo->sampleRate);
+	// two stages of q 1 / sqrt(2) in series are Linkwitz-Riley, Butterworth needs
+	// the poles of a 4th order one
+	const long lanes = ASIOBiquadBank::kLanes;
+	bool ready = asioDriverInfo->highpass && asioDriverInfo->hostFormat == kASIOHostFloat32;
+	for (i = 0; i < asioDriverInfo->inputBuffers && ready; i += lanes)
+	{
+		long channels = asioDriverInfo->inputBuffers - i < lanes ? asioDriverInfo->inputBuffers - i : lanes;
+		ready = asioDriverInfo->highpassFilters[i / lanes].setup(channels, 2);
+	}
+	if (ready)
+	{
+		static const double q[2] = { 0.54119610, 1.30656296 };
+		for (i = 0; i < asioDriverInfo->inputBuffers; i++)
+		{
+			for (long s = 0; s < 2; s++)
+			{
+				double coefficients[5];
+				ASIODesignBiquad(coefficients, kASIOBiquadHighpass, 20. / asioDriverInfo->sampleRate, q[s], 0.);
+				asioDriverInfo->highpassFilters[i / lanes].setStage(i % lanes, s, coefficients);
+			}
+		}
+	}
+	else
+		asioDriverInfo->highpass = false;
+
+	// as many convolvers as the graph has threads, with an equal share of the inputs
+	long threads = asioDriverInfo->graphWorkers + 1;
+	threads = threads < 1 ? 1 : threads > ASIOGraph::kMaxThreads ? (long)ASIOGraph::kMaxThreads : threads;
+	long share = (asioDriverInfo->inputBuffers + threads - 1) / threads;
+	share = share < 1 ? 1 : share;
+	asioDriverInfo->numConvolvers = 0;
+
+	// exponentially decaying noise, 60 dB down after 2 s and a different one on each
+	// input, scaled to unit energy
+	long length = (long)(2. * asioDriverInfo->sampleRate);
+	ready = asioDriverInfo->convolve && asioDriverInfo->hostFormat == kASIOHostFloat32;
+	for (i = 0; i < asioDriverInfo->inputBuffers && ready; i += share)
+	{
+		long channels = asioDriverInfo->inputBuffers - i < share ? asioDriverInfo->inputBuffers - i : share;
+		ready = asioDriverInfo->convolvers[i / share].setup(channels, asioDriverInfo->preferredSize, length);
+		asioDriverInfo->numConvolvers++;
+	}
+	if (ready)
+	{
+		std::vector<float> room(length);
+		unsigned int seed = 1;
+		for (i = 0; i < asioDriverInfo->inputBuffers; i++)
+		{
+			double energy = 0.;
+			for (long j = 0; j < length; j++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				room[j] = (float)(((int)(seed >> 8) - 0x800000) / (double)0x800000 * exp(-6.9 * j / length));
+				energy += room[j] * room[j];
+			}
+			float scale = (float)(1. / sqrt(energy));
+			for (long j = 0; j < length; j++)
+				room[j] *= scale;
+			asioDriverInfo->convolvers[i / share].setImpulse(i % share, &room[0], length);
+		}
+	}
+	else
+	{
+		asioDriverInfo->convolve = false;
+		asioDriverInfo->numConvolvers = 0;
+	}
+
+	// inputSamples -> highpass -> convolver -> host input buffers, and -6 dB from
+	// there to the outputs. The ports of a bank or convolver node are its channels,
+	// the nodes of different ones are independent and run in parallel on the
+	// workers of the graph.
+	asioDriverInfo->graph.clear();
+	asioDriverInfo->monitorChannels = 0;
+	if (asioDriverInfo->useGraph)
+	{
+		ASIOGraph& graph = asioDriverInfo->graph;
+		long inputs = asioDriverInfo->inputBuffers;
+		long highpass = -1, convolve = -1;
+		for (i = 0; i < inputs; i++)
+		{
+			if (asioDriverInfo->highpass && i % lanes == 0)
+			{
+				ASIOBiquadBank* bank = &asioDriverInfo->highpassFilters[i / lanes];
+				highpass = graph.addNode(highpass_node, bank, bank->getNumChannels(), bank->getNumChannels());
+			}
+			if (asioDriverInfo->convolve && i % share == 0)
+			{
+				ASIOConvolver* convolver = &asioDriverInfo->convolvers[i / share];
+				convolve = graph.addNode(convolve_node, convolver, convolver->getNumChannels(), convolver->getNumChannels());
+			}
+
+			long node = graph.addSource(asioDriverInfo->inputSamples[i]);
+			long port = 0;
+			if (highpass >= 0)
+			{
+				graph.connect(node, port, highpass, i % lanes);
+				node = highpass;
+				port = i % lanes;
+			}
+			if (convolve >= 0)
+			{
+				graph.connect(node, port, convolve, i % share);
+				node = convolve;
+				port = i % share;
+			}
+			graph.connect(node, port, graph.addSink((float*)asioDriverInfo->hostBuffers[i]), 0);
+			if (asioDriverInfo->monitor && i < asioDriverInfo->outputBuffers)
+			{
+				long gain = graph.addGain(0.5f);
+				graph.connect(node, port, gain, 0);
+				graph.connect(gain, 0, graph.addSink((float*)asioDriverInfo->hostBuffers[inputs + i]), 0);
+				asioDriverInfo->monitorChannels++;
+			}
+		}
+		if (!graph.compile(asioDriverInfo->preferredSize))
+			return ASE_NoMemory;
+	}
+
+	// 8192 point spectra at 50 % overlap, averaged over 4
+	if (asioDriverInfo->analyze)
+	{
+		long types[kMaxInputChannels];
+		for (i = 0; i < asioDriverInfo->inputBuffers; i++)
+		{
+			types[i] = asioDriverInfo->channelInfos[i].type;
+			asioDriverInfo->analyzerSources[0][i] = asioDriverInfo->bufferInfos[i].buffers[0];
+			asioDriverInfo->analyzerSources[1][i] = asioDriverInfo->bufferInfos[i].buffers[1];
+		}
+		if (!asioDriverInfo->analyzer.setup(asioDriverInfo->inputBuffers, types, asioDriverInfo->preferredSize,
+			asioDriverInfo->sampleRate, 8192, 4096, 4))
+			asioDriverInfo->analyze = false;
+	}
+	return ASE_OK;
+}
+
+// the threads around the buffer switch and the meter reader of the main loop, and
+// back, while the driver is stopped
+long start_processing(DriverInfo* asioDriverInfo)
+{
+	long meterReader = asioDriverInfo->meter.openReader();
+	if (asioDriverInfo->analyze)
+		asioDriverInfo->analyzer.start();
+	for (long c = 0; c < asioDriverInfo->numConvolvers; c++)
+		asioDriverInfo->convolvers[c].start(1);
+	if (asioDriverInfo->useGraph && asioDriverInfo->graphWorkers > 0)
+		asioDriverInfo->graph.start(asioDriverInfo->graphWorkers);
+	return meterReader;
+}
+
+void stop_processing(DriverInfo* asioDriverInfo, long meterReader)
+{
+	asioDriverInfo->analyzer.stop();
+	for (long c = 0; c < asioDriverInfo->numConvolvers; c++)
+		asioDriverInfo->convolvers[c].stop();
+	asioDriverInfo->graph.stop();
+	asioDriverInfo->meter.closeReader(meterReader);
+}
+
 ASIOError create_asio_buffers(DriverInfo* asioDriverInfo)
 {	// create buffers for all inputs and outputs of the card with the 
 	// preferredSize from ASIOGetBufferSize() as buffer size
@@ -415,6 +717,12 @@ ASIOError create_asio_buffers(DriverInfo* asioDriverInfo)
 		asioDriverInfo->preferredSize, &asioCallbacks);
 	if (result == ASE_OK)
 	{
+		// feedback DSP slows down by orders of magnitude on denormals, some drivers
+		// also call the buffer switch from the thread that starts them
+		asioDriverInfo->denormalMode = ASIOSetDenormalMode(asioDriverInfo->denormals ? kASIODenormalsOn : kASIODenormalsOff);
+		printf("ASIOSetDenormalMode (FTZ %s, DAZ %s);\n", (asioDriverInfo->denormalMode & kASIOFlushToZero) ? "on" : "off",
+			(asioDriverInfo->denormalMode & kASIODenormalsAreZero) ? "on" : "off");
+
 		// now get all the buffer details, sample word length, name, word clock group and activation
 		for (i = 0; i < asioDriverInfo->inputBuffers + asioDriverInfo->outputBuffers; i++)
 		{
@@ -435,12 +743,116 @@ ASIOError create_asio_buffers(DriverInfo* asioDriverInfo)
 			if (result == ASE_OK)
 				printf("ASIOGetLatencies (input: %d, output: %d);\n", asioDriverInfo->inputLatency, asioDriverInfo->outputLatency);
 		}
+
+		if (result == ASE_OK)
+		{
+			// resolve the conversion of every channel once, the buffer switch
+			// doesn't look at the sample types anymore
+			asioDriverInfo->useGraph = asioDriverInfo->hostFormat == kASIOHostFloat32 && asioDriverInfo->inputBuffers > 0 &&
+				(asioDriverInfo->highpass || asioDriverInfo->convolve || asioDriverInfo->monitor);
+			for (i = 0; i < asioDriverInfo->inputBuffers + asioDriverInfo->outputBuffers; i++)
+			{
+				ASIOBufferInfo* buffer = &asioDriverInfo->bufferInfos[i];
+				ChannelConversion* c = &asioDriverInfo->conversions[i];
+				size_t hostBytes = asioDriverInfo->preferredSize *
+					(asioDriverInfo->hostFormat == kASIOHostFloat64 ? sizeof(double) : sizeof(float));
+				char* host = new char[hostBytes];
+				memset(host, 0, hostBytes);
+				asioDriverInfo->hostBuffers[i] = host;
+
+				if (buffer->isInput)
+				{
+					c->convert = ASIOGetInputConverter(asioDriverInfo->channelInfos[i].type, asioDriverInfo->hostFormat);
+					c->source[0] = buffer->buffers[0];
+					c->source[1] = buffer->buffers[1];
+					c->dest[0] = c->dest[1] = host;
+					c->elide = false;
+					if (asioDriverInfo->useGraph)
+					{
+						asioDriverInfo->inputSamples[i] = new float[asioDriverInfo->preferredSize];
+						memset(asioDriverInfo->inputSamples[i], 0, asioDriverInfo->preferredSize * sizeof(float));
+						c->dest[0] = c->dest[1] = asioDriverInfo->inputSamples[i];
+					}
+				}
+				else
+				{
+					ASIOChannelConverter plain = ASIOGetOutputConverter(asioDriverInfo->channelInfos[i].type, asioDriverInfo->hostFormat);
+					if (asioDriverInfo->dither || asioDriverInfo->noiseShaping != kASIONoiseShapingOff)
+						c->convert = ASIOGetRequantizingOutputConverter(asioDriverInfo->channelInfos[i].type, asioDriverInfo->hostFormat);
+					else
+						c->convert = plain;
+					c->source[0] = c->source[1] = host;
+					c->dest[0] = buffer->buffers[0];
+					c->dest[1] = buffer->buffers[1];
+
+					// dither and noise shaping turn zeros into noise, the requantizing converters
+					// always convert. The types they leave to the plain converter still elide.
+					// The device halves start with whatever the driver left in them.
+					c->elide = c->convert && c->convert == plain;
+				}
+				c->written = false;
+				c->hostSilent = true;
+				c->silentHalves = 0;
+
+				ASIOInitChannelState(&c->state, (unsigned int)i + 1, asioDriverInfo->dither, asioDriverInfo->noiseShaping);
+
+				// DSD channels are left alone
+				if (!c->convert)
+					c->convert = skip_conversion;
+			}
+			result = setup_processing(asioDriverInfo);
+		}
 	}
 	return result;
 }
 
+void dispose_host_buffers(DriverInfo* asioDriverInfo)
+{
+	for (long i = 0; i < asioDriverInfo->inputBuffers + asioDriverInfo->outputBuffers; i++)
+	{
+		delete[] asioDriverInfo->hostBuffers[i];
+		asioDriverInfo->hostBuffers[i] = 0;
+	}
+	for (long i = 0; i < asioDriverInfo->inputBuffers; i++)
+	{
+		delete[] asioDriverInfo->inputSamples[i];
+		asioDriverInfo->inputSamples[i] = 0;
+	}
+	asioDriverInfo->graph.clear();
+}
+
 int main(int argc, char* argv[])
 {
+	// select the sample conversion kernels once, "-scalar" forces the reference code
+	ASIOConvertISA isa = kASIOConvertAuto;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-scalar") == 0)
+			isa = kASIOConvertScalar;
+		else if (strcmp(argv[i], "-dither") == 0)
+			asioDriverInfo.dither = true;
+		else if (strcmp(argv[i], "-shape1") == 0)
+			asioDriverInfo.noiseShaping = kASIONoiseShapingFirstOrder;
+		else if (strcmp(argv[i], "-shape2") == 0)
+			asioDriverInfo.noiseShaping = kASIONoiseShapingSecondOrder;
+		else if (strcmp(argv[i], "-double") == 0)
+			asioDriverInfo.hostFormat = kASIOHostFloat64;
+		else if (strcmp(argv[i], "-denormals") == 0)
+			asioDriverInfo.denormals = true;
+		else if (strcmp(argv[i], "-analyze") == 0)
+			asioDriverInfo.analyze = true;
+		else if (strcmp(argv[i], "-highpass") == 0)
+			asioDriverInfo.highpass = true;
+		else if (strcmp(argv[i], "-convolve") == 0)
+			asioDriverInfo.convolve = true;
+		else if (strcmp(argv[i], "-monitor") == 0)
+			asioDriverInfo.monitor = true;
+		else if (strcmp(argv[i], "-workers") == 0 && i + 1 < argc)
+			asioDriverInfo.graphWorkers = atol(argv[++i]);
+	}
+	printf("ASIOSelectConvertKernels (%s);\n", ASIOGetConvertISAName(ASIOSelectConvertKernels(isa)));
+	printf("ASIOSelectDSPKernels (%s);\n", ASIOGetConvertISAName(ASIOSelectDSPKernels(isa)));
+
 	// load the driver, this will setup all the necessary internal data structures
 	if (loadAsioDriver((char*)ASIO_DRIVER_NAME))
 	{
@@ -464,6 +876,7 @@ int main(int argc, char* argv[])
 				asioCallbacks.bufferSwitchTimeInfo = &bufferSwitchTimeInfo;
 				if (create_asio_buffers(&asioDriverInfo) == ASE_OK)
 				{
+					long meterReader = start_processing(&asioDriverInfo);
 					if (ASIOStart() == ASE_OK)
 					{
 						// Now all is up and running
@@ -476,10 +889,30 @@ int main(int argc, char* argv[])
 							unsigned long dummy;
 							Delay(6, &dummy);
 #endif
-							fprintf(stdout, "%d ms / %d ms / %d samples", asioDriverInfo.sysRefTime, (long)(asioDriverInfo.nanoSeconds / 1000000.0), (long)asioDriverInfo.samples);
+							// the driver runs at another rate now, the processing is set up for it
+							// while the buffers are stopped
+							double rate = asioDriverInfo.changedRate.exchange(0.);
+							if (rate > 0. && rate != asioDriverInfo.sampleRate)
+							{
+								ASIOStop();
+								stop_processing(&asioDriverInfo, meterReader);
+								asioDriverInfo.sampleRate = rate;
+								printf("\nsampleRateChanged (sampleRate: %f);\n", rate);
+								if (setup_processing(&asioDriverInfo) != ASE_OK)
+									asioDriverInfo.stopped = true;
+								meterReader = start_processing(&asioDriverInfo);
+								if (asioDriverInfo.stopped || ASIOStart() != ASE_OK)
+									break;
+							}
+
+							// all positions of the same buffer, zeros until the first one
+							ASIOTelemetrySnapshot t;
+							if (!asioDriverInfo.telemetry.read(&t))
+								memset(&t, 0, sizeof(t));
+							fprintf(stdout, "%d ms / %d ms / %d samples", t.sysRefTime, (long)(t.nanoSeconds / 1000000.0), (long)t.samples);
 
 							// create a more readable time code format (the quick and dirty way)
-							double remainder = asioDriverInfo.tcSamples;
+							double remainder = t.tcSamples;
 							long hours = (long)(remainder / (asioDriverInfo.sampleRate * 3600));
 							remainder -= hours * asioDriverInfo.sampleRate * 3600;
 							long minutes = (long)(remainder / (asioDriverInfo.sampleRate * 60));
@@ -488,6 +921,56 @@ int main(int argc, char* argv[])
 							remainder -= seconds * asioDriverInfo.sampleRate;
 							fprintf(stdout, " / TC: %2.2d:%2.2d:%2.2d:%5.5d", (long)hours, (long)minutes, (long)seconds, (long)remainder);
 
+							// clipped output samples, the counters are read without disturbing the callback
+							unsigned long long clips = 0;
+							for (long i = asioDriverInfo.inputBuffers; i < asioDriverInfo.inputBuffers + asioDriverInfo.outputBuffers; i++)
+								clips += ASIOGetClipCount(&asioDriverInfo.conversions[i].state);
+							fprintf(stdout, " / clips: %llu", clips);
+
+							// the buffer switch against its deadline
+							ASIOProfilerStats stats;
+							asioDriverInfo.profiler.getStats(&stats);
+							fprintf(stdout, " / load: %.0f %.0f %.0f %.0f %% / missed: %llu", stats.loadP50, stats.loadP99,
+								stats.loadP999, stats.loadMax, stats.missed);
+
+							// share of the output halves that held silence already and weren't converted
+							unsigned long long halves = asioDriverInfo.outputHalves.load(std::memory_order_relaxed);
+							if (halves > 0)
+								fprintf(stdout, " / silent: %.0f %%", 100. * asioDriverInfo.silentSkips.load(std::memory_order_relaxed) / halves);
+
+							// loudest input, polled without waiting for the callback
+							static ASIOMeterLevels levels[kMaxInputChannels + kMaxOutputChannels];
+							if (asioDriverInfo.hostFormat == kASIOHostFloat32 && asioDriverInfo.inputBuffers > 0)
+							{
+								asioDriverInfo.meter.read(meterReader, levels, asioDriverInfo.inputBuffers);
+								float truePeak = 0.f;
+								for (long i = 0; i < asioDriverInfo.inputBuffers; i++)
+									truePeak = levels[i].truePeak > truePeak ? levels[i].truePeak : truePeak;
+								fprintf(stdout, " / in: %.1f dBTP", truePeak > 1e-10f ? 20. * log10(truePeak) : -200.);
+							}
+
+							// strongest bin of all analyzed inputs
+							static float spectra[kMaxInputChannels * (8192 / 2 + 1)];
+							if (asioDriverInfo.analyze && asioDriverInfo.inputBuffers > 0)
+							{
+								long numBins = asioDriverInfo.analyzer.getNumBins();
+								long count = asioDriverInfo.inputBuffers * numBins;
+								asioDriverInfo.analyzer.read(spectra, asioDriverInfo.inputBuffers);
+								long strongest = 0;
+								for (long i = 1; i < count; i++)
+									strongest = spectra[i] > spectra[strongest] ? i : strongest;
+								fprintf(stdout, " / peak: %.0f Hz", asioDriverInfo.analyzer.getBinFrequency(strongest % numBins));
+							}
+
+							// tail partitions the workers didn't finish in time
+							if (asioDriverInfo.convolve)
+							{
+								unsigned long late = 0;
+								for (long c = 0; c < asioDriverInfo.numConvolvers; c++)
+									late += asioDriverInfo.convolvers[c].getLate();
+								fprintf(stdout, " / late: %lu", late);
+							}
+
 							fprintf(stdout, "     \r");
 #if !MAC
 							fflush(stdout);
@@ -495,7 +978,9 @@ int main(int argc, char* argv[])
 						}
 						ASIOStop();
 					}
+					stop_processing(&asioDriverInfo, meterReader);
 					ASIODisposeBuffers();
+					dispose_host_buffers(&asioDriverInfo);
 				}
 			}
 			ASIOExit();
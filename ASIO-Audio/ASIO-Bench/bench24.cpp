@@ -0,0 +1,93 @@
+// packed 24 bit, byte swap and shift conversions: bytes/cycle of the scalar reference against the
+// SIMD kernels, bytes are counted as read plus written per call
+
+#include "benchutil.h"
+#include "ASIOConvertSamples.h"
+
+typedef struct Int24Case
+{
+	const char *name;
+	long readBytes;		// per frame, both channels for stereo
+	long writeBytes;
+	bool inPlace;		// out is refilled from in before every run
+	bool floatInput;
+	void (*run)(ASIOConvertSamples &c, char *left, char *right, char *out, long frames);
+} Int24Case;
+
+static const Int24Case cases[] =
+{
+	{ "convertMono24", 4, 3, false, false,
+		[](ASIOConvertSamples &c, char *l, char *, char *o, long f) { c.convertMono24((long*)l, o, f); } },
+	{ "convertMono24SmallEndian", 4, 3, false, false,
+		[](ASIOConvertSamples &c, char *l, char *, char *o, long f) { c.convertMono24SmallEndian((long*)l, o, f); } },
+	{ "convertStereo24Interleaved", 8, 6, false, false,
+		[](ASIOConvertSamples &c, char *l, char *r, char *o, long f) { c.convertStereo24Interleaved((long*)l, (long*)r, o, f); } },
+	{ "convertStereo24InterleavedSE", 8, 6, false, false,
+		[](ASIOConvertSamples &c, char *l, char *r, char *o, long f) { c.convertStereo24InterleavedSmallEndian((long*)l, (long*)r, o, f); } },
+	{ "convertStereo24", 8, 6, false, false,
+		[](ASIOConvertSamples &c, char *l, char *r, char *o, long f) { c.convertStereo24((long*)l, (long*)r, o, o + f * 3, f); } },
+	{ "convertStereo24SmallEndian", 8, 6, false, false,
+		[](ASIOConvertSamples &c, char *l, char *r, char *o, long f) { c.convertStereo24SmallEndian((long*)l, (long*)r, o, o + f * 3, f); } },
+	{ "int32to24inPlace", 4, 3, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.int32to24inPlace(o, f); } },
+	{ "int24to32inPlace", 3, 4, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.int24to32inPlace(o, f); } },
+	{ "int24to16inPlace", 3, 2, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.int24to16inPlace(o, f); } },
+	{ "float32toInt24inPlace", 4, 3, true, true,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.float32toInt24inPlace((float*)o, f); } },
+	{ "shift32 to 16", 4, 2, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.shift32(o, 8, 2, false, f); } },
+	{ "shift32 to 24 swapped", 4, 3, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.shift32(o, 8, 3, true, f); } },
+	{ "shift32 to 32 swapped", 4, 4, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.shift32(o, 8, 4, true, f); } },
+	{ "reverseEndian 16", 2, 2, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.reverseEndian(o, 2, f); } },
+	{ "reverseEndian 24", 3, 3, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.reverseEndian(o, 3, f); } },
+	{ "reverseEndian 32", 4, 4, true, false,
+		[](ASIOConvertSamples &c, char *, char *, char *o, long f) { c.reverseEndian(o, 4, f); } },
+};
+
+static const int numCases = sizeof(cases) / sizeof(cases[0]);
+
+void benchInt24(long frames)
+{
+	ASIOConvertSamples convert;
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 2000;
+
+	char *left = (char*)benchAlloc(frames * 4);
+	char *right = (char*)benchAlloc(frames * 4);
+	char *out = (char*)benchAlloc(frames * 8);
+	char *floats = (char*)benchAlloc(frames * 4);
+	benchFillRandom(left, frames * 4, 1);
+	benchFillRandom(right, frames * 4, 2);
+	benchFillFloat((float*)floats, frames);
+
+	printf("%-30s %12s %12s %8s\n", "", ASIOGetConvertISAName(kASIOConvertScalar), ASIOGetConvertISAName(best), "speedup");
+	for(int i = 0; i < numCases; i++)
+	{
+		const Int24Case &c = cases[i];
+		char *in = c.floatInput ? floats : left;
+		double bytes = (double)(c.readBytes + c.writeBytes) * frames;
+		double cycles[2];
+		for(int pass = 0; pass < 2; pass++)
+		{
+			ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+			cycles[pass] = benchMinCycles(
+				[&]() { if(c.inPlace) memcpy(out, in, frames * 4); },
+				[&]() { c.run(convert, in, right, out, frames); },
+				repeats);
+		}
+		printf("%-30s %8.2f B/c %8.2f B/c %7.1fx\n", c.name,
+			bytes / cycles[0], bytes / cycles[1], cycles[0] / cycles[1]);
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+
+	benchFree(left);
+	benchFree(right);
+	benchFree(out);
+	benchFree(floats);
+}
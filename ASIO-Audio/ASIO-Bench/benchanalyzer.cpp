@@ -0,0 +1,87 @@
+// Spectrum analysis: the real FFT alone from 256 to 65536 points, then ASIOAnalyzer on
+// 32 Int32LSB channels at 96 kHz with 8192 point windows at 50 % overlap. The worker
+// is timed on this thread through processPending() over one second of buffers of
+// frames samples, load is its cpu time in percent of that second and channels/core
+// how many channels one core keeps up with. push is the cost of the buffer switch side.
+
+#include "benchutil.h"
+#include "ASIOAnalyzer.h"
+#include "ASIOFFT.h"
+#include "asio.h"
+#include <math.h>
+
+static const long numChannels = 32;
+static const double sampleRate = 96000.;
+
+void benchAnalyzer(long frames)
+{
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	double ticks = benchTicksPerSecond();
+
+	float *samples = (float*)benchAlloc(65536 * sizeof(float));
+	float *re = (float*)benchAlloc((65536 / 2 + 1) * sizeof(float));
+	float *im = (float*)benchAlloc((65536 / 2 + 1) * sizeof(float));
+	benchFillFloat(samples, 65536);
+
+	printf("%-22s %-8s %10s %12s\n", "", "", "us/fft", "ns/N log N");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		ASIOSelectDSPKernels(isa);
+		for(long size = 256; size <= 65536; size *= 4)
+		{
+			ASIOFFT fft;
+			fft.setup(size);
+			int repeats = (int)(4000000 / size) + 5;
+			double seconds = benchMinSeconds([]() {}, [&]() { fft.forward(samples, re, im); }, repeats);
+			char name[32];
+			sprintf(name, "fft %ld", size);
+			printf("%-22s %-8s %10.2f %12.3f\n", name, ASIOGetConvertISAName(isa), 1e6 * seconds,
+				1e9 * seconds / (size * log2((double)size)));
+		}
+	}
+
+	// one second of 32 channels, each buffer a slice of the same noise
+	long buffers = (long)(sampleRate / frames);
+	int *device = (int*)benchAlloc(frames * numChannels * sizeof(int));
+	benchFillRandom(device, frames * numChannels * sizeof(int));
+	const void *sources[numChannels];
+	long types[numChannels];
+	for(long ch = 0; ch < numChannels; ch++)
+	{
+		sources[ch] = device + ch * frames;
+		types[ch] = ASIOSTInt32LSB;
+	}
+
+	printf("\n%-22s %-8s %10s %13s %12s %10s\n", "", "", "load", "channels/core", "push c", "push load");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		ASIOSelectDSPKernels(isa);
+		ASIOAnalyzer analyzer;
+		analyzer.setup(numChannels, types, frames, sampleRate, 8192, 4096, 4);
+
+		auto second = [&]()
+		{
+			for(long b = 0; b < buffers; b++)
+			{
+				analyzer.push(sources, frames);
+				analyzer.processPending();
+			}
+		};
+		double seconds = benchMinSeconds([]() {}, second, 3);
+		double pushCycles = benchMinCycles([&]() { analyzer.processPending(); },
+			[&]() { analyzer.push(sources, frames); }, 200);
+		double duration = buffers * frames / sampleRate;
+
+		printf("%-22s %-8s %8.2f %% %13.0f %12.0f %8.3f %%\n", "32 ch 96k 8192/50%", ASIOGetConvertISAName(isa),
+			100. * seconds / duration, numChannels * duration / seconds, pushCycles,
+			100. * pushCycles / ticks / (frames / sampleRate));
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+	benchFree(device);
+	benchFree(samples);
+	benchFree(re);
+	benchFree(im);
+}
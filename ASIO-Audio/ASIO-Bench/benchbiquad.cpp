@@ -0,0 +1,125 @@
+// Biquad bank: an 8 band equalizer on 32 and 64 channels, the usual serial loop that
+// filters one channel after the other against ASIOBiquadBank on every instruction set.
+// The bank interleaves blocks of 16 channels and runs the same stage of all of them in
+// one instruction stream. c/stage is per sample and stage, load the cost of one buffer
+// in percent of its duration at 48 kHz.
+
+#include "benchutil.h"
+#include "ASIOBiquadBank.h"
+#include "ASIODenormals.h"
+#include "ASIOFilterDesign.h"
+#include <vector>
+
+static const long numStages = 8;
+
+typedef struct Biquad
+{
+	float b0, b1, b2, a1, a2;
+} Biquad;
+
+// transposed direct form II, stage after stage over the buffer of one channel
+static void serialChannel(const Biquad *stages, float *state, const float *source, float *dest, long frames)
+{
+	memmove(dest, source, frames * sizeof(float));
+	for(long s = 0; s < numStages; s++)
+	{
+		const Biquad &q = stages[s];
+		float z1 = state[2 * s];
+		float z2 = state[2 * s + 1];
+		for(long i = 0; i < frames; i++)
+		{
+			float x = dest[i];
+			float y = q.b0 * x + z1;
+			z1 = q.b1 * x - q.a1 * y + z2;
+			z2 = q.b2 * x - q.a2 * y;
+			dest[i] = y;
+		}
+		state[2 * s] = z1;
+		state[2 * s + 1] = z2;
+	}
+}
+
+// peaks from 60 Hz up in octaves, +-6 dB in turns, a little different per channel
+static void design(long channel, long stage, double *c)
+{
+	double frequency = 60. * (1 << stage) * (1. + .01 * (channel % 7));
+	ASIODesignBiquad(c, kASIOBiquadPeak, frequency / 48000., 1., (stage & 1) ? -6. : 6.);
+}
+
+void benchBiquad(long frames)
+{
+	static const long channelCounts[] = { 32, 64 };
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 50;
+	double ticks = benchTicksPerSecond();
+	long denormals = ASIOGetDenormalMode();
+	ASIOSetDenormalMode(kASIODenormalsOff);
+
+	printf("%-22s %-8s %10s %10s %9s\n", "", "", "c/stage", "load", "speedup");
+	for(int n = 0; n < 2; n++)
+	{
+		long numChannels = channelCounts[n];
+		float *in = (float*)benchAlloc(frames * numChannels * sizeof(float));
+		float *out = (float*)benchAlloc(frames * numChannels * sizeof(float));
+		benchFillFloat(in, frames * numChannels);
+		std::vector<const float*> sources(numChannels);
+		std::vector<float*> dests(numChannels);
+		for(long ch = 0; ch < numChannels; ch++)
+		{
+			sources[ch] = in + ch * frames;
+			dests[ch] = out + ch * frames;
+		}
+		double samples = (double)frames * numChannels * numStages;
+		char name[32];
+		sprintf(name, "%ld ch %ld stages", numChannels, numStages);
+
+		// one channel after the other
+		std::vector<Biquad> stages(numChannels * numStages);
+		std::vector<float> state(numChannels * numStages * 2, 0.f);
+		for(long ch = 0; ch < numChannels; ch++)
+		{
+			for(long s = 0; s < numStages; s++)
+			{
+				double c[5];
+				design(ch, s, c);
+				Biquad q = { (float)c[0], (float)c[1], (float)c[2], (float)c[3], (float)c[4] };
+				stages[ch * numStages + s] = q;
+			}
+		}
+		auto serial = [&]()
+		{
+			for(long ch = 0; ch < numChannels; ch++)
+				serialChannel(&stages[ch * numStages], &state[ch * numStages * 2], sources[ch], dests[ch], frames);
+		};
+		double serialCycles = benchMinCycles([]() {}, serial, repeats);
+		printf("%-22s %-8s %10.3f %8.2f %% %9s\n", name, "serial", serialCycles / samples,
+			100. * serialCycles / ticks / (frames / 48000.), "1.0");
+
+		for(int isa = kASIOConvertScalar; isa <= best; isa++)
+		{
+			ASIOSelectConvertKernels((ASIOConvertISA)isa);
+			ASIOSelectDSPKernels((ASIOConvertISA)isa);
+			ASIOBiquadBank bank;
+			bank.setup(numChannels, numStages);
+			for(long ch = 0; ch < numChannels; ch++)
+			{
+				for(long s = 0; s < numStages; s++)
+				{
+					double c[5];
+					design(ch, s, c);
+					bank.setStage(ch, s, c);
+				}
+			}
+			double cycles = benchMinCycles([]() {}, [&]() { bank.process(&sources[0], &dests[0], frames); }, repeats);
+			char speedup[16];
+			sprintf(speedup, "%.1f", serialCycles / cycles);
+			printf("%-22s %-8s %10.3f %8.2f %% %9s\n", "", ASIOGetConvertISAName((ASIOConvertISA)isa),
+				cycles / samples, 100. * cycles / ticks / (frames / 48000.), speedup);
+		}
+		benchFree(in);
+		benchFree(out);
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+	ASIOSetDenormalMode(denormals);
+}
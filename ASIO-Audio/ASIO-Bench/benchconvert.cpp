@@ -0,0 +1,282 @@
+// Every ASIOConvertSamples method on every instruction set the cpu supports, from 32 to
+// 8192 frames, with warm and cold caches. Cold flushes the input and output buffers from
+// all cache levels before each run, warm runs them from L1 or L2 like a callback that
+// touches the same buffers every time. The frames argument is not used.
+//
+// ns/frame and GB/s are derived from the time stamp counter, GB/s counts the bytes read
+// plus written, cycles/sample is per output sample (a stereo frame has two). The table
+// shows ns/frame per instruction set and the other two for the best one, -json writes
+// all of them.
+
+#include "benchutil.h"
+#include "asio.h"
+#include "ASIOConvertSamples.h"
+
+enum ConvertInput
+{
+	kInputInt = 0,	// random bytes
+	kInputFloat,	// floats in -1..1
+	kInputDouble	// doubles in -1..1
+};
+
+typedef struct ConvertCase
+{
+	const char *name;
+	long readBytes;		// per frame, all channels
+	long writeBytes;
+	long samples;		// output samples per frame
+	long inPlanes;		// planar channels of the input, 1 for interleaved and mono
+	long outPlanes;
+	bool inPlace;		// out is refilled from in before every run
+	ConvertInput input;
+	void (*run)(ASIOConvertSamples &c, char *in, char *out, long frames);
+} ConvertCase;
+
+// planar channels follow each other in the buffers, every one holds the largest frame count
+static const long maxFrames = 8192;
+static const long maxChannels = 8;
+static const long channelBytes = maxFrames * 8;
+
+static inline long *channel(char *buffer, long n)
+{
+	return (long*)(buffer + n * channelBytes);
+}
+
+// every plane of a buffer out of all caches, bytes is the total over the planes
+static void flushPlanes(char *buffer, long planes, long bytes)
+{
+	for(long n = 0; n < planes; n++)
+		benchFlush(channel(buffer, n), bytes / planes);
+}
+
+static const float mixGains[4] = { .5f, .25f, .125f, .0625f };
+
+static const ConvertCase cases[] =
+{
+	// mono
+	{ "convertMono8", 4, 1, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertMono8((long*)i, o, f); } },
+	{ "convertMono8Unsigned", 4, 1, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertMono8Unsigned((long*)i, o, f); } },
+	{ "convertMono16", 4, 2, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertMono16((long*)i, (short*)o, f); } },
+	{ "convertMono16SmallEndian", 4, 2, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertMono16SmallEndian((long*)i, (short*)o, f); } },
+	{ "convertMono24", 4, 3, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertMono24((long*)i, o, f); } },
+	{ "convertMono24SmallEndian", 4, 3, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertMono24SmallEndian((long*)i, o, f); } },
+
+	// stereo interleaved
+	{ "convertStereo8Interleaved", 8, 2, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo8Interleaved(channel(i, 0), channel(i, 1), o, f); } },
+	{ "convertStereo8InterleavedUnsigned", 8, 2, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo8InterleavedUnsigned(channel(i, 0), channel(i, 1), o, f); } },
+	{ "convertStereo16Interleaved", 8, 4, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo16Interleaved(channel(i, 0), channel(i, 1), (short*)o, f); } },
+	{ "convertStereo16InterleavedSmallEndian", 8, 4, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo16InterleavedSmallEndian(channel(i, 0), channel(i, 1), (short*)o, f); } },
+	{ "convertStereo24Interleaved", 8, 6, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo24Interleaved(channel(i, 0), channel(i, 1), o, f); } },
+	{ "convertStereo24InterleavedSmallEndian", 8, 6, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo24InterleavedSmallEndian(channel(i, 0), channel(i, 1), o, f); } },
+
+	// stereo split
+	{ "convertStereo8", 8, 2, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo8(channel(i, 0), channel(i, 1), o, o + f, f); } },
+	{ "convertStereo8Unsigned", 8, 2, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo8Unsigned(channel(i, 0), channel(i, 1), o, o + f, f); } },
+	{ "convertStereo16", 8, 4, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo16(channel(i, 0), channel(i, 1), (short*)o, (short*)o + f, f); } },
+	{ "convertStereo16SmallEndian", 8, 4, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo16SmallEndian(channel(i, 0), channel(i, 1), (short*)o, (short*)o + f, f); } },
+	{ "convertStereo24", 8, 6, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo24(channel(i, 0), channel(i, 1), o, o + f * 3, f); } },
+	{ "convertStereo24SmallEndian", 8, 6, 2, 2, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.convertStereo24SmallEndian(channel(i, 0), channel(i, 1), o, o + f * 3, f); } },
+
+	// n channels
+	{ "interleave 8ch 16bit", 16, 16, 8, 8, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f)
+		{
+			void *channels[maxChannels];
+			for(long n = 0; n < maxChannels; n++)
+				channels[n] = channel(i, n);
+			c.interleave(channels, o, maxChannels, 2, f);
+		} },
+	{ "interleave 8ch 32bit", 32, 32, 8, 8, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f)
+		{
+			void *channels[maxChannels];
+			for(long n = 0; n < maxChannels; n++)
+				channels[n] = channel(i, n);
+			c.interleave(channels, o, maxChannels, 4, f);
+		} },
+	{ "deinterleave 8ch 24bit", 24, 24, 8, 1, 8, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f)
+		{
+			void *channels[maxChannels];
+			for(long n = 0; n < maxChannels; n++)
+				channels[n] = channel(o, n);
+			c.deinterleave(i, channels, maxChannels, 3, f);
+		} },
+	{ "deinterleave 8ch 32bit", 32, 32, 8, 1, 8, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f)
+		{
+			void *channels[maxChannels];
+			for(long n = 0; n < maxChannels; n++)
+				channels[n] = channel(o, n);
+			c.deinterleave(i, channels, maxChannels, 4, f);
+		} },
+
+	// integer in place
+	{ "int32msb16to16inPlace", 4, 2, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int32msb16to16inPlace((long*)o, f); } },
+	{ "int32lsb16to16inPlace", 4, 2, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int32lsb16to16inPlace((long*)o, f); } },
+	{ "int32msb16shiftedTo16inPlace", 4, 2, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int32msb16shiftedTo16inPlace((long*)o, f, 8); } },
+	{ "int24msbto16inPlace", 3, 2, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int24msbto16inPlace((unsigned char*)o, f); } },
+	{ "shift32 to 24 swapped", 4, 3, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.shift32(o, 8, 3, true, f); } },
+	{ "reverseEndian 32", 4, 4, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.reverseEndian(o, 4, f); } },
+	{ "int32to16inPlace", 4, 2, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int32to16inPlace(o, f); } },
+	{ "int24to16inPlace", 3, 2, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int24to16inPlace(o, f); } },
+	{ "int32to24inPlace", 4, 3, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int32to24inPlace(o, f); } },
+	{ "int16to24inPlace", 2, 3, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int16to24inPlace(o, f); } },
+	{ "int24to32inPlace", 3, 4, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int24to32inPlace(o, f); } },
+	{ "int16to32inPlace", 2, 4, 1, 1, 1, true, kInputInt,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.int16to32inPlace(o, f); } },
+
+	// float to integer in place
+	{ "float32toInt16inPlace", 4, 2, 1, 1, 1, true, kInputFloat,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.float32toInt16inPlace((float*)o, f); } },
+	{ "float32toInt24inPlace", 4, 3, 1, 1, 1, true, kInputFloat,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.float32toInt24inPlace((float*)o, f); } },
+	{ "float32toInt32inPlace", 4, 4, 1, 1, 1, true, kInputFloat,
+		[](ASIOConvertSamples &c, char *, char *o, long f) { c.float32toInt32inPlace((float*)o, f); } },
+
+	// any format to float
+	{ "toFloat32 Int16LSB", 2, 4, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.toFloat32(ASIOSTInt16LSB, i, (float*)o, f); } },
+	{ "toFloat32 Int24LSB", 3, 4, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.toFloat32(ASIOSTInt24LSB, i, (float*)o, f); } },
+	{ "toFloat32 Int32MSB", 4, 4, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.toFloat32(ASIOSTInt32MSB, i, (float*)o, f); } },
+	{ "toFloat32 Float32MSB", 4, 4, 1, 1, 1, false, kInputFloat,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.toFloat32(ASIOSTFloat32MSB, i, (float*)o, f); } },
+	{ "toFloat64 Int24LSB", 3, 8, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.toFloat64(ASIOSTInt24LSB, i, (double*)o, f); } },
+	{ "toFloat64 Int32LSB", 4, 8, 1, 1, 1, false, kInputInt,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.toFloat64(ASIOSTInt32LSB, i, (double*)o, f); } },
+
+	// float to any format
+	{ "fromFloat32 Int16LSB", 4, 2, 1, 1, 1, false, kInputFloat,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.fromFloat32(ASIOSTInt16LSB, (float*)i, o, f); } },
+	{ "fromFloat32 Int24LSB", 4, 3, 1, 1, 1, false, kInputFloat,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.fromFloat32(ASIOSTInt24LSB, (float*)i, o, f); } },
+	{ "fromFloat32 Int32MSB", 4, 4, 1, 1, 1, false, kInputFloat,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.fromFloat32(ASIOSTInt32MSB, (float*)i, o, f); } },
+	{ "fromFloat32 Float32MSB", 4, 4, 1, 1, 1, false, kInputFloat,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.fromFloat32(ASIOSTFloat32MSB, (float*)i, o, f); } },
+	{ "fromFloat64 Int24LSB", 8, 3, 1, 1, 1, false, kInputDouble,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.fromFloat64(ASIOSTInt24LSB, (double*)i, o, f); } },
+	{ "fromFloat64 Float64MSB", 8, 8, 1, 1, 1, false, kInputDouble,
+		[](ASIOConvertSamples &c, char *i, char *o, long f) { c.fromFloat64(ASIOSTFloat64MSB, (double*)i, o, f); } },
+	{ "mixFromFloat32 4 to Int24LSB", 16, 3, 1, 4, 1, false, kInputFloat,
+		[](ASIOConvertSamples &c, char *i, char *o, long f)
+		{
+			const float *sources[4] = { (float*)channel(i, 0), (float*)channel(i, 1), (float*)channel(i, 2), (float*)channel(i, 3) };
+			c.mixFromFloat32(ASIOSTInt24LSB, sources, mixGains, 4, o, f);
+		} },
+};
+
+static const int numCases = sizeof(cases) / sizeof(cases[0]);
+static const long frameCounts[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+
+void benchConvert(long)
+{
+	ASIOConvertSamples convert;
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const double ticksPerNs = benchTicksPerSecond() * 1e-9;
+	const long bufferBytes = maxChannels * channelBytes;
+	const int warmRepeats = 30;
+	const int coldRepeats = 10;
+
+	char *ints = (char*)benchAlloc(bufferBytes);
+	char *floats = (char*)benchAlloc(bufferBytes);
+	char *doubles = (char*)benchAlloc(bufferBytes);
+	char *out = (char*)benchAlloc(bufferBytes);
+	benchFillRandom(ints, bufferBytes);
+	benchFillFloat((float*)floats, bufferBytes / 4);
+	benchFillFloat((float*)doubles, bufferBytes / 8);
+	for(long i = bufferBytes / 8 - 1; i >= 0; i--)
+		((double*)doubles)[i] = ((float*)doubles)[i];
+
+	printf("%-38s %6s %5s", "ns/frame", "frames", "cache");
+	for(int isa = kASIOConvertScalar; isa <= best; isa++)
+		printf(" %8s", ASIOGetConvertISAName((ASIOConvertISA)isa));
+	printf(" %8s %9s\n", "GB/s", "c/sample");
+
+	for(int i = 0; i < numCases; i++)
+	{
+		const ConvertCase &c = cases[i];
+		char *in = c.input == kInputFloat ? floats : c.input == kInputDouble ? doubles : ints;
+		for(long frames : frameCounts)
+		{
+			for(int cold = 0; cold < 2; cold++)
+			{
+				// short warm runs are repeated back to back, the timer would dominate them
+				long runs = cold || frames >= 1024 ? 1 : 1024 / frames;
+				double ticks[kASIOConvertAuto];
+				for(int isa = kASIOConvertScalar; isa <= best; isa++)
+				{
+					ASIOSelectConvertKernels((ASIOConvertISA)isa);
+					ticks[isa] = benchMinCycles(
+						[&]()
+						{
+							if(c.inPlace)
+								memcpy(out, in, c.readBytes * frames);
+							if(cold)
+							{
+								flushPlanes(in, c.inPlanes, c.readBytes * frames);
+								flushPlanes(out, c.outPlanes, c.inPlace ? c.readBytes * frames : c.writeBytes * frames);
+							}
+							else if(!c.inPlace)
+								c.run(convert, in, out, frames);
+						},
+						[&]()
+						{
+							for(long r = 0; r < runs; r++)
+								c.run(convert, in, out, frames);
+						},
+						cold ? coldRepeats : warmRepeats) / runs;
+
+					double ns = ticks[isa] / ticksPerNs;
+					benchJsonResult("convert", c.name, ASIOGetConvertISAName((ASIOConvertISA)isa), frames,
+						cold ? "cold" : "warm", ns / frames, (double)(c.readBytes + c.writeBytes) * frames / ns,
+						ticks[isa] / (frames * c.samples));
+				}
+
+				printf("%-38s %6ld %5s", c.name, frames, cold ? "cold" : "warm");
+				for(int isa = kASIOConvertScalar; isa <= best; isa++)
+					printf(" %8.3f", ticks[isa] / ticksPerNs / frames);
+				printf(" %8.2f %9.3f\n", (double)(c.readBytes + c.writeBytes) * frames * ticksPerNs / ticks[best],
+					ticks[best] / (frames * c.samples));
+			}
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+
+	benchFree(ints);
+	benchFree(floats);
+	benchFree(doubles);
+	benchFree(out);
+}
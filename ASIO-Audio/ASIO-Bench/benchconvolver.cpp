@@ -0,0 +1,95 @@
+// Partitioned convolution: 8 channels through ASIOConvolver at 48 kHz, impulse responses of
+// .5 to 4 seconds at buffer sizes of 32 to 1024 frames. Every buffer is process() timed as the
+// buffer switch, then processPending() as the workers on the same thread, over 8 seconds.
+// switch is the buffer switch in percent of the buffer duration on average and p99.9 in the
+// slowest thousandth of the buffers, the worst one says more about the machine than about
+// the convolver. workers is the tail levels in percent of one core. The frames argument is
+// not used.
+
+#include "benchutil.h"
+#include "ASIOConvolver.h"
+#include "ASIODenormals.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+static const long numChannels = 8;
+static const double sampleRate = 48000.;
+static const double seconds = 8.;
+
+void benchConvolver(long)
+{
+	static const long blockSizes[] = { 32, 64, 128, 256, 512, 1024 };
+	static const double irSeconds[] = { .5, 1., 2., 4. };
+	double ticks = benchTicksPerSecond();
+	long denormals = ASIOGetDenormalMode();
+	ASIOSetDenormalMode(kASIODenormalsOff);
+
+	// exponentially decaying noise, 60 dB over the length, a different one per channel
+	long maxLength = (long)(irSeconds[3] * sampleRate);
+	float *ir = (float*)benchAlloc(maxLength * numChannels * sizeof(float));
+	float *in = (float*)benchAlloc(1024 * numChannels * sizeof(float));
+	float *out = (float*)benchAlloc(1024 * numChannels * sizeof(float));
+	benchFillFloat(in, 1024 * numChannels);
+
+	printf("%-22s %6s %20s %10s %9s %9s %9s\n", "", "frames", "partitions", "levels", "switch", "p99.9",
+		"workers");
+	for(int r = 0; r < 4; r++)
+	{
+		long length = (long)(irSeconds[r] * sampleRate);
+		for(long ch = 0; ch < numChannels; ch++)
+		{
+			float *h = ir + ch * maxLength;
+			benchFillFloat(h, length, 7 + ch);
+			for(long i = 0; i < length; i++)
+				h[i] *= (float)exp(-6.9 * i / length);
+		}
+		char name[32];
+		sprintf(name, "%.1f s, %ld ch", irSeconds[r], numChannels);
+		for(int b = 0; b < 6; b++)
+		{
+			long frames = blockSizes[b];
+			ASIOConvolver convolver;
+			convolver.setup(numChannels, frames, length);
+			for(long ch = 0; ch < numChannels; ch++)
+				convolver.setImpulse(ch, ir + ch * maxLength, length);
+			char partitions[32];
+			sprintf(partitions, "%ld..%ld", convolver.getPartitionSize(0),
+				convolver.getPartitionSize(convolver.getNumLevels() - 1));
+
+			const float *sources[numChannels];
+			float *dests[numChannels];
+			for(long ch = 0; ch < numChannels; ch++)
+			{
+				sources[ch] = in + ch * frames;
+				dests[ch] = out + ch * frames;
+			}
+			long buffers = (long)(seconds * sampleRate / frames);
+			std::vector<double> switchCycles(buffers);
+			double workerCycles = 0.;
+			for(long i = 0; i < buffers; i++)
+			{
+				unsigned long long t0 = benchCycles();
+				convolver.process(sources, dests, frames);
+				unsigned long long t1 = benchCycles();
+				convolver.processPending();
+				unsigned long long t2 = benchCycles();
+				switchCycles[i] = (double)(t1 - t0);
+				workerCycles += (double)(t2 - t1);
+			}
+			double buffer = ticks * frames / sampleRate;
+			double average = 0.;
+			for(long i = 0; i < buffers; i++)
+				average += switchCycles[i] / buffers;
+			std::vector<double>::iterator slow = switchCycles.begin() + (buffers - 1 - buffers / 1000);
+			std::nth_element(switchCycles.begin(), slow, switchCycles.end());
+			printf("%-22s %6ld %20s %10ld %7.2f %% %7.2f %% %7.2f %%\n", b ? "" : name, frames, partitions,
+				convolver.getNumLevels(), 100. * average / buffer, 100. * *slow / buffer,
+				100. * workerCycles / buffers / buffer);
+		}
+	}
+	ASIOSetDenormalMode(denormals);
+	benchFree(ir);
+	benchFree(in);
+	benchFree(out);
+}
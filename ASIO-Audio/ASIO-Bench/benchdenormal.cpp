@@ -0,0 +1,116 @@
+// Denormal protection: the buffer switch of 16 channels, each through a chain of 4
+// biquad lowpasses, over the tail of an impulse. The tail decays into denormals after
+// about a thousand samples and stays there. The chain runs with gradual underflow, with
+// FTZ and DAZ set by ASIOSetDenormalMode and with ASIOFlushDenormals on the filter
+// state after every buffer. avg and worst are the callback cost over the tail, load
+// the average in percent of the buffer duration at 48 kHz.
+
+#include "benchutil.h"
+#include "ASIODenormals.h"
+#include <math.h>
+
+static const long numChannels = 16;
+static const long numStages = 4;
+static const long tailFrames = 48000;
+
+typedef struct Biquad
+{
+	float b0, b1, b2, a1, a2;
+} Biquad;
+
+// transposed direct form II, two state variables per stage and channel
+static void runChain(const Biquad &q, float *state, float *samples, long frames)
+{
+	for(long s = 0; s < numStages; s++)
+	{
+		float z1 = state[2 * s];
+		float z2 = state[2 * s + 1];
+		for(long i = 0; i < frames; i++)
+		{
+			float x = samples[i];
+			float y = q.b0 * x + z1;
+			z1 = q.b1 * x - q.a1 * y + z2;
+			z2 = q.b2 * x - q.a2 * y;
+			samples[i] = y;
+		}
+		state[2 * s] = z1;
+		state[2 * s + 1] = z2;
+	}
+}
+
+// 1 kHz at 48 kHz, Q .707
+static Biquad lowpass()
+{
+	const double pi = 3.14159265358979323846;
+	double w = 2. * pi * 1000. / 48000.;
+	double alpha = sin(w) / (2. * .707);
+	double a0 = 1. + alpha;
+	double c = cos(w);
+	Biquad q = { (float)((1. - c) * .5 / a0), (float)((1. - c) / a0), (float)((1. - c) * .5 / a0),
+		(float)(-2. * c / a0), (float)((1. - alpha) / a0) };
+	return q;
+}
+
+void benchDenormal(long frames)
+{
+	static const char *modes[] = { "denormals", "FTZ/DAZ", "flush state" };
+	const int repeats = 5;
+	const Biquad q = lowpass();
+	double ticks = benchTicksPerSecond();
+	long buffers = (tailFrames + frames - 1) / frames;
+
+	float *samples = (float*)benchAlloc(frames * numChannels * sizeof(float));
+	float *state = (float*)benchAlloc(2 * numStages * numChannels * sizeof(float));
+	long saved = ASIOGetDenormalMode();
+
+	printf("%-22s %12s %12s %10s\n", "", "avg c/buf", "worst c/buf", "load");
+	for(int m = 0; m < 3; m++)
+	{
+		if(m == 1 && ASIOSetDenormalMode(kASIODenormalsOff) == kASIODenormalsOn)
+		{
+			printf("%-22s not supported\n", modes[m]);
+			continue;
+		}
+		ASIOSetDenormalMode(m == 1 ? kASIODenormalsOff : kASIODenormalsOn);
+
+		double total = 1e300;
+		double worst = 0.;
+		for(int r = 0; r < repeats; r++)
+		{
+			// an impulse into every channel, then silence
+			memset(state, 0, 2 * numStages * numChannels * sizeof(float));
+			double sum = 0.;
+			double slowest = 0.;
+			for(long b = 0; b < buffers; b++)
+			{
+				memset(samples, 0, frames * numChannels * sizeof(float));
+				if(b == 0)
+				{
+					for(long ch = 0; ch < numChannels; ch++)
+						samples[ch * frames] = 1.f;
+				}
+				unsigned long long t0 = benchCycles();
+				for(long ch = 0; ch < numChannels; ch++)
+					runChain(q, state + 2 * numStages * ch, samples + ch * frames, frames);
+				if(m == 2)
+					ASIOFlushDenormals(state, 2 * numStages * numChannels);
+				unsigned long long t1 = benchCycles();
+				sum += (double)(t1 - t0);
+				if((double)(t1 - t0) > slowest)
+					slowest = (double)(t1 - t0);
+			}
+			if(sum < total)
+			{
+				total = sum;
+				worst = slowest;
+			}
+		}
+		double average = total / buffers;
+		printf("%-22s %12.0f %12.0f %8.2f %%\n", modes[m], average, worst,
+			100. * average / ticks / (frames / 48000.));
+	}
+	ASIOSetDenormalMode(saved);
+
+	benchFree(samples);
+	benchFree(state);
+}
@@ -0,0 +1,60 @@
+// requantized float output: cycles/sample of the saturating float32toInt kernel against the
+// requantizer with rounding only, TPDF dither and dither with first and second order noise shaping
+
+#include "benchutil.h"
+
+typedef struct DitherFormat
+{
+	const char *name;
+	long byteWidth;
+	long bits;
+} DitherFormat;
+
+static const DitherFormat formats[] =
+{
+	{ "Int16", 2, 16 },
+	{ "Int24", 3, 24 },
+	{ "Int32xx20", 4, 20 },
+};
+
+static const int numFormats = sizeof(formats) / sizeof(formats[0]);
+
+void benchDither(long frames)
+{
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 2000;
+
+	float *in = (float*)benchAlloc(frames * 4);
+	char *out = (char*)benchAlloc(frames * 4);
+	benchFillFloat(in, frames);
+
+	printf("%-10s %-8s %10s %10s %10s %10s %10s\n", "", "", "saturate", "round", "tpdf", "tpdf+ns1", "tpdf+ns2");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		const ASIOConvertKernels *k = ASIOGetConvertKernels();
+		for(int i = 0; i < numFormats; i++)
+		{
+			const DitherFormat &f = formats[i];
+			double scale = (double)((1LL << (f.bits - 1)) - 1) + .49999;
+			double cycles[5];
+			cycles[0] = benchMinCycles([]() {},
+				[&]() { k->float32toInt(in, out, f.byteWidth, false, scale, frames); }, repeats);
+			for(int mode = 0; mode < 4; mode++)
+			{
+				ASIORequantizer r;
+				ASIOInitRequantizer(&r, 1, mode > 0, mode > 1 ? mode - 1 : kASIONoiseShapingOff);
+				cycles[mode + 1] = benchMinCycles([]() {},
+					[&]() { k->requantize(&r, in, out, f.byteWidth, false, f.bits, frames); }, repeats);
+			}
+			printf("%-10s %-8s", f.name, ASIOGetConvertISAName(isa));
+			for(int j = 0; j < 5; j++)
+				printf(" %6.2f c/s", cycles[j] / frames);
+			printf("\n");
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+
+	benchFree(in);
+	benchFree(out);
+}
@@ -0,0 +1,72 @@
+// DSD to PCM decimation: 8 channels through ASIODSDDecimator on one core. The buffer half
+// lasts frames samples at 88.2 kHz, load is the cpu time of one buffer half in percent of
+// its duration, realtime is how many times faster than the stream that is.
+
+#include "benchutil.h"
+#include "asio.h"
+#include "ASIODSDDecimator.h"
+
+typedef struct DSDCase
+{
+	const char *name;
+	long sampleType;
+	double dsdRate;
+	double pcmRate;
+} DSDCase;
+
+static const DSDCase cases[] =
+{
+	{ "DSD64 -> 88.2k", ASIOSTDSDInt8LSB1, 2822400., 88200. },
+	{ "DSD64 -> 176.4k", ASIOSTDSDInt8LSB1, 2822400., 176400. },
+	{ "DSD128 -> 88.2k", ASIOSTDSDInt8LSB1, 5644800., 88200. },
+	{ "DSD128 -> 176.4k", ASIOSTDSDInt8LSB1, 5644800., 176400. },
+	{ "DSD256 -> 88.2k", ASIOSTDSDInt8LSB1, 11289600., 88200. },
+	{ "DSD256 -> 176.4k", ASIOSTDSDInt8LSB1, 11289600., 176400. },
+	{ "DSD64 NER8 -> 88.2k", ASIOSTDSDInt8NER8, 2822400., 88200. },
+};
+
+static const int numCases = sizeof(cases) / sizeof(cases[0]);
+static const long numChannels = 8;
+
+void benchDSD(long frames)
+{
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 50;
+
+	printf("%-22s %-8s %10s %10s %10s\n", "", "", "c/pcm", "load", "realtime");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		ASIOSelectDSPKernels(isa);
+		for(int i = 0; i < numCases; i++)
+		{
+			const DSDCase &c = cases[i];
+			ASIODSDDecimator decimator;
+			decimator.setup(c.sampleType, c.dsdRate, c.pcmRate, numChannels);
+
+			long dsdFrames = (long)(frames * (c.dsdRate / 88200.));
+			long bytes = c.sampleType == ASIOSTDSDInt8NER8 ? dsdFrames : dsdFrames / 8;
+			long pcmFrames = dsdFrames / decimator.getDecimation();
+			unsigned char *in = (unsigned char*)benchAlloc(bytes * numChannels);
+			float *out = (float*)benchAlloc((pcmFrames + 1) * numChannels * sizeof(float));
+			benchFillRandom(in, bytes * numChannels);
+
+			auto run = [&]()
+			{
+				for(long ch = 0; ch < numChannels; ch++)
+					decimator.process(ch, in + ch * bytes, out + ch * (pcmFrames + 1), dsdFrames);
+			};
+			double cycles = benchMinCycles([]() {}, run, repeats);
+			double seconds = benchMinSeconds([]() {}, run, repeats);
+			double duration = frames / 88200.;
+
+			printf("%-22s %-8s %6.1f c/s %8.2f %% %8.0fx\n", c.name, ASIOGetConvertISAName(isa),
+				cycles / (pcmFrames * numChannels), 100. * seconds / duration, duration / seconds);
+
+			benchFree(in);
+			benchFree(out);
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+}
@@ -0,0 +1,67 @@
+// PCM to DSD modulation: stereo through ASIODSDModulator on one core. The buffer half
+// lasts frames samples at 88.2 kHz, c/dsd is the cost of one dsd sample of one channel,
+// load is the cpu time of one buffer half in percent of its duration.
+
+#include "benchutil.h"
+#include "asio.h"
+#include "ASIODSDModulator.h"
+
+typedef struct DSDModCase
+{
+	const char *name;
+	double pcmRate;
+	double dsdRate;
+} DSDModCase;
+
+static const DSDModCase cases[] =
+{
+	{ "88.2k -> DSD64", 88200., 2822400. },
+	{ "176.4k -> DSD64", 176400., 2822400. },
+	{ "88.2k -> DSD128", 88200., 5644800. },
+	{ "176.4k -> DSD128", 176400., 5644800. },
+};
+
+static const int numCases = sizeof(cases) / sizeof(cases[0]);
+static const long numChannels = 2;
+
+void benchDSDModulator(long frames)
+{
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 20;
+
+	printf("%-22s %-8s %10s %10s %10s\n", "", "", "c/dsd", "load", "realtime");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		ASIOSelectDSPKernels(isa);
+		for(int i = 0; i < numCases; i++)
+		{
+			const DSDModCase &c = cases[i];
+			ASIODSDModulator modulator;
+			modulator.setup(ASIOSTDSDInt8LSB1, c.pcmRate, c.dsdRate, numChannels);
+
+			long pcmFrames = (long)(frames * (c.pcmRate / 88200.));
+			long dsdFrames = pcmFrames * modulator.getInterpolation();
+			float *in = (float*)benchAlloc(pcmFrames * numChannels * sizeof(float));
+			unsigned char *out = (unsigned char*)benchAlloc(dsdFrames / 8 * numChannels);
+			benchFillFloat(in, pcmFrames * numChannels);
+
+			auto run = [&]()
+			{
+				for(long ch = 0; ch < numChannels; ch++)
+					modulator.process(ch, in + ch * pcmFrames, out + ch * (dsdFrames / 8), pcmFrames);
+			};
+			double cycles = benchMinCycles([]() {}, run, repeats);
+			double seconds = benchMinSeconds([]() {}, run, repeats);
+			double duration = frames / 88200.;
+
+			printf("%-22s %-8s %6.2f c/s %8.2f %% %8.0fx\n", c.name, ASIOGetConvertISAName(isa),
+				cycles / (dsdFrames * numChannels), 100. * seconds / duration, duration / seconds);
+
+			benchFree(in);
+			benchFree(out);
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+}
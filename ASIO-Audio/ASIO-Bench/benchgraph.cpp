@@ -0,0 +1,84 @@
+// Graph: 64 inputs through 4 gain stages each, summed by 4 into 16 buses, each bus
+// through one more gain into an output: 272 processing nodes, 352 with the sources
+// and sinks. The compiled plan of ASIOGraph
+// against the same mixToFloat kernel calls written out by hand, the difference is what
+// walking the plan costs per step. load is in percent of the buffer duration at 48 kHz.
+
+#include "benchutil.h"
+#include "ASIOGraph.h"
+
+static const long numInputs = 64;
+static const long numStages = 4;
+static const long numBuses = 16;
+
+void benchGraph(long frames)
+{
+	const int repeats = 50;
+	double ticks = benchTicksPerSecond();
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+
+	float *inputs = (float*)benchAlloc(frames * numInputs * sizeof(float));
+	float *outputs = (float*)benchAlloc(frames * numBuses * sizeof(float));
+	float *scratch = (float*)benchAlloc(frames * (numInputs * numStages + numBuses) * sizeof(float));
+	benchFillFloat(inputs, frames * numInputs);
+
+	ASIOGraph graph;
+	for(long b = 0; b < numBuses; b++)
+	{
+		long bus = graph.addGain(.5f);
+		for(long i = 0; i < numInputs / numBuses; i++)
+		{
+			long from = graph.addSource(inputs + (b * (numInputs / numBuses) + i) * frames);
+			for(long s = 0; s < numStages; s++)
+			{
+				long gain = graph.addGain(.9f);
+				graph.connect(from, 0, gain, 0);
+				from = gain;
+			}
+			graph.connect(from, 0, bus, 0);
+		}
+		graph.connect(bus, 0, graph.addSink(outputs + b * frames), 0);
+	}
+	graph.compile(frames);
+
+	// the same by hand, every stage into a buffer of its own
+	const float stage = .9f, bus = .5f;
+	float ones[numInputs / numBuses] = { 1.f, 1.f, 1.f, 1.f };
+	auto direct = [&]()
+	{
+		float *s = scratch;
+		for(long b = 0; b < numBuses; b++)
+		{
+			const float *sums[numInputs / numBuses];
+			for(long i = 0; i < numInputs / numBuses; i++)
+			{
+				const float *from = inputs + (b * (numInputs / numBuses) + i) * frames;
+				for(long j = 0; j < numStages; j++, s += frames)
+				{
+					k->mixToFloat(&from, &stage, 1, s, 4, false, frames);
+					from = s;
+				}
+				sums[i] = from;
+			}
+			k->mixToFloat(sums, ones, numInputs / numBuses, s, 4, false, frames);
+			const float *sum = s;
+			s += frames;
+			k->mixToFloat(&sum, &bus, 1, outputs + b * frames, 4, false, frames);
+		}
+	};
+
+	double planCycles = benchMinCycles([]() {}, [&]() { graph.process(frames); }, repeats);
+	double directCycles = benchMinCycles([]() {}, direct, repeats);
+	double seconds = frames / 48000.;
+
+	printf("%-26s %8s %8s %12s %10s %10s\n", "", "nodes", "steps", "c/buffer", "c/step", "load");
+	printf("%-26s %8ld %8ld %12.0f %10.1f %8.2f %%\n", "compiled plan", graph.getNumNodes(), graph.getNumSteps(),
+		planCycles, planCycles / graph.getNumSteps(), 100. * planCycles / ticks / seconds);
+	printf("%-26s %8s %8ld %12.0f %10.1f %8.2f %%\n", "by hand", "", graph.getNumSteps(),
+		directCycles, directCycles / graph.getNumSteps(), 100. * directCycles / ticks / seconds);
+	printf("%-26s %ld intermediate buffers of %ld frames\n", "plan", graph.getNumBuffers(), frames);
+
+	benchFree(inputs);
+	benchFree(outputs);
+	benchFree(scratch);
+}
@@ -0,0 +1,62 @@
+// n channel interleave and deinterleave: GB/s of the scalar reference and the
+// SIMD tiles, next to a memcpy of the same size as the bandwidth ceiling.
+// Bytes are counted as read plus written per call.
+
+#include "benchutil.h"
+#include "ASIOConvertSamples.h"
+
+static const long channelCounts[] = { 2, 8, 32, 64 };
+static const long byteWidths[] = { 1, 2, 3, 4 };
+
+void benchInterleave(long frames)
+{
+	ASIOConvertSamples convert;
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 500;
+
+	printf("%-22s %10s %10s %10s %10s\n", "", "memcpy", ASIOGetConvertISAName(kASIOConvertScalar),
+		ASIOGetConvertISAName(best), "speedup");
+	for(long numChannels : channelCounts)
+	{
+		for(long byteWidth : byteWidths)
+		{
+			long bytes = numChannels * frames * byteWidth;
+			void *channels[64];
+			for(long c = 0; c < numChannels; c++)
+			{
+				channels[c] = benchAlloc(frames * byteWidth);
+				benchFillRandom(channels[c], frames * byteWidth, c + 1);
+			}
+			char *interleaved = (char*)benchAlloc(bytes);
+			char *copy = (char*)benchAlloc(bytes);
+
+			double copySeconds = benchMinSeconds([]() {}, [&]() { memcpy(copy, interleaved, bytes); }, repeats);
+			for(int direction = 0; direction < 2; direction++)
+			{
+				double seconds[2];
+				for(int pass = 0; pass < 2; pass++)
+				{
+					ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+					if(direction == 0)
+						seconds[pass] = benchMinSeconds([]() {},
+							[&]() { convert.interleave(channels, interleaved, numChannels, byteWidth, frames); }, repeats);
+					else
+						seconds[pass] = benchMinSeconds([]() {},
+							[&]() { convert.deinterleave(interleaved, channels, numChannels, byteWidth, frames); }, repeats);
+				}
+				char name[64];
+				snprintf(name, sizeof(name), "%s %ldch %ldbit", direction == 0 ? "interleave" : "deinterleave",
+					numChannels, byteWidth * 8);
+				double gb = 2. * bytes * 1e-9;
+				printf("%-22s %10.2f %10.2f %10.2f %9.1fx\n", name, gb / copySeconds,
+					gb / seconds[0], gb / seconds[1], seconds[0] / seconds[1]);
+			}
+
+			for(long c = 0; c < numChannels; c++)
+				benchFree(channels[c]);
+			benchFree(interleaved);
+			benchFree(copy);
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+}
@@ -0,0 +1,177 @@
+// ASIO-Bench : microbenchmarks for the host side sample processing.
+// usage: ASIO-Bench [-frames n] [-json file] [benchmark ...]
+//        ASIO-Bench -verify [iterations [seed]]
+// without names all benchmarks are run. -json writes the results of the benchmarks
+// that report through benchJsonResult to file. -verify runs ASIOVerifyConversions
+// instead of the benchmarks and fails on the first mismatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ASIOConvertKernels.h"
+#include "ASIOConvertVerify.h"
+
+typedef void (*BenchFunction)(long frames);
+
+// the benchmarks, each one lives in its own file
+void benchInt24(long frames);
+void benchInterleave(long frames);
+void benchDither(long frames);
+void benchDSD(long frames);
+void benchDSDModulator(long frames);
+void benchMix(long frames);
+void benchConvert(long frames);
+void benchResample(long frames);
+void benchDenormal(long frames);
+void benchMeter(long frames);
+void benchAnalyzer(long frames);
+void benchBiquad(long frames);
+void benchConvolver(long frames);
+void benchTelemetry(long frames);
+void benchProfiler(long frames);
+void benchGraph(long frames);
+void benchParallel(long frames);
+
+typedef struct BenchEntry
+{
+	const char *name;
+	BenchFunction run;
+	const char *description;
+} BenchEntry;
+
+static const BenchEntry benchmarks[] =
+{
+	{ "int24", benchInt24, "packed 24 bit, byte swap and shift conversions, bytes/cycle scalar against SIMD" },
+	{ "interleave", benchInterleave, "n channel interleave and deinterleave, GB/s against memcpy" },
+	{ "dither", benchDither, "requantized output, cycles/sample of truncation, rounding, TPDF dither and noise shaping" },
+	{ "dsd", benchDSD, "DSD to PCM decimation of 8 channels, cpu load and realtime factor" },
+	{ "dsdmod", benchDSDModulator, "PCM to DSD modulation of 2 channels, cycles/dsd sample and cpu load" },
+	{ "mix", benchMix, "gain, mix and output conversion of 64 channels, separate passes against one fused pass" },
+	{ "convert", benchConvert, "every ASIOConvertSamples method, 32 to 8192 frames, warm and cold caches, all instruction sets" },
+	{ "resample", benchResample, "sample rate conversion of 8 channels, 48k to 44.1k at every quality and other ratios, channels/core" },
+	{ "denormal", benchDenormal, "buffer switch of a decaying IIR chain, with denormals, FTZ/DAZ and flushed filter state" },
+	{ "meter", benchMeter, "peak, rms and true peak metering of 64 channels with two readers, cost of one buffer switch" },
+	{ "analyzer", benchAnalyzer, "real FFT 256 to 65536 points, spectrum analysis of 32 channels at 96 kHz and its buffer switch cost" },
+	{ "biquad", benchBiquad, "8 band equalizer on 32 and 64 channels, serial per channel biquads against the SoA bank" },
+	{ "convolver", benchConvolver, "partitioned convolution of 8 channels, cpu load against impulse response length and buffer size" },
+	{ "telemetry", benchTelemetry, "seqlock time info snapshot, cost of publish and read and torn reads with three polling readers" },
+	{ "profiler", benchProfiler, "buffer switch time budget profiler, cost per callback and the report of a simulated driver" },
+	{ "graph", benchGraph, "compiled processing graph of 272 nodes against the same kernel calls by hand, cycles per step" },
+	{ "parallel", benchParallel, "processing graph of 256 filter nodes on 1 to 16 threads at 64 frames, speedup and paced p99 load" },
+};
+
+static const int numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+static FILE *json = 0;
+static long jsonResults = 0;
+
+// names are plain ascii, only quotes and backslashes need an escape
+static void jsonString(const char *s)
+{
+	fputc('"', json);
+	for(; *s; s++)
+	{
+		if(*s == '"' || *s == '\\')
+			fputc('\\', json);
+		fputc(*s, json);
+	}
+	fputc('"', json);
+}
+
+void benchJsonResult(const char *benchmark, const char *name, const char *isa, long frames,
+	const char *cache, double nsPerFrame, double gbPerSecond, double cyclesPerSample)
+{
+	if(!json)
+		return;
+	fprintf(json, "%s\n    { \"benchmark\": ", jsonResults++ ? "," : "");
+	jsonString(benchmark);
+	fprintf(json, ", \"name\": ");
+	jsonString(name);
+	fprintf(json, ", \"isa\": ");
+	jsonString(isa);
+	fprintf(json, ", \"frames\": %ld, \"cache\": ", frames);
+	jsonString(cache);
+	fprintf(json, ", \"ns_per_frame\": %.4f, \"gb_per_s\": %.4f, \"cycles_per_sample\": %.4f }",
+		nsPerFrame, gbPerSecond, cyclesPerSample);
+}
+
+static int verify(long iterations, unsigned int seed)
+{
+	ASIOVerifyResult result;
+	printf("cpu supports %s, verifying %ld iterations with seed %u\n",
+		ASIOGetConvertISAName(ASIOGetSupportedConvertISA()), iterations, seed);
+	bool passed = ASIOVerifyConversions(seed, iterations, &result);
+	printf("%ld trials, %ld failed\n", result.trials, result.failures);
+	if(!passed)
+		printf("first failure: %s\n", result.firstFailure);
+	return passed ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	long frames = 1024;
+	bool selected[sizeof(benchmarks) / sizeof(benchmarks[0])] = { false };
+	bool any = false;
+
+	if(argc > 1 && strcmp(argv[1], "-verify") == 0)
+		return verify(argc > 2 ? atol(argv[2]) : 1000, argc > 3 ? (unsigned int)strtoul(argv[3], 0, 10) : 1);
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+			frames = atol(argv[++i]);
+		else if(strcmp(argv[i], "-json") == 0 && i + 1 < argc)
+		{
+#if defined(_MSC_VER)
+			if(fopen_s(&json, argv[++i], "w") != 0)
+				json = 0;
+#else
+			json = fopen(argv[++i], "w");
+#endif
+			if(!json)
+			{
+				fprintf(stderr, "can't write %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			int b;
+			for(b = 0; b < numBenchmarks; b++)
+			{
+				if(strcmp(argv[i], benchmarks[b].name) == 0)
+					break;
+			}
+			if(b == numBenchmarks)
+			{
+				fprintf(stderr, "usage: %s [-frames n] [-json file] [benchmark ...]\n", argv[0]);
+				fprintf(stderr, "       %s -verify [iterations [seed]]\n", argv[0]);
+				for(b = 0; b < numBenchmarks; b++)
+					fprintf(stderr, "  %-12s %s\n", benchmarks[b].name, benchmarks[b].description);
+				return 1;
+			}
+			selected[b] = any = true;
+		}
+	}
+
+	printf("cpu supports %s\n", ASIOGetConvertISAName(ASIOGetSupportedConvertISA()));
+	if(json)
+	{
+		fprintf(json, "{\n  \"cpu\": ");
+		jsonString(ASIOGetConvertISAName(ASIOGetSupportedConvertISA()));
+		fprintf(json, ",\n  \"frames\": %ld,\n  \"results\": [", frames);
+	}
+	for(int b = 0; b < numBenchmarks; b++)
+	{
+		if(any && !selected[b])
+			continue;
+		printf("\n%s, %ld frames\n", benchmarks[b].name, frames);
+		benchmarks[b].run(frames);
+	}
+	if(json)
+	{
+		fprintf(json, "\n  ]\n}\n");
+		fclose(json);
+	}
+	return 0;
+}
@@ -0,0 +1,45 @@
+// Metering: peak, rms and true peak of 64 channels through ASIOMeter, then one
+// publish() to two open readers, as the buffer switch would. load is the cost in
+// percent of the buffer duration at 48 kHz, the goal is below 1 %.
+
+#include "benchutil.h"
+#include "ASIOMeter.h"
+
+static const long numChannels = 64;
+
+void benchMeter(long frames)
+{
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 50;
+	double ticks = benchTicksPerSecond();
+
+	float *samples = (float*)benchAlloc(frames * numChannels * sizeof(float));
+	benchFillFloat(samples, frames * numChannels);
+
+	printf("%-22s %-8s %10s %12s %10s\n", "", "", "c/sample", "c/buffer", "load");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		ASIOSelectDSPKernels(isa);
+		ASIOMeter meter;
+		meter.setup(numChannels, 48000.);
+		long readers[2] = { meter.openReader(), meter.openReader() };
+
+		auto run = [&]()
+		{
+			for(long ch = 0; ch < numChannels; ch++)
+				meter.process(ch, samples + ch * frames, frames);
+			meter.publish();
+		};
+		double cycles = benchMinCycles([]() {}, run, repeats);
+
+		printf("%-22s %-8s %10.2f %12.0f %8.2f %%\n", "64 channels", ASIOGetConvertISAName(isa),
+			cycles / (frames * numChannels), cycles, 100. * cycles / ticks / (frames / 48000.));
+
+		meter.closeReader(readers[0]);
+		meter.closeReader(readers[1]);
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+	benchFree(samples);
+}
@@ -0,0 +1,90 @@
+// Output stage of a mixer: 64 device outputs, each the sum of a few of 64 float
+// sources times their gains. "separate" scales and adds every source into a float bus
+// with the fir kernel and converts the bus afterwards, "fused" is mixFromFloat32 in one
+// pass. Both run on the best kernels of the cpu. traffic is the bytes separate moves
+// per byte of fused, counted as the loads and stores of the kernels.
+
+#include "benchutil.h"
+#include "asio.h"
+#include "ASIOConvertSamples.h"
+#include "ASIOConvertMatrix.h"
+
+static const long numOutputs = 64;
+static const long numSources = 64;
+static const long mixSizes[] = { 1, 2, 4, 8 };
+static const long sampleTypes[] = { ASIOSTInt16LSB, ASIOSTInt24LSB, ASIOSTInt32LSB, ASIOSTFloat32LSB };
+static const char *const typeNames[] = { "int16", "int24", "int32", "float32" };
+
+void benchMix(long frames)
+{
+	ASIOConvertSamples convert;
+	ASIOConvertISA isa = ASIOSelectConvertKernels(kASIOConvertAuto);
+	const ASIODSPKernels *k = ASIOGetDSPKernels();
+	const int repeats = 50;
+
+	float *sources[numSources];
+	for(long s = 0; s < numSources; s++)
+	{
+		sources[s] = (float*)benchAlloc(frames * sizeof(float));
+		benchFillFloat(sources[s], frames, s + 1);
+	}
+	float *bus = (float*)benchAlloc(frames * sizeof(float));
+	char *outputs[numOutputs];
+	for(long o = 0; o < numOutputs; o++)
+		outputs[o] = (char*)benchAlloc(frames * 4);
+
+	printf("kernels %s\n", ASIOGetConvertISAName(isa));
+	printf("%-22s %12s %12s %10s %10s\n", "", "separate", "fused", "speedup", "traffic");
+	for(long mix : mixSizes)
+	{
+		// output o mixes sources o, o + 1.., the gains just have to differ
+		const float *inputs[numOutputs][8];
+		float gains[numOutputs][8];
+		for(long o = 0; o < numOutputs; o++)
+		{
+			for(long j = 0; j < mix; j++)
+			{
+				inputs[o][j] = sources[(o + j * 7) % numSources];
+				gains[o][j] = .5f / (float)(j + 1);
+			}
+		}
+
+		for(int t = 0; t < (int)(sizeof(sampleTypes) / sizeof(sampleTypes[0])); t++)
+		{
+			long sampleType = sampleTypes[t];
+			ASIOSampleFormat format;
+			ASIOGetSampleFormat(sampleType, &format);
+
+			double separate = benchMinSeconds([]() {}, [&]()
+			{
+				for(long o = 0; o < numOutputs; o++)
+				{
+					for(long j = 0; j < mix; j++)
+						k->fir(&gains[o][j], 1, inputs[o][j], bus, frames, j > 0);
+					convert.fromFloat32(sampleType, bus, outputs[o], frames);
+				}
+			}, repeats);
+			double fused = benchMinSeconds([]() {}, [&]()
+			{
+				for(long o = 0; o < numOutputs; o++)
+					convert.mixFromFloat32(sampleType, inputs[o], gains[o], mix, outputs[o], frames);
+			}, repeats);
+
+			// separate also stores the bus once per source and loads it again for
+			// every source but the first and for the conversion
+			double separateBytes = 4. * mix + 4. * 2 * mix + format.byteWidth;
+			double fusedBytes = 4. * mix + format.byteWidth;
+
+			char name[64];
+			snprintf(name, sizeof(name), "%ld -> %s", mix, typeNames[t]);
+			printf("%-22s %9.2f us %9.2f us %9.2fx %9.2fx\n", name, separate * 1e6, fused * 1e6,
+				separate / fused, separateBytes / fusedBytes);
+		}
+	}
+
+	for(long s = 0; s < numSources; s++)
+		benchFree(sources[s]);
+	for(long o = 0; o < numOutputs; o++)
+		benchFree(outputs[o]);
+	benchFree(bus);
+}
@@ -0,0 +1,143 @@
+// Parallel graph: 64 inputs through 4 filter nodes each, 8 biquads per node, summed by
+// 4 into 16 buses with a gain each, at 64 frames and 48 kHz. The plan of ASIOGraph on
+// 1 to 16 threads, the thread of process() and start(threads - 1) workers:
+//
+//   c/buffer   median of back to back buffers
+//   speedup    against 1 thread
+//   p99, over  buffers paced at the real period of 1.33 ms, the 99th percentile of the
+//              time in process() in percent of the period and the buffers that took
+//              longer than it
+//
+// Every thread count has to give the outputs of 1 thread bit for bit. Threads beyond the
+// cores of the machine share them, speedup is bounded by the cores there are.
+
+#include "benchutil.h"
+#include "ASIOGraph.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+static const long numInputs = 64;
+static const long numNodes = 4;
+static const long numStages = 8;
+static const long numBuses = 16;
+static const long frames64 = 64;
+
+typedef struct BenchFilter
+{
+	float state[numStages][2];
+} BenchFilter;
+
+// a lowpass at 1/8 of the rate, transposed direct form II on every stage
+static void filterNode(void *state, const float *const *inputs, float *const *outputs, long frames)
+{
+	static const float b0 = .0976310729f, b1 = .195262146f, b2 = .0976310729f;
+	static const float a1 = -.942809042f, a2 = .333333333f;
+	BenchFilter *f = (BenchFilter*)state;
+	const float *x = inputs[0];
+	float *y = outputs[0];
+	for(long i = 0; i < frames; i++)
+	{
+		float v = x[i];
+		for(long s = 0; s < numStages; s++)
+		{
+			float out = b0 * v + f->state[s][0];
+			f->state[s][0] = b1 * v - a1 * out + f->state[s][1];
+			f->state[s][1] = b2 * v - a2 * out;
+			v = out;
+		}
+		y[i] = v;
+	}
+}
+
+void benchParallel(long frames)
+{
+	(void)frames;
+	const long buffers = 200;
+	const long paced = 300;
+	double ticks = benchTicksPerSecond();
+	double period = frames64 / 48000.;
+
+	float *inputs = (float*)benchAlloc(frames64 * numInputs * sizeof(float));
+	float *outputs = (float*)benchAlloc(frames64 * numBuses * sizeof(float));
+	float *reference = (float*)benchAlloc(frames64 * numBuses * sizeof(float));
+	benchFillFloat(inputs, frames64 * numInputs);
+	std::vector<BenchFilter> filters(numInputs * numNodes);
+
+	ASIOGraph graph;
+	for(long b = 0; b < numBuses; b++)
+	{
+		long bus = graph.addGain(.25f);
+		for(long i = 0; i < numInputs / numBuses; i++)
+		{
+			long channel = b * (numInputs / numBuses) + i;
+			long from = graph.addSource(inputs + channel * frames64);
+			for(long n = 0; n < numNodes; n++)
+			{
+				long node = graph.addNode(filterNode, &filters[channel * numNodes + n], 1, 1);
+				graph.connect(from, 0, node, 0);
+				from = node;
+			}
+			graph.connect(from, 0, bus, 0);
+		}
+		graph.connect(bus, 0, graph.addSink(outputs + b * frames64), 0);
+	}
+	graph.compile(frames64);
+
+	printf("%u hardware threads, %ld nodes, %ld steps\n", std::thread::hardware_concurrency(),
+		graph.getNumNodes(), graph.getNumSteps());
+	printf("%-10s %12s %10s %10s %10s %8s %8s\n", "threads", "c/buffer", "load", "speedup", "p99", "over", "output");
+
+	static const long threadCounts[] = { 1, 2, 4, 8, 16 };
+	double serial = 0.;
+	for(size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++)
+	{
+		long threads = threadCounts[t];
+		if(threads > 1 && !graph.start(threads - 1))
+			break;
+
+		// back to back from silent filters, the outputs after the last buffer
+		memset(&filters[0], 0, filters.size() * sizeof(BenchFilter));
+		std::vector<double> cycles(buffers);
+		for(long i = 0; i < buffers; i++)
+		{
+			unsigned long long c0 = benchCycles();
+			graph.process(frames64);
+			cycles[i] = (double)(benchCycles() - c0);
+		}
+		bool same = true;
+		if(threads == 1)
+			memcpy(reference, outputs, frames64 * numBuses * sizeof(float));
+		else
+			same = memcmp(reference, outputs, frames64 * numBuses * sizeof(float)) == 0;
+		std::nth_element(cycles.begin(), cycles.begin() + buffers / 2, cycles.end());
+		double median = cycles[buffers / 2];
+		if(threads == 1)
+			serial = median;
+
+		// at the pace of a driver, the workers sleep and spin between the buffers
+		std::vector<double> seconds(paced);
+		long over = 0;
+		double start = benchSeconds();
+		for(long i = 0; i < paced; i++)
+		{
+			while(benchSeconds() < start + i * period)
+				;
+			double t0 = benchSeconds();
+			graph.process(frames64);
+			seconds[i] = benchSeconds() - t0;
+			over += seconds[i] > period;
+		}
+		long rank = paced * 99 / 100;
+		std::nth_element(seconds.begin(), seconds.begin() + rank, seconds.end());
+		graph.stop();
+
+		printf("%-10ld %12.0f %8.1f %% %9.2fx %8.1f %% %8ld %8s\n", threads, median,
+			100. * median / ticks / period, serial / median, 100. * seconds[rank] / period, over,
+			same ? "same" : "DIFFERS");
+	}
+
+	benchFree(inputs);
+	benchFree(outputs);
+	benchFree(reference);
+}
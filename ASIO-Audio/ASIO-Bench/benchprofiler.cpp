@@ -0,0 +1,61 @@
+// Profiler: the cost of ASIOProfiler enter() and leave() around an empty buffer switch,
+// then a simulated driver at 64 frames and 48 kHz. Every callback spins for 30 % of its
+// budget and the next one starts on the following deadline, the sample position skips
+// a buffer 3 times. The report should read a load of 30 %, a period of 100 % and
+// 3 missed periods.
+
+#include "benchutil.h"
+#include "ASIOProfiler.h"
+
+void benchProfiler(long frames)
+{
+	(void)frames;
+	const int repeats = 50;
+	const long calls = 1000;
+	ASIOProfiler profiler;
+	profiler.setup(48000., 64);
+
+	double position = 0.;
+	double cycles = benchMinCycles([]() {}, [&]()
+	{
+		for(long i = 0; i < calls; i++)
+		{
+			profiler.enter(position, true);
+			profiler.leave();
+			position += 64.;
+		}
+	}, repeats) / calls;
+	printf("%-26s %12s\n", "", "c/callback");
+	printf("%-26s %12.1f\n", "enter and leave", cycles);
+
+	const long callbacks = 1000;
+	const long skips[3] = { 250, 500, 750 };
+	profiler.setup(48000., 64);
+	double budget = profiler.getBudget();
+	position = 0.;
+	double start = benchSeconds();
+	for(long i = 0; i < callbacks; i++)
+	{
+		double deadline = start + i * budget;
+		while(benchSeconds() < deadline)
+			;
+		for(long s = 0; s < 3; s++)
+		{
+			if(i == skips[s])
+				position += 64.;
+		}
+		profiler.enter(position, true);
+		while(benchSeconds() < deadline + .3 * budget)
+			;
+		profiler.leave();
+		position += 64.;
+	}
+
+	ASIOProfilerStats stats;
+	profiler.getStats(&stats);
+	printf("%-26s %8s %8s %8s %8s %8s %8s %8s\n", "", "p50", "p99", "p99.9", "max", "calls", "over", "missed");
+	printf("%-26s %6.1f %% %6.1f %% %6.1f %% %6.1f %% %8llu %8llu %8llu\n", "load, 30 % busy",
+		stats.loadP50, stats.loadP99, stats.loadP999, stats.loadMax, stats.callbacks, stats.overruns, stats.missed);
+	printf("%-26s %6.1f %% %6.1f %% %6.1f %% %6.1f %%\n", "period",
+		stats.periodP50, stats.periodP99, stats.periodP999, stats.periodMax);
+}
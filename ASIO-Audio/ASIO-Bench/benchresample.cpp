@@ -0,0 +1,70 @@
+// Sample rate conversion: 8 channels through ASIOResampler on one core. The buffer half
+// lasts frames samples at the source rate, load is the cpu time of one buffer half in
+// percent of its duration and channels/core how many channels one core could convert
+// in real time.
+
+#include "benchutil.h"
+#include "ASIOResampler.h"
+
+typedef struct ResampleCase
+{
+	const char *name;
+	double sourceRate;
+	double destRate;
+	ASIOResamplerQuality quality;
+} ResampleCase;
+
+static const ResampleCase cases[] =
+{
+	{ "48k -> 44.1k draft", 48000., 44100., kASIOResamplerDraft },
+	{ "48k -> 44.1k good", 48000., 44100., kASIOResamplerGood },
+	{ "48k -> 44.1k best", 48000., 44100., kASIOResamplerBest },
+	{ "44.1k -> 48k good", 44100., 48000., kASIOResamplerGood },
+	{ "44.1k -> 96k good", 44100., 96000., kASIOResamplerGood },
+	{ "96k -> 48k good", 96000., 48000., kASIOResamplerGood },
+};
+
+static const int numCases = sizeof(cases) / sizeof(cases[0]);
+static const long numChannels = 8;
+
+void benchResample(long frames)
+{
+	ASIOConvertISA best = ASIOGetSupportedConvertISA();
+	const int repeats = 50;
+
+	printf("%-22s %-8s %10s %10s %13s\n", "", "", "c/out", "load", "channels/core");
+	for(int pass = 0; pass < 2; pass++)
+	{
+		ASIOConvertISA isa = ASIOSelectConvertKernels(pass == 0 ? kASIOConvertScalar : best);
+		ASIOSelectDSPKernels(isa);
+		for(int i = 0; i < numCases; i++)
+		{
+			const ResampleCase &c = cases[i];
+			ASIOResampler resampler;
+			resampler.setup(c.sourceRate, c.destRate, numChannels, c.quality);
+
+			long maxOutput = resampler.getMaxOutput(frames);
+			float *in = (float*)benchAlloc(frames * numChannels * sizeof(float));
+			float *out = (float*)benchAlloc(maxOutput * numChannels * sizeof(float));
+			benchFillFloat(in, frames * numChannels);
+
+			long written = 0;
+			auto run = [&]()
+			{
+				for(long ch = 0; ch < numChannels; ch++)
+					written = resampler.process(ch, in + ch * frames, out + ch * maxOutput, frames);
+			};
+			double cycles = benchMinCycles([]() {}, run, repeats);
+			double seconds = benchMinSeconds([]() {}, run, repeats);
+			double duration = frames / c.sourceRate;
+
+			printf("%-22s %-8s %6.1f c/s %8.2f %% %13.0f\n", c.name, ASIOGetConvertISAName(isa),
+				cycles / (written * numChannels), 100. * seconds / duration, numChannels * duration / seconds);
+
+			benchFree(in);
+			benchFree(out);
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+}
@@ -0,0 +1,107 @@
+// Telemetry: the cost of one ASIOTelemetry publish() in the buffer switch and of one
+// read() on another thread, alone and with three readers polling as fast as they can.
+// The contended run checks every snapshot: all its fields come from one publish() and
+// a torn one is counted, there must be none.
+
+#include "benchutil.h"
+#include "ASIOTelemetry.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+
+static const long numReaders = 3;
+
+// every field derived from n, a reader can tell when they come from different ones
+static void fillSnapshot(ASIOTelemetrySnapshot &t, unsigned long n)
+{
+	memset(&t, 0, sizeof(t));
+	t.time.timeInfo.samplePosition.lo = n;
+	t.time.timeInfo.flags = kSystemTimeValid | kSamplePositionValid;
+	t.nanoSeconds = n * 1e6;
+	t.samples = n * 256.;
+	t.tcSamples = n * 256. + 1.;
+	t.sysRefTime = n;
+	t.index = n & 1;
+}
+
+static bool consistent(const ASIOTelemetrySnapshot &t)
+{
+	unsigned long n = t.sysRefTime;
+	return t.time.timeInfo.samplePosition.lo == n && t.nanoSeconds == n * 1e6 && t.samples == n * 256. &&
+		t.tcSamples == n * 256. + 1. && t.index == (n & 1);
+}
+
+void benchTelemetry(long frames)
+{
+	(void)frames;
+	const int repeats = 50;
+	const long calls = 1000;
+	ASIOTelemetry telemetry;
+	ASIOTelemetrySnapshot t;
+	unsigned long n = 0;
+
+	fillSnapshot(t, ++n);
+	double publishCycles = benchMinCycles([]() {}, [&]()
+	{
+		for(long i = 0; i < calls; i++)
+			telemetry.publish(t);
+	}, repeats) / calls;
+	volatile unsigned long sink = 0;
+	double readCycles = benchMinCycles([]() {}, [&]()
+	{
+		for(long i = 0; i < calls; i++)
+		{
+			telemetry.read(&t);
+			sink += t.sysRefTime;
+		}
+	}, repeats) / calls;
+
+	printf("%-26s %12s %12s\n", "", "c/publish", "c/read");
+	printf("%-26s %12.1f %12.1f\n", "uncontended", publishCycles, readCycles);
+
+	// readers poll while the writer publishes back to back, far more often than any
+	// buffer switch would
+	std::atomic<bool> running(true);
+	std::vector<unsigned long long> reads(numReaders), torn(numReaders);
+	std::vector<std::thread> readers;
+	for(long r = 0; r < numReaders; r++)
+	{
+		readers.push_back(std::thread([&, r]()
+		{
+			ASIOTelemetrySnapshot s;
+			while(running.load(std::memory_order_relaxed))
+			{
+				if(!telemetry.read(&s))
+					continue;
+				reads[r]++;
+				if(!consistent(s))
+					torn[r]++;
+			}
+		}));
+	}
+	unsigned long long publishes = 0;
+	double t0 = benchSeconds();
+	while(benchSeconds() - t0 < .5)
+	{
+		for(long i = 0; i < calls; i++)
+		{
+			fillSnapshot(t, ++n);
+			telemetry.publish(t);
+		}
+		publishes += calls;
+	}
+	double seconds = benchSeconds() - t0;
+	running.store(false);
+	for(long r = 0; r < numReaders; r++)
+		readers[r].join();
+
+	unsigned long long totalReads = 0, totalTorn = 0;
+	for(long r = 0; r < numReaders; r++)
+	{
+		totalReads += reads[r];
+		totalTorn += torn[r];
+	}
+	printf("%-26s %12s %12s %12s\n", "", "publish/s", "reads/s", "torn");
+	printf("%-26s %12.0f %12.0f %12llu\n", "3 readers polling", publishes / seconds, totalReads / seconds, totalTorn);
+	(void)sink;
+}
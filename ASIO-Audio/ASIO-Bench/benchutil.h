@@ -0,0 +1,159 @@
+#ifndef __benchutil__
+#define __benchutil__
+
+// timing and buffer helpers shared by the benchmarks
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "ASIOConvertKernels.h"
+#include "ASIODSPKernels.h"
+
+#if ASIO_CONVERT_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// time stamp counter ticks, these are the "cycles" of all reports.
+// On cpus with an invariant tsc they run at the nominal clock.
+inline unsigned long long benchCycles()
+{
+#if ASIO_CONVERT_X86
+	return __rdtsc();
+#else
+	return (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+inline double benchSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// benchCycles ticks per second, measured against the steady clock over 20 ms
+inline double benchTicksPerSecond()
+{
+	double t0 = benchSeconds();
+	unsigned long long c0 = benchCycles();
+	double t1;
+	do
+		t1 = benchSeconds();
+	while(t1 - t0 < .02);
+	return (double)(benchCycles() - c0) / (t1 - t0);
+}
+
+// 64 byte aligned, zeroed
+inline void *benchAlloc(size_t bytes)
+{
+	void *p;
+#if defined(_MSC_VER)
+	p = _aligned_malloc(bytes ? bytes : 1, 64);
+#else
+	if(posix_memalign(&p, 64, bytes ? bytes : 1) != 0)
+		p = 0;
+#endif
+	if(!p)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	memset(p, 0, bytes);
+	return p;
+}
+
+inline void benchFree(void *p)
+{
+#if defined(_MSC_VER)
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+// evicts a buffer from all cache levels, for cold cache runs
+inline void benchFlush(const void *buffer, size_t bytes)
+{
+#if ASIO_CONVERT_X86
+	const char *p = (const char*)buffer;
+	for(size_t i = 0; i < bytes; i += 64)
+		_mm_clflush(p + i);
+	if(bytes)
+		_mm_clflush(p + bytes - 1);
+	_mm_mfence();
+#else
+	// no flush instruction, 64 MB of other data push it out
+	static char *sweep = 0;
+	const size_t sweepBytes = 64 << 20;
+	if(!sweep)
+		sweep = (char*)calloc(sweepBytes, 1);
+	for(size_t i = 0; sweep && i < sweepBytes; i += 64)
+		sweep[i]++;
+	(void)buffer;
+	(void)bytes;
+#endif
+}
+
+// fills with random bytes, the same sequence for every run
+inline void benchFillRandom(void *buffer, size_t bytes, unsigned int seed = 1)
+{
+	unsigned char *b = (unsigned char*)buffer;
+	for(size_t i = 0; i < bytes; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		b[i] = (unsigned char)(seed >> 24);
+	}
+}
+
+// full scale floats in -1..1
+inline void benchFillFloat(float *buffer, long count, unsigned int seed = 1)
+{
+	for(long i = 0; i < count; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		buffer[i] = (float)((int)(seed >> 8) - 0x800000) / (float)0x800000;
+	}
+}
+
+// one result for the -json file of benchmain, ignored without -json. cache is "warm" or "cold".
+void benchJsonResult(const char *benchmark, const char *name, const char *isa, long frames,
+	const char *cache, double nsPerFrame, double gbPerSecond, double cyclesPerSample);
+
+// runs prepare() untimed and run() timed, returns the fastest run in cycles
+template <class Prepare, class Run>
+double benchMinCycles(Prepare prepare, Run run, int repeats)
+{
+	double best = 1e300;
+	for(int i = 0; i < repeats; i++)
+	{
+		prepare();
+		unsigned long long t0 = benchCycles();
+		run();
+		unsigned long long t1 = benchCycles();
+		if((double)(t1 - t0) < best)
+			best = (double)(t1 - t0);
+	}
+	return best;
+}
+
+// the same in seconds, for throughput figures
+template <class Prepare, class Run>
+double benchMinSeconds(Prepare prepare, Run run, int repeats)
+{
+	double best = 1e300;
+	for(int i = 0; i < repeats; i++)
+	{
+		prepare();
+		double t0 = benchSeconds();
+		run();
+		double t1 = benchSeconds();
+		if(t1 - t0 < best)
+			best = t1 - t0;
+	}
+	return best;
+}
+
+#endif
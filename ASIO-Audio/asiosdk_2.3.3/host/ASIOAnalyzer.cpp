@@ -0,0 +1,181 @@
+#include "ginclude.h"
+#include "ASIOAnalyzer.h"
+#include "ASIODenormals.h"
+#include <math.h>
+#include <string.h>
+#include <chrono>
+
+//-------------------------------------------------------------------------------------------
+
+static const double kRingSeconds = .5;
+
+ASIOAnalyzer::ASIOAnalyzer()
+	: sampleRate(0.), maxFrames(0), stride(0), hop(0), averages(1), scale(0.f), back(2), front(0)
+{
+	ASIOInitChannelState(&state, 1, false, kASIONoiseShapingOff);
+	middle.store(1);
+	running.store(false);
+}
+
+ASIOAnalyzer::~ASIOAnalyzer()
+{
+	stop();
+}
+
+bool ASIOAnalyzer::setup(long numChannels, const long *sampleTypes, long maxFrames, double sampleRate,
+	long fftSize, long hop, long averages)
+{
+	if(running.load() || numChannels < 0 || maxFrames <= 0 || sampleRate <= 0. ||
+		fftSize < 256 || hop < 1 || hop > fftSize || averages < 1 || !fft.setup(fftSize))
+		return false;
+	this->sampleRate = sampleRate;
+	this->maxFrames = maxFrames;
+	this->hop = hop;
+	this->averages = averages;
+
+	long byteWidth = 1;
+	channels.resize(numChannels);
+	for(long i = 0; i < numChannels; i++)
+	{
+		Channel& c = channels[i];
+		ASIOSampleFormat format;
+		c.convert = ASIOGetInputConverter(sampleTypes[i], kASIOHostFloat32);
+		c.byteWidth = c.convert && ASIOGetSampleFormat(sampleTypes[i], &format) ? format.byteWidth : 0;
+		if(c.byteWidth > byteWidth)
+			byteWidth = c.byteWidth;
+		c.input.assign(fftSize + maxFrames, 0.f);
+		c.count = 0;
+		c.power.assign(fft.getNumBins(), 0.f);
+	}
+	stride = (maxFrames * byteWidth + 63) & ~63L;
+	long numBlocks = (long)(kRingSeconds * sampleRate / maxFrames) + 1;
+	if(!ring.setup(kHeaderBytes + stride * numChannels, numBlocks < 4 ? 4 : numBlocks))
+		return false;
+
+	// periodic Hann, its sum is fftSize / 2 and a full scale sine has a magnitude of
+	// fftSize / 4 at its bin
+	const double pi = 3.14159265358979323846;
+	window.resize(fftSize);
+	for(long i = 0; i < fftSize; i++)
+		window[i] = (float)(.5 - .5 * cos(2. * pi * i / fftSize));
+	scale = (float)(16. / ((double)fftSize * fftSize));
+	windowed.assign(fftSize, 0.f);
+	re.assign(fft.getNumBins(), 0.f);
+	im.assign(fft.getNumBins(), 0.f);
+
+	for(long b = 0; b < 3; b++)
+		spectra[b].assign((size_t)numChannels * fft.getNumBins(), 0.f);
+	middle.store(1);
+	back = 2;
+	front = 0;
+	return true;
+}
+
+void ASIOAnalyzer::push(const void *const *buffers, long frames)
+{
+	if(frames > maxFrames)
+		frames = maxFrames;
+	char* block = (char*)ring.beginWrite();
+	if(!block || frames <= 0)
+		return;
+	memcpy(block, &frames, sizeof(frames));
+	for(size_t i = 0; i < channels.size(); i++)
+	{
+		if(channels[i].byteWidth)
+			memcpy(block + kHeaderBytes + i * stride, buffers[i], frames * channels[i].byteWidth);
+	}
+	ring.endWrite();
+}
+
+bool ASIOAnalyzer::start()
+{
+	if(running.load() || channels.empty())
+		return false;
+	running.store(true);
+	worker = std::thread(&ASIOAnalyzer::run, this);
+	return true;
+}
+
+void ASIOAnalyzer::stop()
+{
+	running.store(false);
+	if(worker.joinable())
+		worker.join();
+}
+
+void ASIOAnalyzer::run()
+{
+	// the worker is a DSP thread of its own, see ASIODenormals.h
+	ASIOSetDenormalMode(kASIODenormalsOff);
+	while(running.load(std::memory_order_relaxed))
+	{
+		processPending();
+		std::this_thread::sleep_for(std::chrono::microseconds(kIdleMicroseconds));
+	}
+}
+
+long ASIOAnalyzer::processPending()
+{
+	long spectraDone = 0;
+	for(const char* block; (block = (const char*)ring.beginRead()) != 0; )
+	{
+		long frames;
+		memcpy(&frames, block, sizeof(frames));
+		for(size_t i = 0; i < channels.size(); i++)
+		{
+			Channel& c = channels[i];
+			if(!c.byteWidth)
+				continue;
+			c.convert(&state, block + kHeaderBytes + i * stride, &c.input[c.count], frames);
+			c.count += frames;
+			while(c.count >= fft.getSize())
+			{
+				analyze(c);
+				memmove(&c.input[0], &c.input[hop], (c.count - hop) * sizeof(float));
+				c.count -= hop;
+				spectraDone++;
+			}
+		}
+		ring.endRead();
+	}
+	if(!spectraDone)
+		return 0;
+
+	// all channels to the reader, the ones without a new spectrum as they were
+	long numBins = fft.getNumBins();
+	float* dest = &spectra[back][0];
+	for(size_t i = 0; i < channels.size(); i++)
+		memcpy(dest + i * numBins, &channels[i].power[0], numBins * sizeof(float));
+	back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & 3;
+	return spectraDone;
+}
+
+void ASIOAnalyzer::analyze(Channel &c)
+{
+	long size = fft.getSize();
+	const float* x = &c.input[0];
+	const float* w = &window[0];
+	float* y = &windowed[0];
+	for(long i = 0; i < size; i++)
+		y[i] = x[i] * w[i];
+	fft.forward(y, &re[0], &im[0]);
+
+	float a = 1.f / averages;
+	float* p = &c.power[0];
+	const float* r = &re[0];
+	const float* m = &im[0];
+	for(long k = 0; k < fft.getNumBins(); k++)
+		p[k] += a * (scale * (r[k] * r[k] + m[k] * m[k]) - p[k]);
+}
+
+bool ASIOAnalyzer::read(float *power, long numChannels)
+{
+	bool fresh = (middle.load(std::memory_order_relaxed) & kFresh) != 0;
+	if(fresh)
+		front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+	if(numChannels > (long)channels.size())
+		numChannels = (long)channels.size();
+	if(numChannels > 0)
+		memcpy(power, &spectra[front][0], (size_t)numChannels * fft.getNumBins() * sizeof(float));
+	return fresh;
+}
@@ -0,0 +1,109 @@
+#ifndef __ASIOAnalyzer__
+#define __ASIOAnalyzer__
+
+// Streaming spectrum analyzer of input channels. The buffer switch only copies the
+// device buffers of the analyzed channels into one block of an ASIOBlockRing, as
+// they are, without converting or looking at the samples. A worker thread of its own
+// does the rest:
+//
+//   convert    device samples to float with the input converters of ASIOConvertMatrix.h
+//   window     Hann, fftSize samples every hop samples, fftSize / 2 for 50 % overlap
+//   transform  real FFT, see ASIOFFT.h
+//   average    exponential over the last averages spectra, the power of every bin
+//   publish    the averaged spectra of all channels to the reader, a triple buffer
+//
+// The buffer switch never waits for the worker: when the ring is full the buffers of
+// that call are dropped and counted. Power is linear, a full scale sine at the center
+// of a bin reads 1 there.
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include "ASIOBlockRing.h"
+#include "ASIOConvertMatrix.h"
+#include "ASIOFFT.h"
+
+class ASIOAnalyzer
+{
+public:
+	ASIOAnalyzer();
+	~ASIOAnalyzer();
+
+	// sampleTypes holds the ASIOSampleType of each channel, DSD and unknown types are
+	// left silent. fftSize a power of 2 from 256 to 65536, hop from 1 to fftSize and
+	// averages at least 1. The ring holds half a second of buffers of up to maxFrames.
+	// Allocates everything, call it before the buffers run and before start().
+	bool setup(long numChannels, const long *sampleTypes, long maxFrames, double sampleRate,
+		long fftSize, long hop, long averages);
+
+	long getNumChannels() const { return (long)channels.size(); }
+	long getNumBins() const { return fft.getNumBins(); }
+	double getBinFrequency(long bin) const { return bin * sampleRate / fft.getSize(); }
+
+	// one buffer of every channel, buffers[i] is the device buffer of channel i. Buffer
+	// switch, frames up to maxFrames.
+	void push(const void *const *buffers, long frames);
+
+	// buffers push() couldn't hand to the worker, any thread
+	unsigned long getDropped() const { return ring.getDropped(); }
+
+	// starts and stops the worker thread
+	bool start();
+	void stop();
+
+	// the work of the worker on the calling thread, for a host that runs it itself
+	// instead of start(). Analyzes every pushed buffer, returns the number of spectra
+	// computed; a spectrum went to the reader when it isn't 0.
+	long processPending();
+
+	// the averaged power of numChannels channels, getNumBins() values per channel one
+	// channel after the other, as of the latest spectrum. One reader thread, true when
+	// it changed since the last read.
+	bool read(float *power, long numChannels);
+
+private:
+	enum
+	{
+		kHeaderBytes = 64,		// of a ring block, the frames, then the channels
+		kFresh = 4,				// in middle, published and not read yet
+		kIdleMicroseconds = 1000	// the worker sleeps between looks at the ring
+	};
+
+	typedef struct Channel
+	{
+		ASIOChannelConverter convert;
+		long byteWidth;
+		std::vector<float> input;	// the next window, then samples beyond it
+		long count;					// samples in input
+		std::vector<float> power;	// averaged
+	} Channel;
+
+	void run();
+	void analyze(Channel &c);
+
+	double sampleRate;
+	long maxFrames;
+	long stride;				// bytes of one channel in a ring block
+	long hop;
+	long averages;
+	float scale;				// bin magnitude squared to power
+	ASIOChannelState state;		// of all input converters, they leave it alone
+	ASIOFFT fft;
+	ASIOBlockRing ring;
+	std::vector<Channel> channels;
+	std::vector<float> window;
+	std::vector<float> windowed;
+	std::vector<float> re;
+	std::vector<float> im;
+
+	// triple buffer, back belongs to the worker and front to the reader
+	std::atomic<long> middle;
+	long back;
+	long front;
+	std::vector<float> spectra[3];
+
+	std::atomic<bool> running;
+	std::thread worker;
+};
+
+#endif
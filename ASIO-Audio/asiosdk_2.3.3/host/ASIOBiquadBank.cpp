@@ -0,0 +1,84 @@
+#include "ginclude.h"
+#include "ASIOBiquadBank.h"
+#include "ASIOConvertKernels.h"
+#include "ASIODSPKernels.h"
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------
+
+ASIOBiquadBank::ASIOBiquadBank()
+	: numChannels(0), numStages(0)
+{
+}
+
+bool ASIOBiquadBank::setup(long numChannels, long numStages)
+{
+	if(numChannels < 0 || numStages < 0)
+		return false;
+	this->numChannels = numChannels;
+	this->numStages = numStages;
+	groups.resize((numChannels + kLanes - 1) / kLanes);
+	for(size_t g = 0; g < groups.size(); g++)
+	{
+		Group& group = groups[g];
+		group.coefficients.assign(numStages * 5 * kLanes, 0.f);
+		group.state.assign(numStages * 2 * kLanes, 0.f);
+		for(long s = 0; s < numStages; s++)
+		{
+			for(long lane = 0; lane < kLanes; lane++)
+				group.coefficients[s * 5 * kLanes + lane] = 1.f;
+		}
+	}
+	block.assign(kBlockFrames * kLanes, 0.f);
+	silence.assign(kBlockFrames, 0.f);
+	discard.assign(kBlockFrames, 0.f);
+	return true;
+}
+
+void ASIOBiquadBank::reset()
+{
+	for(size_t g = 0; g < groups.size(); g++)
+	{
+		if(!groups[g].state.empty())
+			memset(&groups[g].state[0], 0, groups[g].state.size() * sizeof(float));
+	}
+}
+
+void ASIOBiquadBank::setStage(long channel, long stage, const double *coefficients)
+{
+	if(channel < 0 || channel >= numChannels || stage < 0 || stage >= numStages)
+		return;
+	float* c = &groups[channel / kLanes].coefficients[stage * 5 * kLanes + channel % kLanes];
+	for(long i = 0; i < 5; i++)
+		c[i * kLanes] = (float)coefficients[i];
+}
+
+void ASIOBiquadBank::process(const float *const *sources, float *const *dests, long frames)
+{
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	const ASIODSPKernels* dsp = ASIOGetDSPKernels();
+	for(size_t g = 0; g < groups.size(); g++)
+	{
+		Group& group = groups[g];
+		long first = (long)g * kLanes;
+		long lanes = numChannels - first < kLanes ? numChannels - first : (long)kLanes;
+		for(long done = 0; done < frames; )
+		{
+			long n = frames - done;
+			if(n > kBlockFrames)
+				n = kBlockFrames;
+			const void* in[kLanes];
+			void* out[kLanes];
+			for(long lane = 0; lane < kLanes; lane++)
+			{
+				in[lane] = lane < lanes ? (const void*)(sources[first + lane] + done) : &silence[0];
+				out[lane] = lane < lanes ? (void*)(dests[first + lane] + done) : &discard[0];
+			}
+			k->interleave(in, &block[0], kLanes, sizeof(float), n);
+			if(numStages)
+				dsp->biquad(&group.coefficients[0], &group.state[0], &block[0], numStages, n);
+			k->deinterleave(&block[0], out, kLanes, sizeof(float), n);
+			done += n;
+		}
+	}
+}
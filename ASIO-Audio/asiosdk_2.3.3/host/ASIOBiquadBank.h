@@ -0,0 +1,67 @@
+#ifndef __ASIOBiquadBank__
+#define __ASIOBiquadBank__
+
+// Equalizer and crossover bank of float channels: every channel runs numStages biquads
+// in series, each with coefficients of its own. The state and coefficients are kept
+// structure of arrays, 16 channels side by side, so that one instruction computes the
+// same stage of 16 channels (AVX-512), 8 (AVX2) or 4 (SSE2) on the biquad kernel of
+// ASIODSPKernels.h instead of one recursion per channel after the other.
+//
+// process() takes the planar buffers of the buffer switch. It interleaves blocks of 16
+// channels into a scratch buffer on the interleave kernel, filters the block through
+// all stages and deinterleaves it back, channels past the last one are silent lanes.
+//
+// Feedback filters decay into denormals, the thread that runs process() should have
+// them off, see ASIODenormals.h.
+
+#include <vector>
+
+class ASIOBiquadBank
+{
+public:
+	enum
+	{
+		kLanes = 16			// channels of the biquad kernel, a bank of up to that many is one pass
+	};
+
+	ASIOBiquadBank();
+	~ASIOBiquadBank() {}
+
+	// every stage passes its input through. Allocates, call it before the buffers run.
+	bool setup(long numChannels, long numStages);
+
+	// all channels back to silence
+	void reset();
+
+	long getNumChannels() const { return numChannels; }
+	long getNumStages() const { return numStages; }
+
+	// b0, b1, b2, a1 and a2 like ASIODesignBiquad() writes them, from the thread that
+	// calls process() or while it doesn't run
+	void setStage(long channel, long stage, const double *coefficients);
+
+	// frames samples of every channel, sources[i] and dests[i] are the buffers of
+	// channel i and may be the same. Buffer switch.
+	void process(const float *const *sources, float *const *dests, long frames);
+
+private:
+	enum
+	{
+		kBlockFrames = 64		// frames per interleaved block, 4 kB
+	};
+
+	typedef struct Group
+	{
+		std::vector<float> coefficients;	// 5 arrays of kLanes per stage
+		std::vector<float> state;			// 2 arrays of kLanes per stage
+	} Group;
+
+	long numChannels;
+	long numStages;
+	std::vector<Group> groups;
+	std::vector<float> block;		// kBlockFrames of kLanes
+	std::vector<float> silence;		// input of the lanes without a channel
+	std::vector<float> discard;		// and their output
+};
+
+#endif
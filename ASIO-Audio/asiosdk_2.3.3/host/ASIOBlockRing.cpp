@@ -0,0 +1,69 @@
+#include "ginclude.h"
+#include "ASIOBlockRing.h"
+#include <stddef.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------------------------
+
+ASIOBlockRing::ASIOBlockRing()
+	: blockBytes(0), mask(-1), blocks(0)
+{
+	written.value.store(0);
+	read.value.store(0);
+	dropped.store(0);
+}
+
+bool ASIOBlockRing::setup(long blockBytes, long numBlocks)
+{
+	if(blockBytes <= 0 || numBlocks <= 0 || numBlocks > (1L << 20))
+		return false;
+	long n = 1;
+	while(n < numBlocks)
+		n <<= 1;
+	this->blockBytes = (blockBytes + 63) & ~63L;
+	mask = n - 1;
+	storage.assign((size_t)this->blockBytes * n + 63, 0);
+	blocks = (char*)(((uintptr_t)&storage[0] + 63) & ~(uintptr_t)63);
+	reset();
+	return true;
+}
+
+void ASIOBlockRing::reset()
+{
+	written.value.store(0, std::memory_order_relaxed);
+	read.value.store(0, std::memory_order_relaxed);
+	dropped.store(0, std::memory_order_relaxed);
+}
+
+void *ASIOBlockRing::beginWrite()
+{
+	if(!blocks)
+		return 0;
+	unsigned long w = written.value.load(std::memory_order_relaxed);
+	if(w - read.value.load(std::memory_order_acquire) > (unsigned long)mask)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return 0;
+	}
+	return blocks + (size_t)(w & mask) * blockBytes;
+}
+
+void ASIOBlockRing::endWrite()
+{
+	written.value.store(written.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+const void *ASIOBlockRing::beginRead()
+{
+	if(!blocks)
+		return 0;
+	unsigned long r = read.value.load(std::memory_order_relaxed);
+	if(r == written.value.load(std::memory_order_acquire))
+		return 0;
+	return blocks + (size_t)(r & mask) * blockBytes;
+}
+
+void ASIOBlockRing::endRead()
+{
+	read.value.store(read.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
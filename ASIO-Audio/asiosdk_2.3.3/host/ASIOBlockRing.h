@@ -0,0 +1,56 @@
+#ifndef __ASIOBlockRing__
+#define __ASIOBlockRing__
+
+// Lock free ring of fixed size blocks between one producer and one consumer thread,
+// for data the buffer switch hands to a worker. Both sides get a block in place,
+// fill or read it and release it, nothing is copied twice. The producer never waits:
+// when all blocks are taken beginWrite() returns 0 and the block counts as dropped.
+// The two counters live on cache lines of their own so that polling one side doesn't
+// pull the line of the other.
+
+#include <vector>
+#include <atomic>
+
+class ASIOBlockRing
+{
+public:
+	ASIOBlockRing();
+	~ASIOBlockRing() {}
+
+	// numBlocks is rounded up to a power of 2, blocks start on 64 byte boundaries.
+	// Allocates, call it before either side runs.
+	bool setup(long blockBytes, long numBlocks);
+
+	// empties the ring and clears the drops, neither side may run
+	void reset();
+
+	long getBlockBytes() const { return blockBytes; }
+	long getNumBlocks() const { return mask + 1; }
+
+	// producer: the next free block, 0 when the ring is full. endWrite() passes it on.
+	void *beginWrite();
+	void endWrite();
+
+	// consumer: the oldest block, 0 when the ring is empty. endRead() frees it.
+	const void *beginRead();
+	void endRead();
+
+	// blocks beginWrite() found no room for, any thread
+	unsigned long getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	typedef struct alignas(64) Counter
+	{
+		std::atomic<unsigned long> value;
+	} Counter;
+
+	long blockBytes;		// rounded up to 64
+	long mask;
+	Counter written;
+	Counter read;
+	std::atomic<unsigned long> dropped;
+	std::vector<char> storage;
+	char *blocks;			// the first 64 byte boundary in storage
+};
+
+#endif
@@ -0,0 +1,812 @@
+#include "ginclude.h"
+#include "ASIOConvertScalar.h"
+
+#if ASIO_CONVERT_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+static ASIOConvertKernels kernels;
+static bool kernelsSelected = false;
+
+
+//-------------------------------------------------------------------------------------------
+// cpu detection
+
+#if ASIO_CONVERT_X86
+static void cpuid(unsigned int leaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, (int)leaf, 0);
+#else
+	__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long xgetbv()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+ASIOConvertISA ASIOGetSupportedConvertISA()
+{
+#if ASIO_CONVERT_X86 && ASIO_LITTLE_ENDIAN
+	unsigned int regs[4];
+	cpuid(0, regs);
+	unsigned int maxLeaf = regs[0];
+	if(maxLeaf < 1)
+		return kASIOConvertScalar;
+
+	cpuid(1, regs);
+	bool sse2 = (regs[3] & (1u << 26)) != 0;
+	bool ssse3 = (regs[2] & (1u << 9)) != 0;
+	bool sse41 = (regs[2] & (1u << 19)) != 0;
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+	if(!sse2)
+		return kASIOConvertScalar;
+	if(!ssse3 || !sse41)
+		return kASIOConvertSSE2;
+
+	// AVX2 also needs the os to save the ymm registers, AVX-512 the opmask and zmm ones
+	if(osxsave && avx && maxLeaf >= 7 && (xgetbv() & 0x6) == 0x6)
+	{
+		cpuid(7, regs);
+		if(!(regs[1] & (1u << 5)))
+			return kASIOConvertSSE41;
+		if((regs[1] & (1u << 16)) && (xgetbv() & 0xe6) == 0xe6)
+			return kASIOConvertAVX512;
+		return kASIOConvertAVX2;
+	}
+	return kASIOConvertSSE41;
+#else
+	return kASIOConvertScalar;
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------------
+// kernel selection
+
+ASIOConvertISA ASIOSelectConvertKernels(ASIOConvertISA isa)
+{
+	ASIOConvertISA supported = ASIOGetSupportedConvertISA();
+	if(isa > supported)
+		isa = supported;
+
+	ASIOInstallScalarKernels(&kernels);
+#if ASIO_CONVERT_X86
+	if(isa >= kASIOConvertSSE2)
+		ASIOInstallSSE2Kernels(&kernels);
+	if(isa >= kASIOConvertSSE41)
+		ASIOInstallSSE41Kernels(&kernels);
+	if(isa >= kASIOConvertAVX2)
+		ASIOInstallAVX2Kernels(&kernels);
+#endif
+	kernels.isa = isa;
+	kernelsSelected = true;
+	return isa;
+}
+
+const ASIOConvertKernels *ASIOGetConvertKernels()
+{
+	if(!kernelsSelected)
+		ASIOSelectConvertKernels(kASIOConvertAuto);
+	return &kernels;
+}
+
+const char *ASIOGetConvertISAName(ASIOConvertISA isa)
+{
+	switch(isa)
+	{
+	case kASIOConvertScalar:
+		return "scalar";
+	case kASIOConvertSSE2:
+		return "SSE2";
+	case kASIOConvertSSE41:
+		return "SSE4.1";
+	case kASIOConvertAVX2:
+		return "AVX2";
+	case kASIOConvertAVX512:
+		return "AVX-512";
+	case kASIOConvertAuto:
+		return "auto";
+	}
+	return "unknown";
+}
+
+
+
+//-------------------------------------------------------------------------------------------
+// scalar reference
+
+void ASIOFloat32toInt16Scalar(const float *source, void *dest, long frames)
+{
+	double sc = fScaler16 + .49999;
+	short* b = (short*)dest;
+	while(--frames >= 0)
+		*b++ = (short)saturateToInt((double)(*source++) * sc, fScaler16);
+}
+
+void ASIOFloat32toInt24Scalar(const float *source, void *dest, long frames)
+{
+	double sc = fScaler24 + .49999;
+	int a;
+	char* b = (char*)dest;
+	char* aa = (char*)&a;
+
+	while(--frames >= 0)
+	{
+		a = saturateToInt((double)(*source++) * sc, fScaler24);
+#if ASIO_LITTLE_ENDIAN
+		*b++ = aa[3];
+		*b++ = aa[2];
+		*b++ = aa[1];
+#else
+		*b++ = aa[1];
+		*b++ = aa[2];
+		*b++ = aa[3];
+#endif
+	}
+}
+
+void ASIOFloat32toInt32Scalar(const float *source, void *dest, long frames)
+{
+	double sc = fScaler32 + .49999;
+	int* b = (int*)dest;
+	while(--frames >= 0)
+		*b++ = saturateToInt((double)(*source++) * sc, fScaler32);
+}
+
+//-------------------------------------------------------------------------------------------
+// packed 24 bit
+
+void ASIOInt32toInt24LSBScalar(const void *source, void *dest, long frames)
+{
+	const int* in = (const int*)source;
+	char* out = (char*)dest;
+	int a;
+	while(--frames >= 0)
+	{
+		a = *in++;
+		out[0] = (char)(a >> 8);	// lsb
+		out[1] = (char)(a >> 16);
+		out[2] = (char)(a >> 24);	// msb
+		out += 3;
+	}
+}
+
+void ASIOInt32toInt24MSBScalar(const void *source, void *dest, long frames)
+{
+	const int* in = (const int*)source;
+	char* out = (char*)dest;
+	int a;
+	while(--frames >= 0)
+	{
+		a = *in++;
+		out[0] = (char)(a >> 24);	// msb
+		out[1] = (char)(a >> 16);
+		out[2] = (char)(a >> 8);	// lsb
+		out += 3;
+	}
+}
+
+void ASIOInt24LSBtoInt32Scalar(const void *source, void *dest, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source + frames * 3;
+	int* out = (int*)dest + frames;
+	while(--frames >= 0)
+	{
+		in -= 3;
+		*--out = (int)(((unsigned int)in[2] << 24) | ((unsigned int)in[1] << 16) | ((unsigned int)in[0] << 8));
+	}
+}
+
+void ASIOInt24MSBtoInt32Scalar(const void *source, void *dest, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source + frames * 3;
+	int* out = (int*)dest + frames;
+	while(--frames >= 0)
+	{
+		in -= 3;
+		*--out = (int)(((unsigned int)in[0] << 24) | ((unsigned int)in[1] << 16) | ((unsigned int)in[2] << 8));
+	}
+}
+
+void ASIOInt24LSBtoInt16Scalar(const void *source, void *dest, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source;
+	short* out = (short*)dest;
+	while(--frames >= 0)
+	{
+		*out++ = (short)((in[2] << 8) | in[1]);
+		in += 3;
+	}
+}
+
+void ASIOInt24MSBtoInt16Scalar(const void *source, void *dest, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source;
+	short* out = (short*)dest;
+	while(--frames >= 0)
+	{
+		*out++ = (short)((in[0] << 8) | in[1]);
+		in += 3;
+	}
+}
+
+void ASIOStereoInt32toInt24LSBScalar(const void *left, const void *right, void *dest, long frames)
+{
+	const int* l = (const int*)left;
+	const int* r = (const int*)right;
+	char* out = (char*)dest;
+	while(--frames >= 0)
+	{
+		ASIOInt32toInt24LSBScalar(l++, out, 1);
+		ASIOInt32toInt24LSBScalar(r++, out + 3, 1);
+		out += 6;
+	}
+}
+
+void ASIOStereoInt32toInt24MSBScalar(const void *left, const void *right, void *dest, long frames)
+{
+	const int* l = (const int*)left;
+	const int* r = (const int*)right;
+	char* out = (char*)dest;
+	while(--frames >= 0)
+	{
+		ASIOInt32toInt24MSBScalar(l++, out, 1);
+		ASIOInt32toInt24MSBScalar(r++, out + 3, 1);
+		out += 6;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// byte swap and shift
+
+void ASIOShift32Scalar(const void *source, void *dest, long shiftAmount, long targetByteWidth,
+	bool revertEndian, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source;
+	unsigned char* out = (unsigned char*)dest;
+	unsigned int a;
+
+	if(targetByteWidth < 2 || targetByteWidth > 4)
+	{
+		// nothing to narrow to, only the byte swap is done
+		if(revertEndian)
+			ASIOReverseEndianScalar(source, dest, 4, frames);
+		return;
+	}
+
+	while(--frames >= 0)
+	{
+		memcpy(&a, in, 4);
+		if(revertEndian)
+			a = (a >> 24) | ((a >> 8) & 0xff00) | ((a << 8) & 0xff0000) | (a << 24);
+		// shifts beyond the word clear it, like pslld
+		a = (unsigned long)shiftAmount < 32 ? a << shiftAmount : 0;
+		in += 4;
+
+		if(targetByteWidth == 2)
+		{
+			short b = (short)(a >> 16);
+			memcpy(out, &b, 2);
+			out += 2;
+		}
+		else if(targetByteWidth == 3)
+		{
+			// upper three bytes in native order
+#if ASIO_LITTLE_ENDIAN
+			out[0] = (unsigned char)(a >> 8);	// lsb
+			out[1] = (unsigned char)(a >> 16);
+			out[2] = (unsigned char)(a >> 24);	// msb
+#else
+			out[0] = (unsigned char)(a >> 24);	// msb
+			out[1] = (unsigned char)(a >> 16);
+			out[2] = (unsigned char)(a >> 8);	// lsb
+#endif
+			out += 3;
+		}
+		else
+		{
+			memcpy(out, &a, 4);
+			out += 4;
+		}
+	}
+}
+
+void ASIOReverseEndianScalar(const void *source, void *dest, long byteWidth, long frames)
+{
+	const char* a = (const char*)source;
+	char* b = (char*)dest;
+	char c;
+	if(byteWidth == 2)
+	{
+		while(--frames >= 0)
+		{
+			c = a[0];
+			b[0] = a[1];
+			b[1] = c;
+			a += 2;
+			b += 2;
+		}
+	}
+	else if(byteWidth == 3)
+	{
+		while(--frames >= 0)
+		{
+			c = a[0];
+			b[1] = a[1];
+			b[0] = a[2];
+			b[2] = c;
+			a += 3;
+			b += 3;
+		}
+	}
+	else if(byteWidth == 4)
+	{
+		char d;
+		while(--frames >= 0)
+		{
+			c = a[0];
+			d = a[1];
+			b[0] = a[3];
+			b[1] = a[2];
+			b[2] = d;
+			b[3] = c;
+			a += 4;
+			b += 4;
+		}
+	}
+	else if(byteWidth == 8)
+	{
+		char t[8];
+		while(--frames >= 0)
+		{
+			for(int i = 0; i < 8; i++)
+				t[i] = a[7 - i];
+			memcpy(b, t, 8);
+			a += 8;
+			b += 8;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// n channel interleave
+
+// a packed 24 bit sample, copied as a whole
+typedef struct Sample24
+{
+	unsigned char b[3];
+} Sample24;
+
+long ASIOInterleaveBlockFrames(long numChannels, long byteWidth)
+{
+	// source and destination of a block together fill about half of a 32k L1
+	const long blockBytes = 8192;
+	long frames = blockBytes / (numChannels * byteWidth + 1);
+	frames &= ~15L;
+	return frames < 16 ? 16 : frames;
+}
+
+template <typename T>
+static void interleaveRect(const void *const *channels, void *dest, long numChannels,
+	long firstChannel, long endChannel, long firstFrame, long endFrame)
+{
+	T* out = (T*)dest;
+	long block = ASIOInterleaveBlockFrames(numChannels, sizeof(T));
+	for(long b = firstFrame; b < endFrame; b += block)
+	{
+		long e = b + block < endFrame ? b + block : endFrame;
+		for(long c = firstChannel; c < endChannel; c++)
+		{
+			const T* in = (const T*)channels[c];
+			for(long f = b; f < e; f++)
+				out[f * numChannels + c] = in[f];
+		}
+	}
+}
+
+template <typename T>
+static void deinterleaveRect(const void *source, void *const *channels, long numChannels,
+	long firstChannel, long endChannel, long firstFrame, long endFrame)
+{
+	const T* in = (const T*)source;
+	long block = ASIOInterleaveBlockFrames(numChannels, sizeof(T));
+	for(long b = firstFrame; b < endFrame; b += block)
+	{
+		long e = b + block < endFrame ? b + block : endFrame;
+		for(long c = firstChannel; c < endChannel; c++)
+		{
+			T* out = (T*)channels[c];
+			for(long f = b; f < e; f++)
+				out[f] = in[f * numChannels + c];
+		}
+	}
+}
+
+void ASIOInterleaveRectScalar(const void *const *channels, void *dest, long numChannels, long byteWidth,
+	long firstChannel, long endChannel, long firstFrame, long endFrame)
+{
+	switch(byteWidth)
+	{
+	case 1:
+		interleaveRect<char>(channels, dest, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 2:
+		interleaveRect<short>(channels, dest, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 3:
+		interleaveRect<Sample24>(channels, dest, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 4:
+		interleaveRect<int>(channels, dest, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 8:
+		interleaveRect<long long>(channels, dest, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	default:
+		for(long f = firstFrame; f < endFrame; f++)
+			for(long c = firstChannel; c < endChannel; c++)
+				memcpy((char*)dest + (f * numChannels + c) * byteWidth,
+					(const char*)channels[c] + f * byteWidth, byteWidth);
+		break;
+	}
+}
+
+void ASIODeinterleaveRectScalar(const void *source, void *const *channels, long numChannels, long byteWidth,
+	long firstChannel, long endChannel, long firstFrame, long endFrame)
+{
+	switch(byteWidth)
+	{
+	case 1:
+		deinterleaveRect<char>(source, channels, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 2:
+		deinterleaveRect<short>(source, channels, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 3:
+		deinterleaveRect<Sample24>(source, channels, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 4:
+		deinterleaveRect<int>(source, channels, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	case 8:
+		deinterleaveRect<long long>(source, channels, numChannels, firstChannel, endChannel, firstFrame, endFrame);
+		break;
+	default:
+		for(long f = firstFrame; f < endFrame; f++)
+			for(long c = firstChannel; c < endChannel; c++)
+				memcpy((char*)channels[c] + f * byteWidth,
+					(const char*)source + (f * numChannels + c) * byteWidth, byteWidth);
+		break;
+	}
+}
+
+void ASIOInterleaveScalar(const void *const *channels, void *dest, long numChannels,
+	long byteWidth, long frames)
+{
+	ASIOInterleaveRectScalar(channels, dest, numChannels, byteWidth, 0, numChannels, 0, frames);
+}
+
+void ASIODeinterleaveScalar(const void *source, void *const *channels, long numChannels,
+	long byteWidth, long frames)
+{
+	ASIODeinterleaveRectScalar(source, channels, numChannels, byteWidth, 0, numChannels, 0, frames);
+}
+
+//-------------------------------------------------------------------------------------------
+// int and float to float, the loops are in ASIOConvertScalar.h
+
+void ASIOIntToFloat32Scalar(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, float scale, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: scalarIntToFloat32<2, false>(source, dest, scale, frames); break;
+	case 5: scalarIntToFloat32<2, true>(source, dest, scale, frames); break;
+	case 6: scalarIntToFloat32<3, false>(source, dest, scale, frames); break;
+	case 7: scalarIntToFloat32<3, true>(source, dest, scale, frames); break;
+	case 8: scalarIntToFloat32<4, false>(source, dest, scale, frames); break;
+	case 9: scalarIntToFloat32<4, true>(source, dest, scale, frames); break;
+	}
+}
+
+void ASIOIntToFloat64Scalar(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: scalarIntToFloat64<2, false>(source, dest, scale, frames); break;
+	case 5: scalarIntToFloat64<2, true>(source, dest, scale, frames); break;
+	case 6: scalarIntToFloat64<3, false>(source, dest, scale, frames); break;
+	case 7: scalarIntToFloat64<3, true>(source, dest, scale, frames); break;
+	case 8: scalarIntToFloat64<4, false>(source, dest, scale, frames); break;
+	case 9: scalarIntToFloat64<4, true>(source, dest, scale, frames); break;
+	}
+}
+
+void ASIOFloatToFloat32Scalar(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: scalarFloatToFloat32<4, false>(source, dest, frames); break;
+	case 9: scalarFloatToFloat32<4, true>(source, dest, frames); break;
+	case 16: scalarFloatToFloat32<8, false>(source, dest, frames); break;
+	case 17: scalarFloatToFloat32<8, true>(source, dest, frames); break;
+	}
+}
+
+void ASIOFloatToFloat64Scalar(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: scalarFloatToFloat64<4, false>(source, dest, frames); break;
+	case 9: scalarFloatToFloat64<4, true>(source, dest, frames); break;
+	case 16: scalarFloatToFloat64<8, false>(source, dest, frames); break;
+	case 17: scalarFloatToFloat64<8, true>(source, dest, frames); break;
+	}
+}
+
+void ASIOFloat32toFloatScalar(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: scalarFloat32toFloat<4, false>(source, dest, frames); break;
+	case 9: scalarFloat32toFloat<4, true>(source, dest, frames); break;
+	case 16: scalarFloat32toFloat<8, false>(source, dest, frames); break;
+	case 17: scalarFloat32toFloat<8, true>(source, dest, frames); break;
+	}
+}
+
+void ASIOFloat64toFloatScalar(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: scalarFloat64toFloat<4, false>(source, dest, frames); break;
+	case 9: scalarFloat64toFloat<4, true>(source, dest, frames); break;
+	case 16: scalarFloat64toFloat<8, false>(source, dest, frames); break;
+	case 17: scalarFloat64toFloat<8, true>(source, dest, frames); break;
+	}
+}
+
+long ASIOFloat32toIntScalar(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return scalarFloat32toInt<2, false>(source, dest, scale, frames);
+	case 5: return scalarFloat32toInt<2, true>(source, dest, scale, frames);
+	case 6: return scalarFloat32toInt<3, false>(source, dest, scale, frames);
+	case 7: return scalarFloat32toInt<3, true>(source, dest, scale, frames);
+	case 8: return scalarFloat32toInt<4, false>(source, dest, scale, frames);
+	case 9: return scalarFloat32toInt<4, true>(source, dest, scale, frames);
+	}
+	return 0;
+}
+
+long ASIOFloat64toIntScalar(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return scalarFloat64toInt<2, false>(source, dest, scale, frames);
+	case 5: return scalarFloat64toInt<2, true>(source, dest, scale, frames);
+	case 6: return scalarFloat64toInt<3, false>(source, dest, scale, frames);
+	case 7: return scalarFloat64toInt<3, true>(source, dest, scale, frames);
+	case 8: return scalarFloat64toInt<4, false>(source, dest, scale, frames);
+	case 9: return scalarFloat64toInt<4, true>(source, dest, scale, frames);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// requantizer
+
+void ASIOInitRequantizer(ASIORequantizer *requantizer, unsigned int seed, bool dither, long shaping)
+{
+	if(!seed)
+		seed = 0x9e3779b9;
+	for(int i = 0; i < 8; i++)
+	{
+		// splitmix32 style scramble so that neighbouring seeds don't correlate
+		unsigned int z = seed + 0x9e3779b9 * (unsigned int)(i + 1);
+		z = (z ^ (z >> 16)) * 0x85ebca6b;
+		z = (z ^ (z >> 13)) * 0xc2b2ae35;
+		z ^= z >> 16;
+		requantizer->rng[i] = z ? z : 1;
+	}
+	requantizer->lane = 0;
+	requantizer->error[0] = requantizer->error[1] = 0;
+	requantizer->shaping = shaping;
+	requantizer->dither = dither;
+}
+
+long ASIORequantizeBlock(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, const int *dither, long frames)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return scalarRequantizeBlock<2, false>(requantizer, source, dest, bits, dither, frames);
+	case 5: return scalarRequantizeBlock<2, true>(requantizer, source, dest, bits, dither, frames);
+	case 6: return scalarRequantizeBlock<3, false>(requantizer, source, dest, bits, dither, frames);
+	case 7: return scalarRequantizeBlock<3, true>(requantizer, source, dest, bits, dither, frames);
+	case 8: return scalarRequantizeBlock<4, false>(requantizer, source, dest, bits, dither, frames);
+	case 9: return scalarRequantizeBlock<4, true>(requantizer, source, dest, bits, dither, frames);
+	}
+	return 0;
+}
+
+long ASIORequantizeScalar(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, long frames)
+{
+	if(bits < 2 || bits > byteWidth * 8)
+		return 0;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return scalarRequantize<2, false>(requantizer, source, dest, bits, frames);
+	case 5: return scalarRequantize<2, true>(requantizer, source, dest, bits, frames);
+	case 6: return scalarRequantize<3, false>(requantizer, source, dest, bits, frames);
+	case 7: return scalarRequantize<3, true>(requantizer, source, dest, bits, frames);
+	case 8: return scalarRequantize<4, false>(requantizer, source, dest, bits, frames);
+	case 9: return scalarRequantize<4, true>(requantizer, source, dest, bits, frames);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// gain and mix
+
+long ASIOMixToIntRangeScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long firstFrame, long endFrame)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return scalarMixToInt<2, false>(sources, gains, numSources, dest, scale, firstFrame, endFrame);
+	case 5: return scalarMixToInt<2, true>(sources, gains, numSources, dest, scale, firstFrame, endFrame);
+	case 6: return scalarMixToInt<3, false>(sources, gains, numSources, dest, scale, firstFrame, endFrame);
+	case 7: return scalarMixToInt<3, true>(sources, gains, numSources, dest, scale, firstFrame, endFrame);
+	case 8: return scalarMixToInt<4, false>(sources, gains, numSources, dest, scale, firstFrame, endFrame);
+	case 9: return scalarMixToInt<4, true>(sources, gains, numSources, dest, scale, firstFrame, endFrame);
+	}
+	return 0;
+}
+
+void ASIOMixToFloatRangeScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long firstFrame, long endFrame)
+{
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: scalarMixToFloat<4, false>(sources, gains, numSources, dest, firstFrame, endFrame); break;
+	case 9: scalarMixToFloat<4, true>(sources, gains, numSources, dest, firstFrame, endFrame); break;
+	case 16: scalarMixToFloat<8, false>(sources, gains, numSources, dest, firstFrame, endFrame); break;
+	case 17: scalarMixToFloat<8, true>(sources, gains, numSources, dest, firstFrame, endFrame); break;
+	}
+}
+
+long ASIOMixToIntScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long frames)
+{
+	return ASIOMixToIntRangeScalar(sources, gains, numSources, dest, byteWidth, reverseEndian, scale, 0, frames);
+}
+
+void ASIOMixToFloatScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long frames)
+{
+	ASIOMixToFloatRangeScalar(sources, gains, numSources, dest, byteWidth, reverseEndian, 0, frames);
+}
+
+//-------------------------------------------------------------------------------------------
+// channel converters, see ASIOInstallChannels()
+
+struct ChannelsScalar
+{
+	template <long layout, bool swap>
+	static void toFloat32(ASIOChannelState *, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			scalarFloatToFloat32<width, swap>(source, (float*)dest, frames);
+		else
+			scalarIntToFloat32<width, swap>(source, (float*)dest, (float)ASIOInputScaleOf(ASIOLayoutBits(layout)), frames);
+	}
+
+	template <long layout, bool swap>
+	static void toFloat64(ASIOChannelState *, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			scalarFloatToFloat64<width, swap>(source, (double*)dest, frames);
+		else
+			scalarIntToFloat64<width, swap>(source, (double*)dest, ASIOInputScaleOf(ASIOLayoutBits(layout)), frames);
+	}
+
+	template <long layout, bool swap>
+	static void fromFloat32(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			scalarFloat32toFloat<width, swap>((const float*)source, dest, frames);
+		else
+			ASIOCountClips(state, scalarFloat32toInt<width, swap>((const float*)source, dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+
+	template <long layout, bool swap>
+	static void fromFloat64(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			scalarFloat64toFloat<width, swap>((const double*)source, dest, frames);
+		else
+			ASIOCountClips(state, scalarFloat64toInt<width, swap>((const double*)source, dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+
+	template <long layout, bool swap>
+	static void requantize(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		ASIOCountClips(state, scalarRequantize<ASIOLayoutBytes(layout), swap>(&state->requantizer,
+			(const float*)source, dest, ASIOLayoutBits(layout), frames));
+	}
+
+	template <long layout, bool swap>
+	static void mix(ASIOChannelState *state, const float *const *sources, const float *gains,
+		long numSources, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			scalarMixToFloat<width, swap>(sources, gains, numSources, dest, 0, frames);
+		else
+			ASIOCountClips(state, scalarMixToInt<width, swap>(sources, gains, numSources, dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), 0, frames));
+	}
+};
+
+void ASIOInstallScalarKernels(ASIOConvertKernels *k)
+{
+	k->isa = kASIOConvertScalar;
+	k->float32toInt16 = ASIOFloat32toInt16Scalar;
+	k->float32toInt24 = ASIOFloat32toInt24Scalar;
+	k->float32toInt32 = ASIOFloat32toInt32Scalar;
+	k->int32toInt24LSB = ASIOInt32toInt24LSBScalar;
+	k->int32toInt24MSB = ASIOInt32toInt24MSBScalar;
+	k->int24LSBtoInt32 = ASIOInt24LSBtoInt32Scalar;
+	k->int24MSBtoInt32 = ASIOInt24MSBtoInt32Scalar;
+	k->int24LSBtoInt16 = ASIOInt24LSBtoInt16Scalar;
+	k->int24MSBtoInt16 = ASIOInt24MSBtoInt16Scalar;
+	k->stereoInt32toInt24LSB = ASIOStereoInt32toInt24LSBScalar;
+	k->stereoInt32toInt24MSB = ASIOStereoInt32toInt24MSBScalar;
+	k->shift32 = ASIOShift32Scalar;
+	k->reverseEndian = ASIOReverseEndianScalar;
+	k->interleave = ASIOInterleaveScalar;
+	k->deinterleave = ASIODeinterleaveScalar;
+	k->intToFloat32 = ASIOIntToFloat32Scalar;
+	k->intToFloat64 = ASIOIntToFloat64Scalar;
+	k->floatToFloat32 = ASIOFloatToFloat32Scalar;
+	k->floatToFloat64 = ASIOFloatToFloat64Scalar;
+	k->float32toInt = ASIOFloat32toIntScalar;
+	k->float64toInt = ASIOFloat64toIntScalar;
+	k->float32toFloat = ASIOFloat32toFloatScalar;
+	k->float64toFloat = ASIOFloat64toFloatScalar;
+	k->requantize = ASIORequantizeScalar;
+	k->mixToInt = ASIOMixToIntScalar;
+	k->mixToFloat = ASIOMixToFloatScalar;
+	ASIOInstallChannels<ChannelsScalar>(k);
+}
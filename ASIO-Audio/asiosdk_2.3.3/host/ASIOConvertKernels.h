@@ -0,0 +1,420 @@
+#ifndef __ASIOConvertKernels__
+#define __ASIOConvertKernels__
+
+// Runtime dispatched sample conversion kernels behind ASIOConvertSamples.
+// The scalar kernels in ASIOConvertKernels.cpp are the reference, every
+// SIMD variant has to produce bit identical output for all inputs.
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define ASIO_CONVERT_X86 1
+#else
+#define ASIO_CONVERT_X86 0
+#endif
+
+// MSVC compiles any intrinsic without flags, GCC and Clang need the
+// instruction set enabled per function
+#if defined(__GNUC__)
+#define ASIO_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ASIO_TARGET(isa)
+#endif
+
+enum ASIOConvertISA
+{
+	kASIOConvertScalar = 0,		// portable reference code
+	kASIOConvertSSE2,
+	kASIOConvertSSE41,			// SSE4.1, implies SSSE3
+	kASIOConvertAVX2,
+	kASIOConvertAVX512,			// AVX-512F, the kernels it doesn't have stay AVX2
+	kASIOConvertAuto			// best instruction set reported by CPUID
+};
+
+// float scalers, the conversions add .49999 to them
+const double fScaler16 = (double)0x7fffL;
+const double fScaler24 = (double)0x7fffffL;
+const double fScaler32 = (double)0x7fffffffL;
+
+// float to integer, dest may be the same buffer as source (in place).
+// Saturating: values beyond full scale give the largest integer, NaN gives 0.
+typedef void (*ASIOFloatToIntKernel)(const float *source, void *dest, long frames);
+
+// integer to integer, dest may be the same buffer as source (in place)
+typedef void (*ASIOIntKernel)(const void *source, void *dest, long frames);
+
+// two channels into one interleaved buffer
+typedef void (*ASIOStereoKernel)(const void *left, const void *right, void *dest, long frames);
+
+// 32 bit to 16, 24 or 32 bit: optional byte swap, left shift and narrowing
+// to the upper bytes in one pass, dest may be the same buffer as source
+typedef void (*ASIOShiftKernel)(const void *source, void *dest, long shiftAmount, long targetByteWidth,
+	bool reverseEndian, long frames);
+
+// byte swap of 2, 3, 4 or 8 byte samples, dest may be the same buffer as source
+typedef void (*ASIOSwapKernel)(const void *source, void *dest, long byteWidth, long frames);
+
+// planar channels to interleaved frames and back, samples are moved unchanged.
+// dest[frame * numChannels + channel] = channels[channel][frame], any byte width.
+typedef void (*ASIOInterleaveKernel)(const void *const *channels, void *dest, long numChannels,
+	long byteWidth, long frames);
+typedef void (*ASIODeinterleaveKernel)(const void *source, void *const *channels, long numChannels,
+	long byteWidth, long frames);
+
+// signed integers of 2, 3 or 4 bytes to float, each sample is multiplied by scale.
+// dest may be the same buffer as source, it has to hold the wider samples then.
+typedef void (*ASIOIntToFloat32Kernel)(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, float scale, long frames);
+typedef void (*ASIOIntToFloat64Kernel)(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames);
+
+// float to signed integers of 2, 3 or 4 bytes, the sample times scale is truncated
+// and saturated to -floor(scale) - 1..floor(scale) like the float32toIntXX kernels.
+// Returns the number of clipped samples, the ones that didn't fit and NaN.
+// dest may be the same buffer as source.
+typedef long (*ASIOFloat32ToIntKernel)(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames);
+
+// float64 to signed integers, the same as ASIOFloat32ToIntKernel with double samples
+typedef long (*ASIOFloat64ToIntKernel)(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames);
+
+// native float or double to float32 or float64 (byteWidth 4 or 8) samples, the output
+// side of ASIOFloatToFloat32Kernel. dest may be the same buffer as source, it has to
+// hold the wider samples then.
+typedef void (*ASIOFloat32ToFloatKernel)(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames);
+typedef void (*ASIOFloat64ToFloatKernel)(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames);
+
+// gain and mix of numSources float channels in the output conversion: the sample of
+// frame i is the float sum of gains[s] * sources[s][i], added in the order of s starting
+// at 0, then converted like ASIOFloat32ToIntKernel and ASIOFloat32ToFloatKernel.
+// No source is read twice and no intermediate buffer is written. dest may not overlap
+// the sources, numSources 0 gives silence. A NaN sum is NaN in every kernel, but its sign
+// and payload depend on which operand the compiler put first.
+typedef long (*ASIOMixToIntKernel)(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long frames);
+typedef void (*ASIOMixToFloatKernel)(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long frames);
+
+// requantizer state of one channel, TPDF dither and error feedback noise shaping
+enum ASIONoiseShaping
+{
+	kASIONoiseShapingOff = 0,
+	kASIONoiseShapingFirstOrder,	// 1 - z^-1
+	kASIONoiseShapingSecondOrder	// (1 - z^-1)^2
+};
+
+typedef struct ASIORequantizer
+{
+	unsigned int rng[8];	// xorshift32 generators, sample n of a stream uses rng[n & 7]
+	long lane;				// generator of the next sample
+	double error[2];		// last two quantization errors in lsb, newest first
+	long shaping;			// ASIONoiseShaping
+	bool dither;
+} ASIORequantizer;
+
+// float to a bits wide integer stored in byteWidth bytes: scaled to 2^(bits - 1) - 1,
+// TPDF dither of +-1 lsb added, noise shaped, rounded and saturated. The SIMD
+// kernels give the same output and state as the scalar one for every input.
+// Returns the number of clipped samples, NaN included. dest may be the same buffer as source.
+typedef long (*ASIORequantizeKernel)(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, long frames);
+
+// output samples of one channel that were saturated, NaN included. The buffer
+// switch is the only writer and only writes when something clipped, the counter
+// has its own cache line so a monitor thread polling it doesn't share a line
+// with the state the callback works on.
+typedef struct alignas(64) ASIOClipCounter
+{
+	std::atomic<unsigned long long> samples;
+} ASIOClipCounter;
+
+// state of the converters of one channel, shared by both buffer halves
+typedef struct ASIOChannelState
+{
+	ASIORequantizer requantizer;	// dither and noise shaping of the requantizing outputs
+	ASIOClipCounter clips;
+} ASIOChannelState;
+
+// one channel of one buffer half, dest may not overlap source
+typedef void (*ASIOChannelConverter)(ASIOChannelState *state, const void *source, void *dest, long frames);
+
+// gain, mix and output conversion of one channel in one pass, dest is the device buffer.
+// The float32 host samples of numSources sources are summed with their gains like
+// ASIOMixToIntKernel, a bus buffer for the sum is never written.
+typedef void (*ASIOChannelMixer)(ASIOChannelState *state, const float *const *sources, const float *gains,
+	long numSources, void *dest, long frames);
+
+// the callback is the only writer, no locked add needed
+static inline void ASIOCountClips(ASIOChannelState *state, long clipped)
+{
+	if(clipped)
+	{
+		std::atomic<unsigned long long>& samples = state->clips.samples;
+		samples.store(samples.load(std::memory_order_relaxed) + (unsigned long long)clipped, std::memory_order_relaxed);
+	}
+}
+
+// float32 or float64 (byteWidth 4 or 8) to float, dest may be the same buffer as source
+typedef void (*ASIOFloatToFloat32Kernel)(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, long frames);
+typedef void (*ASIOFloatToFloat64Kernel)(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, long frames);
+
+// layout of an ASIOSampleType as seen by the kernels
+typedef struct ASIOSampleFormat
+{
+	long byteWidth;			// bytes per sample
+	long bits;				// significant bits, the alignment of the Int32xx16..24 formats
+	bool isFloat;
+	bool reverseEndian;		// byte order differs from the cpu
+} ASIOSampleFormat;
+
+// the sample layouts behind the ASIOSampleTypes, the channel converters are
+// generated per layout and byte order. Int32xx is an xx bit sample right
+// aligned in 4 bytes. The ones the requantizer dithers come first.
+enum ASIOSampleLayout
+{
+	kASIOLayoutInt16 = 0,
+	kASIOLayoutInt24,
+	kASIOLayoutInt32x16,
+	kASIOLayoutInt32x18,
+	kASIOLayoutInt32x20,
+	kASIOLayoutInt32x24,
+	kASIOLayoutInt32,
+	kASIOLayoutFloat32,
+	kASIOLayoutFloat64,
+	kASIONumLayouts,
+	kASIONumDitheredLayouts = kASIOLayoutInt32
+};
+
+static constexpr long ASIOLayoutBytes(long layout)
+{
+	return layout == kASIOLayoutInt16 ? 2 : layout == kASIOLayoutInt24 ? 3 : layout == kASIOLayoutFloat64 ? 8 : 4;
+}
+
+static constexpr long ASIOLayoutBits(long layout)
+{
+	return layout == kASIOLayoutInt16 || layout == kASIOLayoutInt32x16 ? 16
+		: layout == kASIOLayoutInt32x18 ? 18
+		: layout == kASIOLayoutInt32x20 ? 20
+		: layout == kASIOLayoutInt24 || layout == kASIOLayoutInt32x24 ? 24
+		: layout == kASIOLayoutFloat64 ? 64 : 32;
+}
+
+static constexpr bool ASIOLayoutIsFloat(long layout)
+{
+	return layout == kASIOLayoutFloat32 || layout == kASIOLayoutFloat64;
+}
+
+// integer full scale to -1..1, 1 / 2^(bits - 1), exact. Float formats are not scaled.
+static constexpr double ASIOInputScaleOf(long bits)
+{
+	return bits > 0 && bits <= 32 ? 1. / (double)(1LL << (bits - 1)) : 1.;
+}
+
+// -1..1 to the integer full scale of the saturating outputs, the same rounding as fScalerXX + .49999
+static constexpr double ASIOOutputScaleOf(long bits)
+{
+	return bits > 0 && bits <= 32 ? (double)((1LL << (bits - 1)) - 1) + .49999 : 1.;
+}
+
+typedef struct ASIOConvertKernels
+{
+	ASIOConvertISA isa;
+
+	// float to integer
+	ASIOFloatToIntKernel float32toInt16;
+	ASIOFloatToIntKernel float32toInt24;
+	ASIOFloatToIntKernel float32toInt32;
+
+	// packed 24 bit, LSB is lsb first and MSB is msb first in memory.
+	// 32 bit data is native and uses the upper three bytes, 16 bit data is native.
+	// The widening kernels run backwards so they can work in place.
+	ASIOIntKernel int32toInt24LSB;
+	ASIOIntKernel int32toInt24MSB;
+	ASIOIntKernel int24LSBtoInt32;
+	ASIOIntKernel int24MSBtoInt32;
+	ASIOIntKernel int24LSBtoInt16;
+	ASIOIntKernel int24MSBtoInt16;
+	ASIOStereoKernel stereoInt32toInt24LSB;
+	ASIOStereoKernel stereoInt32toInt24MSB;
+
+	// byte swap, shift and narrow
+	ASIOShiftKernel shift32;
+	ASIOSwapKernel reverseEndian;
+
+	// n channel interleave, transposed in cache sized blocks of frames
+	ASIOInterleaveKernel interleave;
+	ASIODeinterleaveKernel deinterleave;
+
+	// input normalization, see ASIOConvertSamples::toFloat32
+	ASIOIntToFloat32Kernel intToFloat32;
+	ASIOIntToFloat64Kernel intToFloat64;
+	ASIOFloatToFloat32Kernel floatToFloat32;
+	ASIOFloatToFloat64Kernel floatToFloat64;
+
+	// output conversion of the converter matrix, see ASIOConvertMatrix.h
+	ASIOFloat32ToIntKernel float32toInt;
+	ASIOFloat64ToIntKernel float64toInt;
+	ASIOFloat32ToFloatKernel float32toFloat;
+	ASIOFloat64ToFloatKernel float64toFloat;
+	ASIORequantizeKernel requantize;
+
+	// fused output stage, see ASIOConvertMatrix.h
+	ASIOMixToIntKernel mixToInt;
+	ASIOMixToFloatKernel mixToFloat;
+	// the converters of ASIOConvertMatrix.h per [layout][reverseEndian], the width,
+	// byte order and scale are template arguments of each one. The requantizing
+	// outputs only exist for the dithered layouts.
+	ASIOChannelConverter channelToFloat32[kASIONumLayouts][2];
+	ASIOChannelConverter channelToFloat64[kASIONumLayouts][2];
+	ASIOChannelConverter channelFromFloat32[kASIONumLayouts][2];
+	ASIOChannelConverter channelFromFloat64[kASIONumLayouts][2];
+	ASIOChannelConverter channelRequantize[kASIONumDitheredLayouts][2];
+	ASIOChannelMixer channelMix[kASIONumLayouts][2];
+} ASIOConvertKernels;
+
+// highest instruction set supported by the cpu and the os
+ASIOConvertISA ASIOGetSupportedConvertISA();
+
+// select the kernels once at startup, before any audio is running.
+// Requests above the supported level are lowered, the selected level is returned.
+ASIOConvertISA ASIOSelectConvertKernels(ASIOConvertISA isa);
+const ASIOConvertKernels *ASIOGetConvertKernels();
+const char *ASIOGetConvertISAName(ASIOConvertISA isa);
+
+//-------------------------------------------------------------------------------------------
+// channel converters of an instruction set. Channels has the static member templates
+// toFloat32, toFloat64, fromFloat32, fromFloat64, requantize and mix<layout, reverseEndian>,
+// ASIOInstallChannels<Channels>() fills the channel tables with every instance.
+
+template <typename Channels, long layout>
+static inline void ASIOInstallRequantizer(ASIOConvertKernels *k, std::true_type)
+{
+	k->channelRequantize[layout][0] = Channels::template requantize<layout, false>;
+	k->channelRequantize[layout][1] = Channels::template requantize<layout, true>;
+}
+
+template <typename Channels, long layout>
+static inline void ASIOInstallRequantizer(ASIOConvertKernels *, std::false_type)
+{
+}
+
+template <typename Channels, long layout>
+static inline void ASIOInstallLayout(ASIOConvertKernels *k)
+{
+	k->channelToFloat32[layout][0] = Channels::template toFloat32<layout, false>;
+	k->channelToFloat32[layout][1] = Channels::template toFloat32<layout, true>;
+	k->channelToFloat64[layout][0] = Channels::template toFloat64<layout, false>;
+	k->channelToFloat64[layout][1] = Channels::template toFloat64<layout, true>;
+	k->channelFromFloat32[layout][0] = Channels::template fromFloat32<layout, false>;
+	k->channelFromFloat32[layout][1] = Channels::template fromFloat32<layout, true>;
+	k->channelFromFloat64[layout][0] = Channels::template fromFloat64<layout, false>;
+	k->channelFromFloat64[layout][1] = Channels::template fromFloat64<layout, true>;
+	k->channelMix[layout][0] = Channels::template mix<layout, false>;
+	k->channelMix[layout][1] = Channels::template mix<layout, true>;
+	ASIOInstallRequantizer<Channels, layout>(k, std::integral_constant<bool, (layout < kASIONumDitheredLayouts)>());
+}
+
+template <typename Channels, std::size_t... layouts>
+static inline void ASIOInstallChannels(ASIOConvertKernels *k, std::index_sequence<layouts...>)
+{
+	int expand[] = { (ASIOInstallLayout<Channels, (long)layouts>(k), 0)... };
+	(void)expand;
+}
+
+template <typename Channels>
+static inline void ASIOInstallChannels(ASIOConvertKernels *k)
+{
+	ASIOInstallChannels<Channels>(k, std::make_index_sequence<kASIONumLayouts>());
+}
+
+//-------------------------------------------------------------------------------------------
+// scalar reference kernels, also used for the tails of the SIMD kernels
+
+void ASIOFloat32toInt16Scalar(const float *source, void *dest, long frames);
+void ASIOFloat32toInt24Scalar(const float *source, void *dest, long frames);
+void ASIOFloat32toInt32Scalar(const float *source, void *dest, long frames);
+
+void ASIOInt32toInt24LSBScalar(const void *source, void *dest, long frames);
+void ASIOInt32toInt24MSBScalar(const void *source, void *dest, long frames);
+void ASIOInt24LSBtoInt32Scalar(const void *source, void *dest, long frames);
+void ASIOInt24MSBtoInt32Scalar(const void *source, void *dest, long frames);
+void ASIOInt24LSBtoInt16Scalar(const void *source, void *dest, long frames);
+void ASIOInt24MSBtoInt16Scalar(const void *source, void *dest, long frames);
+void ASIOStereoInt32toInt24LSBScalar(const void *left, const void *right, void *dest, long frames);
+void ASIOStereoInt32toInt24MSBScalar(const void *left, const void *right, void *dest, long frames);
+
+void ASIOShift32Scalar(const void *source, void *dest, long shiftAmount, long targetByteWidth,
+	bool reverseEndian, long frames);
+void ASIOReverseEndianScalar(const void *source, void *dest, long byteWidth, long frames);
+
+void ASIOInterleaveScalar(const void *const *channels, void *dest, long numChannels,
+	long byteWidth, long frames);
+void ASIODeinterleaveScalar(const void *source, void *const *channels, long numChannels,
+	long byteWidth, long frames);
+
+// part of an interleave, channels [firstChannel, endChannel) and frames
+// [firstFrame, endFrame), for the edges the SIMD tiles don't cover
+void ASIOInterleaveRectScalar(const void *const *channels, void *dest, long numChannels, long byteWidth,
+	long firstChannel, long endChannel, long firstFrame, long endFrame);
+void ASIODeinterleaveRectScalar(const void *source, void *const *channels, long numChannels, long byteWidth,
+	long firstChannel, long endChannel, long firstFrame, long endFrame);
+
+// frames per cache block of an interleave, a multiple of 16 so that every tile fits
+long ASIOInterleaveBlockFrames(long numChannels, long byteWidth);
+
+// the widening kernels run backwards so they can work in place
+void ASIOIntToFloat32Scalar(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, float scale, long frames);
+void ASIOIntToFloat64Scalar(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames);
+void ASIOFloatToFloat32Scalar(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, long frames);
+void ASIOFloatToFloat64Scalar(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, long frames);
+long ASIOFloat32toIntScalar(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames);
+long ASIOFloat64toIntScalar(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames);
+void ASIOFloat32toFloatScalar(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames);
+void ASIOFloat64toFloatScalar(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames);
+
+// the seed is spread over the eight generators, 0 is replaced by a fixed seed
+void ASIOInitRequantizer(ASIORequantizer *requantizer, unsigned int seed, bool dither, long shaping);
+long ASIORequantizeScalar(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, long frames);
+
+// the sample loop of the requantizer with the dither already drawn, in 1/65536 lsb.
+// The SIMD kernels use it for noise shaping, the error feedback can't be vectorized.
+long ASIORequantizeBlock(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, const int *dither, long frames);
+
+long ASIOMixToIntScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long frames);
+void ASIOMixToFloatScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long frames);
+
+// frames [firstFrame, endFrame) of a mix, dest is the start of the whole buffer.
+// For the frames the SIMD loops don't cover.
+long ASIOMixToIntRangeScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long firstFrame, long endFrame);
+void ASIOMixToFloatRangeScalar(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long firstFrame, long endFrame);
+
+// each installer only replaces the kernels it implements
+void ASIOInstallScalarKernels(ASIOConvertKernels *kernels);
+#if ASIO_CONVERT_X86
+void ASIOInstallSSE2Kernels(ASIOConvertKernels *kernels);
+void ASIOInstallSSE41Kernels(ASIOConvertKernels *kernels);
+void ASIOInstallAVX2Kernels(ASIOConvertKernels *kernels);
+#endif
+
+#endif
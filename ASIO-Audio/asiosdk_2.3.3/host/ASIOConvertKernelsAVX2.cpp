@@ -0,0 +1,1432 @@
+#include "ginclude.h"
+#include "ASIOConvertSIMD.h"
+
+#if ASIO_CONVERT_X86
+
+// AVX2 kernels, 16 or 32 frames per iteration
+
+//-------------------------------------------------------------------------------------------
+// float to int
+
+// the constants of SaturationSSE2 four wide
+typedef struct SaturationAVX2
+{
+	__m256d scale;
+	__m256d lo;
+	__m256d hi;
+	__m256d below;
+	__m256d above;
+} SaturationAVX2;
+
+static inline ASIO_AVX2 SaturationAVX2 saturationAVX2(double scale)
+{
+	double hi = floor(scale);
+	SaturationAVX2 s = { _mm256_set1_pd(scale), _mm256_set1_pd(-hi - 1.), _mm256_set1_pd(hi),
+		_mm256_set1_pd(-hi - 2.), _mm256_set1_pd(hi + 1.) };
+	return s;
+}
+
+static inline ASIO_AVX2 __m256d saturate4(__m256d &d, const SaturationAVX2 &s)
+{
+	__m256d clipped = _mm256_or_pd(_mm256_cmp_pd(d, s.below, _CMP_NGT_UQ), _mm256_cmp_pd(d, s.above, _CMP_NLT_UQ));
+	d = _mm256_min_pd(_mm256_max_pd(_mm256_and_pd(d, _mm256_cmp_pd(d, d, _CMP_ORD_Q)), s.lo), s.hi);
+	return clipped;
+}
+
+// 8 doubles to 8 saturated int32, same rounding as the scalar reference.
+// Each clipped sample subtracts 1 from a lane of clips.
+static inline ASIO_AVX2 __m256i doubleToInt8(__m256d lo, __m256d hi, const SaturationAVX2 &s, __m256i &clips)
+{
+	lo = _mm256_mul_pd(lo, s.scale);
+	hi = _mm256_mul_pd(hi, s.scale);
+	__m256d clo = saturate4(lo, s);
+	__m256d chi = saturate4(hi, s);
+	clips = _mm256_add_epi32(clips, _mm256_castps_si256(
+		_mm256_shuffle_ps(_mm256_castpd_ps(clo), _mm256_castpd_ps(chi), _MM_SHUFFLE(2, 0, 2, 0))));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(lo)), _mm256_cvttpd_epi32(hi), 1);
+}
+
+static inline ASIO_AVX2 __m256i floatToInt8(const float *source, const SaturationAVX2 &s, __m256i &clips)
+{
+	__m256 x = _mm256_loadu_ps(source);
+	return doubleToInt8(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), s, clips);
+}
+
+static inline ASIO_AVX2 __m256i floatToInt8(const float *source, const SaturationAVX2 &s)
+{
+	__m256i clips = _mm256_setzero_si256();
+	return floatToInt8(source, s, clips);
+}
+
+static inline ASIO_AVX2 long clipCount(__m256i clips)
+{
+	return clipCount(_mm_add_epi32(_mm256_castsi256_si128(clips), _mm256_extracti128_si256(clips, 1)));
+}
+
+static ASIO_AVX2 void float32toInt16AVX2(const float *source, void *dest, long frames)
+{
+	const SaturationAVX2 sc = saturationAVX2(fScaler16 + .49999);
+	short* b = (short*)dest;
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m256i lo = floatToInt8(source + i, sc);
+		__m256i hi = floatToInt8(source + i + 8, sc);
+		lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+		hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+		// packs works per 128 bit lane, put the quarters back in order
+		__m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+		_mm256_storeu_si256((__m256i*)(b + i), p);
+	}
+	ASIOFloat32toInt16Scalar(source + n, b + n, frames - n);
+}
+
+static ASIO_AVX2 void float32toInt24AVX2(const float *source, void *dest, long frames)
+{
+	const SaturationAVX2 sc = saturationAVX2(fScaler24 + .49999);
+	const __m256i mask = _mm256_broadcastsi128_si256(pack24MSBMask());
+	char* b = (char*)dest;
+	long n = frames & ~31L;
+	for(long i = 0; i < n; i += 32)
+	{
+		__m256i v0 = floatToInt8(source + i, sc);
+		__m256i v1 = floatToInt8(source + i + 8, sc);
+		__m256i v2 = floatToInt8(source + i + 16, sc);
+		__m256i v3 = floatToInt8(source + i + 24, sc);
+		pack24x32(b + i * 3, mask, v0, v1, v2, v3);
+	}
+	ASIOFloat32toInt24Scalar(source + n, b + n * 3, frames - n);
+}
+
+static ASIO_AVX2 void float32toInt32AVX2(const float *source, void *dest, long frames)
+{
+	const SaturationAVX2 sc = saturationAVX2(fScaler32 + .49999);
+	int* b = (int*)dest;
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m256i lo = floatToInt8(source + i, sc);
+		__m256i hi = floatToInt8(source + i + 8, sc);
+		_mm256_storeu_si256((__m256i*)(b + i), lo);
+		_mm256_storeu_si256((__m256i*)(b + i + 8), hi);
+	}
+	ASIOFloat32toInt32Scalar(source + n, b + n, frames - n);
+}
+
+//-------------------------------------------------------------------------------------------
+// packed 24 bit, 32 frames per iteration
+
+static inline ASIO_AVX2 void int32toInt24(const void *source, void *dest, long frames, __m128i mask, ASIOIntKernel tail)
+{
+	const __m256i m = _mm256_broadcastsi128_si256(mask);
+	const int* in = (const int*)source;
+	char* out = (char*)dest;
+	long n = frames & ~31L;
+	for(long i = 0; i < n; i += 32)
+	{
+		__m256i v0 = _mm256_loadu_si256((const __m256i*)(in + i));
+		__m256i v1 = _mm256_loadu_si256((const __m256i*)(in + i + 8));
+		__m256i v2 = _mm256_loadu_si256((const __m256i*)(in + i + 16));
+		__m256i v3 = _mm256_loadu_si256((const __m256i*)(in + i + 24));
+		pack24x32(out + i * 3, m, v0, v1, v2, v3);
+	}
+	tail(in + n, out + n * 3, frames - n);
+}
+
+static inline ASIO_AVX2 void int24toInt32(const void *source, void *dest, long frames, __m128i mask, ASIOIntKernel tail)
+{
+	const __m256i m = _mm256_broadcastsi128_si256(mask);
+	const char* in = (const char*)source;
+	int* out = (int*)dest;
+	long n = frames & ~31L;
+
+	// backwards, starting with the tail, so the conversion can be done in place
+	tail(in + n * 3, out + n, frames - n);
+	for(long i = n - 32; i >= 0; i -= 32)
+	{
+		__m256i g[4];
+		load24x32(in + i * 3, g);
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_shuffle_epi8(g[0], m));
+		_mm256_storeu_si256((__m256i*)(out + i + 8), _mm256_shuffle_epi8(g[1], m));
+		_mm256_storeu_si256((__m256i*)(out + i + 16), _mm256_shuffle_epi8(g[2], m));
+		_mm256_storeu_si256((__m256i*)(out + i + 24), _mm256_shuffle_epi8(g[3], m));
+	}
+}
+
+static inline ASIO_AVX2 void int24toInt16(const void *source, void *dest, long frames, __m128i mask, ASIOIntKernel tail)
+{
+	const __m256i m = _mm256_broadcastsi128_si256(mask);
+	const char* in = (const char*)source;
+	short* out = (short*)dest;
+	long n = frames & ~31L;
+	for(long i = 0; i < n; i += 32)
+	{
+		__m256i g[4];
+		load24x32(in + i * 3, g);
+		// 4 shorts at the bottom of each lane, unpack and restore the lane order
+		__m256i lo = _mm256_unpacklo_epi64(_mm256_shuffle_epi8(g[0], m), _mm256_shuffle_epi8(g[1], m));
+		__m256i hi = _mm256_unpacklo_epi64(_mm256_shuffle_epi8(g[2], m), _mm256_shuffle_epi8(g[3], m));
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_permute4x64_epi64(lo, 0xd8));
+		_mm256_storeu_si256((__m256i*)(out + i + 16), _mm256_permute4x64_epi64(hi, 0xd8));
+	}
+	tail(in + n * 3, out + n, frames - n);
+}
+
+static inline ASIO_AVX2 void stereoInt32toInt24(const void *left, const void *right, void *dest, long frames,
+	__m128i mask, ASIOStereoKernel tail)
+{
+	const __m256i m = _mm256_broadcastsi128_si256(mask);
+	const int* l = (const int*)left;
+	const int* r = (const int*)right;
+	char* out = (char*)dest;
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m256i v[4];
+		for(int j = 0; j < 2; j++)
+		{
+			__m256i lv = _mm256_loadu_si256((const __m256i*)(l + i + j * 8));
+			__m256i rv = _mm256_loadu_si256((const __m256i*)(r + i + j * 8));
+			__m256i lo = _mm256_unpacklo_epi32(lv, rv);
+			__m256i hi = _mm256_unpackhi_epi32(lv, rv);
+			v[j * 2] = _mm256_permute2x128_si256(lo, hi, 0x20);
+			v[j * 2 + 1] = _mm256_permute2x128_si256(lo, hi, 0x31);
+		}
+		pack24x32(out + i * 6, m, v[0], v[1], v[2], v[3]);
+	}
+	tail(l + n, r + n, out + n * 6, frames - n);
+}
+
+static ASIO_AVX2 void int32toInt24LSBAVX2(const void *source, void *dest, long frames)
+{
+	int32toInt24(source, dest, frames, pack24LSBMask(), ASIOInt32toInt24LSBScalar);
+}
+
+static ASIO_AVX2 void int32toInt24MSBAVX2(const void *source, void *dest, long frames)
+{
+	int32toInt24(source, dest, frames, pack24MSBMask(), ASIOInt32toInt24MSBScalar);
+}
+
+static ASIO_AVX2 void int24LSBtoInt32AVX2(const void *source, void *dest, long frames)
+{
+	int24toInt32(source, dest, frames, unpack24LSBMask(), ASIOInt24LSBtoInt32Scalar);
+}
+
+static ASIO_AVX2 void int24MSBtoInt32AVX2(const void *source, void *dest, long frames)
+{
+	int24toInt32(source, dest, frames, unpack24MSBMask(), ASIOInt24MSBtoInt32Scalar);
+}
+
+static ASIO_AVX2 void int24LSBtoInt16AVX2(const void *source, void *dest, long frames)
+{
+	int24toInt16(source, dest, frames, int24LSBto16Mask(), ASIOInt24LSBtoInt16Scalar);
+}
+
+static ASIO_AVX2 void int24MSBtoInt16AVX2(const void *source, void *dest, long frames)
+{
+	int24toInt16(source, dest, frames, int24MSBto16Mask(), ASIOInt24MSBtoInt16Scalar);
+}
+
+static ASIO_AVX2 void stereoInt32toInt24LSBAVX2(const void *left, const void *right, void *dest, long frames)
+{
+	stereoInt32toInt24(left, right, dest, frames, pack24LSBMask(), ASIOStereoInt32toInt24LSBScalar);
+}
+
+static ASIO_AVX2 void stereoInt32toInt24MSBAVX2(const void *left, const void *right, void *dest, long frames)
+{
+	stereoInt32toInt24(left, right, dest, frames, pack24MSBMask(), ASIOStereoInt32toInt24MSBScalar);
+}
+
+//-------------------------------------------------------------------------------------------
+// byte swap, shift and narrow in one pass, 32 frames per iteration
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void shift32Loop(const char *in, char *out, __m128i count, long frames)
+{
+	const __m256i swapMask = _mm256_broadcastsi128_si256(swap32Mask());
+	for(long i = 0; i < frames; i += 32)
+	{
+		__m256i v[4];
+		for(int j = 0; j < 4; j++)
+		{
+			v[j] = _mm256_loadu_si256((const __m256i*)(in + i * 4 + j * 32));
+			if(swap)
+				v[j] = _mm256_shuffle_epi8(v[j], swapMask);
+			v[j] = _mm256_sll_epi32(v[j], count);
+		}
+		if(width == 2)
+		{
+			// 4 shorts per lane, gathered into the low lane and joined
+			const __m256i mask = _mm256_broadcastsi128_si256(upper16Mask());
+			for(int j = 0; j < 4; j++)
+				v[j] = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v[j], mask), 0x08);
+			_mm256_storeu_si256((__m256i*)(out + i * 2), _mm256_permute2x128_si256(v[0], v[1], 0x20));
+			_mm256_storeu_si256((__m256i*)(out + i * 2 + 32), _mm256_permute2x128_si256(v[2], v[3], 0x20));
+		}
+		else if(width == 3)
+			pack24x32(out + i * 3, _mm256_broadcastsi128_si256(pack24LSBMask()), v[0], v[1], v[2], v[3]);
+		else
+		{
+			for(int j = 0; j < 4; j++)
+				_mm256_storeu_si256((__m256i*)(out + i * 4 + j * 32), v[j]);
+		}
+	}
+}
+
+static ASIO_AVX2 void reverseEndianAVX2(const void *source, void *dest, long byteWidth, long frames);
+
+static ASIO_AVX2 void shift32AVX2(const void *source, void *dest, long shiftAmount, long targetByteWidth,
+	bool revertEndian, long frames)
+{
+	const char* in = (const char*)source;
+	char* out = (char*)dest;
+	if(targetByteWidth < 2 || targetByteWidth > 4)
+	{
+		if(revertEndian)
+			reverseEndianAVX2(source, dest, 4, frames);
+		return;
+	}
+
+	// vpslld clears the word for counts above 31, negative ones included
+	__m128i count = _mm_cvtsi32_si128((int)shiftAmount);
+	long n = frames & ~31L;
+	switch(targetByteWidth * 2 + (revertEndian ? 1 : 0))
+	{
+	case 4: shift32Loop<2, false>(in, out, count, n); break;
+	case 5: shift32Loop<2, true>(in, out, count, n); break;
+	case 6: shift32Loop<3, false>(in, out, count, n); break;
+	case 7: shift32Loop<3, true>(in, out, count, n); break;
+	case 8: shift32Loop<4, false>(in, out, count, n); break;
+	case 9: shift32Loop<4, true>(in, out, count, n); break;
+	}
+	ASIOShift32Scalar(in + n * 4, out + n * targetByteWidth, shiftAmount, targetByteWidth,
+		revertEndian, frames - n);
+}
+
+static ASIO_AVX2 void reverseEndianAVX2(const void *source, void *dest, long byteWidth, long frames)
+{
+	const char* in = (const char*)source;
+	char* out = (char*)dest;
+	long n = frames & ~31L;
+	if(byteWidth == 2 || byteWidth == 4 || byteWidth == 8)
+	{
+		const __m256i mask = _mm256_broadcastsi128_si256(
+			byteWidth == 2 ? swap16Mask() : byteWidth == 4 ? swap32Mask() : swap64Mask());
+		for(long i = 0; i < n * byteWidth; i += 32)
+			_mm256_storeu_si256((__m256i*)(out + i), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(in + i)), mask));
+	}
+	else if(byteWidth == 3)
+	{
+		const __m256i mask = _mm256_broadcastsi128_si256(swap24Mask());
+		for(long i = 0; i < n * 3; i += 96)
+		{
+			__m256i g[4];
+			load24x32(in + i, g);
+			pack24x32(out + i, mask, g[0], g[1], g[2], g[3]);
+		}
+	}
+	else
+		return;
+	ASIOReverseEndianScalar(in + n * byteWidth, out + n * byteWidth, byteWidth, frames - n);
+}
+
+//-------------------------------------------------------------------------------------------
+// n channel interleave, tiles of 8x8 32 bit or 4x4 64 bit samples. 8 and 16 bit
+// keep the SSE2 tiles, a 256 bit tile would need twice the registers.
+
+template <long width>
+static inline ASIO_AVX2 void interleaveTiles(const void *const *channels, void *dest, long numChannels, long frames)
+{
+	const long size = 32 / width;
+	const long stride = numChannels * width;
+	long tiled = numChannels - numChannels % size;
+	long n = frames & ~(size - 1);
+	long block = ASIOInterleaveBlockFrames(numChannels, width);
+	char* out = (char*)dest;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += size)
+		{
+			for(long f = b; f < e; f += size)
+			{
+				__m256i r[size];
+				loadChannels(r, channels + c, f * width, std::make_index_sequence<size>());
+				if(width == 4)
+					transpose8x32(r);
+				else
+					transpose4x64(r);
+				storeRows(out + f * stride + c * width, stride, r, std::make_index_sequence<size>());
+			}
+		}
+	}
+	ASIOInterleaveRectScalar(channels, dest, numChannels, width, tiled, numChannels, 0, n);
+	ASIOInterleaveRectScalar(channels, dest, numChannels, width, 0, numChannels, n, frames);
+}
+
+template <long width>
+static inline ASIO_AVX2 void deinterleaveTiles(const void *source, void *const *channels, long numChannels, long frames)
+{
+	const long size = 32 / width;
+	const long stride = numChannels * width;
+	long tiled = numChannels - numChannels % size;
+	long n = frames & ~(size - 1);
+	long block = ASIOInterleaveBlockFrames(numChannels, width);
+	const char* in = (const char*)source;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += size)
+		{
+			for(long f = b; f < e; f += size)
+			{
+				__m256i r[size];
+				loadRows(r, in + f * stride + c * width, stride, std::make_index_sequence<size>());
+				if(width == 4)
+					transpose8x32(r);
+				else
+					transpose4x64(r);
+				storeChannels(channels + c, f * width, r, std::make_index_sequence<size>());
+			}
+		}
+	}
+	ASIODeinterleaveRectScalar(source, channels, numChannels, width, tiled, numChannels, 0, n);
+	ASIODeinterleaveRectScalar(source, channels, numChannels, width, 0, numChannels, n, frames);
+}
+
+// 24 bit in tiles of 8x8, each row is 24 bytes with 12 in each lane. Like the
+// SSSE3 tiles the loads read 4 bytes past a row, the tiled frames stop 2 short
+// of the end and only the 24 bytes are stored. 4 channels left over take an
+// SSSE3 column.
+static inline ASIO_AVX2 __m256i load24x8(const char *source)
+{
+	__m128i lo = _mm_loadu_si128((const __m128i*)source);
+	__m128i hi = _mm_loadu_si128((const __m128i*)(source + 12));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+static inline ASIO_AVX2 void store24x8(char *dest, __m256i v)
+{
+	v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+	_mm_storeu_si128((__m128i*)dest, _mm256_castsi256_si128(v));
+	_mm_storel_epi64((__m128i*)(dest + 16), _mm256_extracti128_si256(v, 1));
+}
+
+static inline ASIO_AVX2 void transpose8x24(__m256i r[8])
+{
+	const __m256i unpack = _mm256_broadcastsi128_si256(unpack24LSBMask());
+	const __m256i pack = _mm256_broadcastsi128_si256(pack24LSBMask());
+	r[0] = _mm256_shuffle_epi8(r[0], unpack);
+	r[1] = _mm256_shuffle_epi8(r[1], unpack);
+	r[2] = _mm256_shuffle_epi8(r[2], unpack);
+	r[3] = _mm256_shuffle_epi8(r[3], unpack);
+	r[4] = _mm256_shuffle_epi8(r[4], unpack);
+	r[5] = _mm256_shuffle_epi8(r[5], unpack);
+	r[6] = _mm256_shuffle_epi8(r[6], unpack);
+	r[7] = _mm256_shuffle_epi8(r[7], unpack);
+	transpose8x32(r);
+	r[0] = _mm256_shuffle_epi8(r[0], pack);
+	r[1] = _mm256_shuffle_epi8(r[1], pack);
+	r[2] = _mm256_shuffle_epi8(r[2], pack);
+	r[3] = _mm256_shuffle_epi8(r[3], pack);
+	r[4] = _mm256_shuffle_epi8(r[4], pack);
+	r[5] = _mm256_shuffle_epi8(r[5], pack);
+	r[6] = _mm256_shuffle_epi8(r[6], pack);
+	r[7] = _mm256_shuffle_epi8(r[7], pack);
+}
+
+static ASIO_AVX2 void interleave24AVX2(const void *const *channels, void *dest, long numChannels, long frames)
+{
+	const long stride = numChannels * 3;
+	long tiled = numChannels & ~7L;
+	long column = numChannels & 4;
+	long n = frames > 2 ? (frames - 2) & ~7L : 0;
+	long block = ASIOInterleaveBlockFrames(numChannels, 3);
+	char* out = (char*)dest;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += 8)
+		{
+			const char* in[8];
+			for(long i = 0; i < 8; i++)
+				in[i] = (const char*)channels[c + i];
+			for(long f = b; f < e; f += 8)
+			{
+				__m256i r[8] = { load24x8(in[0] + f * 3), load24x8(in[1] + f * 3),
+					load24x8(in[2] + f * 3), load24x8(in[3] + f * 3),
+					load24x8(in[4] + f * 3), load24x8(in[5] + f * 3),
+					load24x8(in[6] + f * 3), load24x8(in[7] + f * 3) };
+				transpose8x24(r);
+				char* row = out + f * stride + c * 3;
+				store24x8(row, r[0]);
+				store24x8(row + stride, r[1]);
+				store24x8(row + stride * 2, r[2]);
+				store24x8(row + stride * 3, r[3]);
+				store24x8(row + stride * 4, r[4]);
+				store24x8(row + stride * 5, r[5]);
+				store24x8(row + stride * 6, r[6]);
+				store24x8(row + stride * 7, r[7]);
+			}
+		}
+		if(column)
+			interleaveColumn24(channels + tiled, out + tiled * 3, stride, b, e);
+	}
+	ASIOInterleaveRectScalar(channels, dest, numChannels, 3, tiled + column, numChannels, 0, n);
+	ASIOInterleaveRectScalar(channels, dest, numChannels, 3, 0, numChannels, n, frames);
+}
+
+static ASIO_AVX2 void deinterleave24AVX2(const void *source, void *const *channels, long numChannels, long frames)
+{
+	const long stride = numChannels * 3;
+	long tiled = numChannels & ~7L;
+	long column = numChannels & 4;
+	long n = frames > 2 ? (frames - 2) & ~7L : 0;
+	long block = ASIOInterleaveBlockFrames(numChannels, 3);
+	const char* in = (const char*)source;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += 8)
+		{
+			char* out[8];
+			for(long i = 0; i < 8; i++)
+				out[i] = (char*)channels[c + i];
+			for(long f = b; f < e; f += 8)
+			{
+				const char* row = in + f * stride + c * 3;
+				__m256i r[8] = { load24x8(row), load24x8(row + stride),
+					load24x8(row + stride * 2), load24x8(row + stride * 3),
+					load24x8(row + stride * 4), load24x8(row + stride * 5),
+					load24x8(row + stride * 6), load24x8(row + stride * 7) };
+				transpose8x24(r);
+				store24x8(out[0] + f * 3, r[0]);
+				store24x8(out[1] + f * 3, r[1]);
+				store24x8(out[2] + f * 3, r[2]);
+				store24x8(out[3] + f * 3, r[3]);
+				store24x8(out[4] + f * 3, r[4]);
+				store24x8(out[5] + f * 3, r[5]);
+				store24x8(out[6] + f * 3, r[6]);
+				store24x8(out[7] + f * 3, r[7]);
+			}
+		}
+		if(column)
+			deinterleaveColumn24(in + tiled * 3, channels + tiled, stride, b, e);
+	}
+	ASIODeinterleaveRectScalar(source, channels, numChannels, 3, tiled + column, numChannels, 0, n);
+	ASIODeinterleaveRectScalar(source, channels, numChannels, 3, 0, numChannels, n, frames);
+}
+
+// stereo, unpacked within the lanes and put in order with a lane permute
+template <long width>
+static inline ASIO_AVX2 __m256i unpackLo256(__m256i a, __m256i b)
+{
+	if(width == 1)
+		return _mm256_unpacklo_epi8(a, b);
+	if(width == 2)
+		return _mm256_unpacklo_epi16(a, b);
+	if(width == 4)
+		return _mm256_unpacklo_epi32(a, b);
+	return _mm256_unpacklo_epi64(a, b);
+}
+
+template <long width>
+static inline ASIO_AVX2 __m256i unpackHi256(__m256i a, __m256i b)
+{
+	if(width == 1)
+		return _mm256_unpackhi_epi8(a, b);
+	if(width == 2)
+		return _mm256_unpackhi_epi16(a, b);
+	if(width == 4)
+		return _mm256_unpackhi_epi32(a, b);
+	return _mm256_unpackhi_epi64(a, b);
+}
+
+// like splitStereo(), the lanes come out as a0 b0 a1 b1 and are reordered
+template <long width>
+static inline ASIO_AVX2 void splitStereo256(__m256i a, __m256i b, __m256i &left, __m256i &right)
+{
+	if(width == 1)
+	{
+		const __m256i low = _mm256_set1_epi16(0xff);
+		left = _mm256_packus_epi16(_mm256_and_si256(a, low), _mm256_and_si256(b, low));
+		right = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+	}
+	else if(width == 2)
+	{
+		left = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16),
+			_mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16));
+		right = _mm256_packs_epi32(_mm256_srai_epi32(a, 16), _mm256_srai_epi32(b, 16));
+	}
+	else if(width == 4)
+	{
+		__m256 x = _mm256_castsi256_ps(a);
+		__m256 y = _mm256_castsi256_ps(b);
+		left = _mm256_castps_si256(_mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)));
+		right = _mm256_castps_si256(_mm256_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	else
+	{
+		left = _mm256_unpacklo_epi64(a, b);
+		right = _mm256_unpackhi_epi64(a, b);
+	}
+	left = _mm256_permute4x64_epi64(left, _MM_SHUFFLE(3, 1, 2, 0));
+	right = _mm256_permute4x64_epi64(right, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <long width>
+static inline ASIO_AVX2 void interleaveStereo(const void *const *channels, void *dest, long frames)
+{
+	const long size = 32 / width;
+	const char* left = (const char*)channels[0];
+	const char* right = (const char*)channels[1];
+	char* out = (char*)dest;
+	long n = frames & ~(size - 1);
+	for(long f = 0; f < n; f += size)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(left + f * width));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(right + f * width));
+		__m256i lo = unpackLo256<width>(a, b);
+		__m256i hi = unpackHi256<width>(a, b);
+		_mm256_storeu_si256((__m256i*)(out + f * width * 2), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(out + f * width * 2 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	ASIOInterleaveRectScalar(channels, dest, 2, width, 0, 2, n, frames);
+}
+
+template <long width>
+static inline ASIO_AVX2 void deinterleaveStereo(const void *source, void *const *channels, long frames)
+{
+	const long size = 32 / width;
+	const char* in = (const char*)source;
+	char* left = (char*)channels[0];
+	char* right = (char*)channels[1];
+	long n = frames & ~(size - 1);
+	for(long f = 0; f < n; f += size)
+	{
+		__m256i l, r;
+		splitStereo256<width>(_mm256_loadu_si256((const __m256i*)(in + f * width * 2)),
+			_mm256_loadu_si256((const __m256i*)(in + f * width * 2 + 32)), l, r);
+		_mm256_storeu_si256((__m256i*)(left + f * width), l);
+		_mm256_storeu_si256((__m256i*)(right + f * width), r);
+	}
+	ASIODeinterleaveRectScalar(source, channels, 2, width, 0, 2, n, frames);
+}
+
+// 24 bit stereo, 32 frames spread to int32 lanes, unpacked and packed again
+static inline ASIO_AVX2 void zipStereo24(__m256i l, __m256i r, __m256i unpack, __m256i &v0, __m256i &v1)
+{
+	__m256i a = _mm256_shuffle_epi8(l, unpack);
+	__m256i b = _mm256_shuffle_epi8(r, unpack);
+	__m256i lo = _mm256_unpacklo_epi32(a, b);
+	__m256i hi = _mm256_unpackhi_epi32(a, b);
+	v0 = _mm256_permute2x128_si256(lo, hi, 0x20);
+	v1 = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+static ASIO_AVX2 void interleaveStereo24(const void *const *channels, void *dest, long frames)
+{
+	const __m256i unpack = _mm256_broadcastsi128_si256(unpack24LSBMask());
+	const __m256i pack = _mm256_broadcastsi128_si256(pack24LSBMask());
+	const char* left = (const char*)channels[0];
+	const char* right = (const char*)channels[1];
+	char* out = (char*)dest;
+	long n = frames & ~31L;
+	for(long f = 0; f < n; f += 32)
+	{
+		__m256i l[4], r[4], v[8];
+		load24x32(left + f * 3, l);
+		load24x32(right + f * 3, r);
+		zipStereo24(l[0], r[0], unpack, v[0], v[1]);
+		zipStereo24(l[1], r[1], unpack, v[2], v[3]);
+		zipStereo24(l[2], r[2], unpack, v[4], v[5]);
+		zipStereo24(l[3], r[3], unpack, v[6], v[7]);
+		pack24x32(out + f * 6, pack, v[0], v[1], v[2], v[3]);
+		pack24x32(out + f * 6 + 96, pack, v[4], v[5], v[6], v[7]);
+	}
+	ASIOInterleaveRectScalar(channels, dest, 2, 3, 0, 2, n, frames);
+}
+
+static ASIO_AVX2 void deinterleaveStereo24(const void *source, void *const *channels, long frames)
+{
+	const __m256i unpack = _mm256_broadcastsi128_si256(unpack24LSBMask());
+	const __m256i pack = _mm256_broadcastsi128_si256(pack24LSBMask());
+	const char* in = (const char*)source;
+	char* left = (char*)channels[0];
+	char* right = (char*)channels[1];
+	long n = frames & ~31L;
+	for(long f = 0; f < n; f += 32)
+	{
+		__m256i g[8], l[4], r[4];
+		load24x32(in + f * 6, g);
+		load24x32(in + f * 6 + 96, g + 4);
+		splitStereo256<4>(_mm256_shuffle_epi8(g[0], unpack), _mm256_shuffle_epi8(g[1], unpack), l[0], r[0]);
+		splitStereo256<4>(_mm256_shuffle_epi8(g[2], unpack), _mm256_shuffle_epi8(g[3], unpack), l[1], r[1]);
+		splitStereo256<4>(_mm256_shuffle_epi8(g[4], unpack), _mm256_shuffle_epi8(g[5], unpack), l[2], r[2]);
+		splitStereo256<4>(_mm256_shuffle_epi8(g[6], unpack), _mm256_shuffle_epi8(g[7], unpack), l[3], r[3]);
+		pack24x32(left + f * 3, pack, l[0], l[1], l[2], l[3]);
+		pack24x32(right + f * 3, pack, r[0], r[1], r[2], r[3]);
+	}
+	ASIODeinterleaveRectScalar(source, channels, 2, 3, 0, 2, n, frames);
+}
+
+static ASIO_AVX2 void interleaveAVX2(const void *const *channels, void *dest, long numChannels,
+	long byteWidth, long frames)
+{
+	if(numChannels == 2)
+	{
+		switch(byteWidth)
+		{
+		case 1: interleaveStereo<1>(channels, dest, frames); return;
+		case 2: interleaveStereo<2>(channels, dest, frames); return;
+		case 3: interleaveStereo24(channels, dest, frames); return;
+		case 4: interleaveStereo<4>(channels, dest, frames); return;
+		case 8: interleaveStereo<8>(channels, dest, frames); return;
+		}
+	}
+	switch(byteWidth)
+	{
+	case 1: interleaveTiles128<1>(channels, dest, numChannels, frames); break;
+	case 2: interleaveTiles128<2>(channels, dest, numChannels, frames); break;
+	case 3: interleave24AVX2(channels, dest, numChannels, frames); break;
+	case 4: interleaveTiles<4>(channels, dest, numChannels, frames); break;
+	case 8: interleaveTiles<8>(channels, dest, numChannels, frames); break;
+	default: ASIOInterleaveScalar(channels, dest, numChannels, byteWidth, frames); break;
+	}
+}
+
+static ASIO_AVX2 void deinterleaveAVX2(const void *source, void *const *channels, long numChannels,
+	long byteWidth, long frames)
+{
+	if(numChannels == 2)
+	{
+		switch(byteWidth)
+		{
+		case 1: deinterleaveStereo<1>(source, channels, frames); return;
+		case 2: deinterleaveStereo<2>(source, channels, frames); return;
+		case 3: deinterleaveStereo24(source, channels, frames); return;
+		case 4: deinterleaveStereo<4>(source, channels, frames); return;
+		case 8: deinterleaveStereo<8>(source, channels, frames); return;
+		}
+	}
+	switch(byteWidth)
+	{
+	case 1: deinterleaveTiles128<1>(source, channels, numChannels, frames); break;
+	case 2: deinterleaveTiles128<2>(source, channels, numChannels, frames); break;
+	case 3: deinterleave24AVX2(source, channels, numChannels, frames); break;
+	case 4: deinterleaveTiles<4>(source, channels, numChannels, frames); break;
+	case 8: deinterleaveTiles<8>(source, channels, numChannels, frames); break;
+	default: ASIODeinterleaveScalar(source, channels, numChannels, byteWidth, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// int to float, 32 frames per iteration, backwards so that they can widen in place
+
+// 32 samples of 2, 3 or 4 bytes as int32, the 24 bit ones left aligned
+template <long width, bool swap>
+static inline ASIO_AVX2 void loadInt32x32(const char *in, __m256i v[4])
+{
+	if(width == 2)
+	{
+		for(int j = 0; j < 2; j++)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(in + j * 32));
+			if(swap)
+				a = _mm256_shuffle_epi8(a, _mm256_broadcastsi128_si256(swap16Mask()));
+			v[j * 2] = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(a));
+			v[j * 2 + 1] = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(a, 1));
+		}
+	}
+	else if(width == 3)
+	{
+		const __m256i mask = _mm256_broadcastsi128_si256(swap ? unpack24MSBMask() : unpack24LSBMask());
+		load24x32(in, v);
+		for(int j = 0; j < 4; j++)
+			v[j] = _mm256_shuffle_epi8(v[j], mask);
+	}
+	else
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			v[j] = _mm256_loadu_si256((const __m256i*)(in + j * 32));
+			if(swap)
+				v[j] = _mm256_shuffle_epi8(v[j], _mm256_broadcastsi128_si256(swap32Mask()));
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void intToFloat32Loop(const char *in, float *out, float scale, long frames)
+{
+	const __m256 sc = _mm256_set1_ps(scale);
+	for(long i = frames - 32; i >= 0; i -= 32)
+	{
+		__m256i v[4];
+		loadInt32x32<width, swap>(in + i * width, v);
+		for(int j = 3; j >= 0; j--)
+			_mm256_storeu_ps(out + i + j * 8, _mm256_mul_ps(_mm256_cvtepi32_ps(v[j]), sc));
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void intToFloat64Loop(const char *in, double *out, double scale, long frames)
+{
+	const __m256d sc = _mm256_set1_pd(scale);
+	for(long i = frames - 32; i >= 0; i -= 32)
+	{
+		__m256i v[4];
+		loadInt32x32<width, swap>(in + i * width, v);
+		for(int j = 3; j >= 0; j--)
+		{
+			_mm256_storeu_pd(out + i + j * 8 + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v[j], 1)), sc));
+			_mm256_storeu_pd(out + i + j * 8, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v[j])), sc));
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void intToFloat32Frames(const char *in, float *dest, float scale, long frames)
+{
+	long n = frames & ~31L;
+
+	// the tail first, then the blocks downwards.
+	// 24 bit samples are left aligned in the registers, the scale makes up for it.
+	scalarIntToFloat32<width, swap>(in + n * width, dest + n, scale, frames - n);
+	intToFloat32Loop<width, swap>(in, dest, width == 3 ? scale * (1.f / 256.f) : scale, n);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void intToFloat64Frames(const char *in, double *dest, double scale, long frames)
+{
+	long n = frames & ~31L;
+	scalarIntToFloat64<width, swap>(in + n * width, dest + n, scale, frames - n);
+	intToFloat64Loop<width, swap>(in, dest, width == 3 ? scale * (1. / 256.) : scale, n);
+}
+
+static ASIO_AVX2 void intToFloat32AVX2(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, float scale, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: intToFloat32Frames<2, false>(in, dest, scale, frames); break;
+	case 5: intToFloat32Frames<2, true>(in, dest, scale, frames); break;
+	case 6: intToFloat32Frames<3, false>(in, dest, scale, frames); break;
+	case 7: intToFloat32Frames<3, true>(in, dest, scale, frames); break;
+	case 8: intToFloat32Frames<4, false>(in, dest, scale, frames); break;
+	case 9: intToFloat32Frames<4, true>(in, dest, scale, frames); break;
+	}
+}
+
+static ASIO_AVX2 void intToFloat64AVX2(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: intToFloat64Frames<2, false>(in, dest, scale, frames); break;
+	case 5: intToFloat64Frames<2, true>(in, dest, scale, frames); break;
+	case 6: intToFloat64Frames<3, false>(in, dest, scale, frames); break;
+	case 7: intToFloat64Frames<3, true>(in, dest, scale, frames); break;
+	case 8: intToFloat64Frames<4, false>(in, dest, scale, frames); break;
+	case 9: intToFloat64Frames<4, true>(in, dest, scale, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// float to int of any width and byte order, 32 frames per iteration
+
+// 32 int32 to 2, 3 or 4 bytes, the low bytes of each sample are kept
+template <long width, bool swap>
+static inline ASIO_AVX2 void storeInt32x32(char *out, __m256i v[4])
+{
+	if(width == 2)
+	{
+		for(int j = 0; j < 4; j += 2)
+		{
+			__m256i lo = _mm256_srai_epi32(_mm256_slli_epi32(v[j], 16), 16);
+			__m256i hi = _mm256_srai_epi32(_mm256_slli_epi32(v[j + 1], 16), 16);
+			__m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+			if(swap)
+				p = _mm256_shuffle_epi8(p, _mm256_broadcastsi128_si256(swap16Mask()));
+			_mm256_storeu_si256((__m256i*)(out + j * 16), p);
+		}
+	}
+	else if(width == 3)
+		pack24x32(out, _mm256_broadcastsi128_si256(swap ? low24MSBMask() : low24LSBMask()),
+			v[0], v[1], v[2], v[3]);
+	else
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			if(swap)
+				v[j] = _mm256_shuffle_epi8(v[j], _mm256_broadcastsi128_si256(swap32Mask()));
+			_mm256_storeu_si256((__m256i*)(out + j * 32), v[j]);
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long float32toIntLoop(const float *in, char *out, const SaturationAVX2 &sc, long frames)
+{
+	__m256i clips = _mm256_setzero_si256();
+	for(long i = 0; i < frames; i += 32)
+	{
+		__m256i v[4];
+		for(int j = 0; j < 4; j++)
+			v[j] = floatToInt8(in + i + j * 8, sc, clips);
+		storeInt32x32<width, swap>(out + i * width, v);
+	}
+	return clipCount(clips);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long float32toIntFrames(const float *source, char *out, double scale, long frames)
+{
+	long n = frames & ~31L;
+	long clipped = float32toIntLoop<width, swap>(source, out, saturationAVX2(scale), n);
+	return clipped + scalarFloat32toInt<width, swap>(source + n, out + n * width, scale, frames - n);
+}
+
+static ASIO_AVX2 long float32toIntAVX2(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return float32toIntFrames<2, false>(source, out, scale, frames);
+	case 5: return float32toIntFrames<2, true>(source, out, scale, frames);
+	case 6: return float32toIntFrames<3, false>(source, out, scale, frames);
+	case 7: return float32toIntFrames<3, true>(source, out, scale, frames);
+	case 8: return float32toIntFrames<4, false>(source, out, scale, frames);
+	case 9: return float32toIntFrames<4, true>(source, out, scale, frames);
+	}
+	return 0;
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long float64toIntLoop(const double *in, char *out, const SaturationAVX2 &sc, long frames)
+{
+	__m256i clips = _mm256_setzero_si256();
+	for(long i = 0; i < frames; i += 32)
+	{
+		__m256i v[4];
+		for(int j = 0; j < 4; j++)
+			v[j] = doubleToInt8(_mm256_loadu_pd(in + i + j * 8), _mm256_loadu_pd(in + i + j * 8 + 4), sc, clips);
+		storeInt32x32<width, swap>(out + i * width, v);
+	}
+	return clipCount(clips);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long float64toIntFrames(const double *source, char *out, double scale, long frames)
+{
+	long n = frames & ~31L;
+	long clipped = float64toIntLoop<width, swap>(source, out, saturationAVX2(scale), n);
+	return clipped + scalarFloat64toInt<width, swap>(source + n, out + n * width, scale, frames - n);
+}
+
+static ASIO_AVX2 long float64toIntAVX2(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return float64toIntFrames<2, false>(source, out, scale, frames);
+	case 5: return float64toIntFrames<2, true>(source, out, scale, frames);
+	case 6: return float64toIntFrames<3, false>(source, out, scale, frames);
+	case 7: return float64toIntFrames<3, true>(source, out, scale, frames);
+	case 8: return float64toIntFrames<4, false>(source, out, scale, frames);
+	case 9: return float64toIntFrames<4, true>(source, out, scale, frames);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// float32 and float64 samples in either byte order, 8 frames per iteration.
+// Widening runs backwards and narrowing forwards so that both work in place.
+
+template <bool swap>
+static inline ASIO_AVX2 __m256 loadFloat8(const char *in)
+{
+	__m256i v = _mm256_loadu_si256((const __m256i*)in);
+	return _mm256_castsi256_ps(swap ? _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(swap32Mask())) : v);
+}
+
+template <bool swap>
+static inline ASIO_AVX2 __m256d loadDouble4(const char *in)
+{
+	__m256i v = _mm256_loadu_si256((const __m256i*)in);
+	return _mm256_castsi256_pd(swap ? _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(swap64Mask())) : v);
+}
+
+template <bool swap>
+static inline ASIO_AVX2 void storeFloat8(char *out, __m256 x)
+{
+	__m256i v = _mm256_castps_si256(x);
+	_mm256_storeu_si256((__m256i*)out, swap ? _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(swap32Mask())) : v);
+}
+
+template <bool swap>
+static inline ASIO_AVX2 void storeDouble4(char *out, __m256d x)
+{
+	__m256i v = _mm256_castpd_si256(x);
+	_mm256_storeu_si256((__m256i*)out, swap ? _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(swap64Mask())) : v);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void floatToFloat32Loop(const char *in, float *out, long frames)
+{
+	for(long i = 0; i < frames; i += 8)
+	{
+		if(width == 4)
+			_mm256_storeu_ps(out + i, loadFloat8<swap>(in + i * 4));
+		else
+			_mm256_storeu_ps(out + i, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(loadDouble4<swap>(in + i * 8))),
+				_mm256_cvtpd_ps(loadDouble4<swap>(in + i * 8 + 32)), 1));
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void floatToFloat64Loop(const char *in, double *out, long frames)
+{
+	for(long i = frames - 8; i >= 0; i -= 8)
+	{
+		__m256d lo, hi;
+		if(width == 4)
+		{
+			__m256 x = loadFloat8<swap>(in + i * 4);
+			lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+			hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+		}
+		else
+		{
+			lo = loadDouble4<swap>(in + i * 8);
+			hi = loadDouble4<swap>(in + i * 8 + 32);
+		}
+		_mm256_storeu_pd(out + i + 4, hi);
+		_mm256_storeu_pd(out + i, lo);
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void float32toFloatLoop(const float *in, char *out, long frames)
+{
+	for(long i = frames - 8; i >= 0; i -= 8)
+	{
+		__m256 x = _mm256_loadu_ps(in + i);
+		if(width == 4)
+			storeFloat8<swap>(out + i * 4, x);
+		else
+		{
+			storeDouble4<swap>(out + i * 8 + 32, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+			storeDouble4<swap>(out + i * 8, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void float64toFloatLoop(const double *in, char *out, long frames)
+{
+	for(long i = 0; i < frames; i += 8)
+	{
+		__m256d lo = _mm256_loadu_pd(in + i);
+		__m256d hi = _mm256_loadu_pd(in + i + 4);
+		if(width == 4)
+			storeFloat8<swap>(out + i * 4, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1));
+		else
+		{
+			storeDouble4<swap>(out + i * 8, lo);
+			storeDouble4<swap>(out + i * 8 + 32, hi);
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void floatToFloat32Frames(const char *in, float *dest, long frames)
+{
+	long n = frames & ~7L;
+	floatToFloat32Loop<width, swap>(in, dest, n);
+	scalarFloatToFloat32<width, swap>(in + n * width, dest + n, frames - n);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void floatToFloat64Frames(const char *in, double *dest, long frames)
+{
+	long n = frames & ~7L;
+	scalarFloatToFloat64<width, swap>(in + n * width, dest + n, frames - n);
+	floatToFloat64Loop<width, swap>(in, dest, n);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void float32toFloatFrames(const float *source, char *out, long frames)
+{
+	long n = frames & ~7L;
+	scalarFloat32toFloat<width, swap>(source + n, out + n * width, frames - n);
+	float32toFloatLoop<width, swap>(source, out, n);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void float64toFloatFrames(const double *source, char *out, long frames)
+{
+	long n = frames & ~7L;
+	float64toFloatLoop<width, swap>(source, out, n);
+	scalarFloat64toFloat<width, swap>(source + n, out + n * width, frames - n);
+}
+
+static ASIO_AVX2 void floatToFloat32AVX2(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: floatToFloat32Frames<4, false>(in, dest, frames); break;
+	case 9: floatToFloat32Frames<4, true>(in, dest, frames); break;
+	case 16: floatToFloat32Frames<8, false>(in, dest, frames); break;
+	case 17: floatToFloat32Frames<8, true>(in, dest, frames); break;
+	}
+}
+
+static ASIO_AVX2 void floatToFloat64AVX2(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: floatToFloat64Frames<4, false>(in, dest, frames); break;
+	case 9: floatToFloat64Frames<4, true>(in, dest, frames); break;
+	case 16: floatToFloat64Frames<8, false>(in, dest, frames); break;
+	case 17: floatToFloat64Frames<8, true>(in, dest, frames); break;
+	}
+}
+
+static ASIO_AVX2 void float32toFloatAVX2(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: float32toFloatFrames<4, false>(source, out, frames); break;
+	case 9: float32toFloatFrames<4, true>(source, out, frames); break;
+	case 16: float32toFloatFrames<8, false>(source, out, frames); break;
+	case 17: float32toFloatFrames<8, true>(source, out, frames); break;
+	}
+}
+
+static ASIO_AVX2 void float64toFloatAVX2(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: float64toFloatFrames<4, false>(source, out, frames); break;
+	case 9: float64toFloatFrames<4, true>(source, out, frames); break;
+	case 16: float64toFloatFrames<8, false>(source, out, frames); break;
+	case 17: float64toFloatFrames<8, true>(source, out, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// gain and mix, 32 frames per iteration. The sources are summed in four registers in the
+// order of the reference, then converted like float32toIntLoop and float32toFloatLoop.
+
+static inline ASIO_AVX2 void mix32(const float *const *sources, const float *gains, long numSources,
+	long i, __m256 m[4])
+{
+	// named accumulators, an array would be kept in memory across the source loop
+	__m256 m0 = _mm256_setzero_ps(), m1 = m0, m2 = m0, m3 = m0;
+	for(long s = 0; s < numSources; s++)
+	{
+		__m256 g = _mm256_set1_ps(gains[s]);
+		const float* in = sources[s] + i;
+		m0 = _mm256_add_ps(m0, _mm256_mul_ps(g, _mm256_loadu_ps(in)));
+		m1 = _mm256_add_ps(m1, _mm256_mul_ps(g, _mm256_loadu_ps(in + 8)));
+		m2 = _mm256_add_ps(m2, _mm256_mul_ps(g, _mm256_loadu_ps(in + 16)));
+		m3 = _mm256_add_ps(m3, _mm256_mul_ps(g, _mm256_loadu_ps(in + 24)));
+	}
+	m[0] = m0;
+	m[1] = m1;
+	m[2] = m2;
+	m[3] = m3;
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long mixToIntLoop(const float *const *sources, const float *gains, long numSources,
+	char *out, const SaturationAVX2 &sc, long frames)
+{
+	__m256i clips = _mm256_setzero_si256();
+	for(long i = 0; i < frames; i += 32)
+	{
+		__m256 m[4];
+		__m256i v[4];
+		mix32(sources, gains, numSources, i, m);
+		for(int j = 0; j < 4; j++)
+			v[j] = doubleToInt8(_mm256_cvtps_pd(_mm256_castps256_ps128(m[j])),
+				_mm256_cvtps_pd(_mm256_extractf128_ps(m[j], 1)), sc, clips);
+		storeInt32x32<width, swap>(out + i * width, v);
+	}
+	return clipCount(clips);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void mixToFloatLoop(const float *const *sources, const float *gains, long numSources,
+	char *out, long frames)
+{
+	for(long i = 0; i < frames; i += 32)
+	{
+		__m256 m[4];
+		mix32(sources, gains, numSources, i, m);
+		for(int j = 0; j < 4; j++)
+		{
+			char* o = out + (i + j * 8) * width;
+			if(width == 4)
+				storeFloat8<swap>(o, m[j]);
+			else
+			{
+				storeDouble4<swap>(o, _mm256_cvtps_pd(_mm256_castps256_ps128(m[j])));
+				storeDouble4<swap>(o + 32, _mm256_cvtps_pd(_mm256_extractf128_ps(m[j], 1)));
+			}
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long mixToIntFrames(const float *const *sources, const float *gains, long numSources,
+	char *out, double scale, long frames)
+{
+	long n = frames & ~31L;
+	long clipped = mixToIntLoop<width, swap>(sources, gains, numSources, out, saturationAVX2(scale), n);
+	return clipped + scalarMixToInt<width, swap>(sources, gains, numSources, out, scale, n, frames);
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 void mixToFloatFrames(const float *const *sources, const float *gains, long numSources,
+	char *out, long frames)
+{
+	long n = frames & ~31L;
+	mixToFloatLoop<width, swap>(sources, gains, numSources, out, n);
+	scalarMixToFloat<width, swap>(sources, gains, numSources, out, n, frames);
+}
+
+static ASIO_AVX2 long mixToIntAVX2(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return mixToIntFrames<2, false>(sources, gains, numSources, out, scale, frames);
+	case 5: return mixToIntFrames<2, true>(sources, gains, numSources, out, scale, frames);
+	case 6: return mixToIntFrames<3, false>(sources, gains, numSources, out, scale, frames);
+	case 7: return mixToIntFrames<3, true>(sources, gains, numSources, out, scale, frames);
+	case 8: return mixToIntFrames<4, false>(sources, gains, numSources, out, scale, frames);
+	case 9: return mixToIntFrames<4, true>(sources, gains, numSources, out, scale, frames);
+	}
+	return 0;
+}
+
+static ASIO_AVX2 void mixToFloatAVX2(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: mixToFloatFrames<4, false>(sources, gains, numSources, out, frames); break;
+	case 9: mixToFloatFrames<4, true>(sources, gains, numSources, out, frames); break;
+	case 16: mixToFloatFrames<8, false>(sources, gains, numSources, out, frames); break;
+	case 17: mixToFloatFrames<8, true>(sources, gains, numSources, out, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// requantizer, 32 frames per iteration starting at generator 0
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long requantizeLoop(ASIORequantizer *r, const float *in, char *out, long bits, long frames)
+{
+	const double scale = (double)((1LL << (bits - 1)) - 1);
+	const __m256d sc = _mm256_set1_pd(scale);
+	const __m256d lo = _mm256_set1_pd(-scale - 1.);
+	const __m256d hi = _mm256_set1_pd(scale);
+	__m256i rng = _mm256_loadu_si256((const __m256i*)r->rng);
+	__m256i dither = _mm256_setzero_si256();
+	__m256i clips = _mm256_setzero_si256();
+	for(long i = 0; i < frames; i += 32)
+	{
+		__m256i v[4];
+		for(int j = 0; j < 4; j++)
+		{
+			if(r->dither)
+			{
+				rng = xorshift8(rng);
+				dither = tpdf8(rng);
+			}
+			v[j] = requantize8(in + i + j * 8, dither, sc, lo, hi, clips);
+		}
+		storeInt32x32<width, swap>(out + i * width, v);
+	}
+	_mm256_storeu_si256((__m256i*)r->rng, rng);
+	return clipCount(clips);
+}
+
+// the error feedback stays scalar, only the dither is drawn 8 samples at a time
+template <long width, bool swap>
+static inline ASIO_AVX2 long requantizeShaped(ASIORequantizer *r, const float *in, char *out, long bits, long frames)
+{
+	int dither[64] = { 0 };
+	long clipped = 0;
+	__m256i rng = _mm256_loadu_si256((const __m256i*)r->rng);
+	for(long i = 0; i < frames; i += 64)
+	{
+		long n = frames - i < 64 ? frames - i : 64;
+		for(long j = 0; r->dither && j < n; j += 8)
+		{
+			rng = xorshift8(rng);
+			_mm256_storeu_si256((__m256i*)(dither + j), tpdf8(rng));
+		}
+		clipped += scalarRequantizeBlock<width, swap>(r, in + i, out + i * width, bits, dither, n);
+	}
+	_mm256_storeu_si256((__m256i*)r->rng, rng);
+	return clipped;
+}
+
+template <long width, bool swap>
+static inline ASIO_AVX2 long requantizeFrames(ASIORequantizer *requantizer, const float *source, char *out,
+	long bits, long frames)
+{
+	// the vector loops start at generator 0
+	long head = requantizer->dither ? (8 - requantizer->lane) & 7 : 0;
+	if(head > frames)
+		head = frames;
+	long clipped = scalarRequantize<width, swap>(requantizer, source, out, bits, head);
+	source += head;
+	out += head * width;
+	frames -= head;
+
+	long n = frames & ~31L;
+	if(requantizer->shaping)
+		clipped += requantizeShaped<width, swap>(requantizer, source, out, bits, n);
+	else
+		clipped += requantizeLoop<width, swap>(requantizer, source, out, bits, n);
+	return clipped + scalarRequantize<width, swap>(requantizer, source + n, out + n * width, bits, frames - n);
+}
+
+static ASIO_AVX2 long requantizeAVX2(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, long frames)
+{
+	if(bits < 2 || bits > byteWidth * 8)
+		return 0;
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return requantizeFrames<2, false>(requantizer, source, out, bits, frames);
+	case 5: return requantizeFrames<2, true>(requantizer, source, out, bits, frames);
+	case 6: return requantizeFrames<3, false>(requantizer, source, out, bits, frames);
+	case 7: return requantizeFrames<3, true>(requantizer, source, out, bits, frames);
+	case 8: return requantizeFrames<4, false>(requantizer, source, out, bits, frames);
+	case 9: return requantizeFrames<4, true>(requantizer, source, out, bits, frames);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// channel converters, see ASIOInstallChannels()
+
+struct ChannelsAVX2
+{
+	template <long layout, bool swap>
+	static ASIO_AVX2 void toFloat32(ASIOChannelState *, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			floatToFloat32Frames<width, swap>((const char*)source, (float*)dest, frames);
+		else
+			intToFloat32Frames<width, swap>((const char*)source, (float*)dest,
+				(float)ASIOInputScaleOf(ASIOLayoutBits(layout)), frames);
+	}
+
+	template <long layout, bool swap>
+	static ASIO_AVX2 void toFloat64(ASIOChannelState *, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			floatToFloat64Frames<width, swap>((const char*)source, (double*)dest, frames);
+		else
+			intToFloat64Frames<width, swap>((const char*)source, (double*)dest,
+				ASIOInputScaleOf(ASIOLayoutBits(layout)), frames);
+	}
+
+	template <long layout, bool swap>
+	static ASIO_AVX2 void fromFloat32(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			float32toFloatFrames<width, swap>((const float*)source, (char*)dest, frames);
+		else
+			ASIOCountClips(state, float32toIntFrames<width, swap>((const float*)source, (char*)dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+
+	template <long layout, bool swap>
+	static ASIO_AVX2 void fromFloat64(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			float64toFloatFrames<width, swap>((const double*)source, (char*)dest, frames);
+		else
+			ASIOCountClips(state, float64toIntFrames<width, swap>((const double*)source, (char*)dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+
+	template <long layout, bool swap>
+	static ASIO_AVX2 void requantize(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		ASIOCountClips(state, requantizeFrames<ASIOLayoutBytes(layout), swap>(&state->requantizer,
+			(const float*)source, (char*)dest, ASIOLayoutBits(layout), frames));
+	}
+
+	template <long layout, bool swap>
+	static ASIO_AVX2 void mix(ASIOChannelState *state, const float *const *sources, const float *gains,
+		long numSources, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			mixToFloatFrames<width, swap>(sources, gains, numSources, (char*)dest, frames);
+		else
+			ASIOCountClips(state, mixToIntFrames<width, swap>(sources, gains, numSources, (char*)dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+};
+
+void ASIOInstallAVX2Kernels(ASIOConvertKernels *k)
+{
+	k->float32toInt16 = float32toInt16AVX2;
+	k->float32toInt24 = float32toInt24AVX2;
+	k->float32toInt32 = float32toInt32AVX2;
+	k->int32toInt24LSB = int32toInt24LSBAVX2;
+	k->int32toInt24MSB = int32toInt24MSBAVX2;
+	k->int24LSBtoInt32 = int24LSBtoInt32AVX2;
+	k->int24MSBtoInt32 = int24MSBtoInt32AVX2;
+	k->int24LSBtoInt16 = int24LSBtoInt16AVX2;
+	k->int24MSBtoInt16 = int24MSBtoInt16AVX2;
+	k->stereoInt32toInt24LSB = stereoInt32toInt24LSBAVX2;
+	k->stereoInt32toInt24MSB = stereoInt32toInt24MSBAVX2;
+	k->shift32 = shift32AVX2;
+	k->reverseEndian = reverseEndianAVX2;
+	k->interleave = interleaveAVX2;
+	k->deinterleave = deinterleaveAVX2;
+	k->intToFloat32 = intToFloat32AVX2;
+	k->intToFloat64 = intToFloat64AVX2;
+	k->floatToFloat32 = floatToFloat32AVX2;
+	k->floatToFloat64 = floatToFloat64AVX2;
+	k->float32toInt = float32toIntAVX2;
+	k->float64toInt = float64toIntAVX2;
+	k->float32toFloat = float32toFloatAVX2;
+	k->float64toFloat = float64toFloatAVX2;
+	k->requantize = requantizeAVX2;
+	k->mixToInt = mixToIntAVX2;
+	k->mixToFloat = mixToFloatAVX2;
+	ASIOInstallChannels<ChannelsAVX2>(k);
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "ginclude.h"
+#include "ASIOConvertSIMD.h"
+
+#if ASIO_CONVERT_X86
+
+// SSE2 kernels, the double multiply of the reference is kept so that the
+// results stay bit identical, it is just done two samples per instruction
+
+//-------------------------------------------------------------------------------------------
+// float to int
+
+static ASIO_SSE2 void float32toInt16SSE2(const float *source, void *dest, long frames)
+{
+	const SaturationSSE2 sc = saturationSSE2(fScaler16 + .49999);
+	short* b = (short*)dest;
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		__m128i lo = floatToInt4(_mm_loadu_ps(source + i), sc);
+		__m128i hi = floatToInt4(_mm_loadu_ps(source + i + 4), sc);
+		_mm_storeu_si128((__m128i*)(b + i), truncate16(lo, hi));
+	}
+	ASIOFloat32toInt16Scalar(source + n, b + n, frames - n);
+}
+
+static ASIO_SSE2 void float32toInt24SSE2(const float *source, void *dest, long frames)
+{
+	// no byte shuffles in SSE2, the packing stays scalar
+	const SaturationSSE2 sc = saturationSSE2(fScaler24 + .49999);
+	char* b = (char*)dest;
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		union { __m128i v[2]; unsigned char c[32]; } a;
+		a.v[0] = floatToInt4(_mm_loadu_ps(source + i), sc);
+		a.v[1] = floatToInt4(_mm_loadu_ps(source + i + 4), sc);
+		for(int j = 0; j < 32; j += 4)
+		{
+			*b++ = a.c[j + 3];
+			*b++ = a.c[j + 2];
+			*b++ = a.c[j + 1];
+		}
+	}
+	ASIOFloat32toInt24Scalar(source + n, b, frames - n);
+}
+
+static ASIO_SSE2 void float32toInt32SSE2(const float *source, void *dest, long frames)
+{
+	const SaturationSSE2 sc = saturationSSE2(fScaler32 + .49999);
+	int* b = (int*)dest;
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		__m128i lo = floatToInt4(_mm_loadu_ps(source + i), sc);
+		__m128i hi = floatToInt4(_mm_loadu_ps(source + i + 4), sc);
+		_mm_storeu_si128((__m128i*)(b + i), lo);
+		_mm_storeu_si128((__m128i*)(b + i + 4), hi);
+	}
+	ASIOFloat32toInt32Scalar(source + n, b + n, frames - n);
+}
+
+//-------------------------------------------------------------------------------------------
+// n channel interleave, 24 bit needs byte shuffles and stays scalar here
+
+static ASIO_SSE2 void interleaveSSE2(const void *const *channels, void *dest, long numChannels,
+	long byteWidth, long frames)
+{
+	switch(byteWidth)
+	{
+	case 1: interleave128<1>(channels, dest, numChannels, frames); break;
+	case 2: interleave128<2>(channels, dest, numChannels, frames); break;
+	case 4: interleave128<4>(channels, dest, numChannels, frames); break;
+	case 8: interleave128<8>(channels, dest, numChannels, frames); break;
+	default: ASIOInterleaveScalar(channels, dest, numChannels, byteWidth, frames); break;
+	}
+}
+
+static ASIO_SSE2 void deinterleaveSSE2(const void *source, void *const *channels, long numChannels,
+	long byteWidth, long frames)
+{
+	switch(byteWidth)
+	{
+	case 1: deinterleave128<1>(source, channels, numChannels, frames); break;
+	case 2: deinterleave128<2>(source, channels, numChannels, frames); break;
+	case 4: deinterleave128<4>(source, channels, numChannels, frames); break;
+	case 8: deinterleave128<8>(source, channels, numChannels, frames); break;
+	default: ASIODeinterleaveScalar(source, channels, numChannels, byteWidth, frames); break;
+	}
+}
+
+void ASIOInstallSSE2Kernels(ASIOConvertKernels *k)
+{
+	k->float32toInt16 = float32toInt16SSE2;
+	k->float32toInt24 = float32toInt24SSE2;
+	k->float32toInt32 = float32toInt32SSE2;
+	k->interleave = interleaveSSE2;
+	k->deinterleave = deinterleaveSSE2;
+}
+
+#endif
@@ -0,0 +1,991 @@
+#include "ginclude.h"
+#include "ASIOConvertSIMD.h"
+
+#if ASIO_CONVERT_X86
+
+// SSE4.1/SSSE3 kernels, byte shuffles replace the shift and scalar
+// byte loops of the SSE2 narrowing
+
+//-------------------------------------------------------------------------------------------
+// float to int
+
+static ASIO_SSE41 void float32toInt16SSE41(const float *source, void *dest, long frames)
+{
+	const SaturationSSE2 sc = saturationSSE2(fScaler16 + .49999);
+	const __m128i low16 = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+	short* b = (short*)dest;
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		__m128i lo = _mm_shuffle_epi8(floatToInt4(_mm_loadu_ps(source + i), sc), low16);
+		__m128i hi = _mm_shuffle_epi8(floatToInt4(_mm_loadu_ps(source + i + 4), sc), low16);
+		_mm_storeu_si128((__m128i*)(b + i), _mm_unpacklo_epi64(lo, hi));
+	}
+	ASIOFloat32toInt16Scalar(source + n, b + n, frames - n);
+}
+
+static ASIO_SSE41 void float32toInt24SSE41(const float *source, void *dest, long frames)
+{
+	const SaturationSSE2 sc = saturationSSE2(fScaler24 + .49999);
+	const __m128i mask = pack24MSBMask();
+	char* b = (char*)dest;
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m128i v0 = floatToInt4(_mm_loadu_ps(source + i), sc);
+		__m128i v1 = floatToInt4(_mm_loadu_ps(source + i + 4), sc);
+		__m128i v2 = floatToInt4(_mm_loadu_ps(source + i + 8), sc);
+		__m128i v3 = floatToInt4(_mm_loadu_ps(source + i + 12), sc);
+		pack24x16(b + i * 3, mask, v0, v1, v2, v3);
+	}
+	ASIOFloat32toInt24Scalar(source + n, b + n * 3, frames - n);
+}
+
+//-------------------------------------------------------------------------------------------
+// packed 24 bit, 16 frames per iteration
+
+static inline ASIO_SSE41 void int32toInt24(const void *source, void *dest, long frames, __m128i mask, ASIOIntKernel tail)
+{
+	const int* in = (const int*)source;
+	char* out = (char*)dest;
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m128i v0 = _mm_loadu_si128((const __m128i*)(in + i));
+		__m128i v1 = _mm_loadu_si128((const __m128i*)(in + i + 4));
+		__m128i v2 = _mm_loadu_si128((const __m128i*)(in + i + 8));
+		__m128i v3 = _mm_loadu_si128((const __m128i*)(in + i + 12));
+		pack24x16(out + i * 3, mask, v0, v1, v2, v3);
+	}
+	tail(in + n, out + n * 3, frames - n);
+}
+
+static inline ASIO_SSE41 void int24toInt32(const void *source, void *dest, long frames, __m128i mask, ASIOIntKernel tail)
+{
+	const char* in = (const char*)source;
+	int* out = (int*)dest;
+	long n = frames & ~15L;
+
+	// backwards, starting with the tail, so the conversion can be done in place
+	tail(in + n * 3, out + n, frames - n);
+	for(long i = n - 16; i >= 0; i -= 16)
+	{
+		__m128i g[4];
+		load24x16(in + i * 3, g);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_shuffle_epi8(g[0], mask));
+		_mm_storeu_si128((__m128i*)(out + i + 4), _mm_shuffle_epi8(g[1], mask));
+		_mm_storeu_si128((__m128i*)(out + i + 8), _mm_shuffle_epi8(g[2], mask));
+		_mm_storeu_si128((__m128i*)(out + i + 12), _mm_shuffle_epi8(g[3], mask));
+	}
+}
+
+static inline ASIO_SSE41 void int24toInt16(const void *source, void *dest, long frames, __m128i mask, ASIOIntKernel tail)
+{
+	const char* in = (const char*)source;
+	short* out = (short*)dest;
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m128i g[4];
+		load24x16(in + i * 3, g);
+		__m128i lo = _mm_unpacklo_epi64(_mm_shuffle_epi8(g[0], mask), _mm_shuffle_epi8(g[1], mask));
+		__m128i hi = _mm_unpacklo_epi64(_mm_shuffle_epi8(g[2], mask), _mm_shuffle_epi8(g[3], mask));
+		_mm_storeu_si128((__m128i*)(out + i), lo);
+		_mm_storeu_si128((__m128i*)(out + i + 8), hi);
+	}
+	tail(in + n * 3, out + n, frames - n);
+}
+
+static inline ASIO_SSE41 void stereoInt32toInt24(const void *left, const void *right, void *dest, long frames,
+	__m128i mask, ASIOStereoKernel tail)
+{
+	const int* l = (const int*)left;
+	const int* r = (const int*)right;
+	char* out = (char*)dest;
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		__m128i l0 = _mm_loadu_si128((const __m128i*)(l + i));
+		__m128i l1 = _mm_loadu_si128((const __m128i*)(l + i + 4));
+		__m128i r0 = _mm_loadu_si128((const __m128i*)(r + i));
+		__m128i r1 = _mm_loadu_si128((const __m128i*)(r + i + 4));
+		pack24x16(out + i * 6, mask, _mm_unpacklo_epi32(l0, r0), _mm_unpackhi_epi32(l0, r0),
+			_mm_unpacklo_epi32(l1, r1), _mm_unpackhi_epi32(l1, r1));
+	}
+	tail(l + n, r + n, out + n * 6, frames - n);
+}
+
+static ASIO_SSE41 void int32toInt24LSBSSE41(const void *source, void *dest, long frames)
+{
+	int32toInt24(source, dest, frames, pack24LSBMask(), ASIOInt32toInt24LSBScalar);
+}
+
+static ASIO_SSE41 void int32toInt24MSBSSE41(const void *source, void *dest, long frames)
+{
+	int32toInt24(source, dest, frames, pack24MSBMask(), ASIOInt32toInt24MSBScalar);
+}
+
+static ASIO_SSE41 void int24LSBtoInt32SSE41(const void *source, void *dest, long frames)
+{
+	int24toInt32(source, dest, frames, unpack24LSBMask(), ASIOInt24LSBtoInt32Scalar);
+}
+
+static ASIO_SSE41 void int24MSBtoInt32SSE41(const void *source, void *dest, long frames)
+{
+	int24toInt32(source, dest, frames, unpack24MSBMask(), ASIOInt24MSBtoInt32Scalar);
+}
+
+static ASIO_SSE41 void int24LSBtoInt16SSE41(const void *source, void *dest, long frames)
+{
+	int24toInt16(source, dest, frames, int24LSBto16Mask(), ASIOInt24LSBtoInt16Scalar);
+}
+
+static ASIO_SSE41 void int24MSBtoInt16SSE41(const void *source, void *dest, long frames)
+{
+	int24toInt16(source, dest, frames, int24MSBto16Mask(), ASIOInt24MSBtoInt16Scalar);
+}
+
+static ASIO_SSE41 void stereoInt32toInt24LSBSSE41(const void *left, const void *right, void *dest, long frames)
+{
+	stereoInt32toInt24(left, right, dest, frames, pack24LSBMask(), ASIOStereoInt32toInt24LSBScalar);
+}
+
+static ASIO_SSE41 void stereoInt32toInt24MSBSSE41(const void *left, const void *right, void *dest, long frames)
+{
+	stereoInt32toInt24(left, right, dest, frames, pack24MSBMask(), ASIOStereoInt32toInt24MSBScalar);
+}
+
+//-------------------------------------------------------------------------------------------
+// byte swap, shift and narrow in one pass, 16 frames per iteration
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void shift32Loop(const char *in, char *out, __m128i count, long frames)
+{
+	const __m128i swapMask = swap32Mask();
+	for(long i = 0; i < frames; i += 16)
+	{
+		__m128i v[4];
+		for(int j = 0; j < 4; j++)
+		{
+			v[j] = _mm_loadu_si128((const __m128i*)(in + i * 4 + j * 16));
+			if(swap)
+				v[j] = _mm_shuffle_epi8(v[j], swapMask);
+			v[j] = _mm_sll_epi32(v[j], count);
+		}
+		if(width == 2)
+		{
+			const __m128i mask = upper16Mask();
+			__m128i lo = _mm_unpacklo_epi64(_mm_shuffle_epi8(v[0], mask), _mm_shuffle_epi8(v[1], mask));
+			__m128i hi = _mm_unpacklo_epi64(_mm_shuffle_epi8(v[2], mask), _mm_shuffle_epi8(v[3], mask));
+			_mm_storeu_si128((__m128i*)(out + i * 2), lo);
+			_mm_storeu_si128((__m128i*)(out + i * 2 + 16), hi);
+		}
+		else if(width == 3)
+			pack24x16(out + i * 3, pack24LSBMask(), v[0], v[1], v[2], v[3]);
+		else
+		{
+			for(int j = 0; j < 4; j++)
+				_mm_storeu_si128((__m128i*)(out + i * 4 + j * 16), v[j]);
+		}
+	}
+}
+
+static ASIO_SSE41 void reverseEndianSSE41(const void *source, void *dest, long byteWidth, long frames);
+
+static ASIO_SSE41 void shift32SSE41(const void *source, void *dest, long shiftAmount, long targetByteWidth,
+	bool revertEndian, long frames)
+{
+	const char* in = (const char*)source;
+	char* out = (char*)dest;
+	if(targetByteWidth < 2 || targetByteWidth > 4)
+	{
+		if(revertEndian)
+			reverseEndianSSE41(source, dest, 4, frames);
+		return;
+	}
+
+	// pslld clears the word for counts above 31, negative ones included
+	__m128i count = _mm_cvtsi32_si128((int)shiftAmount);
+	long n = frames & ~15L;
+	switch(targetByteWidth * 2 + (revertEndian ? 1 : 0))
+	{
+	case 4: shift32Loop<2, false>(in, out, count, n); break;
+	case 5: shift32Loop<2, true>(in, out, count, n); break;
+	case 6: shift32Loop<3, false>(in, out, count, n); break;
+	case 7: shift32Loop<3, true>(in, out, count, n); break;
+	case 8: shift32Loop<4, false>(in, out, count, n); break;
+	case 9: shift32Loop<4, true>(in, out, count, n); break;
+	}
+	ASIOShift32Scalar(in + n * 4, out + n * targetByteWidth, shiftAmount, targetByteWidth,
+		revertEndian, frames - n);
+}
+
+static ASIO_SSE41 void reverseEndianSSE41(const void *source, void *dest, long byteWidth, long frames)
+{
+	const char* in = (const char*)source;
+	char* out = (char*)dest;
+	long n = frames & ~15L;
+	if(byteWidth == 2 || byteWidth == 4 || byteWidth == 8)
+	{
+		const __m128i mask = byteWidth == 2 ? swap16Mask() : byteWidth == 4 ? swap32Mask() : swap64Mask();
+		for(long i = 0; i < n * byteWidth; i += 16)
+			_mm_storeu_si128((__m128i*)(out + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + i)), mask));
+	}
+	else if(byteWidth == 3)
+	{
+		const __m128i mask = swap24Mask();
+		for(long i = 0; i < n * 3; i += 48)
+		{
+			__m128i g[4];
+			load24x16(in + i, g);
+			pack24x16(out + i, mask, g[0], g[1], g[2], g[3]);
+		}
+	}
+	else
+		return;
+	ASIOReverseEndianScalar(in + n * byteWidth, out + n * byteWidth, byteWidth, frames - n);
+}
+
+//-------------------------------------------------------------------------------------------
+// n channel interleave, the SSE2 paths with byte shuffles for 24 bit
+
+static ASIO_SSE41 void interleaveSSE41(const void *const *channels, void *dest, long numChannels,
+	long byteWidth, long frames)
+{
+	switch(byteWidth)
+	{
+	case 1: interleave128<1>(channels, dest, numChannels, frames); break;
+	case 2: interleave128<2>(channels, dest, numChannels, frames); break;
+	case 3: interleave24(channels, dest, numChannels, frames); break;
+	case 4: interleave128<4>(channels, dest, numChannels, frames); break;
+	case 8: interleave128<8>(channels, dest, numChannels, frames); break;
+	default: ASIOInterleaveScalar(channels, dest, numChannels, byteWidth, frames); break;
+	}
+}
+
+static ASIO_SSE41 void deinterleaveSSE41(const void *source, void *const *channels, long numChannels,
+	long byteWidth, long frames)
+{
+	switch(byteWidth)
+	{
+	case 1: deinterleave128<1>(source, channels, numChannels, frames); break;
+	case 2: deinterleave128<2>(source, channels, numChannels, frames); break;
+	case 3: deinterleave24(source, channels, numChannels, frames); break;
+	case 4: deinterleave128<4>(source, channels, numChannels, frames); break;
+	case 8: deinterleave128<8>(source, channels, numChannels, frames); break;
+	default: ASIODeinterleaveScalar(source, channels, numChannels, byteWidth, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// int to float, 16 frames per iteration, backwards so that they can widen in place
+
+// 16 samples of 2, 3 or 4 bytes as int32, the 24 bit ones left aligned
+template <long width, bool swap>
+static inline ASIO_SSE41 void loadInt32x16(const char *in, __m128i v[4])
+{
+	if(width == 2)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)in);
+		__m128i b = _mm_loadu_si128((const __m128i*)(in + 16));
+		if(swap)
+		{
+			a = _mm_shuffle_epi8(a, swap16Mask());
+			b = _mm_shuffle_epi8(b, swap16Mask());
+		}
+		v[0] = _mm_cvtepi16_epi32(a);
+		v[1] = _mm_cvtepi16_epi32(_mm_srli_si128(a, 8));
+		v[2] = _mm_cvtepi16_epi32(b);
+		v[3] = _mm_cvtepi16_epi32(_mm_srli_si128(b, 8));
+	}
+	else if(width == 3)
+	{
+		const __m128i mask = swap ? unpack24MSBMask() : unpack24LSBMask();
+		load24x16(in, v);
+		for(int j = 0; j < 4; j++)
+			v[j] = _mm_shuffle_epi8(v[j], mask);
+	}
+	else
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			v[j] = _mm_loadu_si128((const __m128i*)(in + j * 16));
+			if(swap)
+				v[j] = _mm_shuffle_epi8(v[j], swap32Mask());
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void intToFloat32Loop(const char *in, float *out, float scale, long frames)
+{
+	const __m128 sc = _mm_set1_ps(scale);
+	for(long i = frames - 16; i >= 0; i -= 16)
+	{
+		__m128i v[4];
+		loadInt32x16<width, swap>(in + i * width, v);
+		for(int j = 3; j >= 0; j--)
+			_mm_storeu_ps(out + i + j * 4, _mm_mul_ps(_mm_cvtepi32_ps(v[j]), sc));
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void intToFloat64Loop(const char *in, double *out, double scale, long frames)
+{
+	const __m128d sc = _mm_set1_pd(scale);
+	for(long i = frames - 16; i >= 0; i -= 16)
+	{
+		__m128i v[4];
+		loadInt32x16<width, swap>(in + i * width, v);
+		for(int j = 3; j >= 0; j--)
+		{
+			_mm_storeu_pd(out + i + j * 4 + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v[j], 8)), sc));
+			_mm_storeu_pd(out + i + j * 4, _mm_mul_pd(_mm_cvtepi32_pd(v[j]), sc));
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void intToFloat32Frames(const char *in, float *dest, float scale, long frames)
+{
+	long n = frames & ~15L;
+
+	// the tail first, then the blocks downwards.
+	// 24 bit samples are left aligned in the registers, the scale makes up for it.
+	scalarIntToFloat32<width, swap>(in + n * width, dest + n, scale, frames - n);
+	intToFloat32Loop<width, swap>(in, dest, width == 3 ? scale * (1.f / 256.f) : scale, n);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void intToFloat64Frames(const char *in, double *dest, double scale, long frames)
+{
+	long n = frames & ~15L;
+	scalarIntToFloat64<width, swap>(in + n * width, dest + n, scale, frames - n);
+	intToFloat64Loop<width, swap>(in, dest, width == 3 ? scale * (1. / 256.) : scale, n);
+}
+
+static ASIO_SSE41 void intToFloat32SSE41(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, float scale, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: intToFloat32Frames<2, false>(in, dest, scale, frames); break;
+	case 5: intToFloat32Frames<2, true>(in, dest, scale, frames); break;
+	case 6: intToFloat32Frames<3, false>(in, dest, scale, frames); break;
+	case 7: intToFloat32Frames<3, true>(in, dest, scale, frames); break;
+	case 8: intToFloat32Frames<4, false>(in, dest, scale, frames); break;
+	case 9: intToFloat32Frames<4, true>(in, dest, scale, frames); break;
+	}
+}
+
+static ASIO_SSE41 void intToFloat64SSE41(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: intToFloat64Frames<2, false>(in, dest, scale, frames); break;
+	case 5: intToFloat64Frames<2, true>(in, dest, scale, frames); break;
+	case 6: intToFloat64Frames<3, false>(in, dest, scale, frames); break;
+	case 7: intToFloat64Frames<3, true>(in, dest, scale, frames); break;
+	case 8: intToFloat64Frames<4, false>(in, dest, scale, frames); break;
+	case 9: intToFloat64Frames<4, true>(in, dest, scale, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// float to int of any width and byte order, 16 frames per iteration
+
+// 16 int32 to 2, 3 or 4 bytes, the low bytes of each sample are kept
+template <long width, bool swap>
+static inline ASIO_SSE41 void storeInt32x16(char *out, __m128i v[4])
+{
+	if(width == 2)
+	{
+		__m128i lo = truncate16(v[0], v[1]);
+		__m128i hi = truncate16(v[2], v[3]);
+		if(swap)
+		{
+			lo = _mm_shuffle_epi8(lo, swap16Mask());
+			hi = _mm_shuffle_epi8(hi, swap16Mask());
+		}
+		_mm_storeu_si128((__m128i*)out, lo);
+		_mm_storeu_si128((__m128i*)(out + 16), hi);
+	}
+	else if(width == 3)
+		pack24x16(out, swap ? low24MSBMask() : low24LSBMask(), v[0], v[1], v[2], v[3]);
+	else
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			if(swap)
+				v[j] = _mm_shuffle_epi8(v[j], swap32Mask());
+			_mm_storeu_si128((__m128i*)(out + j * 16), v[j]);
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long float32toIntLoop(const float *in, char *out, const SaturationSSE2 &sc, long frames)
+{
+	__m128i clips = _mm_setzero_si128();
+	for(long i = 0; i < frames; i += 16)
+	{
+		__m128i v[4];
+		for(int j = 0; j < 4; j++)
+			v[j] = floatToInt4(_mm_loadu_ps(in + i + j * 4), sc, clips);
+		storeInt32x16<width, swap>(out + i * width, v);
+	}
+	return clipCount(clips);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long float32toIntFrames(const float *source, char *out, double scale, long frames)
+{
+	long n = frames & ~15L;
+	long clipped = float32toIntLoop<width, swap>(source, out, saturationSSE2(scale), n);
+	return clipped + scalarFloat32toInt<width, swap>(source + n, out + n * width, scale, frames - n);
+}
+
+static ASIO_SSE41 long float32toIntSSE41(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return float32toIntFrames<2, false>(source, out, scale, frames);
+	case 5: return float32toIntFrames<2, true>(source, out, scale, frames);
+	case 6: return float32toIntFrames<3, false>(source, out, scale, frames);
+	case 7: return float32toIntFrames<3, true>(source, out, scale, frames);
+	case 8: return float32toIntFrames<4, false>(source, out, scale, frames);
+	case 9: return float32toIntFrames<4, true>(source, out, scale, frames);
+	}
+	return 0;
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long float64toIntLoop(const double *in, char *out, const SaturationSSE2 &sc, long frames)
+{
+	__m128i clips = _mm_setzero_si128();
+	for(long i = 0; i < frames; i += 16)
+	{
+		__m128i v[4];
+		for(int j = 0; j < 4; j++)
+			v[j] = doubleToInt4(_mm_loadu_pd(in + i + j * 4), _mm_loadu_pd(in + i + j * 4 + 2), sc, clips);
+		storeInt32x16<width, swap>(out + i * width, v);
+	}
+	return clipCount(clips);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long float64toIntFrames(const double *source, char *out, double scale, long frames)
+{
+	long n = frames & ~15L;
+	long clipped = float64toIntLoop<width, swap>(source, out, saturationSSE2(scale), n);
+	return clipped + scalarFloat64toInt<width, swap>(source + n, out + n * width, scale, frames - n);
+}
+
+static ASIO_SSE41 long float64toIntSSE41(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, double scale, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return float64toIntFrames<2, false>(source, out, scale, frames);
+	case 5: return float64toIntFrames<2, true>(source, out, scale, frames);
+	case 6: return float64toIntFrames<3, false>(source, out, scale, frames);
+	case 7: return float64toIntFrames<3, true>(source, out, scale, frames);
+	case 8: return float64toIntFrames<4, false>(source, out, scale, frames);
+	case 9: return float64toIntFrames<4, true>(source, out, scale, frames);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// float32 and float64 samples in either byte order, 4 frames per iteration.
+// Widening runs backwards and narrowing forwards so that both work in place.
+
+template <bool swap>
+static inline ASIO_SSE41 __m128 loadFloat4(const char *in)
+{
+	__m128i v = _mm_loadu_si128((const __m128i*)in);
+	return _mm_castsi128_ps(swap ? _mm_shuffle_epi8(v, swap32Mask()) : v);
+}
+
+template <bool swap>
+static inline ASIO_SSE41 __m128d loadDouble2(const char *in)
+{
+	__m128i v = _mm_loadu_si128((const __m128i*)in);
+	return _mm_castsi128_pd(swap ? _mm_shuffle_epi8(v, swap64Mask()) : v);
+}
+
+template <bool swap>
+static inline ASIO_SSE41 void storeFloat4(char *out, __m128 x)
+{
+	__m128i v = _mm_castps_si128(x);
+	_mm_storeu_si128((__m128i*)out, swap ? _mm_shuffle_epi8(v, swap32Mask()) : v);
+}
+
+template <bool swap>
+static inline ASIO_SSE41 void storeDouble2(char *out, __m128d x)
+{
+	__m128i v = _mm_castpd_si128(x);
+	_mm_storeu_si128((__m128i*)out, swap ? _mm_shuffle_epi8(v, swap64Mask()) : v);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void floatToFloat32Loop(const char *in, float *out, long frames)
+{
+	for(long i = 0; i < frames; i += 4)
+	{
+		if(width == 4)
+			_mm_storeu_ps(out + i, loadFloat4<swap>(in + i * 4));
+		else
+			_mm_storeu_ps(out + i, _mm_movelh_ps(_mm_cvtpd_ps(loadDouble2<swap>(in + i * 8)),
+				_mm_cvtpd_ps(loadDouble2<swap>(in + i * 8 + 16))));
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void floatToFloat64Loop(const char *in, double *out, long frames)
+{
+	for(long i = frames - 4; i >= 0; i -= 4)
+	{
+		__m128d lo, hi;
+		if(width == 4)
+		{
+			__m128 x = loadFloat4<swap>(in + i * 4);
+			lo = _mm_cvtps_pd(x);
+			hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+		}
+		else
+		{
+			lo = loadDouble2<swap>(in + i * 8);
+			hi = loadDouble2<swap>(in + i * 8 + 16);
+		}
+		_mm_storeu_pd(out + i + 2, hi);
+		_mm_storeu_pd(out + i, lo);
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void float32toFloatLoop(const float *in, char *out, long frames)
+{
+	for(long i = frames - 4; i >= 0; i -= 4)
+	{
+		__m128 x = _mm_loadu_ps(in + i);
+		if(width == 4)
+			storeFloat4<swap>(out + i * 4, x);
+		else
+		{
+			storeDouble2<swap>(out + i * 8 + 16, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+			storeDouble2<swap>(out + i * 8, _mm_cvtps_pd(x));
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void float64toFloatLoop(const double *in, char *out, long frames)
+{
+	for(long i = 0; i < frames; i += 4)
+	{
+		__m128d lo = _mm_loadu_pd(in + i);
+		__m128d hi = _mm_loadu_pd(in + i + 2);
+		if(width == 4)
+			storeFloat4<swap>(out + i * 4, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+		else
+		{
+			storeDouble2<swap>(out + i * 8, lo);
+			storeDouble2<swap>(out + i * 8 + 16, hi);
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void floatToFloat32Frames(const char *in, float *dest, long frames)
+{
+	long n = frames & ~3L;
+	floatToFloat32Loop<width, swap>(in, dest, n);
+	scalarFloatToFloat32<width, swap>(in + n * width, dest + n, frames - n);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void floatToFloat64Frames(const char *in, double *dest, long frames)
+{
+	long n = frames & ~3L;
+	scalarFloatToFloat64<width, swap>(in + n * width, dest + n, frames - n);
+	floatToFloat64Loop<width, swap>(in, dest, n);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void float32toFloatFrames(const float *source, char *out, long frames)
+{
+	long n = frames & ~3L;
+	scalarFloat32toFloat<width, swap>(source + n, out + n * width, frames - n);
+	float32toFloatLoop<width, swap>(source, out, n);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void float64toFloatFrames(const double *source, char *out, long frames)
+{
+	long n = frames & ~3L;
+	float64toFloatLoop<width, swap>(source, out, n);
+	scalarFloat64toFloat<width, swap>(source + n, out + n * width, frames - n);
+}
+
+static ASIO_SSE41 void floatToFloat32SSE41(const void *source, float *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: floatToFloat32Frames<4, false>(in, dest, frames); break;
+	case 9: floatToFloat32Frames<4, true>(in, dest, frames); break;
+	case 16: floatToFloat32Frames<8, false>(in, dest, frames); break;
+	case 17: floatToFloat32Frames<8, true>(in, dest, frames); break;
+	}
+}
+
+static ASIO_SSE41 void floatToFloat64SSE41(const void *source, double *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	const char* in = (const char*)source;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: floatToFloat64Frames<4, false>(in, dest, frames); break;
+	case 9: floatToFloat64Frames<4, true>(in, dest, frames); break;
+	case 16: floatToFloat64Frames<8, false>(in, dest, frames); break;
+	case 17: floatToFloat64Frames<8, true>(in, dest, frames); break;
+	}
+}
+
+static ASIO_SSE41 void float32toFloatSSE41(const float *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: float32toFloatFrames<4, false>(source, out, frames); break;
+	case 9: float32toFloatFrames<4, true>(source, out, frames); break;
+	case 16: float32toFloatFrames<8, false>(source, out, frames); break;
+	case 17: float32toFloatFrames<8, true>(source, out, frames); break;
+	}
+}
+
+static ASIO_SSE41 void float64toFloatSSE41(const double *source, void *dest, long byteWidth,
+	bool reverseEndian, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: float64toFloatFrames<4, false>(source, out, frames); break;
+	case 9: float64toFloatFrames<4, true>(source, out, frames); break;
+	case 16: float64toFloatFrames<8, false>(source, out, frames); break;
+	case 17: float64toFloatFrames<8, true>(source, out, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// gain and mix, 16 frames per iteration. The sources are summed in four registers in the
+// order of the reference, then converted like float32toIntLoop and float32toFloatLoop.
+
+static inline ASIO_SSE41 void mix16(const float *const *sources, const float *gains, long numSources,
+	long i, __m128 m[4])
+{
+	// named accumulators, an array would be kept in memory across the source loop
+	__m128 m0 = _mm_setzero_ps(), m1 = m0, m2 = m0, m3 = m0;
+	for(long s = 0; s < numSources; s++)
+	{
+		__m128 g = _mm_set1_ps(gains[s]);
+		const float* in = sources[s] + i;
+		m0 = _mm_add_ps(m0, _mm_mul_ps(g, _mm_loadu_ps(in)));
+		m1 = _mm_add_ps(m1, _mm_mul_ps(g, _mm_loadu_ps(in + 4)));
+		m2 = _mm_add_ps(m2, _mm_mul_ps(g, _mm_loadu_ps(in + 8)));
+		m3 = _mm_add_ps(m3, _mm_mul_ps(g, _mm_loadu_ps(in + 12)));
+	}
+	m[0] = m0;
+	m[1] = m1;
+	m[2] = m2;
+	m[3] = m3;
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long mixToIntLoop(const float *const *sources, const float *gains, long numSources,
+	char *out, const SaturationSSE2 &sc, long frames)
+{
+	__m128i clips = _mm_setzero_si128();
+	for(long i = 0; i < frames; i += 16)
+	{
+		__m128 m[4];
+		__m128i v[4];
+		mix16(sources, gains, numSources, i, m);
+		for(int j = 0; j < 4; j++)
+			v[j] = floatToInt4(m[j], sc, clips);
+		storeInt32x16<width, swap>(out + i * width, v);
+	}
+	return clipCount(clips);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void mixToFloatLoop(const float *const *sources, const float *gains, long numSources,
+	char *out, long frames)
+{
+	for(long i = 0; i < frames; i += 16)
+	{
+		__m128 m[4];
+		mix16(sources, gains, numSources, i, m);
+		for(int j = 0; j < 4; j++)
+		{
+			char* o = out + (i + j * 4) * width;
+			if(width == 4)
+				storeFloat4<swap>(o, m[j]);
+			else
+			{
+				storeDouble2<swap>(o, _mm_cvtps_pd(m[j]));
+				storeDouble2<swap>(o + 16, _mm_cvtps_pd(_mm_movehl_ps(m[j], m[j])));
+			}
+		}
+	}
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long mixToIntFrames(const float *const *sources, const float *gains, long numSources,
+	char *out, double scale, long frames)
+{
+	long n = frames & ~15L;
+	long clipped = mixToIntLoop<width, swap>(sources, gains, numSources, out, saturationSSE2(scale), n);
+	return clipped + scalarMixToInt<width, swap>(sources, gains, numSources, out, scale, n, frames);
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 void mixToFloatFrames(const float *const *sources, const float *gains, long numSources,
+	char *out, long frames)
+{
+	long n = frames & ~15L;
+	mixToFloatLoop<width, swap>(sources, gains, numSources, out, n);
+	scalarMixToFloat<width, swap>(sources, gains, numSources, out, n, frames);
+}
+
+static ASIO_SSE41 long mixToIntSSE41(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, double scale, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return mixToIntFrames<2, false>(sources, gains, numSources, out, scale, frames);
+	case 5: return mixToIntFrames<2, true>(sources, gains, numSources, out, scale, frames);
+	case 6: return mixToIntFrames<3, false>(sources, gains, numSources, out, scale, frames);
+	case 7: return mixToIntFrames<3, true>(sources, gains, numSources, out, scale, frames);
+	case 8: return mixToIntFrames<4, false>(sources, gains, numSources, out, scale, frames);
+	case 9: return mixToIntFrames<4, true>(sources, gains, numSources, out, scale, frames);
+	}
+	return 0;
+}
+
+static ASIO_SSE41 void mixToFloatSSE41(const float *const *sources, const float *gains, long numSources,
+	void *dest, long byteWidth, bool reverseEndian, long frames)
+{
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 8: mixToFloatFrames<4, false>(sources, gains, numSources, out, frames); break;
+	case 9: mixToFloatFrames<4, true>(sources, gains, numSources, out, frames); break;
+	case 16: mixToFloatFrames<8, false>(sources, gains, numSources, out, frames); break;
+	case 17: mixToFloatFrames<8, true>(sources, gains, numSources, out, frames); break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// requantizer, 16 frames per iteration starting at generator 0
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long requantizeLoop(ASIORequantizer *r, const float *in, char *out, long bits, long frames)
+{
+	const double scale = (double)((1LL << (bits - 1)) - 1);
+	const __m128d sc = _mm_set1_pd(scale);
+	const __m128d lo = _mm_set1_pd(-scale - 1.);
+	const __m128d hi = _mm_set1_pd(scale);
+	__m128i rng[2] = { _mm_loadu_si128((const __m128i*)r->rng), _mm_loadu_si128((const __m128i*)(r->rng + 4)) };
+	__m128i dither = _mm_setzero_si128();
+	__m128i clips = _mm_setzero_si128();
+	for(long i = 0; i < frames; i += 16)
+	{
+		__m128i v[4];
+		for(int j = 0; j < 4; j++)
+		{
+			if(r->dither)
+			{
+				rng[j & 1] = xorshift4(rng[j & 1]);
+				dither = tpdf4(rng[j & 1]);
+			}
+			v[j] = requantize4(_mm_loadu_ps(in + i + j * 4), dither, sc, lo, hi, clips);
+		}
+		storeInt32x16<width, swap>(out + i * width, v);
+	}
+	_mm_storeu_si128((__m128i*)r->rng, rng[0]);
+	_mm_storeu_si128((__m128i*)(r->rng + 4), rng[1]);
+	return clipCount(clips);
+}
+
+// the error feedback stays scalar, only the dither is drawn 8 samples at a time
+template <long width, bool swap>
+static inline ASIO_SSE41 long requantizeShaped(ASIORequantizer *r, const float *in, char *out, long bits, long frames)
+{
+	int dither[64] = { 0 };
+	long clipped = 0;
+	__m128i rng[2] = { _mm_loadu_si128((const __m128i*)r->rng), _mm_loadu_si128((const __m128i*)(r->rng + 4)) };
+	for(long i = 0; i < frames; i += 64)
+	{
+		long n = frames - i < 64 ? frames - i : 64;
+		for(long j = 0; r->dither && j < n; j += 4)
+		{
+			rng[(j >> 2) & 1] = xorshift4(rng[(j >> 2) & 1]);
+			_mm_storeu_si128((__m128i*)(dither + j), tpdf4(rng[(j >> 2) & 1]));
+		}
+		clipped += scalarRequantizeBlock<width, swap>(r, in + i, out + i * width, bits, dither, n);
+	}
+	_mm_storeu_si128((__m128i*)r->rng, rng[0]);
+	_mm_storeu_si128((__m128i*)(r->rng + 4), rng[1]);
+	return clipped;
+}
+
+template <long width, bool swap>
+static inline ASIO_SSE41 long requantizeFrames(ASIORequantizer *requantizer, const float *source, char *out,
+	long bits, long frames)
+{
+	// the vector loops start at generator 0
+	long head = requantizer->dither ? (8 - requantizer->lane) & 7 : 0;
+	if(head > frames)
+		head = frames;
+	long clipped = scalarRequantize<width, swap>(requantizer, source, out, bits, head);
+	source += head;
+	out += head * width;
+	frames -= head;
+
+	long n = frames & ~15L;
+	if(requantizer->shaping)
+		clipped += requantizeShaped<width, swap>(requantizer, source, out, bits, n);
+	else
+		clipped += requantizeLoop<width, swap>(requantizer, source, out, bits, n);
+	return clipped + scalarRequantize<width, swap>(requantizer, source + n, out + n * width, bits, frames - n);
+}
+
+static ASIO_SSE41 long requantizeSSE41(ASIORequantizer *requantizer, const float *source, void *dest,
+	long byteWidth, bool reverseEndian, long bits, long frames)
+{
+	if(bits < 2 || bits > byteWidth * 8)
+		return 0;
+	char* out = (char*)dest;
+	switch(byteWidth * 2 + (reverseEndian ? 1 : 0))
+	{
+	case 4: return requantizeFrames<2, false>(requantizer, source, out, bits, frames);
+	case 5: return requantizeFrames<2, true>(requantizer, source, out, bits, frames);
+	case 6: return requantizeFrames<3, false>(requantizer, source, out, bits, frames);
+	case 7: return requantizeFrames<3, true>(requantizer, source, out, bits, frames);
+	case 8: return requantizeFrames<4, false>(requantizer, source, out, bits, frames);
+	case 9: return requantizeFrames<4, true>(requantizer, source, out, bits, frames);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// channel converters, see ASIOInstallChannels()
+
+struct ChannelsSSE41
+{
+	template <long layout, bool swap>
+	static ASIO_SSE41 void toFloat32(ASIOChannelState *, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			floatToFloat32Frames<width, swap>((const char*)source, (float*)dest, frames);
+		else
+			intToFloat32Frames<width, swap>((const char*)source, (float*)dest,
+				(float)ASIOInputScaleOf(ASIOLayoutBits(layout)), frames);
+	}
+
+	template <long layout, bool swap>
+	static ASIO_SSE41 void toFloat64(ASIOChannelState *, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			floatToFloat64Frames<width, swap>((const char*)source, (double*)dest, frames);
+		else
+			intToFloat64Frames<width, swap>((const char*)source, (double*)dest,
+				ASIOInputScaleOf(ASIOLayoutBits(layout)), frames);
+	}
+
+	template <long layout, bool swap>
+	static ASIO_SSE41 void fromFloat32(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			float32toFloatFrames<width, swap>((const float*)source, (char*)dest, frames);
+		else
+			ASIOCountClips(state, float32toIntFrames<width, swap>((const float*)source, (char*)dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+
+	template <long layout, bool swap>
+	static ASIO_SSE41 void fromFloat64(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			float64toFloatFrames<width, swap>((const double*)source, (char*)dest, frames);
+		else
+			ASIOCountClips(state, float64toIntFrames<width, swap>((const double*)source, (char*)dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+
+	template <long layout, bool swap>
+	static ASIO_SSE41 void requantize(ASIOChannelState *state, const void *source, void *dest, long frames)
+	{
+		ASIOCountClips(state, requantizeFrames<ASIOLayoutBytes(layout), swap>(&state->requantizer,
+			(const float*)source, (char*)dest, ASIOLayoutBits(layout), frames));
+	}
+
+	template <long layout, bool swap>
+	static ASIO_SSE41 void mix(ASIOChannelState *state, const float *const *sources, const float *gains,
+		long numSources, void *dest, long frames)
+	{
+		constexpr long width = ASIOLayoutBytes(layout);
+		if(ASIOLayoutIsFloat(layout))
+			mixToFloatFrames<width, swap>(sources, gains, numSources, (char*)dest, frames);
+		else
+			ASIOCountClips(state, mixToIntFrames<width, swap>(sources, gains, numSources, (char*)dest,
+				ASIOOutputScaleOf(ASIOLayoutBits(layout)), frames));
+	}
+};
+
+void ASIOInstallSSE41Kernels(ASIOConvertKernels *k)
+{
+	k->float32toInt16 = float32toInt16SSE41;
+	k->float32toInt24 = float32toInt24SSE41;
+	k->int32toInt24LSB = int32toInt24LSBSSE41;
+	k->int32toInt24MSB = int32toInt24MSBSSE41;
+	k->int24LSBtoInt32 = int24LSBtoInt32SSE41;
+	k->int24MSBtoInt32 = int24MSBtoInt32SSE41;
+	k->int24LSBtoInt16 = int24LSBtoInt16SSE41;
+	k->int24MSBtoInt16 = int24MSBtoInt16SSE41;
+	k->stereoInt32toInt24LSB = stereoInt32toInt24LSBSSE41;
+	k->stereoInt32toInt24MSB = stereoInt32toInt24MSBSSE41;
+	k->shift32 = shift32SSE41;
+	k->reverseEndian = reverseEndianSSE41;
+	k->interleave = interleaveSSE41;
+	k->deinterleave = deinterleaveSSE41;
+	k->intToFloat32 = intToFloat32SSE41;
+	k->intToFloat64 = intToFloat64SSE41;
+	k->floatToFloat32 = floatToFloat32SSE41;
+	k->floatToFloat64 = floatToFloat64SSE41;
+	k->float32toInt = float32toIntSSE41;
+	k->float64toInt = float64toIntSSE41;
+	k->float32toFloat = float32toFloatSSE41;
+	k->float64toFloat = float64toFloatSSE41;
+	k->requantize = requantizeSSE41;
+	k->mixToInt = mixToIntSSE41;
+	k->mixToFloat = mixToFloatSSE41;
+	ASIOInstallChannels<ChannelsSSE41>(k);
+}
+
+#endif
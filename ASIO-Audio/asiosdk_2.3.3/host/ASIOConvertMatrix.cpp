@@ -0,0 +1,155 @@
+#include "ginclude.h"
+#include "asio.h"
+#include "ASIOConvertMatrix.h"
+#include <string.h>
+#include <utility>
+
+//-------------------------------------------------------------------------------------------
+// sample formats
+
+static constexpr ASIOSampleFormat makeFormat(long byteWidth, long bits, bool isFloat, bool msb)
+{
+#if ASIO_LITTLE_ENDIAN
+	return ASIOSampleFormat{ byteWidth, bits, isFloat, msb };
+#else
+	return ASIOSampleFormat{ byteWidth, bits, isFloat, !msb };
+#endif
+}
+
+// byteWidth 0 marks the types without a pcm layout
+static constexpr ASIOSampleFormat formatOf(long sampleType)
+{
+	switch(sampleType)
+	{
+	case ASIOSTInt16MSB:	return makeFormat(2, 16, false, true);
+	case ASIOSTInt24MSB:	return makeFormat(3, 24, false, true);
+	case ASIOSTInt32MSB:	return makeFormat(4, 32, false, true);
+	case ASIOSTFloat32MSB:	return makeFormat(4, 32, true, true);
+	case ASIOSTFloat64MSB:	return makeFormat(8, 64, true, true);
+	case ASIOSTInt32MSB16:	return makeFormat(4, 16, false, true);
+	case ASIOSTInt32MSB18:	return makeFormat(4, 18, false, true);
+	case ASIOSTInt32MSB20:	return makeFormat(4, 20, false, true);
+	case ASIOSTInt32MSB24:	return makeFormat(4, 24, false, true);
+	case ASIOSTInt16LSB:	return makeFormat(2, 16, false, false);
+	case ASIOSTInt24LSB:	return makeFormat(3, 24, false, false);
+	case ASIOSTInt32LSB:	return makeFormat(4, 32, false, false);
+	case ASIOSTFloat32LSB:	return makeFormat(4, 32, true, false);
+	case ASIOSTFloat64LSB:	return makeFormat(8, 64, true, false);
+	case ASIOSTInt32LSB16:	return makeFormat(4, 16, false, false);
+	case ASIOSTInt32LSB18:	return makeFormat(4, 18, false, false);
+	case ASIOSTInt32LSB20:	return makeFormat(4, 20, false, false);
+	case ASIOSTInt32LSB24:	return makeFormat(4, 24, false, false);
+	}
+	return makeFormat(0, 0, false, false);
+}
+
+// the channel converters of a pcm format
+static constexpr long layoutOf(ASIOSampleFormat f)
+{
+	return f.isFloat ? (f.byteWidth == 8 ? kASIOLayoutFloat64 : kASIOLayoutFloat32)
+		: f.byteWidth == 2 ? kASIOLayoutInt16
+		: f.byteWidth == 3 ? kASIOLayoutInt24
+		: f.bits == 16 ? kASIOLayoutInt32x16
+		: f.bits == 18 ? kASIOLayoutInt32x18
+		: f.bits == 20 ? kASIOLayoutInt32x20
+		: f.bits == 24 ? kASIOLayoutInt32x24 : kASIOLayoutInt32;
+}
+
+
+void ASIOInitChannelState(ASIOChannelState *state, unsigned int seed, bool dither, ASIONoiseShaping shaping)
+{
+	ASIOInitRequantizer(&state->requantizer, seed, dither, shaping);
+	state->clips.samples.store(0, std::memory_order_relaxed);
+}
+
+unsigned long long ASIOGetClipCount(const ASIOChannelState *state)
+{
+	return state->clips.samples.load(std::memory_order_relaxed);
+}
+
+
+//-------------------------------------------------------------------------------------------
+// the matrix, one row per ASIOSampleType
+
+typedef struct MatrixRow
+{
+	ASIOSampleFormat format;
+	long layout;			// ASIOSampleLayout
+} MatrixRow;
+
+typedef struct Matrix
+{
+	MatrixRow rows[ASIOSTLastEntry];
+} Matrix;
+
+template <size_t... sampleTypes>
+static constexpr Matrix makeMatrix(std::index_sequence<sampleTypes...>)
+{
+	return Matrix{ { MatrixRow{ formatOf((long)sampleTypes), layoutOf(formatOf((long)sampleTypes)) }... } };
+}
+
+static constexpr Matrix matrix = makeMatrix(std::make_index_sequence<ASIOSTLastEntry>());
+
+static const MatrixRow *rowOf(long sampleType)
+{
+	if(sampleType < 0 || sampleType >= ASIOSTLastEntry || !matrix.rows[sampleType].format.byteWidth)
+		return 0;
+	return &matrix.rows[sampleType];
+}
+
+ASIOChannelConverter ASIOGetInputConverter(long sampleType, ASIOHostSampleFormat host)
+{
+	const MatrixRow* row = rowOf(sampleType);
+	if(!row || host < 0 || host >= kASIONumHostFormats)
+		return 0;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(host == kASIOHostFloat32)
+		return k->channelToFloat32[row->layout][row->format.reverseEndian];
+	return k->channelToFloat64[row->layout][row->format.reverseEndian];
+}
+
+ASIOChannelConverter ASIOGetOutputConverter(long sampleType, ASIOHostSampleFormat host)
+{
+	const MatrixRow* row = rowOf(sampleType);
+	if(!row || host < 0 || host >= kASIONumHostFormats)
+		return 0;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(host == kASIOHostFloat32)
+		return k->channelFromFloat32[row->layout][row->format.reverseEndian];
+	return k->channelFromFloat64[row->layout][row->format.reverseEndian];
+}
+
+ASIOChannelConverter ASIOGetRequantizingOutputConverter(long sampleType, ASIOHostSampleFormat host)
+{
+	// dither only makes sense down to 24 bits, the wider formats keep the plain output
+	const MatrixRow* row = rowOf(sampleType);
+	if(row && host == kASIOHostFloat32 && row->layout < kASIONumDitheredLayouts)
+		return ASIOGetConvertKernels()->channelRequantize[row->layout][row->format.reverseEndian];
+	return ASIOGetOutputConverter(sampleType, host);
+}
+
+ASIOChannelMixer ASIOGetOutputMixer(long sampleType)
+{
+	const MatrixRow* row = rowOf(sampleType);
+	return row ? ASIOGetConvertKernels()->channelMix[row->layout][row->format.reverseEndian] : 0;
+}
+
+bool ASIOGetSampleFormat(long sampleType, ASIOSampleFormat *format)
+{
+	const MatrixRow* row = rowOf(sampleType);
+	if(!row)
+		return false;
+	*format = row->format;
+	return true;
+}
+
+double ASIOGetSampleScale(const ASIOSampleFormat *format)
+{
+	// a power of two, the products stay exact
+	return ASIOInputScaleOf(format->bits);
+}
+
+double ASIOGetOutputScale(const ASIOSampleFormat *format)
+{
+	return ASIOOutputScaleOf(format->bits);
+}
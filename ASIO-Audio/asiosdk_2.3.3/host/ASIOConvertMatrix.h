@@ -0,0 +1,55 @@
+#ifndef __ASIOConvertMatrix__
+#define __ASIOConvertMatrix__
+
+// Converters between the device buffers of every ASIOSampleType and the
+// host's own sample format. Each instruction set has one converter per sample
+// layout, byte order and host format in the kernel table, with the format as
+// template arguments. A host looks them up once when the buffers are created,
+// after ASIOSelectConvertKernels, and the buffer switch makes one call per
+// channel that doesn't branch on the format. A converter keeps the kernels it
+// was looked up with.
+
+#include "ASIOConvertKernels.h"
+
+enum ASIOHostSampleFormat
+{
+	kASIOHostFloat32 = 0,		// native float, -1..1
+	kASIOHostFloat64,			// native double, -1..1
+	kASIONumHostFormats
+};
+
+// seed should differ per channel so that the dither of the channels is uncorrelated.
+// Also clears the clip counter, call it before the buffers run.
+void ASIOInitChannelState(ASIOChannelState *state, unsigned int seed, bool dither, ASIONoiseShaping shaping);
+
+// clipped samples since ASIOInitChannelState, safe to call from any thread
+unsigned long long ASIOGetClipCount(const ASIOChannelState *state);
+
+// device input to host samples, 0 for the DSD and unknown types
+ASIOChannelConverter ASIOGetInputConverter(long sampleType, ASIOHostSampleFormat host);
+
+// host samples to device output, 0 for the DSD and unknown types. Integer
+// outputs saturate and count the clipped samples in the channel state.
+ASIOChannelConverter ASIOGetOutputConverter(long sampleType, ASIOHostSampleFormat host);
+
+// like ASIOGetOutputConverter, but the integer outputs of up to 24 bits (Int16,
+// Int24 and Int32xx16..24) are requantized with the dither and noise shaping
+// set in the channel state. The other types and the float64 host get the
+// plain converter.
+ASIOChannelConverter ASIOGetRequantizingOutputConverter(long sampleType, ASIOHostSampleFormat host);
+
+// mixing output for float32 host samples, 0 for the DSD and unknown types. Integer
+// outputs saturate and count the clipped samples like ASIOGetOutputConverter.
+ASIOChannelMixer ASIOGetOutputMixer(long sampleType);
+
+// sampleType is an ASIOSampleType, false for DSD and unknown types
+bool ASIOGetSampleFormat(long sampleType, ASIOSampleFormat *format);
+
+// integer full scale of a format to -1..1, 1 / 2^(bits - 1)
+double ASIOGetSampleScale(const ASIOSampleFormat *format);
+
+// -1..1 to the integer full scale of a format for the saturating outputs,
+// 2^(bits - 1) - 1 with the same rounding as the fixed width converters
+double ASIOGetOutputScale(const ASIOSampleFormat *format);
+
+#endif
@@ -0,0 +1,975 @@
+#ifndef __ASIOConvertSIMD__
+#define __ASIOConvertSIMD__
+
+// helpers shared by the SSE2, SSE4.1 and AVX2 kernels, each one is compiled
+// for the lowest instruction set it needs so every kernel file can use it
+
+#include "ASIOConvertScalar.h"
+
+#if ASIO_CONVERT_X86
+
+#include <immintrin.h>
+#include <math.h>
+
+#define ASIO_SSE2 ASIO_TARGET("sse2")
+#define ASIO_SSSE3 ASIO_TARGET("ssse3")
+#define ASIO_SSE41 ASIO_TARGET("sse4.1")
+#define ASIO_AVX2 ASIO_TARGET("avx2")
+#define ASIO_AVX512 ASIO_TARGET("avx512f")
+
+//-------------------------------------------------------------------------------------------
+// float to int
+
+// constants of the saturating conversions, see saturateToInt() of the reference
+typedef struct SaturationSSE2
+{
+	__m128d scale;
+	__m128d lo;			// -floor(scale) - 1
+	__m128d hi;			// floor(scale)
+	__m128d below;		// the truncation of values up to here doesn't fit
+	__m128d above;		// and from here on
+} SaturationSSE2;
+
+static inline ASIO_SSE2 SaturationSSE2 saturationSSE2(double scale)
+{
+	double hi = floor(scale);
+	SaturationSSE2 s = { _mm_set1_pd(scale), _mm_set1_pd(-hi - 1.), _mm_set1_pd(hi),
+		_mm_set1_pd(-hi - 2.), _mm_set1_pd(hi + 1.) };
+	return s;
+}
+
+// 2 doubles, NaN to 0 and clamped, clipped lanes are all ones in the returned mask
+static inline ASIO_SSE2 __m128d saturate2(__m128d &d, const SaturationSSE2 &s)
+{
+	__m128d clipped = _mm_or_pd(_mm_cmpngt_pd(d, s.below), _mm_cmpnlt_pd(d, s.above));
+	d = _mm_min_pd(_mm_max_pd(_mm_and_pd(d, _mm_cmpord_pd(d, d)), s.lo), s.hi);
+	return clipped;
+}
+
+// 4 doubles to 4 saturated int32, same rounding as the scalar reference.
+// Each clipped sample subtracts 1 from a lane of clips.
+static inline ASIO_SSE2 __m128i doubleToInt4(__m128d lo, __m128d hi, const SaturationSSE2 &s, __m128i &clips)
+{
+	lo = _mm_mul_pd(lo, s.scale);
+	hi = _mm_mul_pd(hi, s.scale);
+	__m128d clo = saturate2(lo, s);
+	__m128d chi = saturate2(hi, s);
+	clips = _mm_add_epi32(clips, _mm_castps_si128(
+		_mm_shuffle_ps(_mm_castpd_ps(clo), _mm_castpd_ps(chi), _MM_SHUFFLE(2, 0, 2, 0))));
+	return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+
+static inline ASIO_SSE2 __m128i floatToInt4(__m128 x, const SaturationSSE2 &s, __m128i &clips)
+{
+	return doubleToInt4(_mm_cvtps_pd(x), _mm_cvtps_pd(_mm_movehl_ps(x, x)), s, clips);
+}
+
+static inline ASIO_SSE2 __m128i floatToInt4(__m128 x, const SaturationSSE2 &s)
+{
+	__m128i clips = _mm_setzero_si128();
+	return floatToInt4(x, s, clips);
+}
+
+static inline ASIO_SSE2 long clipCount(__m128i clips)
+{
+	clips = _mm_add_epi32(clips, _mm_shuffle_epi32(clips, _MM_SHUFFLE(1, 0, 3, 2)));
+	clips = _mm_add_epi32(clips, _mm_shuffle_epi32(clips, _MM_SHUFFLE(2, 3, 0, 1)));
+	return -(long)_mm_cvtsi128_si32(clips);
+}
+
+// keep the low 16 bits of each int32 like the (short) cast of the reference
+static inline ASIO_SSE2 __m128i truncate16(__m128i a, __m128i b)
+{
+	a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+	b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+	return _mm_packs_epi32(a, b);
+}
+
+//-------------------------------------------------------------------------------------------
+// requantizer, the same generator and arithmetic as ASIORequantizeBlock
+
+// one xorshift32 step per generator
+static inline ASIO_SSE2 __m128i xorshift4(__m128i x)
+{
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+	return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+// generator output to triangular dither in 1/65536 lsb
+static inline ASIO_SSE2 __m128i tpdf4(__m128i x)
+{
+	__m128i sum = _mm_add_epi32(_mm_srli_epi32(x, 16), _mm_and_si128(x, _mm_set1_epi32(0xffff)));
+	return _mm_sub_epi32(sum, _mm_set1_epi32(65535));
+}
+
+// clipped lanes, NaN or saturated, are all ones in the returned mask
+static inline ASIO_SSE2 __m128d requantize2(__m128d &y, __m128i dither, __m128d lo, __m128d hi)
+{
+	__m128d unordered = _mm_cmpunord_pd(y, y);
+	y = _mm_andnot_pd(unordered, y);		// NaN to 0
+	y = _mm_add_pd(y, _mm_mul_pd(_mm_cvtepi32_pd(dither), _mm_set1_pd(1. / 65536.)));
+	__m128d clipped = _mm_or_pd(_mm_cmplt_pd(y, lo), _mm_cmpgt_pd(y, hi));
+	y = _mm_min_pd(_mm_max_pd(y, lo), hi);
+	return _mm_or_pd(clipped, unordered);
+}
+
+// 4 floats to 4 dithered, rounded and saturated int32, clipped samples
+// subtract 1 from a lane of clips like floatToInt4()
+static inline ASIO_SSE2 __m128i requantize4(__m128 x, __m128i dither, __m128d sc, __m128d lo, __m128d hi,
+	__m128i &clips)
+{
+	__m128d a = _mm_mul_pd(_mm_cvtps_pd(x), sc);
+	__m128d b = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), sc);
+	__m128d ca = requantize2(a, dither, lo, hi);
+	__m128d cb = requantize2(b, _mm_unpackhi_epi64(dither, dither), lo, hi);
+	clips = _mm_add_epi32(clips, _mm_castps_si128(
+		_mm_shuffle_ps(_mm_castpd_ps(ca), _mm_castpd_ps(cb), _MM_SHUFFLE(2, 0, 2, 0))));
+	return _mm_unpacklo_epi64(_mm_cvtpd_epi32(a), _mm_cvtpd_epi32(b));
+}
+
+static inline ASIO_AVX2 __m256i xorshift8(__m256i x)
+{
+	x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+	return _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+}
+
+static inline ASIO_AVX2 __m256i tpdf8(__m256i x)
+{
+	__m256i sum = _mm256_add_epi32(_mm256_srli_epi32(x, 16), _mm256_and_si256(x, _mm256_set1_epi32(0xffff)));
+	return _mm256_sub_epi32(sum, _mm256_set1_epi32(65535));
+}
+
+static inline ASIO_AVX2 __m256d requantize4(__m256d &y, __m128i dither, __m256d lo, __m256d hi)
+{
+	__m256d unordered = _mm256_cmp_pd(y, y, _CMP_UNORD_Q);
+	y = _mm256_andnot_pd(unordered, y);
+	y = _mm256_add_pd(y, _mm256_mul_pd(_mm256_cvtepi32_pd(dither), _mm256_set1_pd(1. / 65536.)));
+	__m256d clipped = _mm256_or_pd(_mm256_cmp_pd(y, lo, _CMP_LT_OQ), _mm256_cmp_pd(y, hi, _CMP_GT_OQ));
+	y = _mm256_min_pd(_mm256_max_pd(y, lo), hi);
+	return _mm256_or_pd(clipped, unordered);
+}
+
+static inline ASIO_AVX2 __m256i requantize8(const float *source, __m256i dither, __m256d sc, __m256d lo, __m256d hi,
+	__m256i &clips)
+{
+	__m256d a = _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(source)), sc);
+	__m256d b = _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(source + 4)), sc);
+	__m256d ca = requantize4(a, _mm256_castsi256_si128(dither), lo, hi);
+	__m256d cb = requantize4(b, _mm256_extracti128_si256(dither, 1), lo, hi);
+	clips = _mm256_add_epi32(clips, _mm256_castps_si256(
+		_mm256_shuffle_ps(_mm256_castpd_ps(ca), _mm256_castpd_ps(cb), _MM_SHUFFLE(2, 0, 2, 0))));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvtpd_epi32(a)), _mm256_cvtpd_epi32(b), 1);
+}
+
+//-------------------------------------------------------------------------------------------
+// packed 24 bit
+
+// byte shuffles for the packed 24 bit formats, -1 clears the byte.
+// pack masks take the upper three bytes of each int32 into 12 bytes,
+// unpack masks spread 12 bytes into the upper three bytes of each int32
+static inline ASIO_SSE2 __m128i pack24LSBMask()
+{
+	return _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+}
+
+static inline ASIO_SSE2 __m128i pack24MSBMask()
+{
+	return _mm_setr_epi8(3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1);
+}
+
+static inline ASIO_SSE2 __m128i unpack24LSBMask()
+{
+	return _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+}
+
+static inline ASIO_SSE2 __m128i unpack24MSBMask()
+{
+	return _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+}
+
+// low three bytes of each int32, for 24 bit values that are not left aligned
+static inline ASIO_SSE2 __m128i low24LSBMask()
+{
+	return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+}
+
+static inline ASIO_SSE2 __m128i low24MSBMask()
+{
+	return _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+}
+
+// upper two bytes of each 24 bit sample as native int16, in the low 8 bytes
+static inline ASIO_SSE2 __m128i int24LSBto16Mask()
+{
+	return _mm_setr_epi8(1, 2, 4, 5, 7, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1);
+}
+
+static inline ASIO_SSE2 __m128i int24MSBto16Mask()
+{
+	return _mm_setr_epi8(1, 0, 4, 3, 7, 6, 10, 9, -1, -1, -1, -1, -1, -1, -1, -1);
+}
+
+// byte swaps
+static inline ASIO_SSE2 __m128i swap16Mask()
+{
+	return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+}
+
+static inline ASIO_SSE2 __m128i swap24Mask()
+{
+	return _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, -1, -1, -1, -1);
+}
+
+static inline ASIO_SSE2 __m128i swap32Mask()
+{
+	return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+}
+
+static inline ASIO_SSE2 __m128i swap64Mask()
+{
+	return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+}
+
+// upper two bytes of each int32, in the low 8 bytes
+static inline ASIO_SSE2 __m128i upper16Mask()
+{
+	return _mm_setr_epi8(2, 3, 6, 7, 10, 11, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+}
+
+// 16 int32, already shuffled to 12 valid bytes each, into 48 bytes
+static inline ASIO_SSSE3 void store24x16(char *dest, __m128i v0, __m128i v1, __m128i v2, __m128i v3)
+{
+	_mm_storeu_si128((__m128i*)dest, _mm_or_si128(v0, _mm_slli_si128(v1, 12)));
+	_mm_storeu_si128((__m128i*)(dest + 16), _mm_or_si128(_mm_srli_si128(v1, 4), _mm_slli_si128(v2, 8)));
+	_mm_storeu_si128((__m128i*)(dest + 32), _mm_or_si128(_mm_srli_si128(v2, 8), _mm_slli_si128(v3, 4)));
+}
+
+static inline ASIO_SSSE3 void pack24x16(char *dest, __m128i mask, __m128i v0, __m128i v1, __m128i v2, __m128i v3)
+{
+	store24x16(dest, _mm_shuffle_epi8(v0, mask), _mm_shuffle_epi8(v1, mask),
+		_mm_shuffle_epi8(v2, mask), _mm_shuffle_epi8(v3, mask));
+}
+
+// 48 bytes into four registers holding 12 bytes (4 samples) each at the bottom
+static inline ASIO_SSSE3 void load24x16(const char *source, __m128i g[4])
+{
+	__m128i in0 = _mm_loadu_si128((const __m128i*)source);
+	__m128i in1 = _mm_loadu_si128((const __m128i*)(source + 16));
+	__m128i in2 = _mm_loadu_si128((const __m128i*)(source + 32));
+	g[0] = in0;
+	g[1] = _mm_alignr_epi8(in1, in0, 12);
+	g[2] = _mm_alignr_epi8(in2, in1, 8);
+	g[3] = _mm_srli_si128(in2, 4);
+}
+
+// 32 int32, already shuffled to 12 valid bytes per lane, into 96 bytes.
+// The lanes are compacted to 24 bytes and stored overlapping, the last
+// store is split so nothing beyond the 96 bytes is written
+static inline ASIO_AVX2 void store24x32(char *dest, __m256i v0, __m256i v1, __m256i v2, __m256i v3)
+{
+	const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+	v0 = _mm256_permutevar8x32_epi32(v0, compact);
+	v1 = _mm256_permutevar8x32_epi32(v1, compact);
+	v2 = _mm256_permutevar8x32_epi32(v2, compact);
+	v3 = _mm256_permutevar8x32_epi32(v3, compact);
+	_mm256_storeu_si256((__m256i*)dest, v0);
+	_mm256_storeu_si256((__m256i*)(dest + 24), v1);
+	_mm256_storeu_si256((__m256i*)(dest + 48), v2);
+	_mm_storeu_si128((__m128i*)(dest + 72), _mm256_castsi256_si128(v3));
+	_mm_storel_epi64((__m128i*)(dest + 88), _mm256_extracti128_si256(v3, 1));
+}
+
+static inline ASIO_AVX2 void pack24x32(char *dest, __m256i mask, __m256i v0, __m256i v1, __m256i v2, __m256i v3)
+{
+	store24x32(dest, _mm256_shuffle_epi8(v0, mask), _mm256_shuffle_epi8(v1, mask),
+		_mm256_shuffle_epi8(v2, mask), _mm256_shuffle_epi8(v3, mask));
+}
+
+// 96 bytes into four registers holding 12 bytes per lane, never reads past the 96 bytes
+static inline ASIO_AVX2 void load24x32(const char *source, __m256i g[4])
+{
+	for(int i = 0; i < 3; i++)
+	{
+		__m128i lo = _mm_loadu_si128((const __m128i*)(source + i * 24));
+		__m128i hi = _mm_loadu_si128((const __m128i*)(source + i * 24 + 12));
+		g[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+	}
+	__m128i lo = _mm_loadu_si128((const __m128i*)(source + 72));
+	__m128i hi = _mm_srli_si128(_mm_loadu_si128((const __m128i*)(source + 80)), 4);
+	g[3] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+//-------------------------------------------------------------------------------------------
+// tile transposes for the interleave, row i of the tile becomes column i
+
+static inline ASIO_SSE2 void transpose8x16(__m128i r[8])
+{
+	__m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	__m128i a1 = _mm_unpacklo_epi16(r[2], r[3]);
+	__m128i a2 = _mm_unpacklo_epi16(r[4], r[5]);
+	__m128i a3 = _mm_unpacklo_epi16(r[6], r[7]);
+	__m128i a4 = _mm_unpackhi_epi16(r[0], r[1]);
+	__m128i a5 = _mm_unpackhi_epi16(r[2], r[3]);
+	__m128i a6 = _mm_unpackhi_epi16(r[4], r[5]);
+	__m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+	__m128i b0 = _mm_unpacklo_epi32(a0, a1);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a1);
+	__m128i b2 = _mm_unpacklo_epi32(a2, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a2, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a5);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a5);
+	__m128i b6 = _mm_unpacklo_epi32(a6, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a6, a7);
+	r[0] = _mm_unpacklo_epi64(b0, b2);
+	r[1] = _mm_unpackhi_epi64(b0, b2);
+	r[2] = _mm_unpacklo_epi64(b1, b3);
+	r[3] = _mm_unpackhi_epi64(b1, b3);
+	r[4] = _mm_unpacklo_epi64(b4, b6);
+	r[5] = _mm_unpackhi_epi64(b4, b6);
+	r[6] = _mm_unpacklo_epi64(b5, b7);
+	r[7] = _mm_unpackhi_epi64(b5, b7);
+}
+
+static inline ASIO_SSE2 void transpose16x8(__m128i r[16])
+{
+	// a0-a7 pair rows 2i and 2i + 1 in columns 0-7, a8-a15 in columns 8-15
+	__m128i a0 = _mm_unpacklo_epi8(r[0], r[1]);
+	__m128i a1 = _mm_unpacklo_epi8(r[2], r[3]);
+	__m128i a2 = _mm_unpacklo_epi8(r[4], r[5]);
+	__m128i a3 = _mm_unpacklo_epi8(r[6], r[7]);
+	__m128i a4 = _mm_unpacklo_epi8(r[8], r[9]);
+	__m128i a5 = _mm_unpacklo_epi8(r[10], r[11]);
+	__m128i a6 = _mm_unpacklo_epi8(r[12], r[13]);
+	__m128i a7 = _mm_unpacklo_epi8(r[14], r[15]);
+	__m128i a8 = _mm_unpackhi_epi8(r[0], r[1]);
+	__m128i a9 = _mm_unpackhi_epi8(r[2], r[3]);
+	__m128i a10 = _mm_unpackhi_epi8(r[4], r[5]);
+	__m128i a11 = _mm_unpackhi_epi8(r[6], r[7]);
+	__m128i a12 = _mm_unpackhi_epi8(r[8], r[9]);
+	__m128i a13 = _mm_unpackhi_epi8(r[10], r[11]);
+	__m128i a14 = _mm_unpackhi_epi8(r[12], r[13]);
+	__m128i a15 = _mm_unpackhi_epi8(r[14], r[15]);
+	// b(4k + i) holds columns 4k..4k + 3 of rows 4i..4i + 3
+	__m128i b0 = _mm_unpacklo_epi16(a0, a1);
+	__m128i b1 = _mm_unpacklo_epi16(a2, a3);
+	__m128i b2 = _mm_unpacklo_epi16(a4, a5);
+	__m128i b3 = _mm_unpacklo_epi16(a6, a7);
+	__m128i b4 = _mm_unpackhi_epi16(a0, a1);
+	__m128i b5 = _mm_unpackhi_epi16(a2, a3);
+	__m128i b6 = _mm_unpackhi_epi16(a4, a5);
+	__m128i b7 = _mm_unpackhi_epi16(a6, a7);
+	__m128i b8 = _mm_unpacklo_epi16(a8, a9);
+	__m128i b9 = _mm_unpacklo_epi16(a10, a11);
+	__m128i b10 = _mm_unpacklo_epi16(a12, a13);
+	__m128i b11 = _mm_unpacklo_epi16(a14, a15);
+	__m128i b12 = _mm_unpackhi_epi16(a8, a9);
+	__m128i b13 = _mm_unpackhi_epi16(a10, a11);
+	__m128i b14 = _mm_unpackhi_epi16(a12, a13);
+	__m128i b15 = _mm_unpackhi_epi16(a14, a15);
+	// c(4k + 2h + i) holds columns 4k + 2h and 4k + 2h + 1 of rows 8i..8i + 7
+	__m128i c0 = _mm_unpacklo_epi32(b0, b1);
+	__m128i c1 = _mm_unpacklo_epi32(b2, b3);
+	__m128i c2 = _mm_unpackhi_epi32(b0, b1);
+	__m128i c3 = _mm_unpackhi_epi32(b2, b3);
+	__m128i c4 = _mm_unpacklo_epi32(b4, b5);
+	__m128i c5 = _mm_unpacklo_epi32(b6, b7);
+	__m128i c6 = _mm_unpackhi_epi32(b4, b5);
+	__m128i c7 = _mm_unpackhi_epi32(b6, b7);
+	__m128i c8 = _mm_unpacklo_epi32(b8, b9);
+	__m128i c9 = _mm_unpacklo_epi32(b10, b11);
+	__m128i c10 = _mm_unpackhi_epi32(b8, b9);
+	__m128i c11 = _mm_unpackhi_epi32(b10, b11);
+	__m128i c12 = _mm_unpacklo_epi32(b12, b13);
+	__m128i c13 = _mm_unpacklo_epi32(b14, b15);
+	__m128i c14 = _mm_unpackhi_epi32(b12, b13);
+	__m128i c15 = _mm_unpackhi_epi32(b14, b15);
+	r[0] = _mm_unpacklo_epi64(c0, c1);
+	r[1] = _mm_unpackhi_epi64(c0, c1);
+	r[2] = _mm_unpacklo_epi64(c2, c3);
+	r[3] = _mm_unpackhi_epi64(c2, c3);
+	r[4] = _mm_unpacklo_epi64(c4, c5);
+	r[5] = _mm_unpackhi_epi64(c4, c5);
+	r[6] = _mm_unpacklo_epi64(c6, c7);
+	r[7] = _mm_unpackhi_epi64(c6, c7);
+	r[8] = _mm_unpacklo_epi64(c8, c9);
+	r[9] = _mm_unpackhi_epi64(c8, c9);
+	r[10] = _mm_unpacklo_epi64(c10, c11);
+	r[11] = _mm_unpackhi_epi64(c10, c11);
+	r[12] = _mm_unpacklo_epi64(c12, c13);
+	r[13] = _mm_unpackhi_epi64(c12, c13);
+	r[14] = _mm_unpacklo_epi64(c14, c15);
+	r[15] = _mm_unpackhi_epi64(c14, c15);
+}
+
+static inline ASIO_SSE2 void transpose4x32(__m128i r[4])
+{
+	__m128i a0 = _mm_unpacklo_epi32(r[0], r[1]);
+	__m128i a1 = _mm_unpacklo_epi32(r[2], r[3]);
+	__m128i a2 = _mm_unpackhi_epi32(r[0], r[1]);
+	__m128i a3 = _mm_unpackhi_epi32(r[2], r[3]);
+	r[0] = _mm_unpacklo_epi64(a0, a1);
+	r[1] = _mm_unpackhi_epi64(a0, a1);
+	r[2] = _mm_unpacklo_epi64(a2, a3);
+	r[3] = _mm_unpackhi_epi64(a2, a3);
+}
+
+static inline ASIO_SSE2 void transpose2x64(__m128i r[2])
+{
+	__m128i a0 = _mm_unpacklo_epi64(r[0], r[1]);
+	r[1] = _mm_unpackhi_epi64(r[0], r[1]);
+	r[0] = a0;
+}
+
+static inline ASIO_AVX2 void transpose8x32(__m256i r[8])
+{
+	__m256i a0 = _mm256_unpacklo_epi32(r[0], r[1]);
+	__m256i a1 = _mm256_unpackhi_epi32(r[0], r[1]);
+	__m256i a2 = _mm256_unpacklo_epi32(r[2], r[3]);
+	__m256i a3 = _mm256_unpackhi_epi32(r[2], r[3]);
+	__m256i a4 = _mm256_unpacklo_epi32(r[4], r[5]);
+	__m256i a5 = _mm256_unpackhi_epi32(r[4], r[5]);
+	__m256i a6 = _mm256_unpacklo_epi32(r[6], r[7]);
+	__m256i a7 = _mm256_unpackhi_epi32(r[6], r[7]);
+	__m256i b0 = _mm256_unpacklo_epi64(a0, a2);
+	__m256i b1 = _mm256_unpackhi_epi64(a0, a2);
+	__m256i b2 = _mm256_unpacklo_epi64(a1, a3);
+	__m256i b3 = _mm256_unpackhi_epi64(a1, a3);
+	__m256i b4 = _mm256_unpacklo_epi64(a4, a6);
+	__m256i b5 = _mm256_unpackhi_epi64(a4, a6);
+	__m256i b6 = _mm256_unpacklo_epi64(a5, a7);
+	__m256i b7 = _mm256_unpackhi_epi64(a5, a7);
+	r[0] = _mm256_permute2x128_si256(b0, b4, 0x20);
+	r[1] = _mm256_permute2x128_si256(b1, b5, 0x20);
+	r[2] = _mm256_permute2x128_si256(b2, b6, 0x20);
+	r[3] = _mm256_permute2x128_si256(b3, b7, 0x20);
+	r[4] = _mm256_permute2x128_si256(b0, b4, 0x31);
+	r[5] = _mm256_permute2x128_si256(b1, b5, 0x31);
+	r[6] = _mm256_permute2x128_si256(b2, b6, 0x31);
+	r[7] = _mm256_permute2x128_si256(b3, b7, 0x31);
+}
+
+static inline ASIO_AVX2 void transpose4x64(__m256i r[4])
+{
+	__m256i a0 = _mm256_unpacklo_epi64(r[0], r[1]);
+	__m256i a1 = _mm256_unpackhi_epi64(r[0], r[1]);
+	__m256i a2 = _mm256_unpacklo_epi64(r[2], r[3]);
+	__m256i a3 = _mm256_unpackhi_epi64(r[2], r[3]);
+	r[0] = _mm256_permute2x128_si256(a0, a2, 0x20);
+	r[1] = _mm256_permute2x128_si256(a1, a3, 0x20);
+	r[2] = _mm256_permute2x128_si256(a0, a2, 0x31);
+	r[3] = _mm256_permute2x128_si256(a1, a3, 0x31);
+}
+
+//-------------------------------------------------------------------------------------------
+// n channel interleave, the SSE2 and SSSE3 paths every kernel file falls back to
+
+// 24 bit tile of 4x4 samples, 12 bytes at the bottom of each row. The rows
+// are spread to int32 lanes for the transpose and packed again.
+static inline ASIO_SSSE3 void transpose4x24(__m128i r[4])
+{
+	const __m128i unpack = unpack24LSBMask();
+	const __m128i pack = pack24LSBMask();
+	__m128i a0 = _mm_shuffle_epi8(r[0], unpack);
+	__m128i a1 = _mm_shuffle_epi8(r[1], unpack);
+	__m128i a2 = _mm_shuffle_epi8(r[2], unpack);
+	__m128i a3 = _mm_shuffle_epi8(r[3], unpack);
+	__m128i b0 = _mm_unpacklo_epi32(a0, a1);
+	__m128i b1 = _mm_unpacklo_epi32(a2, a3);
+	__m128i b2 = _mm_unpackhi_epi32(a0, a1);
+	__m128i b3 = _mm_unpackhi_epi32(a2, a3);
+	r[0] = _mm_shuffle_epi8(_mm_unpacklo_epi64(b0, b1), pack);
+	r[1] = _mm_shuffle_epi8(_mm_unpackhi_epi64(b0, b1), pack);
+	r[2] = _mm_shuffle_epi8(_mm_unpacklo_epi64(b2, b3), pack);
+	r[3] = _mm_shuffle_epi8(_mm_unpackhi_epi64(b2, b3), pack);
+}
+
+// the low 12 bytes of v, nothing beyond
+static inline ASIO_SSE2 void store12(char *dest, __m128i v)
+{
+	_mm_storel_epi64((__m128i*)dest, v);
+	_mm_store_ss((float*)(dest + 8), _mm_castsi128_ps(_mm_srli_si128(v, 8)));
+}
+
+// the rows of a tile, unrolled so that the tile stays in registers. Row i
+// is at p + i * stride, or offset bytes into channels[i].
+template <std::size_t... i>
+static inline ASIO_SSE2 void loadRows(__m128i *r, const char *p, long stride, std::index_sequence<i...>)
+{
+	int expand[] = { (r[i] = _mm_loadu_si128((const __m128i*)(p + (long)i * stride)), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_SSE2 void storeRows(char *p, long stride, const __m128i *r, std::index_sequence<i...>)
+{
+	int expand[] = { (_mm_storeu_si128((__m128i*)(p + (long)i * stride), r[i]), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_SSE2 void loadChannels(__m128i *r, const void *const *channels, long offset, std::index_sequence<i...>)
+{
+	int expand[] = { (r[i] = _mm_loadu_si128((const __m128i*)((const char*)channels[i] + offset)), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_SSE2 void storeChannels(void *const *channels, long offset, const __m128i *r, std::index_sequence<i...>)
+{
+	int expand[] = { (_mm_storeu_si128((__m128i*)((char*)channels[i] + offset), r[i]), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_AVX2 void loadRows(__m256i *r, const char *p, long stride, std::index_sequence<i...>)
+{
+	int expand[] = { (r[i] = _mm256_loadu_si256((const __m256i*)(p + (long)i * stride)), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_AVX2 void storeRows(char *p, long stride, const __m256i *r, std::index_sequence<i...>)
+{
+	int expand[] = { (_mm256_storeu_si256((__m256i*)(p + (long)i * stride), r[i]), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_AVX2 void loadChannels(__m256i *r, const void *const *channels, long offset, std::index_sequence<i...>)
+{
+	int expand[] = { (r[i] = _mm256_loadu_si256((const __m256i*)((const char*)channels[i] + offset)), 0)... };
+	(void)expand;
+}
+
+template <std::size_t... i>
+static inline ASIO_AVX2 void storeChannels(void *const *channels, long offset, const __m256i *r, std::index_sequence<i...>)
+{
+	int expand[] = { (_mm256_storeu_si256((__m256i*)((char*)channels[i] + offset), r[i]), 0)... };
+	(void)expand;
+}
+
+// tiles of 16x16 8 bit, 8x8 16 bit, 4x4 32 bit or 2x2 64 bit samples, 8 bit
+// has half tiles for 8 channels left over
+static inline ASIO_SSE2 void transposeTile(__m128i *r, long byteWidth)
+{
+	if(byteWidth == 1)
+		transpose16x8(r);
+	else if(byteWidth == 2)
+		transpose8x16(r);
+	else if(byteWidth == 4)
+		transpose4x32(r);
+	else
+		transpose2x64(r);
+}
+
+// rows 2i and 2i + 1 of 8 bytes each in the low and high half of v[i]
+template <std::size_t... i>
+static inline ASIO_SSE2 void storeRowPairs(char *p, long stride, const __m128i *v, std::index_sequence<i...>)
+{
+	int expand[] = { (_mm_storel_epi64((__m128i*)(p + (long)i * 2 * stride), v[i]),
+		_mm_storeh_pd((double*)(p + ((long)i * 2 + 1) * stride), _mm_castsi128_pd(v[i])), 0)... };
+	(void)expand;
+}
+
+// rows 2i and 2i + 1 of 8 bytes each interleaved bytewise into a[i]
+template <std::size_t... i>
+static inline ASIO_SSE2 void loadRowPairs8(__m128i *a, const char *p, long stride, std::index_sequence<i...>)
+{
+	int expand[] = { (a[i] = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + (long)i * 2 * stride)),
+		_mm_loadl_epi64((const __m128i*)(p + ((long)i * 2 + 1) * stride))), 0)... };
+	(void)expand;
+}
+
+// 8 bit, 8 channels of 16 frames. Each register ends up holding two rows of
+// 8 bytes, that is 8 frames of a channel or 8 channels of a frame.
+static inline ASIO_SSE2 void interleaveHalfColumn8(const void *const *channels, char *out, long stride, long b, long e)
+{
+	for(long f = b; f < e; f += 16)
+	{
+		__m128i r[8];
+		loadChannels(r, channels, f, std::make_index_sequence<8>());
+		// channel pairs of frames 0-7 and 8-15
+		__m128i a0 = _mm_unpacklo_epi8(r[0], r[1]);
+		__m128i a1 = _mm_unpacklo_epi8(r[2], r[3]);
+		__m128i a2 = _mm_unpacklo_epi8(r[4], r[5]);
+		__m128i a3 = _mm_unpacklo_epi8(r[6], r[7]);
+		__m128i a4 = _mm_unpackhi_epi8(r[0], r[1]);
+		__m128i a5 = _mm_unpackhi_epi8(r[2], r[3]);
+		__m128i a6 = _mm_unpackhi_epi8(r[4], r[5]);
+		__m128i a7 = _mm_unpackhi_epi8(r[6], r[7]);
+		// channels 0-3 and 4-7 of 4 frames each
+		__m128i b0 = _mm_unpacklo_epi16(a0, a1);
+		__m128i b1 = _mm_unpackhi_epi16(a0, a1);
+		__m128i b2 = _mm_unpacklo_epi16(a2, a3);
+		__m128i b3 = _mm_unpackhi_epi16(a2, a3);
+		__m128i b4 = _mm_unpacklo_epi16(a4, a5);
+		__m128i b5 = _mm_unpackhi_epi16(a4, a5);
+		__m128i b6 = _mm_unpacklo_epi16(a6, a7);
+		__m128i b7 = _mm_unpackhi_epi16(a6, a7);
+		// two frames each
+		__m128i v[8] = { _mm_unpacklo_epi32(b0, b2), _mm_unpackhi_epi32(b0, b2),
+			_mm_unpacklo_epi32(b1, b3), _mm_unpackhi_epi32(b1, b3),
+			_mm_unpacklo_epi32(b4, b6), _mm_unpackhi_epi32(b4, b6),
+			_mm_unpacklo_epi32(b5, b7), _mm_unpackhi_epi32(b5, b7) };
+		char* row = out + f * stride;
+		storeRowPairs(row, stride, v, std::make_index_sequence<8>());
+	}
+}
+
+static inline ASIO_SSE2 void deinterleaveHalfColumn8(const char *in, void *const *channels, long stride, long b, long e)
+{
+	for(long f = b; f < e; f += 16)
+	{
+		// frame pairs, the 16 bit lane c is channel c
+		__m128i a[8];
+		loadRowPairs8(a, in + f * stride, stride, std::make_index_sequence<8>());
+		// 4 frames of channels 0-3 and 4-7
+		__m128i b0 = _mm_unpacklo_epi16(a[0], a[1]);
+		__m128i b1 = _mm_unpackhi_epi16(a[0], a[1]);
+		__m128i b2 = _mm_unpacklo_epi16(a[2], a[3]);
+		__m128i b3 = _mm_unpackhi_epi16(a[2], a[3]);
+		__m128i b4 = _mm_unpacklo_epi16(a[4], a[5]);
+		__m128i b5 = _mm_unpackhi_epi16(a[4], a[5]);
+		__m128i b6 = _mm_unpacklo_epi16(a[6], a[7]);
+		__m128i b7 = _mm_unpackhi_epi16(a[6], a[7]);
+		// 8 frames of two channels
+		__m128i c0 = _mm_unpacklo_epi32(b0, b2);
+		__m128i c1 = _mm_unpackhi_epi32(b0, b2);
+		__m128i c2 = _mm_unpacklo_epi32(b1, b3);
+		__m128i c3 = _mm_unpackhi_epi32(b1, b3);
+		__m128i c4 = _mm_unpacklo_epi32(b4, b6);
+		__m128i c5 = _mm_unpackhi_epi32(b4, b6);
+		__m128i c6 = _mm_unpacklo_epi32(b5, b7);
+		__m128i c7 = _mm_unpackhi_epi32(b5, b7);
+		__m128i r[8] = { _mm_unpacklo_epi64(c0, c4), _mm_unpackhi_epi64(c0, c4),
+			_mm_unpacklo_epi64(c1, c5), _mm_unpackhi_epi64(c1, c5),
+			_mm_unpacklo_epi64(c2, c6), _mm_unpackhi_epi64(c2, c6),
+			_mm_unpacklo_epi64(c3, c7), _mm_unpackhi_epi64(c3, c7) };
+		storeChannels(channels, f, r, std::make_index_sequence<8>());
+	}
+}
+
+template <long width>
+static inline ASIO_SSE2 void interleaveTiles128(const void *const *channels, void *dest, long numChannels, long frames)
+{
+	const long size = 16 / width;
+	const long stride = numChannels * width;
+	long tiled = numChannels - numChannels % size;
+	long half = width == 1 ? (numChannels - tiled) & 8 : 0;
+	long n = frames & ~(size - 1);
+	long block = ASIOInterleaveBlockFrames(numChannels, width);
+	char* out = (char*)dest;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += size)
+		{
+			for(long f = b; f < e; f += size)
+			{
+				__m128i r[size];
+				loadChannels(r, channels + c, f * width, std::make_index_sequence<size>());
+				transposeTile(r, width);
+				storeRows(out + f * stride + c * width, stride, r, std::make_index_sequence<size>());
+			}
+		}
+		if(half)
+			interleaveHalfColumn8(channels + tiled, out + tiled, stride, b, e);
+	}
+	ASIOInterleaveRectScalar(channels, dest, numChannels, width, tiled + half, numChannels, 0, n);
+	ASIOInterleaveRectScalar(channels, dest, numChannels, width, 0, numChannels, n, frames);
+}
+
+template <long width>
+static inline ASIO_SSE2 void deinterleaveTiles128(const void *source, void *const *channels, long numChannels, long frames)
+{
+	const long size = 16 / width;
+	const long stride = numChannels * width;
+	long tiled = numChannels - numChannels % size;
+	long half = width == 1 ? (numChannels - tiled) & 8 : 0;
+	long n = frames & ~(size - 1);
+	long block = ASIOInterleaveBlockFrames(numChannels, width);
+	const char* in = (const char*)source;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += size)
+		{
+			for(long f = b; f < e; f += size)
+			{
+				__m128i r[size];
+				loadRows(r, in + f * stride + c * width, stride, std::make_index_sequence<size>());
+				transposeTile(r, width);
+				storeChannels(channels + c, f * width, r, std::make_index_sequence<size>());
+			}
+		}
+		if(half)
+			deinterleaveHalfColumn8(in + tiled, channels + tiled, stride, b, e);
+	}
+	ASIODeinterleaveRectScalar(source, channels, numChannels, width, tiled + half, numChannels, 0, n);
+	ASIODeinterleaveRectScalar(source, channels, numChannels, width, 0, numChannels, n, frames);
+}
+
+// 24 bit in tiles of 4x4, a column of tiles is 4 channels of frames b..e.
+// The 16 byte loads read 4 bytes past the 12 of a row, the tiled frames stop
+// 2 short of the end so that they stay inside the buffers. Only 12 bytes are
+// stored per row.
+static inline ASIO_SSSE3 void interleaveColumn24(const void *const *channels, char *out, long stride, long b, long e)
+{
+	const char* in0 = (const char*)channels[0];
+	const char* in1 = (const char*)channels[1];
+	const char* in2 = (const char*)channels[2];
+	const char* in3 = (const char*)channels[3];
+	for(long f = b; f < e; f += 4)
+	{
+		__m128i r[4] = { _mm_loadu_si128((const __m128i*)(in0 + f * 3)),
+			_mm_loadu_si128((const __m128i*)(in1 + f * 3)),
+			_mm_loadu_si128((const __m128i*)(in2 + f * 3)),
+			_mm_loadu_si128((const __m128i*)(in3 + f * 3)) };
+		transpose4x24(r);
+		char* row = out + f * stride;
+		store12(row, r[0]);
+		store12(row + stride, r[1]);
+		store12(row + stride * 2, r[2]);
+		store12(row + stride * 3, r[3]);
+	}
+}
+
+static inline ASIO_SSSE3 void deinterleaveColumn24(const char *in, void *const *channels, long stride, long b, long e)
+{
+	char* out0 = (char*)channels[0];
+	char* out1 = (char*)channels[1];
+	char* out2 = (char*)channels[2];
+	char* out3 = (char*)channels[3];
+	for(long f = b; f < e; f += 4)
+	{
+		const char* row = in + f * stride;
+		__m128i r[4] = { _mm_loadu_si128((const __m128i*)row),
+			_mm_loadu_si128((const __m128i*)(row + stride)),
+			_mm_loadu_si128((const __m128i*)(row + stride * 2)),
+			_mm_loadu_si128((const __m128i*)(row + stride * 3)) };
+		transpose4x24(r);
+		store12(out0 + f * 3, r[0]);
+		store12(out1 + f * 3, r[1]);
+		store12(out2 + f * 3, r[2]);
+		store12(out3 + f * 3, r[3]);
+	}
+}
+
+static inline ASIO_SSSE3 void interleaveTiles24(const void *const *channels, void *dest, long numChannels, long frames)
+{
+	const long stride = numChannels * 3;
+	long tiled = numChannels & ~3L;
+	long n = frames > 2 ? (frames - 2) & ~3L : 0;
+	long block = ASIOInterleaveBlockFrames(numChannels, 3);
+	char* out = (char*)dest;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += 4)
+			interleaveColumn24(channels + c, out + c * 3, stride, b, e);
+	}
+	ASIOInterleaveRectScalar(channels, dest, numChannels, 3, tiled, numChannels, 0, n);
+	ASIOInterleaveRectScalar(channels, dest, numChannels, 3, 0, numChannels, n, frames);
+}
+
+static inline ASIO_SSSE3 void deinterleaveTiles24(const void *source, void *const *channels, long numChannels, long frames)
+{
+	const long stride = numChannels * 3;
+	long tiled = numChannels & ~3L;
+	long n = frames > 2 ? (frames - 2) & ~3L : 0;
+	long block = ASIOInterleaveBlockFrames(numChannels, 3);
+	const char* in = (const char*)source;
+	for(long b = 0; b < n; b += block)
+	{
+		long e = b + block < n ? b + block : n;
+		for(long c = 0; c < tiled; c += 4)
+			deinterleaveColumn24(in + c * 3, channels + c, stride, b, e);
+	}
+	ASIODeinterleaveRectScalar(source, channels, numChannels, 3, tiled, numChannels, 0, n);
+	ASIODeinterleaveRectScalar(source, channels, numChannels, 3, 0, numChannels, n, frames);
+}
+
+// stereo, the two channels are unpacked into each other
+template <long width>
+static inline ASIO_SSE2 __m128i unpackLo(__m128i a, __m128i b)
+{
+	if(width == 1)
+		return _mm_unpacklo_epi8(a, b);
+	if(width == 2)
+		return _mm_unpacklo_epi16(a, b);
+	if(width == 4)
+		return _mm_unpacklo_epi32(a, b);
+	return _mm_unpacklo_epi64(a, b);
+}
+
+template <long width>
+static inline ASIO_SSE2 __m128i unpackHi(__m128i a, __m128i b)
+{
+	if(width == 1)
+		return _mm_unpackhi_epi8(a, b);
+	if(width == 2)
+		return _mm_unpackhi_epi16(a, b);
+	if(width == 4)
+		return _mm_unpackhi_epi32(a, b);
+	return _mm_unpackhi_epi64(a, b);
+}
+
+// the even samples of a then b into left, the odd ones into right
+template <long width>
+static inline ASIO_SSE2 void splitStereo(__m128i a, __m128i b, __m128i &left, __m128i &right)
+{
+	if(width == 1)
+	{
+		const __m128i low = _mm_set1_epi16(0xff);
+		left = _mm_packus_epi16(_mm_and_si128(a, low), _mm_and_si128(b, low));
+		right = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+	}
+	else if(width == 2)
+	{
+		// sign extended so that the saturating pack leaves them alone
+		left = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+		right = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+	}
+	else if(width == 4)
+	{
+		__m128 x = _mm_castsi128_ps(a);
+		__m128 y = _mm_castsi128_ps(b);
+		left = _mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)));
+		right = _mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	else
+	{
+		left = _mm_unpacklo_epi64(a, b);
+		right = _mm_unpackhi_epi64(a, b);
+	}
+}
+
+template <long width>
+static inline ASIO_SSE2 void interleaveStereo128(const void *const *channels, void *dest, long frames)
+{
+	const long size = 16 / width;
+	const char* left = (const char*)channels[0];
+	const char* right = (const char*)channels[1];
+	char* out = (char*)dest;
+	long n = frames & ~(size - 1);
+	for(long f = 0; f < n; f += size)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(left + f * width));
+		__m128i b = _mm_loadu_si128((const __m128i*)(right + f * width));
+		_mm_storeu_si128((__m128i*)(out + f * width * 2), unpackLo<width>(a, b));
+		_mm_storeu_si128((__m128i*)(out + f * width * 2 + 16), unpackHi<width>(a, b));
+	}
+	ASIOInterleaveRectScalar(channels, dest, 2, width, 0, 2, n, frames);
+}
+
+template <long width>
+static inline ASIO_SSE2 void deinterleaveStereo128(const void *source, void *const *channels, long frames)
+{
+	const long size = 16 / width;
+	const char* in = (const char*)source;
+	char* left = (char*)channels[0];
+	char* right = (char*)channels[1];
+	long n = frames & ~(size - 1);
+	for(long f = 0; f < n; f += size)
+	{
+		__m128i l, r;
+		splitStereo<width>(_mm_loadu_si128((const __m128i*)(in + f * width * 2)),
+			_mm_loadu_si128((const __m128i*)(in + f * width * 2 + 16)), l, r);
+		_mm_storeu_si128((__m128i*)(left + f * width), l);
+		_mm_storeu_si128((__m128i*)(right + f * width), r);
+	}
+	ASIODeinterleaveRectScalar(source, channels, 2, width, 0, 2, n, frames);
+}
+
+// 24 bit stereo, 16 frames spread to int32 lanes, unpacked and packed again
+static inline ASIO_SSSE3 void interleaveStereo24(const void *const *channels, void *dest, long frames)
+{
+	const __m128i unpack = unpack24LSBMask();
+	const __m128i pack = pack24LSBMask();
+	const char* left = (const char*)channels[0];
+	const char* right = (const char*)channels[1];
+	char* out = (char*)dest;
+	long n = frames & ~15L;
+	for(long f = 0; f < n; f += 16)
+	{
+		__m128i l[4], r[4];
+		load24x16(left + f * 3, l);
+		load24x16(right + f * 3, r);
+		__m128i a0 = _mm_shuffle_epi8(l[0], unpack);
+		__m128i a1 = _mm_shuffle_epi8(l[1], unpack);
+		__m128i a2 = _mm_shuffle_epi8(l[2], unpack);
+		__m128i a3 = _mm_shuffle_epi8(l[3], unpack);
+		__m128i b0 = _mm_shuffle_epi8(r[0], unpack);
+		__m128i b1 = _mm_shuffle_epi8(r[1], unpack);
+		__m128i b2 = _mm_shuffle_epi8(r[2], unpack);
+		__m128i b3 = _mm_shuffle_epi8(r[3], unpack);
+		pack24x16(out + f * 6, pack, _mm_unpacklo_epi32(a0, b0), _mm_unpackhi_epi32(a0, b0),
+			_mm_unpacklo_epi32(a1, b1), _mm_unpackhi_epi32(a1, b1));
+		pack24x16(out + f * 6 + 48, pack, _mm_unpacklo_epi32(a2, b2), _mm_unpackhi_epi32(a2, b2),
+			_mm_unpacklo_epi32(a3, b3), _mm_unpackhi_epi32(a3, b3));
+	}
+	ASIOInterleaveRectScalar(channels, dest, 2, 3, 0, 2, n, frames);
+}
+
+static inline ASIO_SSSE3 void deinterleaveStereo24(const void *source, void *const *channels, long frames)
+{
+	const __m128i unpack = unpack24LSBMask();
+	const __m128i pack = pack24LSBMask();
+	const char* in = (const char*)source;
+	char* left = (char*)channels[0];
+	char* right = (char*)channels[1];
+	long n = frames & ~15L;
+	for(long f = 0; f < n; f += 16)
+	{
+		__m128i g[8], l[4], r[4];
+		load24x16(in + f * 6, g);
+		load24x16(in + f * 6 + 48, g + 4);
+		splitStereo<4>(_mm_shuffle_epi8(g[0], unpack), _mm_shuffle_epi8(g[1], unpack), l[0], r[0]);
+		splitStereo<4>(_mm_shuffle_epi8(g[2], unpack), _mm_shuffle_epi8(g[3], unpack), l[1], r[1]);
+		splitStereo<4>(_mm_shuffle_epi8(g[4], unpack), _mm_shuffle_epi8(g[5], unpack), l[2], r[2]);
+		splitStereo<4>(_mm_shuffle_epi8(g[6], unpack), _mm_shuffle_epi8(g[7], unpack), l[3], r[3]);
+		pack24x16(left + f * 3, pack, l[0], l[1], l[2], l[3]);
+		pack24x16(right + f * 3, pack, r[0], r[1], r[2], r[3]);
+	}
+	ASIODeinterleaveRectScalar(source, channels, 2, 3, 0, 2, n, frames);
+}
+
+template <long width>
+static inline ASIO_SSE2 void interleave128(const void *const *channels, void *dest, long numChannels, long frames)
+{
+	if(numChannels == 2)
+		interleaveStereo128<width>(channels, dest, frames);
+	else
+		interleaveTiles128<width>(channels, dest, numChannels, frames);
+}
+
+template <long width>
+static inline ASIO_SSE2 void deinterleave128(const void *source, void *const *channels, long numChannels, long frames)
+{
+	if(numChannels == 2)
+		deinterleaveStereo128<width>(source, channels, frames);
+	else
+		deinterleaveTiles128<width>(source, channels, numChannels, frames);
+}
+
+static inline ASIO_SSSE3 void interleave24(const void *const *channels, void *dest, long numChannels, long frames)
+{
+	if(numChannels == 2)
+		interleaveStereo24(channels, dest, frames);
+	else
+		interleaveTiles24(channels, dest, numChannels, frames);
+}
+
+static inline ASIO_SSSE3 void deinterleave24(const void *source, void *const *channels, long numChannels, long frames)
+{
+	if(numChannels == 2)
+		deinterleaveStereo24(source, channels, frames);
+	else
+		deinterleaveTiles24(source, channels, numChannels, frames);
+}
+
+#endif
+
+#endif
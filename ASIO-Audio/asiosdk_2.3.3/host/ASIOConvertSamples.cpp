@@ -1,5 +1,7 @@
 #include "ginclude.h"
 #include "ASIOConvertSamples.h"
+#include "ASIOConvertKernels.h"
+#include "ASIOConvertMatrix.h"
 #include <math.h>
 
 #if MAC
@@ -68,41 +70,15 @@ void ASIOConvertSamples::convertMono16(long *source, short *dest, long frames)
 		s += 4;
 	}
 #else
-	long l;
-
-	source--;
-	dest--;
+	int* s = (int*)source;	// the samples are 32 bit, long may be 64
 	while(--frames >= 0)
-	{
-		l = *++source;
-		*++dest = (short)(l >> 16);
-	}	
+		*dest++ = (short)(*s++ >> 16);
 #endif
 }
 
 void ASIOConvertSamples::convertMono24(long *source, char *dest, long frames)
 {
-	// work with chars in order to prevent misalignments
-	char *s = (char *)source;
-	char a, b, c;
-
-	dest--;
-	while(--frames >= 0)
-	{
-#if ASIO_LITTLE_ENDIAN
-		a = s[3];	// msb
-		b = s[2];
-		c = s[1];	// lsb
-#else
-		a = s[0];
-		b = s[1];
-		c = s[2];
-#endif
-		s += 4;
-		*++dest = a;	// big endian, msb first
-		*++dest = b;
-		*++dest = c;
-	}
+	ASIOGetConvertKernels()->int32toInt24MSB(source, dest, frames);
 }
 
 // small endian
@@ -131,27 +107,7 @@ void ASIOConvertSamples::convertMono16SmallEndian(long *source, short *dest, lon
 
 void ASIOConvertSamples::convertMono24SmallEndian(long *source, char *dest, long frames)
 {
-	// work with chars in order to prevent misalignments
-	char *s = (char *)source;
-	char a, b, c;
-
-	dest--;
-	while(--frames >= 0)
-	{
-#if ASIO_LITTLE_ENDIAN
-		a = s[3];
-		b = s[2];
-		c = s[1];
-#else
-		a = s[0];
-		b = s[1];
-		c = s[2];
-#endif
-		s += 4;
-		*++dest = c;	// lsb first
-		*++dest = b;
-		*++dest = a;
-	}
+	ASIOGetConvertKernels()->int32toInt24LSB(source, dest, frames);
 }
 
 
@@ -222,55 +178,19 @@ void ASIOConvertSamples::convertStereo16Interleaved(long *left, long *right, sho
 		sr += 4;
 	}
 #else
-	long l, r;
-
-	left--;
-	right--;
-	dest--;
+	int* l = (int*)left;
+	int* r = (int*)right;
 	while(--frames >= 0)
 	{
-		l = *++left;
-		r = *++right;
-		*++dest = (short)(l >> 16);
-		*++dest = (short)(r >> 16);
+		*dest++ = (short)(*l++ >> 16);
+		*dest++ = (short)(*r++ >> 16);
 	}
 #endif	
 }
 
 void ASIOConvertSamples::convertStereo24Interleaved(long *left, long *right, char *dest, long frames)
 {
-	// work with chars in order to prevent misalignments
-	char *sl = (char *)left;
-	char *sr = (char *)right;
-	char al, bl, cl, ar, br, cr;
-
-	dest--;
-	while(--frames >= 0)
-	{
-#if ASIO_LITTLE_ENDIAN
-		al = sl[3];
-		bl = sl[2];
-		cl = sl[1];
-		ar = sr[3];
-		br = sr[2];
-		cr = sr[1];
-#else
-		al = sl[0];
-		bl = sl[1];
-		cl = sl[2];
-		ar = sr[0];
-		br = sr[1];
-		cr = sr[2];
-#endif
-		sl += 4;
-		sr += 4;
-		*++dest = al;
-		*++dest = bl;
-		*++dest = cl;
-		*++dest = ar;
-		*++dest = br;
-		*++dest = cr;
-	}
+	ASIOGetConvertKernels()->stereoInt32toInt24MSB(left, right, dest, frames);
 }
 
 void ASIOConvertSamples::convertStereo16InterleavedSmallEndian(long *left, long *right, short *dest, long frames)
@@ -305,38 +225,7 @@ void ASIOConvertSamples::convertStereo16InterleavedSmallEndian(long *left, long
 
 void ASIOConvertSamples::convertStereo24InterleavedSmallEndian(long *left, long *right, char *dest, long frames)
 {
-	// work with chars in order to prevent misalignments
-	char *sl = (char *)left;
-	char *sr = (char *)right;
-	char al, bl, cl, ar, br, cr;
-
-	dest--;
-	while(--frames >= 0)
-	{
-#if ASIO_LITTLE_ENDIAN
-		al = sl[3];
-		bl = sl[2];
-		cl = sl[1];
-		ar = sr[3];
-		br = sr[2];
-		cr = sr[1];
-#else
-		al = sl[0];
-		bl = sl[1];
-		cl = sl[2];
-		ar = sr[0];
-		br = sr[1];
-		cr = sr[2];
-#endif
-		sl += 4;
-		sr += 4;
-		*++dest = cl;
-		*++dest = bl;
-		*++dest = al;
-		*++dest = cr;
-		*++dest = br;
-		*++dest = ar;
-	}
+	ASIOGetConvertKernels()->stereoInt32toInt24LSB(left, right, dest, frames);
 }
 
 
@@ -410,57 +299,21 @@ void ASIOConvertSamples::convertStereo16(long *left, long *right, short *dLeft,
 		sr += 4;
 	}
 #else
-	long l, r;
-
-	left--;
-	right--;
-	dLeft--;
-	dRight--;
+	int* l = (int*)left;
+	int* r = (int*)right;
 	while(--frames >= 0)
 	{
-		l = *++left;
-		r = *++right;
-		*++dLeft = (short)(l >> 16);
-		*++dRight = (short)(r >> 16);
+		*dLeft++ = (short)(*l++ >> 16);
+		*dRight++ = (short)(*r++ >> 16);
 	}
 #endif	
 }
 
 void ASIOConvertSamples::convertStereo24(long *left, long *right, char *dLeft, char *dRight, long frames)
 {
-	// work with chars in order to prevent misalignments
-	char *sl = (char *)left;
-	char *sr = (char *)right;
-	char al, bl, cl, ar, br, cr;
-
-	dLeft--;
-	dRight--;
-	while(--frames >= 0)
-	{
-#if ASIO_LITTLE_ENDIAN
-		al = sl[3];
-		bl = sl[2];
-		cl = sl[1];
-		ar = sr[3];
-		br = sr[2];
-		cr = sr[1];
-#else
-		al = sl[0];
-		bl = sl[1];
-		cl = sl[2];
-		ar = sr[0];
-		br = sr[1];
-		cr = sr[2];
-#endif
-		sl += 4;
-		sr += 4;
-		*++dLeft = al;
-		*++dLeft = bl;
-		*++dLeft = cl;
-		*++dRight = ar;
-		*++dRight = br;
-		*++dRight = cr;
-	}
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	k->int32toInt24MSB(left, dLeft, frames);
+	k->int32toInt24MSB(right, dRight, frames);
 }
 
 // small endian
@@ -498,39 +351,22 @@ void ASIOConvertSamples::convertStereo16SmallEndian(long *left, long *right, sho
 
 void ASIOConvertSamples::convertStereo24SmallEndian(long *left, long *right, char *dLeft, char *dRight, long frames)
 {
-	// work with chars in order to prevent misalignments
-	char *sl = (char *)left;
-	char *sr = (char *)right;
-	char al, bl, cl, ar, br, cr;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	k->int32toInt24LSB(left, dLeft, frames);
+	k->int32toInt24LSB(right, dRight, frames);
+}
 
-	dLeft--;
-	dRight--;
-	while(--frames >= 0)
-	{
-#if ASIO_LITTLE_ENDIAN
-		al = sl[3];
-		bl = sl[2];
-		cl = sl[1];
-		ar = sr[3];
-		br = sr[2];
-		cr = sr[1];
-#else
-		al = sl[0];
-		bl = sl[1];
-		cl = sl[2];
-		ar = sr[0];
-		br = sr[1];
-		cr = sr[2];
-#endif
-		sl += 4;
-		sr += 4;
-		*++dLeft = cl;
-		*++dLeft = bl;
-		*++dLeft = al;
-		*++dRight = cr;
-		*++dRight = br;
-		*++dRight = ar;
-	}
+//------------------------------------------------------------------------------------------
+// n channel interleave
+
+void ASIOConvertSamples::interleave(void **channels, void *dest, long numChannels, long byteWidth, long frames)
+{
+	ASIOGetConvertKernels()->interleave(channels, dest, numChannels, byteWidth, frames);
+}
+
+void ASIOConvertSamples::deinterleave(void *source, void **channels, long numChannels, long byteWidth, long frames)
+{
+	ASIOGetConvertKernels()->deinterleave(source, channels, numChannels, byteWidth, frames);
 }
 
 //------------------------------------------------------------------------------------------
@@ -564,9 +400,10 @@ void ASIOConvertSamples::int32lsb16to16inPlace(long *in, long frames)
 	}
 }
 
-void ASIOConvertSamples::int32msb16shiftedTo16inPlace(long *in, long frames, long shift)
+void ASIOConvertSamples::int32msb16shiftedTo16inPlace(long *in1, long frames, long shift)
 {
-	short* out = (short*)in;
+	int* in = (int*)in1;	// the samples are 32 bit, long may be 64
+	short* out = (short*)in1;
 	while(--frames >= 0)
 		*out++ = (short)(*in++ >> shift);
 }
@@ -596,98 +433,12 @@ void ASIOConvertSamples::int24msbto16inPlace(unsigned char *in, long frames)
 void ASIOConvertSamples::shift32(void* buffer, long shiftAmount, long targetByteWidth,
 	bool revertEndian,	long sampleFrames)
 {
-	long a;
-	long frames = sampleFrames;
-	long* source = (long*)buffer;
-	if(revertEndian)
-	{
-		reverseEndian(buffer, 4, sampleFrames);
-		revertEndian = false;
-	}
-
-	if(targetByteWidth == 2)
-	{
-		short* dest = (short*)buffer;
-		short* al = (short*)&a;
-#if ASIO_LITTLE_ENDIAN
-		al++;
-#endif
-		while(--frames >= 0)
-		{
-			a = *source++;
-			a <<= shiftAmount;
-			*dest++ = *al;
-		}
-	}
-	
-	else if(targetByteWidth == 3)
-	{
-		char* dest = (char*)buffer;
-		long* source = (long*)buffer;
-		char* aa = (char*)&a;
-		while(--frames >= 0)
-		{
-			a = *source++;
-			a <<= shiftAmount;
-#if ASIO_LITTLE_ENDIAN
-			dest[0] = aa[1];	// lsb
-			dest[1] = aa[2];
-			dest[2] = aa[3];	// msb
-#else
-			dest[0] = aa[0];	// msb
-			dest[1] = aa[1];
-			dest[2] = aa[2];	// lsb
-#endif
-			dest += 3;
-		}
-	}
-	
-	else if(targetByteWidth == 4)
-	{
-		long* dest = source;
-		while(--frames >= 0)
-			*dest++ = *source++ << shiftAmount;
-	}
+	ASIOGetConvertKernels()->shift32(buffer, buffer, shiftAmount, targetByteWidth, revertEndian, sampleFrames);
 }
 
 void ASIOConvertSamples::reverseEndian(void* buffer, long byteWidth, long frames)
 {
-	char* a = (char*)buffer;
-	char* b = a;
-	char c; 
-	if(byteWidth == 2)
-	{
-		while(--frames >= 0)
-		{
-			c = a[0];
-			a[0] = a[1];
-			a[1] = c;
-			a += 2;
-		}
-	}
-	else if(byteWidth == 3)
-	{
-		while(--frames >= 0)
-		{
-			c = a[0];
-			a[0] = a[2];
-			a[2] = c;
-			a += 3;
-		}
-	}
-	else if(byteWidth == 4)
-	{
-		while(--frames >= 0)
-		{
-			c = a[0];
-			a[0] = a[3];
-			a[3] = c;
-			c = a[1];
-			a[1] = a[2];
-			a[2] = c;
-			a += 4;
-		}
-	}
+	ASIOGetConvertKernels()->reverseEndian(buffer, buffer, byteWidth, frames);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -708,46 +459,20 @@ void ASIOConvertSamples::int32to16inPlace(void* buffer, long frames)
 
 void ASIOConvertSamples::int24to16inPlace(void* buffer, long frames)
 {
-	char* from = (char*)buffer;
-	char* to = from;
-	while(--frames >= 0)
-	{
 #if ASIO_LITTLE_ENDIAN
-		to[0] = from[1];
-		to[1] = from[2];
+	ASIOGetConvertKernels()->int24LSBtoInt16(buffer, buffer, frames);
 #else
-		to[0] = from[0];
-		to[1] = from[1];
+	ASIOGetConvertKernels()->int24MSBtoInt16(buffer, buffer, frames);
 #endif
-		from += 3;
-		to += 2;
-	}
 }
 
 void ASIOConvertSamples::int32to24inPlace(void* buffer, long frames)
 {
-	long* in = (long*)buffer;
-	char* out = (char*)buffer;
-	long a;
-	while(--frames >= 0)
-	{
-		a = *in++;
-		a >>= 8;			// 32->24
 #if ASIO_LITTLE_ENDIAN
-		out[0] = (char)a;	// lsb
-		a >>= 8;
-		out[1] = (char)a;
-		a >>= 8;
-		out[2] = (char)a;
+	ASIOGetConvertKernels()->int32toInt24LSB(buffer, buffer, frames);
 #else
-		out[2] = (char)a;	// lsb
-		a >>= 8;
-		out[1] = (char)a;
-		a >>= 8;
-		out[0] = (char)a;
+	ASIOGetConvertKernels()->int32toInt24MSB(buffer, buffer, frames);
 #endif
-		out += 3;
-	}
 }
 
 void ASIOConvertSamples::int16to24inPlace(void* buffer, long frames)
@@ -774,86 +499,115 @@ void ASIOConvertSamples::int16to24inPlace(void* buffer, long frames)
 
 void ASIOConvertSamples::int24to32inPlace(void* buffer, long frames)
 {
-	long a, b, c;
-	char* in = (char*)buffer;
-	long* out = (long*)buffer;
-	in += (frames * 3);
-	out += frames;
-	while(--frames >= 0)
-	{
 #if ASIO_LITTLE_ENDIAN
-		a = (long)in[-1];	// msb
-		b = (long)in[-2];
-		c = (long)in[-3];
+	ASIOGetConvertKernels()->int24LSBtoInt32(buffer, buffer, frames);
 #else
-		a = (long)in[-3];	// msb
-		b = (long)in[-2];
-		c = (long)in[-1];
+	ASIOGetConvertKernels()->int24MSBtoInt32(buffer, buffer, frames);
 #endif
-		a <<= 24;
-		b <<= 16;
-		b &= 0x00ff0000;
-		a |= b;
-		c <<= 8;
-		c &= 0x0000ff00;
-		a |= c;
-		*--out = a;
-		in -= 3;
-	}
 }
 
 void ASIOConvertSamples::int16to32inPlace(void* buffer, long frames)
 {
 	short* in = (short*)buffer;
-	long* out = (long*)buffer;
+	int* out = (int*)buffer;
 	in += frames;
 	out += frames;
 	while(--frames >= 0)
-		*--out = ((long)(*--in)) << 16;
+		*--out = (int)((unsigned int)(int)*--in << 16);
 }
 
 //------------------------------------------------------------------------------------------
-// float to int
-
-const double fScaler16 = (double)0x7fffL;
-const double fScaler24 = (double)0x7fffffL;
-const double fScaler32 = (double)0x7fffffffL;
+// float to int, runtime dispatched, see ASIOConvertKernels.h
 
 void ASIOConvertSamples::float32toInt16inPlace(float* buffer, long frames)
 {
-	double sc = fScaler16 + .49999;
-	short* b = (short*)buffer;
-	while(--frames >= 0)
-		*b++ = (short)((double)(*buffer++) * sc);
+	ASIOGetConvertKernels()->float32toInt16(buffer, buffer, frames);
 }
 
 void ASIOConvertSamples::float32toInt24inPlace(float* buffer, long frames)
 {
-	double sc = fScaler24 + .49999;
-	long a;
-	char* b = (char*)buffer;
-	char* aa = (char*)&a;
-	
-	while(--frames >= 0)
-	{
-		a = (long)((double)(*buffer++) * sc);
-#if ASIO_LITTLE_ENDIAN
-		*b++ = aa[3];
-		*b++ = aa[2];
-		*b++ = aa[1];
-#else
-		*b++ = aa[1];
-		*b++ = aa[2];
-		*b++ = aa[3];
-#endif
-	}
+	ASIOGetConvertKernels()->float32toInt24(buffer, buffer, frames);
 }
 
 void ASIOConvertSamples::float32toInt32inPlace(float* buffer, long frames)
 {
-	double sc = fScaler32 + .49999;
-	long* b = (long*)buffer;
-	while(--frames >= 0)
-		*b++ = (long)((double)(*buffer++) * sc);
+	ASIOGetConvertKernels()->float32toInt32(buffer, buffer, frames);
+}
+
+//------------------------------------------------------------------------------------------
+// int to float, runtime dispatched. The 32 bit formats with 16..24 bit alignment are
+// scaled by their own full scale in one multiply, there is no shift pass.
+
+bool ASIOConvertSamples::toFloat32(long sampleType, void* source, float* dest, long frames)
+{
+	ASIOSampleFormat format;
+	if(!ASIOGetSampleFormat(sampleType, &format))
+		return false;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(format.isFloat)
+		k->floatToFloat32(source, dest, format.byteWidth, format.reverseEndian, frames);
+	else
+		k->intToFloat32(source, dest, format.byteWidth, format.reverseEndian,
+			(float)ASIOGetSampleScale(&format), frames);
+	return true;
 }
 
+bool ASIOConvertSamples::toFloat64(long sampleType, void* source, double* dest, long frames)
+{
+	ASIOSampleFormat format;
+	if(!ASIOGetSampleFormat(sampleType, &format))
+		return false;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(format.isFloat)
+		k->floatToFloat64(source, dest, format.byteWidth, format.reverseEndian, frames);
+	else
+		k->intToFloat64(source, dest, format.byteWidth, format.reverseEndian,
+			ASIOGetSampleScale(&format), frames);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------
+// float to any format, runtime dispatched
+
+bool ASIOConvertSamples::fromFloat32(long sampleType, float* source, void* dest, long frames)
+{
+	ASIOSampleFormat format;
+	if(!ASIOGetSampleFormat(sampleType, &format))
+		return false;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(format.isFloat)
+		k->float32toFloat(source, dest, format.byteWidth, format.reverseEndian, frames);
+	else
+		k->float32toInt(source, dest, format.byteWidth, format.reverseEndian,
+			ASIOGetOutputScale(&format), frames);
+	return true;
+}
+
+bool ASIOConvertSamples::fromFloat64(long sampleType, double* source, void* dest, long frames)
+{
+	ASIOSampleFormat format;
+	if(!ASIOGetSampleFormat(sampleType, &format))
+		return false;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(format.isFloat)
+		k->float64toFloat(source, dest, format.byteWidth, format.reverseEndian, frames);
+	else
+		k->float64toInt(source, dest, format.byteWidth, format.reverseEndian,
+			ASIOGetOutputScale(&format), frames);
+	return true;
+}
+
+bool ASIOConvertSamples::mixFromFloat32(long sampleType, const float* const* sources, const float* gains,
+	long numSources, void* dest, long frames)
+{
+	ASIOSampleFormat format;
+	if(!ASIOGetSampleFormat(sampleType, &format))
+		return false;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	if(format.isFloat)
+		k->mixToFloat(sources, gains, numSources, dest, format.byteWidth, format.reverseEndian, frames);
+	else
+		k->mixToInt(sources, gains, numSources, dest, format.byteWidth, format.reverseEndian,
+			ASIOGetOutputScale(&format), frames);
+	return true;
+}
@@ -32,6 +32,10 @@ public:
 	void convertStereo24(long *left, long *right, char *dLeft, char *dRight, long frames);
 	void convertStereo24SmallEndian(long *left, long *right, char *dLeft, char *dRight, long frames);
 
+	// n channels, samples of byteWidth bytes are moved unchanged
+	void interleave(void **channels, void *dest, long numChannels, long byteWidth, long frames);
+	void deinterleave(void *source, void **channels, long numChannels, long byteWidth, long frames);
+
 	// integer in place conversions
 
 	void int32msb16to16inPlace(long *in, long frames);
@@ -52,11 +56,32 @@ public:
 	void int24to32inPlace(void* buffer, long frames);
 	void int16to32inPlace(void* buffer, long frames);
 
-	// float to integer
+	// float to integer, saturating: samples beyond -1..1 give full scale, NaN gives 0
 	
 	void float32toInt16inPlace(float* buffer, long frames);
 	void float32toInt24inPlace(float* buffer, long frames);
 	void float32toInt32inPlace(float* buffer, long frames);
+
+	// integer to float, sampleType is the ASIOSampleType of source.
+	// Integers are normalized to -1..1 (full scale is 2^(bits - 1)), float formats are
+	// converted as they are. dest may be source if it can hold the wider samples,
+	// false for the DSD types.
+
+	bool toFloat32(long sampleType, void* source, float* dest, long frames);
+	bool toFloat64(long sampleType, void* source, double* dest, long frames);
+
+	// float to any format, sampleType is the ASIOSampleType of dest. Integers saturate
+	// like the fixed width converters, float formats are converted as they are.
+	// dest may be source if the samples don't get wider, false for the DSD types.
+
+	bool fromFloat32(long sampleType, float* source, void* dest, long frames);
+	bool fromFloat64(long sampleType, double* source, void* dest, long frames);
+
+	// numSources float channels times their gains summed into dest in one pass, like
+	// fromFloat32 of the sum. dest may not be one of the sources, false for the DSD types.
+
+	bool mixFromFloat32(long sampleType, const float* const* sources, const float* gains,
+		long numSources, void* dest, long frames);
 };
 
 #endif
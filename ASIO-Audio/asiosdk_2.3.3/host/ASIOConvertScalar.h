@@ -0,0 +1,396 @@
+#ifndef __ASIOConvertScalar__
+#define __ASIOConvertScalar__
+
+// the sample loops of the scalar reference with the byte width and order as
+// template arguments. The scalar kernels switch into them, the channel
+// converters of every instruction set run their tails through them.
+
+#include "ASIOConvertKernels.h"
+#include <string.h>
+#include <math.h>
+
+// double to integer saturated to -hi - 1..hi, NaN gives 0. The SIMD kernels
+// mask NaN and clamp with minpd/maxpd before cvttpd2dq, which is the same.
+static inline int saturateToInt(double d, double hi)
+{
+	if(d != d)
+		return 0;
+	if(d < -hi - 1.)
+		d = -hi - 1.;
+	if(d > hi)
+		d = hi;
+	return (int)d;
+}
+
+// true if the truncation of d doesn't fit -hi - 1..hi, or d is NaN
+static inline bool clips(double d, double hi)
+{
+	return !(d > -hi - 2. && d < hi + 1.);
+}
+
+// sign extended integer of 2, 3 or 4 bytes
+template <long width, bool reverseEndian>
+static inline int readInt(const unsigned char *p)
+{
+	unsigned int a = 0;
+#if ASIO_LITTLE_ENDIAN
+	const bool lsbFirst = !reverseEndian;
+#else
+	const bool lsbFirst = reverseEndian;
+#endif
+	if(lsbFirst)
+	{
+		for(long i = width - 1; i >= 0; i--)
+			a = (a << 8) | p[i];
+	}
+	else
+	{
+		for(long i = 0; i < width; i++)
+			a = (a << 8) | p[i];
+	}
+	int shift = (int)(4 - width) * 8;
+	return (int)(a << shift) >> shift;
+}
+
+// float32 or float64
+template <long width, bool reverseEndian>
+static inline double readFloat(const unsigned char *p)
+{
+	unsigned char b[8];
+	for(long i = 0; i < width; i++)
+		b[i] = reverseEndian ? p[width - 1 - i] : p[i];
+	if(width == 4)
+	{
+		float f;
+		memcpy(&f, b, 4);
+		return f;
+	}
+	double d;
+	memcpy(&d, b, 8);
+	return d;
+}
+
+// signed integer of 2, 3 or 4 bytes
+template <long width, bool reverseEndian>
+static inline void writeInt(unsigned char *p, int value)
+{
+	unsigned int a = (unsigned int)value;
+#if ASIO_LITTLE_ENDIAN
+	const bool lsbFirst = !reverseEndian;
+#else
+	const bool lsbFirst = reverseEndian;
+#endif
+	if(lsbFirst)
+	{
+		for(long i = 0; i < width; i++, a >>= 8)
+			p[i] = (unsigned char)a;
+	}
+	else
+	{
+		for(long i = width - 1; i >= 0; i--, a >>= 8)
+			p[i] = (unsigned char)a;
+	}
+}
+
+// float32 or float64
+template <long width, bool reverseEndian>
+static inline void writeFloat(unsigned char *p, double value)
+{
+	unsigned char b[8];
+	if(width == 4)
+	{
+		float f = (float)value;
+		memcpy(b, &f, 4);
+	}
+	else
+		memcpy(b, &value, 8);
+	for(long i = 0; i < width; i++)
+		p[i] = reverseEndian ? b[width - 1 - i] : b[i];
+}
+
+// float samples moved unchanged, signaling NaNs too. Each sample is read
+// before it is written, dest may be the same buffer as source.
+template <long width, bool reverseEndian>
+static inline void moveFloats(const void *source, void *dest, long frames)
+{
+	if(!reverseEndian)
+	{
+		if(source != dest)
+			memmove(dest, source, frames * width);
+		return;
+	}
+	const unsigned char* in = (const unsigned char*)source;
+	unsigned char* out = (unsigned char*)dest;
+	for(long i = 0; i < frames; i++, in += width, out += width)
+	{
+		unsigned char b[width];
+		memcpy(b, in, width);
+		for(long j = 0; j < width; j++)
+			out[j] = b[width - 1 - j];
+	}
+}
+
+static inline float mixSample(const float *const *sources, const float *gains, long numSources, long i)
+{
+	float sum = 0.f;
+	for(long s = 0; s < numSources; s++)
+		sum += gains[s] * sources[s][i];
+	return sum;
+}
+
+// triangular in -65535..65535, the sum of two 16 bit uniforms
+static inline int nextTPDF(ASIORequantizer *r)
+{
+	unsigned int x = r->rng[r->lane];
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	r->rng[r->lane] = x;
+	r->lane = (r->lane + 1) & 7;
+	return (int)(x >> 16) + (int)(x & 0xffff) - 65535;
+}
+
+//-------------------------------------------------------------------------------------------
+// int and float to float, see ASIOIntToFloat32Kernel and ASIOFloatToFloat32Kernel
+
+template <long width, bool swap>
+static inline void scalarIntToFloat32(const void *source, float *dest, float scale, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source + frames * width;
+	float* out = dest + frames;
+	while(--frames >= 0)
+	{
+		in -= width;
+		*--out = (float)readInt<width, swap>(in) * scale;
+	}
+}
+
+template <long width, bool swap>
+static inline void scalarIntToFloat64(const void *source, double *dest, double scale, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source + frames * width;
+	double* out = dest + frames;
+	while(--frames >= 0)
+	{
+		in -= width;
+		*--out = (double)readInt<width, swap>(in) * scale;
+	}
+}
+
+template <long width, bool swap>
+static inline void scalarFloatToFloat32(const void *source, float *dest, long frames)
+{
+	// forwards, float64 gets narrower
+	if(width == 4)
+	{
+		moveFloats<4, swap>(source, dest, frames);
+		return;
+	}
+	const unsigned char* in = (const unsigned char*)source;
+	float* out = dest;
+	while(--frames >= 0)
+	{
+		*out++ = (float)readFloat<width, swap>(in);
+		in += width;
+	}
+}
+
+template <long width, bool swap>
+static inline void scalarFloatToFloat64(const void *source, double *dest, long frames)
+{
+	const unsigned char* in = (const unsigned char*)source + frames * width;
+	double* out = dest + frames;
+	while(--frames >= 0)
+	{
+		in -= width;
+		*--out = readFloat<width, swap>(in);
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// float to int and float, see ASIOFloat32ToIntKernel and ASIOFloat32ToFloatKernel
+
+template <long width, bool swap>
+static inline long scalarFloat32toInt(const float *source, void *dest, double scale, long frames)
+{
+	const double hi = floor(scale);
+	long clipped = 0;
+	unsigned char* out = (unsigned char*)dest;
+	while(--frames >= 0)
+	{
+		double d = (double)(*source++) * scale;
+		clipped += clips(d, hi);
+		writeInt<width, swap>(out, saturateToInt(d, hi));
+		out += width;
+	}
+	return clipped;
+}
+
+template <long width, bool swap>
+static inline long scalarFloat64toInt(const double *source, void *dest, double scale, long frames)
+{
+	const double hi = floor(scale);
+	long clipped = 0;
+	unsigned char* out = (unsigned char*)dest;
+	while(--frames >= 0)
+	{
+		double d = *source++ * scale;
+		clipped += clips(d, hi);
+		writeInt<width, swap>(out, saturateToInt(d, hi));
+		out += width;
+	}
+	return clipped;
+}
+
+template <long width, bool swap>
+static inline void scalarFloat32toFloat(const float *source, void *dest, long frames)
+{
+	if(width == 4)
+	{
+		moveFloats<4, swap>(source, dest, frames);
+		return;
+	}
+	// backwards, float64 gets wider
+	const float* in = source + frames;
+	unsigned char* out = (unsigned char*)dest + frames * width;
+	while(--frames >= 0)
+	{
+		out -= width;
+		writeFloat<width, swap>(out, *--in);
+	}
+}
+
+template <long width, bool swap>
+static inline void scalarFloat64toFloat(const double *source, void *dest, long frames)
+{
+	if(width == 8)
+	{
+		moveFloats<8, swap>(source, dest, frames);
+		return;
+	}
+	const double* in = source;
+	unsigned char* out = (unsigned char*)dest;
+	while(--frames >= 0)
+	{
+		writeFloat<width, swap>(out, *in++);
+		out += width;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// gain and mix of frames firstFrame..endFrame, see ASIOMixToIntKernel
+
+template <long width, bool swap>
+static inline long scalarMixToInt(const float *const *sources, const float *gains, long numSources,
+	void *dest, double scale, long firstFrame, long endFrame)
+{
+	const double hi = floor(scale);
+	long clipped = 0;
+	unsigned char* out = (unsigned char*)dest + firstFrame * width;
+	for(long i = firstFrame; i < endFrame; i++)
+	{
+		double d = (double)mixSample(sources, gains, numSources, i) * scale;
+		clipped += clips(d, hi);
+		writeInt<width, swap>(out, saturateToInt(d, hi));
+		out += width;
+	}
+	return clipped;
+}
+
+template <long width, bool swap>
+static inline void scalarMixToFloat(const float *const *sources, const float *gains, long numSources,
+	void *dest, long firstFrame, long endFrame)
+{
+	unsigned char* out = (unsigned char*)dest + firstFrame * width;
+	for(long i = firstFrame; i < endFrame; i++)
+	{
+		writeFloat<width, swap>(out, mixSample(sources, gains, numSources, i));
+		out += width;
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// requantizer, see ASIORequantizeKernel and ASIORequantizeBlock()
+
+template <long width, bool swap>
+static inline long scalarRequantizeBlock(ASIORequantizer *requantizer, const float *source, void *dest,
+	long bits, const int *dither, long frames)
+{
+	const double scale = (double)((1LL << (bits - 1)) - 1);
+	const double lo = -scale - 1.;
+	const double hi = scale;
+	const double toInt = 6755399441055744.;		// 1.5 * 2^52, adding it rounds to an integer
+	double c1 = 0, c2 = 0;
+	if(requantizer->shaping == kASIONoiseShapingFirstOrder)
+		c1 = 1.;
+	else if(requantizer->shaping == kASIONoiseShapingSecondOrder)
+	{
+		c1 = 2.;
+		c2 = -1.;
+	}
+	double e1 = requantizer->error[0];
+	double e2 = requantizer->error[1];
+	long clipped = 0;
+	unsigned char* out = (unsigned char*)dest;
+
+	for(long i = 0; i < frames; i++)
+	{
+		double y = (double)source[i] * scale;
+		if(y != y)
+		{
+			y = 0;		// NaN
+			clipped++;
+		}
+		double w = (y - c2 * e2) - c1 * e1;		// e1 last, it is on the feedback path
+		double v = w + (double)dither[i] * (1. / 65536.);
+		if(v < lo)
+		{
+			v = lo;
+			clipped++;
+		}
+		if(v > hi)
+		{
+			v = hi;
+			clipped++;
+		}
+		double q = (v + toInt) - toInt;
+		if(requantizer->shaping)
+		{
+			// clipping would make the feedback run away, keep it to a few lsb
+			double e = q - w;
+			if(e < -2.)
+				e = -2.;
+			if(e > 2.)
+				e = 2.;
+			e2 = e1;
+			e1 = e;
+		}
+		writeInt<width, swap>(out, (int)q);
+		out += width;
+	}
+	requantizer->error[0] = e1;
+	requantizer->error[1] = e2;
+	return clipped;
+}
+
+template <long width, bool swap>
+static inline long scalarRequantize(ASIORequantizer *requantizer, const float *source, void *dest,
+	long bits, long frames)
+{
+	int dither[64];
+	long clipped = 0;
+	char* out = (char*)dest;
+	while(frames > 0)
+	{
+		long n = frames < 64 ? frames : 64;
+		for(long i = 0; i < n; i++)
+			dither[i] = requantizer->dither ? nextTPDF(requantizer) : 0;
+		clipped += scalarRequantizeBlock<width, swap>(requantizer, source, out, bits, dither, n);
+		source += n;
+		out += n * width;
+		frames -= n;
+	}
+	return clipped;
+}
+
+#endif
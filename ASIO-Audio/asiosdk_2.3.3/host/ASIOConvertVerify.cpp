@@ -0,0 +1,1562 @@
+#include "ginclude.h"
+#include "asio.h"
+#include "ASIOConvertVerify.h"
+#include "ASIOConvertKernels.h"
+#include "ASIOConvertMatrix.h"
+#include "ASIODSPKernels.h"
+#include "ASIOConvertSamples.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if ASIO_LITTLE_ENDIAN
+static const bool kNativeMsbFirst = false;
+#else
+static const bool kNativeMsbFirst = true;
+#endif
+
+enum
+{
+	kMaxSources = 9,		// mix sources
+	kGuardBytes = 64,		// after the output, have to stay untouched
+	kStateBytes = 64,		// requantizer state after the trial
+	kGuardFill = 0xa5
+};
+
+
+//-------------------------------------------------------------------------------------------
+// trials
+
+// xorshift32, reproducible from the seed on every platform
+typedef struct VerifyRandom
+{
+	unsigned int s;
+} VerifyRandom;
+
+static unsigned int nextRandom(VerifyRandom &r)
+{
+	r.s ^= r.s << 13;
+	r.s ^= r.s >> 17;
+	r.s ^= r.s << 5;
+	return r.s;
+}
+
+static long randomBelow(VerifyRandom &r, long n)
+{
+	return (long)(nextRandom(r) % (unsigned int)n);
+}
+
+// -1..1
+static double randomUnit(VerifyRandom &r)
+{
+	return (double)(int)nextRandom(r) / 2147483648.;
+}
+
+// one conversion call. The input is frames * inBytes + inExtra bytes, the output
+// frames * outBytes. In place the input is copied to the output buffer first.
+typedef struct Trial
+{
+	long variant;			// of the case, which method of a family
+	long frames;
+	long inBytes;
+	long outBytes;
+	long inExtra;			// fir taps before the samples
+	long align;				// the buffer offsets are multiples of it
+	bool inPlace;
+	long byteWidth;
+	bool reverseEndian;
+	long shift;
+	long channels;			// planes, mix sources or fir taps
+	long sampleType;
+	long bits;
+	double scale;
+	bool flag;				// fir accumulate, requantizer dither
+	long shaping;
+	unsigned int seed;
+	long split;				// planar output of the packing, requantizer frames of the first call
+	float gains[kMaxSources];
+} Trial;
+
+enum VerifyInput
+{
+	kInputInt = 0,			// bytes with 32 bit edge values
+	kInputFloat,
+	kInputDouble
+};
+
+// runs on the selected kernels, returns the clipped samples or 0. state receives
+// whatever the conversion keeps between calls.
+typedef long (*VerifyRun)(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *state);
+
+// the same from the sample values, never in place
+typedef long (*VerifyReference)(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *state);
+
+typedef struct VerifyCase
+{
+	const char *name;
+	long variant;
+	VerifyInput input;
+	bool anyNaN;				// float outputs where NaN matches NaN of any sign and payload
+	void (*setup)(Trial &t, VerifyRandom &r);
+	VerifyRun run;
+	VerifyReference reference;	// 0: run on the scalar kernels
+} VerifyCase;
+
+static long alignOf(long bytes)
+{
+	return bytes % 8 == 0 ? 8 : bytes % 4 == 0 ? 4 : bytes % 2 == 0 ? 2 : 1;
+}
+
+static long alignOf(long inSample, long outSample)
+{
+	long a = alignOf(inSample);
+	long b = alignOf(outSample);
+	return a > b ? a : b;
+}
+
+// planes of frames samples one after the other
+static void planes(unsigned char *base, long count, long sampleBytes, long frames, void **p)
+{
+	for(long c = 0; c < count; c++)
+		p[c] = base + c * sampleBytes * frames;
+}
+
+
+//-------------------------------------------------------------------------------------------
+// reference helpers, plain byte arithmetic
+
+// sign extended integer of width bytes
+static int loadInt(const unsigned char *p, long width, bool msbFirst)
+{
+	unsigned int a = 0;
+	for(long i = 0; i < width; i++)
+		a = (a << 8) | p[msbFirst ? i : width - 1 - i];
+	int shift = (int)(4 - width) * 8;
+	return (int)(a << shift) >> shift;
+}
+
+// the lower width bytes of value
+static void storeInt(unsigned char *p, int value, long width, bool msbFirst)
+{
+	for(long i = 0; i < width; i++)
+		p[msbFirst ? width - 1 - i : i] = (unsigned char)((unsigned int)value >> (8 * i));
+}
+
+static void copyBytes(unsigned char *dest, const unsigned char *source, long width, bool reverse)
+{
+	for(long i = 0; i < width; i++)
+		dest[i] = source[reverse ? width - 1 - i : i];
+}
+
+static float loadFloat(const unsigned char *p, bool reverse)
+{
+	unsigned char b[4];
+	float f;
+	copyBytes(b, p, 4, reverse);
+	memcpy(&f, b, 4);
+	return f;
+}
+
+static double loadDouble(const unsigned char *p, bool reverse)
+{
+	unsigned char b[8];
+	double d;
+	copyBytes(b, p, 8, reverse);
+	memcpy(&d, b, 8);
+	return d;
+}
+
+static void storeFloat(unsigned char *p, float f, bool reverse)
+{
+	unsigned char b[4];
+	memcpy(b, &f, 4);
+	copyBytes(p, b, 4, reverse);
+}
+
+static void storeDouble(unsigned char *p, double d, bool reverse)
+{
+	unsigned char b[8];
+	memcpy(b, &d, 8);
+	copyBytes(p, b, 8, reverse);
+}
+
+// x * scale truncated and saturated to -floor(scale) - 1..floor(scale), NaN gives 0
+static int saturate(double x, double scale, long *clipped)
+{
+	double hi = floor(scale);
+	double d = x * scale;
+	if(d != d)
+	{
+		++*clipped;
+		return 0;
+	}
+	d = d < 0. ? ceil(d) : floor(d);
+	if(d > hi)
+	{
+		++*clipped;
+		return (int)hi;
+	}
+	if(d < -hi - 1.)
+	{
+		++*clipped;
+		return (int)(-hi - 1.);
+	}
+	return (int)d;
+}
+
+// the layouts of the ASIOSampleTypes, from asio.h
+typedef struct VerifyType
+{
+	long sampleType;
+	long width;
+	long bits;
+	bool isFloat;
+	bool msbFirst;
+} VerifyType;
+
+static const VerifyType types[] =
+{
+	{ ASIOSTInt16MSB, 2, 16, false, true },
+	{ ASIOSTInt24MSB, 3, 24, false, true },
+	{ ASIOSTInt32MSB, 4, 32, false, true },
+	{ ASIOSTFloat32MSB, 4, 32, true, true },
+	{ ASIOSTFloat64MSB, 8, 64, true, true },
+	{ ASIOSTInt32MSB16, 4, 16, false, true },
+	{ ASIOSTInt32MSB18, 4, 18, false, true },
+	{ ASIOSTInt32MSB20, 4, 20, false, true },
+	{ ASIOSTInt32MSB24, 4, 24, false, true },
+	{ ASIOSTInt16LSB, 2, 16, false, false },
+	{ ASIOSTInt24LSB, 3, 24, false, false },
+	{ ASIOSTInt32LSB, 4, 32, false, false },
+	{ ASIOSTFloat32LSB, 4, 32, true, false },
+	{ ASIOSTFloat64LSB, 8, 64, true, false },
+	{ ASIOSTInt32LSB16, 4, 16, false, false },
+	{ ASIOSTInt32LSB18, 4, 18, false, false },
+	{ ASIOSTInt32LSB20, 4, 20, false, false },
+	{ ASIOSTInt32LSB24, 4, 24, false, false },
+};
+
+static const long numTypes = sizeof(types) / sizeof(types[0]);
+
+static const VerifyType &typeOf(const Trial &t)
+{
+	for(long i = 0; i < numTypes; i++)
+	{
+		if(types[i].sampleType == t.sampleType)
+			return types[i];
+	}
+	return types[0];
+}
+
+// one output sample of a type, float32 bits are kept as they are
+static void storeOutput(const VerifyType &type, unsigned char *p, double value, const float *exact32,
+	long *clipped)
+{
+	if(type.isFloat && type.width == 4)
+		storeFloat(p, exact32 ? *exact32 : (float)value, type.msbFirst != kNativeMsbFirst);
+	else if(type.isFloat)
+		storeDouble(p, value, type.msbFirst != kNativeMsbFirst);
+	else
+		storeInt(p, saturate(value, (double)((1LL << (type.bits - 1)) - 1) + .49999, clipped),
+			type.width, type.msbFirst);
+}
+
+
+//-------------------------------------------------------------------------------------------
+// ASIOConvertSamples against the references
+
+// packing of 32 bit samples to 8, 16 and 24 bits, mono, stereo interleaved and stereo split
+enum
+{
+	kPackWidth = 0x0f,
+	kPackUnsigned = 0x10,
+	kPackLsbFirst = 0x20
+};
+
+static void setupPack(Trial &t, VerifyRandom &)
+{
+	t.byteWidth = t.variant & kPackWidth;
+	t.inBytes = 4 * t.channels;
+	t.outBytes = t.byteWidth * t.channels;
+	t.align = 4;
+}
+
+static void setupMono(Trial &t, VerifyRandom &r)
+{
+	t.channels = 1;
+	setupPack(t, r);
+}
+
+static void setupStereo(Trial &t, VerifyRandom &r)
+{
+	t.channels = 2;
+	setupPack(t, r);
+}
+
+static void setupStereoSplit(Trial &t, VerifyRandom &r)
+{
+	t.channels = 2;
+	t.split = 1;
+	setupPack(t, r);
+}
+
+static long runMono(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	ASIOConvertSamples c;
+	long *s = (long*)in;
+	switch(t.variant)
+	{
+	case 1:
+		c.convertMono8(s, (char*)out, t.frames);
+		break;
+	case 1 | kPackUnsigned:
+		c.convertMono8Unsigned(s, (char*)out, t.frames);
+		break;
+	case 2:
+		c.convertMono16(s, (short*)out, t.frames);
+		break;
+	case 2 | kPackLsbFirst:
+		c.convertMono16SmallEndian(s, (short*)out, t.frames);
+		break;
+	case 3:
+		c.convertMono24(s, (char*)out, t.frames);
+		break;
+	case 3 | kPackLsbFirst:
+		c.convertMono24SmallEndian(s, (char*)out, t.frames);
+		break;
+	}
+	return 0;
+}
+
+static long runStereo(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	ASIOConvertSamples c;
+	long *l = (long*)in;
+	long *r = (long*)(in + 4 * t.frames);
+	switch(t.variant)
+	{
+	case 1:
+		c.convertStereo8Interleaved(l, r, (char*)out, t.frames);
+		break;
+	case 1 | kPackUnsigned:
+		c.convertStereo8InterleavedUnsigned(l, r, (char*)out, t.frames);
+		break;
+	case 2:
+		c.convertStereo16Interleaved(l, r, (short*)out, t.frames);
+		break;
+	case 2 | kPackLsbFirst:
+		c.convertStereo16InterleavedSmallEndian(l, r, (short*)out, t.frames);
+		break;
+	case 3:
+		c.convertStereo24Interleaved(l, r, (char*)out, t.frames);
+		break;
+	case 3 | kPackLsbFirst:
+		c.convertStereo24InterleavedSmallEndian(l, r, (char*)out, t.frames);
+		break;
+	}
+	return 0;
+}
+
+static long runStereoSplit(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	ASIOConvertSamples c;
+	long *l = (long*)in;
+	long *r = (long*)(in + 4 * t.frames);
+	unsigned char *dr = out + t.byteWidth * t.frames;
+	switch(t.variant)
+	{
+	case 1:
+		c.convertStereo8(l, r, (char*)out, (char*)dr, t.frames);
+		break;
+	case 1 | kPackUnsigned:
+		c.convertStereo8Unsigned(l, r, (char*)out, (char*)dr, t.frames);
+		break;
+	case 2:
+		c.convertStereo16(l, r, (short*)out, (short*)dr, t.frames);
+		break;
+	case 2 | kPackLsbFirst:
+		c.convertStereo16SmallEndian(l, r, (short*)out, (short*)dr, t.frames);
+		break;
+	case 3:
+		c.convertStereo24(l, r, (char*)out, (char*)dr, t.frames);
+		break;
+	case 3 | kPackLsbFirst:
+		c.convertStereo24SmallEndian(l, r, (char*)out, (char*)dr, t.frames);
+		break;
+	}
+	return 0;
+}
+
+// the upper 8, 16 or 24 bits, msb first unless small endian. 8 bit unsigned has the sign flipped.
+static long referencePack(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *)
+{
+	long w = t.byteWidth;
+	for(long c = 0; c < t.channels; c++)
+	{
+		for(long f = 0; f < t.frames; f++)
+		{
+			int v = loadInt(in + 4 * (c * t.frames + f), 4, kNativeMsbFirst) >> (32 - 8 * w);
+			if(t.variant & kPackUnsigned)
+				v ^= 0x80;
+			unsigned char *p = t.split ? out + w * (c * t.frames + f) : out + w * (f * t.channels + c);
+			storeInt(p, v, w, !(t.variant & kPackLsbFirst));
+		}
+	}
+	return 0;
+}
+
+// n channel interleave of samples of byteWidth bytes, planes in the input or the output
+static void setupInterleave(Trial &t, VerifyRandom &r)
+{
+	static const long widths[] = { 1, 2, 3, 4, 8, 6 };
+	t.channels = 1 + randomBelow(r, 24);
+	t.byteWidth = widths[randomBelow(r, sizeof(widths) / sizeof(widths[0]))];
+	t.inBytes = t.outBytes = t.channels * t.byteWidth;
+	t.align = alignOf(t.byteWidth);
+}
+
+static long runInterleave(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	void *p[32];
+	if(t.variant == 0)
+	{
+		planes(in, t.channels, t.byteWidth, t.frames, p);
+		ASIOConvertSamples().interleave(p, out, t.channels, t.byteWidth, t.frames);
+	}
+	else
+	{
+		planes(out, t.channels, t.byteWidth, t.frames, p);
+		ASIOConvertSamples().deinterleave(in, p, t.channels, t.byteWidth, t.frames);
+	}
+	return 0;
+}
+
+static long referenceInterleave(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *)
+{
+	long w = t.byteWidth;
+	for(long c = 0; c < t.channels; c++)
+	{
+		for(long f = 0; f < t.frames; f++)
+		{
+			long planar = w * (c * t.frames + f);
+			long interleaved = w * (f * t.channels + c);
+			if(t.variant == 0)
+				memcpy(out + interleaved, in + planar, w);
+			else
+				memcpy(out + planar, in + interleaved, w);
+		}
+	}
+	return 0;
+}
+
+// the in place integer conversions, native samples of inBytes to outBytes. Narrowing
+// shifts right by t.shift, widening left.
+enum
+{
+	kInt32msb16to16 = 0,
+	kInt32lsb16to16,
+	kInt32msb16shiftedTo16,
+	kInt24msbto16,
+	kInt32to16,
+	kInt24to16,
+	kInt32to24,
+	kInt16to24,
+	kInt24to32,
+	kInt16to32
+};
+
+static void setupResize(Trial &t, VerifyRandom &r)
+{
+	static const long bytes[][2] = { { 4, 2 }, { 4, 2 }, { 4, 2 }, { 3, 2 }, { 4, 2 }, { 3, 2 },
+		{ 4, 3 }, { 2, 3 }, { 3, 4 }, { 2, 4 } };
+	t.inBytes = bytes[t.variant][0];
+	t.outBytes = bytes[t.variant][1];
+	t.inPlace = true;
+	t.align = alignOf(t.inBytes, t.outBytes);
+	long d = t.inBytes - t.outBytes;
+	t.shift = 8 * (d < 0 ? -d : d);
+	if(t.variant == kInt32lsb16to16)
+		t.shift = 0;
+	else if(t.variant == kInt32msb16shiftedTo16)
+		t.shift = randomBelow(r, 17);
+}
+
+static long runResize(const Trial &t, unsigned char *in, unsigned char *, unsigned char *)
+{
+	ASIOConvertSamples c;
+	switch(t.variant)
+	{
+	case kInt32msb16to16:
+		c.int32msb16to16inPlace((long*)in, t.frames);
+		break;
+	case kInt32lsb16to16:
+		c.int32lsb16to16inPlace((long*)in, t.frames);
+		break;
+	case kInt32msb16shiftedTo16:
+		c.int32msb16shiftedTo16inPlace((long*)in, t.frames, t.shift);
+		break;
+	case kInt24msbto16:
+		c.int24msbto16inPlace(in, t.frames);
+		break;
+	case kInt32to16:
+		c.int32to16inPlace(in, t.frames);
+		break;
+	case kInt24to16:
+		c.int24to16inPlace(in, t.frames);
+		break;
+	case kInt32to24:
+		c.int32to24inPlace(in, t.frames);
+		break;
+	case kInt16to24:
+		c.int16to24inPlace(in, t.frames);
+		break;
+	case kInt24to32:
+		c.int24to32inPlace(in, t.frames);
+		break;
+	case kInt16to32:
+		c.int16to32inPlace(in, t.frames);
+		break;
+	}
+	return 0;
+}
+
+static long referenceResize(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *)
+{
+	for(long f = 0; f < t.frames; f++)
+	{
+		int v = loadInt(in + f * t.inBytes, t.inBytes, kNativeMsbFirst);
+		v = t.inBytes > t.outBytes ? v >> t.shift : (int)((unsigned int)v << t.shift);
+		storeInt(out + f * t.outBytes, v, t.outBytes, kNativeMsbFirst);
+	}
+	return 0;
+}
+
+// byte swap, shift and narrowing of 32 bit samples in place. Target widths outside 2..4
+// only swap, shifts of 32 and more clear the sample.
+static void setupShift32(Trial &t, VerifyRandom &r)
+{
+	t.byteWidth = 1 + randomBelow(r, 5);
+	t.shift = randomBelow(r, 41);
+	t.reverseEndian = randomBelow(r, 2) != 0;
+	t.inBytes = 4;
+	t.outBytes = t.byteWidth >= 2 && t.byteWidth <= 4 ? t.byteWidth : 4;
+	t.inPlace = true;
+	t.align = 4;
+}
+
+static long runShift32(const Trial &t, unsigned char *in, unsigned char *, unsigned char *)
+{
+	ASIOConvertSamples().shift32(in, t.shift, t.byteWidth, t.reverseEndian, t.frames);
+	return 0;
+}
+
+static long referenceShift32(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *)
+{
+	for(long f = 0; f < t.frames; f++)
+	{
+		unsigned int a = (unsigned int)loadInt(in + 4 * f, 4, t.reverseEndian != kNativeMsbFirst);
+		if(t.outBytes != t.byteWidth)
+		{
+			storeInt(out + 4 * f, (int)a, 4, kNativeMsbFirst);
+			continue;
+		}
+		a = t.shift < 32 ? a << t.shift : 0;
+		storeInt(out + f * t.byteWidth, (int)(a >> (32 - 8 * t.byteWidth)), t.byteWidth, kNativeMsbFirst);
+	}
+	return 0;
+}
+
+// byte swap of 2, 3, 4 and 8 byte samples in place, other widths are left alone
+static void setupReverse(Trial &t, VerifyRandom &r)
+{
+	static const long widths[] = { 2, 3, 4, 8, 1, 5 };
+	t.byteWidth = widths[randomBelow(r, sizeof(widths) / sizeof(widths[0]))];
+	t.inBytes = t.outBytes = t.byteWidth;
+	t.inPlace = true;
+	t.align = alignOf(t.byteWidth);
+}
+
+static long runReverse(const Trial &t, unsigned char *in, unsigned char *, unsigned char *)
+{
+	ASIOConvertSamples().reverseEndian(in, t.byteWidth, t.frames);
+	return 0;
+}
+
+static long referenceReverse(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *)
+{
+	bool swap = t.byteWidth == 2 || t.byteWidth == 3 || t.byteWidth == 4 || t.byteWidth == 8;
+	for(long f = 0; f < t.frames; f++)
+		copyBytes(out + f * t.byteWidth, in + f * t.byteWidth, t.byteWidth, swap);
+	return 0;
+}
+
+// float32toIntXXinPlace, the reference is the scalar kernel, see ASIOConvertKernels.h
+static void setupFloatToIntFixed(Trial &t, VerifyRandom &)
+{
+	t.inBytes = 4;
+	t.outBytes = t.variant;
+	t.inPlace = true;
+	t.align = 4;
+}
+
+static long runFloatToIntFixed(const Trial &t, unsigned char *in, unsigned char *, unsigned char *)
+{
+	ASIOConvertSamples c;
+	if(t.variant == 2)
+		c.float32toInt16inPlace((float*)in, t.frames);
+	else if(t.variant == 3)
+		c.float32toInt24inPlace((float*)in, t.frames);
+	else
+		c.float32toInt32inPlace((float*)in, t.frames);
+	return 0;
+}
+
+// any sample type to float and back. variant 0 and 1 read the type to float32 and
+// float64, 2 and 3 write it from them, 4 is the mix.
+static void setupFormat(Trial &t, VerifyRandom &r)
+{
+	const VerifyType &type = types[randomBelow(r, numTypes)];
+	long host = t.variant == 1 || t.variant == 3 ? 8 : 4;
+	t.sampleType = type.sampleType;
+	t.byteWidth = type.width;
+	if(t.variant <= 1)
+	{
+		t.inBytes = type.width;
+		t.outBytes = host;
+	}
+	else if(t.variant <= 3)
+	{
+		t.inBytes = host;
+		t.outBytes = type.width;
+	}
+	else
+	{
+		t.channels = randomBelow(r, kMaxSources + 1);
+		t.inBytes = 4 * t.channels;
+		t.outBytes = type.width;
+		for(long s = 0; s < t.channels; s++)
+		{
+			static const float edges[] = { 0.f, 1.f, -1.f, .5f, 2.f, 1e-40f, (float)HUGE_VAL };
+			t.gains[s] = randomBelow(r, 4) == 0 ? edges[randomBelow(r, sizeof(edges) / sizeof(edges[0]))] :
+				(float)(2. * randomUnit(r));
+		}
+	}
+	t.align = alignOf(t.inBytes <= 8 ? t.inBytes : 4, t.outBytes);
+	// in place only where the converters allow it
+	t.inPlace = t.variant <= 3 && randomBelow(r, 2) == 0 &&
+		(t.variant <= 1 ? t.outBytes >= t.inBytes : t.outBytes <= t.inBytes);
+}
+
+static long runFormat(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	ASIOConvertSamples c;
+	const float *sources[kMaxSources];
+	switch(t.variant)
+	{
+	case 0:
+		return c.toFloat32(t.sampleType, in, (float*)out, t.frames) ? 0 : -1;
+	case 1:
+		return c.toFloat64(t.sampleType, in, (double*)out, t.frames) ? 0 : -1;
+	case 2:
+		return c.fromFloat32(t.sampleType, (float*)in, out, t.frames) ? 0 : -1;
+	case 3:
+		return c.fromFloat64(t.sampleType, (double*)in, out, t.frames) ? 0 : -1;
+	}
+	planes(in, t.channels, 4, t.frames, (void**)sources);
+	return c.mixFromFloat32(t.sampleType, sources, t.gains, t.channels, out, t.frames) ? 0 : -1;
+}
+
+// integers scaled by 1 / 2^(bits - 1), float formats as they are. The integer outputs
+// saturate at 2^(bits - 1) - 1 + .49999 like the float32toIntXX converters.
+static long referenceFormat(const Trial &t, const unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const VerifyType &type = typeOf(t);
+	bool reverse = type.msbFirst != kNativeMsbFirst;
+	long clipped = 0;
+	for(long f = 0; f < t.frames; f++)
+	{
+		if(t.variant <= 1)
+		{
+			const unsigned char *p = in + f * type.width;
+			double value;
+			if(!type.isFloat)
+				value = ldexp((double)loadInt(p, type.width, type.msbFirst), 1 - (int)type.bits);
+			else if(type.width == 4)
+				value = loadFloat(p, reverse);
+			else
+				value = loadDouble(p, reverse);
+			if(t.variant == 1)
+				memcpy(out + 8 * f, &value, 8);
+			else if(type.isFloat && type.width == 4)
+				copyBytes(out + 4 * f, p, 4, reverse);
+			else
+			{
+				float v = (float)value;
+				memcpy(out + 4 * f, &v, 4);
+			}
+			continue;
+		}
+
+		float x32;
+		double x;
+		if(t.variant == 3)
+			memcpy(&x, in + 8 * f, 8);
+		else if(t.variant == 2)
+		{
+			memcpy(&x32, in + 4 * f, 4);
+			x = x32;
+		}
+		else
+		{
+			x32 = 0.f;
+			for(long s = 0; s < t.channels; s++)
+			{
+				float v;
+				memcpy(&v, in + 4 * (s * t.frames + f), 4);
+				x32 += t.gains[s] * v;
+			}
+			x = x32;
+		}
+		storeOutput(type, out + f * type.width, x, t.variant == 3 ? 0 : &x32, &clipped);
+	}
+	return 0;
+}
+
+
+// the channel converters of ASIOConvertMatrix.h, looked up on the selected kernels.
+// Variants as setupFormat, 5 is the requantizing output. Two calls split at a
+// random frame, the clips and the requantizer state after them are compared too.
+static void setupChannel(Trial &t, VerifyRandom &r)
+{
+	long variant = t.variant;
+	t.variant = variant == 5 ? 2 : variant;
+	setupFormat(t, r);
+	t.variant = variant;
+	t.flag = randomBelow(r, 4) != 0;
+	t.shaping = randomBelow(r, 3);
+	t.seed = nextRandom(r);
+	t.split = randomBelow(r, t.frames + 1);
+	t.inPlace = false;
+}
+
+static long runChannel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *state)
+{
+	ASIOChannelState channel;
+	ASIOInitChannelState(&channel, t.seed, t.flag, (ASIONoiseShaping)t.shaping);
+	long first[2] = { 0, t.split };
+	long frames[2] = { t.split, t.frames - t.split };
+	if(t.variant == 4)
+	{
+		ASIOChannelMixer mix = ASIOGetOutputMixer(t.sampleType);
+		const float *sources[kMaxSources];
+		planes(in, t.channels, 4, t.frames, (void**)sources);
+		for(int i = 0; i < 2; i++)
+		{
+			const float *from[kMaxSources];
+			for(long s = 0; s < t.channels; s++)
+				from[s] = sources[s] + first[i];
+			mix(&channel, from, t.gains, t.channels, out + first[i] * t.outBytes, frames[i]);
+		}
+	}
+	else
+	{
+		ASIOHostSampleFormat host = t.variant == 1 || t.variant == 3 ? kASIOHostFloat64 : kASIOHostFloat32;
+		ASIOChannelConverter convert = t.variant <= 1 ? ASIOGetInputConverter(t.sampleType, host) :
+			t.variant <= 3 ? ASIOGetOutputConverter(t.sampleType, host) :
+			ASIOGetRequantizingOutputConverter(t.sampleType, host);
+		for(int i = 0; i < 2; i++)
+			convert(&channel, in + first[i] * t.inBytes, out + first[i] * t.outBytes, frames[i]);
+	}
+
+	// field by field like runRequantize
+	const ASIORequantizer &q = channel.requantizer;
+	memcpy(state, q.rng, sizeof(q.rng));
+	memcpy(state + 32, &q.error, sizeof(q.error));
+	int lane = (int)q.lane;
+	memcpy(state + 48, &lane, 4);
+	return (long)ASIOGetClipCount(&channel);
+}
+
+
+//-------------------------------------------------------------------------------------------
+// kernels against the scalar kernels
+
+// float32toInt16, 24 and 32, variant is the output width
+static void setupFloatToIntKernel(Trial &t, VerifyRandom &r)
+{
+	t.inBytes = 4;
+	t.outBytes = t.variant;
+	t.inPlace = randomBelow(r, 2) == 0;
+	t.align = 4;
+}
+
+static long runFloatToIntKernel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	if(t.variant == 2)
+		k->float32toInt16((const float*)in, out, t.frames);
+	else if(t.variant == 3)
+		k->float32toInt24((const float*)in, out, t.frames);
+	else
+		k->float32toInt32((const float*)in, out, t.frames);
+	return 0;
+}
+
+// the packed 24 bit kernels, variant is the index of the kernel
+enum
+{
+	kInt32toInt24LSB = 0,
+	kInt32toInt24MSB,
+	kInt24LSBtoInt32,
+	kInt24MSBtoInt32,
+	kInt24LSBtoInt16,
+	kInt24MSBtoInt16,
+	kStereoInt32toInt24LSB,
+	kStereoInt32toInt24MSB
+};
+
+static void setupInt24Kernel(Trial &t, VerifyRandom &r)
+{
+	static const long bytes[][2] = { { 4, 3 }, { 4, 3 }, { 3, 4 }, { 3, 4 }, { 3, 2 }, { 3, 2 }, { 8, 6 }, { 8, 6 } };
+	t.inBytes = bytes[t.variant][0];
+	t.outBytes = bytes[t.variant][1];
+	t.inPlace = t.variant < kStereoInt32toInt24LSB && randomBelow(r, 2) == 0;
+	t.align = alignOf(t.inBytes, t.outBytes) > 4 ? 4 : alignOf(t.inBytes, t.outBytes);
+}
+
+static long runInt24Kernel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	switch(t.variant)
+	{
+	case kInt32toInt24LSB:
+		k->int32toInt24LSB(in, out, t.frames);
+		break;
+	case kInt32toInt24MSB:
+		k->int32toInt24MSB(in, out, t.frames);
+		break;
+	case kInt24LSBtoInt32:
+		k->int24LSBtoInt32(in, out, t.frames);
+		break;
+	case kInt24MSBtoInt32:
+		k->int24MSBtoInt32(in, out, t.frames);
+		break;
+	case kInt24LSBtoInt16:
+		k->int24LSBtoInt16(in, out, t.frames);
+		break;
+	case kInt24MSBtoInt16:
+		k->int24MSBtoInt16(in, out, t.frames);
+		break;
+	case kStereoInt32toInt24LSB:
+		k->stereoInt32toInt24LSB(in, in + 4 * t.frames, out, t.frames);
+		break;
+	case kStereoInt32toInt24MSB:
+		k->stereoInt32toInt24MSB(in, in + 4 * t.frames, out, t.frames);
+		break;
+	}
+	return 0;
+}
+
+static void setupShiftKernel(Trial &t, VerifyRandom &r)
+{
+	setupShift32(t, r);
+	t.inPlace = randomBelow(r, 2) == 0;
+}
+
+static long runShiftKernel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	ASIOGetConvertKernels()->shift32(in, out, t.shift, t.byteWidth, t.reverseEndian, t.frames);
+	return 0;
+}
+
+static void setupReverseKernel(Trial &t, VerifyRandom &r)
+{
+	setupReverse(t, r);
+	t.inPlace = randomBelow(r, 2) == 0;
+}
+
+static long runReverseKernel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	ASIOGetConvertKernels()->reverseEndian(in, out, t.byteWidth, t.frames);
+	return 0;
+}
+
+static long runInterleaveKernel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	void *p[32];
+	if(t.variant == 0)
+	{
+		planes(in, t.channels, t.byteWidth, t.frames, p);
+		ASIOGetConvertKernels()->interleave(p, out, t.channels, t.byteWidth, t.frames);
+	}
+	else
+	{
+		planes(out, t.channels, t.byteWidth, t.frames, p);
+		ASIOGetConvertKernels()->deinterleave(in, p, t.channels, t.byteWidth, t.frames);
+	}
+	return 0;
+}
+
+// integers of 1..5 bytes, 1 and 5 have to leave dest alone. Scales are the
+// powers of two of the sample types or anything.
+static void setupIntToFloat(Trial &t, VerifyRandom &r)
+{
+	t.byteWidth = 1 + randomBelow(r, 5);
+	t.reverseEndian = randomBelow(r, 2) != 0;
+	t.scale = randomBelow(r, 2) == 0 ? ldexp(1., -(int)randomBelow(r, 32)) : randomUnit(r) * 4.;
+	t.inBytes = t.byteWidth;
+	t.outBytes = t.variant == 0 ? 4 : 8;
+	t.inPlace = randomBelow(r, 2) == 0;
+	t.align = alignOf(t.inBytes, t.outBytes);
+}
+
+static long runIntToFloat(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	if(t.variant == 0)
+		k->intToFloat32(in, (float*)out, t.byteWidth, t.reverseEndian, (float)t.scale, t.frames);
+	else
+		k->intToFloat64(in, (double*)out, t.byteWidth, t.reverseEndian, t.scale, t.frames);
+	return 0;
+}
+
+// float32 or float64 samples to native float or double and back, widths other than
+// 4 and 8 have to leave dest alone. variant 0 and 1 are the input side to float32
+// and float64, 2 and 3 the output side from them.
+static void setupFloatFormat(Trial &t, VerifyRandom &r)
+{
+	static const long widths[] = { 4, 8, 4, 8, 2 };
+	long host = t.variant == 1 || t.variant == 3 ? 8 : 4;
+	t.byteWidth = widths[randomBelow(r, sizeof(widths) / sizeof(widths[0]))];
+	t.reverseEndian = randomBelow(r, 2) != 0;
+	t.inBytes = t.variant <= 1 ? t.byteWidth : host;
+	t.outBytes = t.variant <= 1 ? host : t.byteWidth;
+	t.inPlace = randomBelow(r, 2) == 0;
+	t.align = alignOf(t.inBytes, t.outBytes);
+}
+
+static long runFloatFormat(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	switch(t.variant)
+	{
+	case 0:
+		k->floatToFloat32(in, (float*)out, t.byteWidth, t.reverseEndian, t.frames);
+		break;
+	case 1:
+		k->floatToFloat64(in, (double*)out, t.byteWidth, t.reverseEndian, t.frames);
+		break;
+	case 2:
+		k->float32toFloat((const float*)in, out, t.byteWidth, t.reverseEndian, t.frames);
+		break;
+	case 3:
+		k->float64toFloat((const double*)in, out, t.byteWidth, t.reverseEndian, t.frames);
+		break;
+	}
+	return 0;
+}
+
+// float32 (variant 0) or float64 to integers of 1..5 bytes, the full scales of 1 to 32
+// bits or anything up to beyond the int range
+static void setupFloatToInt(Trial &t, VerifyRandom &r)
+{
+	t.byteWidth = 1 + randomBelow(r, 5);
+	t.reverseEndian = randomBelow(r, 2) != 0;
+	if(randomBelow(r, 2) == 0)
+		t.scale = (double)((1LL << randomBelow(r, 32)) - 1) + .49999;
+	else
+		t.scale = fabs(randomUnit(r)) * 4294967296.;
+	t.inBytes = t.variant == 0 ? 4 : 8;
+	t.outBytes = t.byteWidth;
+	t.inPlace = randomBelow(r, 2) == 0;
+	t.align = alignOf(t.inBytes, t.outBytes);
+}
+
+static long runFloatToInt(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	if(t.variant == 0)
+		return k->float32toInt((const float*)in, out, t.byteWidth, t.reverseEndian, t.scale, t.frames);
+	return k->float64toInt((const double*)in, out, t.byteWidth, t.reverseEndian, t.scale, t.frames);
+}
+
+// two calls split at a random frame, the state after them is compared too
+static void setupRequantize(Trial &t, VerifyRandom &r)
+{
+	t.byteWidth = 2 + randomBelow(r, 3);
+	t.bits = 8 + randomBelow(r, (t.byteWidth == 2 ? 16 : 24) - 7);
+	t.reverseEndian = randomBelow(r, 2) != 0;
+	t.flag = randomBelow(r, 4) != 0;
+	t.shaping = randomBelow(r, 3);
+	t.seed = nextRandom(r);
+	t.split = randomBelow(r, t.frames + 1);
+	t.inBytes = 4;
+	t.outBytes = t.byteWidth;
+	t.inPlace = randomBelow(r, 2) == 0;
+	t.align = alignOf(t.inBytes, t.outBytes);
+}
+
+static long runRequantize(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *state)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	ASIORequantizer q;
+	ASIOInitRequantizer(&q, t.seed, t.flag, t.shaping);
+	long clipped = k->requantize(&q, (const float*)in, out, t.byteWidth, t.reverseEndian, t.bits, t.split);
+	clipped += k->requantize(&q, (const float*)in + t.split, out + t.split * t.byteWidth, t.byteWidth,
+		t.reverseEndian, t.bits, t.frames - t.split);
+
+	// field by field, the padding is undefined
+	memcpy(state, q.rng, sizeof(q.rng));
+	memcpy(state + 32, &q.error, sizeof(q.error));
+	int lane = (int)q.lane;
+	memcpy(state + 48, &lane, 4);
+	return clipped;
+}
+
+// variant 0 mixes to integers, 1 to float formats
+static void setupMixKernel(Trial &t, VerifyRandom &r)
+{
+	t.channels = randomBelow(r, kMaxSources + 1);
+	t.reverseEndian = randomBelow(r, 2) != 0;
+	if(t.variant == 0)
+	{
+		t.byteWidth = 1 + randomBelow(r, 5);
+		t.scale = (double)((1LL << randomBelow(r, 32)) - 1) + .49999;
+	}
+	else
+		t.byteWidth = randomBelow(r, 5) == 0 ? 2 : 4 + 4 * randomBelow(r, 2);
+	for(long s = 0; s < t.channels; s++)
+	{
+		static const float edges[] = { 0.f, 1.f, -1.f, .5f, 2.f, 1e-40f, (float)HUGE_VAL };
+		t.gains[s] = randomBelow(r, 4) == 0 ? edges[randomBelow(r, sizeof(edges) / sizeof(edges[0]))] :
+			(float)(2. * randomUnit(r));
+	}
+	t.inBytes = 4 * t.channels;
+	t.outBytes = t.byteWidth;
+	t.align = alignOf(4, t.outBytes);
+}
+
+static long runMixKernel(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const ASIOConvertKernels *k = ASIOGetConvertKernels();
+	const float *sources[kMaxSources];
+	planes(in, t.channels, 4, t.frames, (void**)sources);
+	if(t.variant == 0)
+		return k->mixToInt(sources, t.gains, t.channels, out, t.byteWidth, t.reverseEndian, t.scale, t.frames);
+	k->mixToFloat(sources, t.gains, t.channels, out, t.byteWidth, t.reverseEndian, t.frames);
+	return 0;
+}
+
+// the taps come first in the input, then frames + numTaps - 1 samples. With accumulate
+// the sums start at the guard fill of the output.
+static void setupFir(Trial &t, VerifyRandom &r)
+{
+	t.channels = 1 + randomBelow(r, 40);
+	t.flag = randomBelow(r, 2) != 0;
+	t.byteWidth = 4;
+	t.inBytes = t.outBytes = 4;
+	t.inExtra = 4 * (2 * t.channels - 1);
+	t.align = 4;
+}
+
+static long runFir(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const float *taps = (const float*)in;
+	ASIOGetDSPKernels()->fir(taps, t.channels, taps + t.channels, (float*)out, t.frames, t.flag);
+	return 0;
+}
+
+// channels taps per phase, shift phases, split the step and bits the starting phase.
+// The bank comes first in the input, then the samples the last window reaches. The
+// samples consumed count as the clip count, the final phase is the state.
+static void setupPolyphase(Trial &t, VerifyRandom &r)
+{
+	t.channels = 8 * (1 + randomBelow(r, 8));
+	t.shift = 1 + randomBelow(r, 64);
+	t.split = 1 + randomBelow(r, 4 * t.shift);
+	t.bits = randomBelow(r, t.shift);
+	long last = t.frames ? (t.bits + (t.frames - 1) * t.split) / t.shift : 0;
+	t.byteWidth = 4;
+	t.inBytes = 0;
+	t.outBytes = 4;
+	t.inExtra = 4 * (t.shift * t.channels + last + t.channels);
+	t.align = 4;
+}
+
+static long runPolyphase(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *state)
+{
+	const float *bank = (const float*)in;
+	long phase = t.bits;
+	long consumed = ASIOGetDSPKernels()->polyphase(bank, t.channels, t.shift, t.split, &phase,
+		bank + t.shift * t.channels, (float*)out, t.frames);
+	memcpy(state, &phase, sizeof(phase));
+	return consumed;
+}
+
+// frames complex values in a pass of shift points at stride split, the twiddles come first
+// in the input, then the real and the imaginary parts
+static void setupFFTPass(Trial &t, VerifyRandom &r)
+{
+	long bits = 1 + randomBelow(r, 12);
+	t.frames = 1L << bits;
+	t.shift = bits < 2 || randomBelow(r, 4) == 0 ? 2 : 1L << (2 + 2 * randomBelow(r, bits / 2));
+	t.split = t.frames / t.shift;
+	t.byteWidth = 4;
+	t.inBytes = t.outBytes = 8;
+	t.inExtra = t.shift > 2 ? 4 * 6 * (t.shift / 4) : 0;
+	t.align = 4;
+}
+
+static long runFFTPass(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const float *twiddles = (const float*)in;
+	ASIOGetDSPKernels()->fftPass((const float*)(in + t.inExtra), (float*)out, t.frames, t.shift,
+		t.split, twiddles);
+	return 0;
+}
+
+// channels pairs of spectra of frames bins, the x spectra one after the other in the
+// input, then the h spectra
+static void setupMultiplySpectra(Trial &t, VerifyRandom &r)
+{
+	t.channels = 1 + randomBelow(r, 12);
+	t.frames = 16 * (1 + randomBelow(r, 16));
+	t.byteWidth = 4;
+	t.inBytes = 4 * 4 * t.channels;
+	t.outBytes = 8;
+	t.align = 4;
+}
+
+static long runMultiplySpectra(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	const float *x[12];
+	const float *h[12];
+	for(long p = 0; p < t.channels; p++)
+	{
+		x[p] = (const float*)in + 2 * t.frames * p;
+		h[p] = (const float*)in + 2 * t.frames * (t.channels + p);
+	}
+	ASIOGetDSPKernels()->multiplySpectra(x, h, t.channels, (float*)out, t.frames);
+	return 0;
+}
+
+// channels stages on split frames of 16 channels. The coefficients come first in the
+// input, then the block and the state as 2 * channels frames more, the kernel runs on a
+// copy of both in the output.
+static void setupBiquad(Trial &t, VerifyRandom &r)
+{
+	t.channels = 1 + randomBelow(r, 4);
+	t.split = t.frames;
+	t.frames += 2 * t.channels;
+	t.byteWidth = 4;
+	t.inBytes = t.outBytes = 4 * 16;
+	t.inExtra = 4 * 80 * t.channels;
+	t.align = 4;
+}
+
+static long runBiquad(const Trial &t, unsigned char *in, unsigned char *out, unsigned char *)
+{
+	memcpy(out, in + t.inExtra, t.frames * t.outBytes);
+	float *block = (float*)out;
+	ASIOGetDSPKernels()->biquad((const float*)in, block + 16 * t.split, block, t.channels, t.split);
+	return 0;
+}
+
+// flag without the sum of squares. Both results go to the state, a NaN sum as the
+// default NaN since its payload may differ.
+static void setupMeter(Trial &t, VerifyRandom &r)
+{
+	t.flag = randomBelow(r, 4) == 0;
+	t.byteWidth = 4;
+	t.inBytes = 4;
+	t.outBytes = 0;
+	t.align = 4;
+}
+
+static long runMeter(const Trial &t, unsigned char *in, unsigned char *, unsigned char *state)
+{
+	float sum = 0.f;
+	float peak = ASIOGetDSPKernels()->meter((const float*)in, t.frames, t.flag ? 0 : &sum);
+	if(sum != sum)
+		sum = (float)NAN;
+	memcpy(state, &peak, sizeof(peak));
+	memcpy(state + sizeof(peak), &sum, sizeof(sum));
+	return 0;
+}
+
+// the taps come first in the input, then frames + 11 samples
+static void setupTruePeak(Trial &t, VerifyRandom &)
+{
+	t.byteWidth = 4;
+	t.inBytes = 4;
+	t.outBytes = 0;
+	t.inExtra = 4 * (18 + 11);
+	t.align = 4;
+}
+
+static long runTruePeak(const Trial &t, unsigned char *in, unsigned char *, unsigned char *state)
+{
+	const float *taps = (const float*)in;
+	float peak = ASIOGetDSPKernels()->truePeak(taps, taps + 18, t.frames);
+	memcpy(state, &peak, sizeof(peak));
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// the cases
+
+static const VerifyCase cases[] =
+{
+	{ "convertMono8", 1, kInputInt, false, setupMono, runMono, referencePack },
+	{ "convertMono8Unsigned", 1 | kPackUnsigned, kInputInt, false, setupMono, runMono, referencePack },
+	{ "convertMono16", 2, kInputInt, false, setupMono, runMono, referencePack },
+	{ "convertMono16SmallEndian", 2 | kPackLsbFirst, kInputInt, false, setupMono, runMono, referencePack },
+	{ "convertMono24", 3, kInputInt, false, setupMono, runMono, referencePack },
+	{ "convertMono24SmallEndian", 3 | kPackLsbFirst, kInputInt, false, setupMono, runMono, referencePack },
+	{ "convertStereo8Interleaved", 1, kInputInt, false, setupStereo, runStereo, referencePack },
+	{ "convertStereo8InterleavedUnsigned", 1 | kPackUnsigned, kInputInt, false, setupStereo, runStereo, referencePack },
+	{ "convertStereo16Interleaved", 2, kInputInt, false, setupStereo, runStereo, referencePack },
+	{ "convertStereo16InterleavedSmallEndian", 2 | kPackLsbFirst, kInputInt, false, setupStereo, runStereo, referencePack },
+	{ "convertStereo24Interleaved", 3, kInputInt, false, setupStereo, runStereo, referencePack },
+	{ "convertStereo24InterleavedSmallEndian", 3 | kPackLsbFirst, kInputInt, false, setupStereo, runStereo, referencePack },
+	{ "convertStereo8", 1, kInputInt, false, setupStereoSplit, runStereoSplit, referencePack },
+	{ "convertStereo8Unsigned", 1 | kPackUnsigned, kInputInt, false, setupStereoSplit, runStereoSplit, referencePack },
+	{ "convertStereo16", 2, kInputInt, false, setupStereoSplit, runStereoSplit, referencePack },
+	{ "convertStereo16SmallEndian", 2 | kPackLsbFirst, kInputInt, false, setupStereoSplit, runStereoSplit, referencePack },
+	{ "convertStereo24", 3, kInputInt, false, setupStereoSplit, runStereoSplit, referencePack },
+	{ "convertStereo24SmallEndian", 3 | kPackLsbFirst, kInputInt, false, setupStereoSplit, runStereoSplit, referencePack },
+	{ "interleave", 0, kInputInt, false, setupInterleave, runInterleave, referenceInterleave },
+	{ "deinterleave", 1, kInputInt, false, setupInterleave, runInterleave, referenceInterleave },
+	{ "int32msb16to16inPlace", kInt32msb16to16, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int32lsb16to16inPlace", kInt32lsb16to16, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int32msb16shiftedTo16inPlace", kInt32msb16shiftedTo16, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int24msbto16inPlace", kInt24msbto16, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int32to16inPlace", kInt32to16, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int24to16inPlace", kInt24to16, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int32to24inPlace", kInt32to24, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int16to24inPlace", kInt16to24, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int24to32inPlace", kInt24to32, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "int16to32inPlace", kInt16to32, kInputInt, false, setupResize, runResize, referenceResize },
+	{ "shift32", 0, kInputInt, false, setupShift32, runShift32, referenceShift32 },
+	{ "reverseEndian", 0, kInputInt, false, setupReverse, runReverse, referenceReverse },
+	{ "float32toInt16inPlace", 2, kInputFloat, false, setupFloatToIntFixed, runFloatToIntFixed, 0 },
+	{ "float32toInt24inPlace", 3, kInputFloat, false, setupFloatToIntFixed, runFloatToIntFixed, 0 },
+	{ "float32toInt32inPlace", 4, kInputFloat, false, setupFloatToIntFixed, runFloatToIntFixed, 0 },
+	{ "toFloat32", 0, kInputInt, false, setupFormat, runFormat, referenceFormat },
+	{ "toFloat64", 1, kInputInt, false, setupFormat, runFormat, referenceFormat },
+	{ "fromFloat32", 2, kInputFloat, false, setupFormat, runFormat, referenceFormat },
+	{ "fromFloat64", 3, kInputDouble, false, setupFormat, runFormat, referenceFormat },
+	{ "mixFromFloat32", 4, kInputFloat, true, setupFormat, runFormat, referenceFormat },
+	{ "channel toFloat32", 0, kInputInt, false, setupChannel, runChannel, 0 },
+	{ "channel toFloat64", 1, kInputInt, false, setupChannel, runChannel, 0 },
+	{ "channel fromFloat32", 2, kInputFloat, false, setupChannel, runChannel, 0 },
+	{ "channel fromFloat64", 3, kInputDouble, false, setupChannel, runChannel, 0 },
+	{ "channel mix", 4, kInputFloat, true, setupChannel, runChannel, 0 },
+	{ "channel requantize", 5, kInputFloat, false, setupChannel, runChannel, 0 },
+
+	{ "kernel float32toInt16", 2, kInputFloat, false, setupFloatToIntKernel, runFloatToIntKernel, 0 },
+	{ "kernel float32toInt24", 3, kInputFloat, false, setupFloatToIntKernel, runFloatToIntKernel, 0 },
+	{ "kernel float32toInt32", 4, kInputFloat, false, setupFloatToIntKernel, runFloatToIntKernel, 0 },
+	{ "kernel int32toInt24LSB", kInt32toInt24LSB, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel int32toInt24MSB", kInt32toInt24MSB, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel int24LSBtoInt32", kInt24LSBtoInt32, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel int24MSBtoInt32", kInt24MSBtoInt32, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel int24LSBtoInt16", kInt24LSBtoInt16, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel int24MSBtoInt16", kInt24MSBtoInt16, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel stereoInt32toInt24LSB", kStereoInt32toInt24LSB, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel stereoInt32toInt24MSB", kStereoInt32toInt24MSB, kInputInt, false, setupInt24Kernel, runInt24Kernel, 0 },
+	{ "kernel shift32", 0, kInputInt, false, setupShiftKernel, runShiftKernel, 0 },
+	{ "kernel reverseEndian", 0, kInputInt, false, setupReverseKernel, runReverseKernel, 0 },
+	{ "kernel interleave", 0, kInputInt, false, setupInterleave, runInterleaveKernel, 0 },
+	{ "kernel deinterleave", 1, kInputInt, false, setupInterleave, runInterleaveKernel, 0 },
+	{ "kernel intToFloat32", 0, kInputInt, false, setupIntToFloat, runIntToFloat, 0 },
+	{ "kernel intToFloat64", 1, kInputInt, false, setupIntToFloat, runIntToFloat, 0 },
+	{ "kernel floatToFloat32", 0, kInputDouble, false, setupFloatFormat, runFloatFormat, 0 },
+	{ "kernel floatToFloat64", 1, kInputDouble, false, setupFloatFormat, runFloatFormat, 0 },
+	{ "kernel float32toFloat", 2, kInputFloat, false, setupFloatFormat, runFloatFormat, 0 },
+	{ "kernel float64toFloat", 3, kInputDouble, false, setupFloatFormat, runFloatFormat, 0 },
+	{ "kernel float32toInt", 0, kInputFloat, false, setupFloatToInt, runFloatToInt, 0 },
+	{ "kernel float64toInt", 1, kInputDouble, false, setupFloatToInt, runFloatToInt, 0 },
+	{ "kernel requantize", 0, kInputFloat, false, setupRequantize, runRequantize, 0 },
+	{ "kernel mixToInt", 0, kInputFloat, false, setupMixKernel, runMixKernel, 0 },
+	{ "kernel mixToFloat", 1, kInputFloat, true, setupMixKernel, runMixKernel, 0 },
+	{ "kernel fir", 0, kInputFloat, true, setupFir, runFir, 0 },
+	{ "kernel polyphase", 0, kInputFloat, true, setupPolyphase, runPolyphase, 0 },
+	{ "kernel fftPass", 0, kInputFloat, true, setupFFTPass, runFFTPass, 0 },
+	{ "kernel multiplySpectra", 0, kInputFloat, true, setupMultiplySpectra, runMultiplySpectra, 0 },
+	{ "kernel biquad", 0, kInputFloat, true, setupBiquad, runBiquad, 0 },
+	{ "kernel meter", 0, kInputFloat, false, setupMeter, runMeter, 0 },
+	{ "kernel truePeak", 0, kInputFloat, false, setupTruePeak, runTruePeak, 0 },
+};
+
+static const long numCases = sizeof(cases) / sizeof(cases[0]);
+
+
+//-------------------------------------------------------------------------------------------
+// input
+
+static void fillInt(unsigned char *p, long bytes, VerifyRandom &r)
+{
+	static const int edges[] = { 0, -1, 1, 0x7fffffff, (int)0x80000000, 0x7fffff00, (int)0x80000100,
+		0x00800000, (int)0xff7fffff, 0x7fff0000, (int)0x80008000, 0x0000ffff };
+	for(long i = 0; i < bytes; i++)
+		p[i] = (unsigned char)nextRandom(r);
+	for(long i = 0; i + 4 <= bytes; i += 4)
+	{
+		if(randomBelow(r, 8) == 0)
+			storeInt(p + i, edges[randomBelow(r, sizeof(edges) / sizeof(edges[0]))], 4, kNativeMsbFirst);
+	}
+}
+
+// a quarter edge values, some at the rounding boundaries of every integer width,
+// the rest -1.5..1.5
+static double randomSample(VerifyRandom &r)
+{
+	static const double edges[] = { 0., -0., 1., -1., 1. - 1. / 16777216., -1. + 1. / 16777216.,
+		1. + 1. / 8388608., -1. - 1. / 8388608., 1e30, -1e30, 2147483648., -2147483649., .5, -.5 };
+	switch(randomBelow(r, 8))
+	{
+	case 0:
+		return edges[randomBelow(r, sizeof(edges) / sizeof(edges[0]))];
+	case 1:
+		// k / 2^(bits - 1) and the values next to it
+		return ldexp((double)((int)nextRandom(r) >> randomBelow(r, 32)) + .5 * (double)(randomBelow(r, 5) - 2),
+			-(int)randomBelow(r, 32));
+	}
+	return 1.5 * randomUnit(r);
+}
+
+static void fillFloat(unsigned char *p, long bytes, VerifyRandom &r)
+{
+	static const unsigned int edges[] = { 0x7fc00000, 0xffc00000, 0x7f800001, 0xff800123, 0x7f800000,
+		0xff800000, 0x00000001, 0x807fffff, 0x00800000, 0x7f7fffff, 0xff7fffff };
+	for(long i = 0; i + 4 <= bytes; i += 4)
+	{
+		if(randomBelow(r, 16) == 0)
+			memcpy(p + i, &edges[randomBelow(r, sizeof(edges) / sizeof(edges[0]))], 4);
+		else
+		{
+			float f = (float)randomSample(r);
+			memcpy(p + i, &f, 4);
+		}
+	}
+}
+
+static void fillDouble(unsigned char *p, long bytes, VerifyRandom &r)
+{
+	static const unsigned long long edges[] = { 0x7ff8000000000000ULL, 0xfff8000000000000ULL,
+		0x7ff0000000000001ULL, 0xfff0000000012345ULL, 0x7ff0000000000000ULL, 0xfff0000000000000ULL,
+		0x0000000000000001ULL, 0x800fffffffffffffULL, 0x7fefffffffffffffULL, 0x36a0000000000000ULL };
+	for(long i = 0; i + 8 <= bytes; i += 8)
+	{
+		if(randomBelow(r, 16) == 0)
+			memcpy(p + i, &edges[randomBelow(r, sizeof(edges) / sizeof(edges[0]))], 8);
+		else
+		{
+			double d = randomSample(r);
+			memcpy(p + i, &d, 8);
+		}
+	}
+}
+
+static void fillInput(VerifyInput input, unsigned char *p, long bytes, VerifyRandom &r)
+{
+	memset(p, 0, bytes);
+	if(input == kInputFloat)
+		fillFloat(p, bytes, r);
+	else if(input == kInputDouble)
+		fillDouble(p, bytes, r);
+	else
+		fillInt(p, bytes, r);
+}
+
+
+//-------------------------------------------------------------------------------------------
+// comparison
+
+static bool isNaN(const unsigned char *p, long width, bool reverse)
+{
+	if(width == 4)
+	{
+		float f = loadFloat(p, reverse);
+		return f != f;
+	}
+	double d = loadDouble(p, reverse);
+	return d != d;
+}
+
+// first differing byte of the output region [begin, end) and the rest of the buffer
+// but [end, skipEnd), -1 if there is none
+static long firstDifference(const VerifyCase &c, const Trial &t, const unsigned char *a, const unsigned char *b,
+	long size, long begin, long end, long skipEnd)
+{
+	for(long i = 0; i < size; i++)
+	{
+		if(i == end)
+			i = skipEnd;
+		if(i >= size)
+			break;
+		if(a[i] == b[i])
+			continue;
+		if(c.anyNaN && i >= begin && i < end && (t.byteWidth == 4 || t.byteWidth == 8))
+		{
+			long s = begin + (i - begin) / t.byteWidth * t.byteWidth;
+			bool reverse = c.variant == 4 ? typeOf(t).msbFirst != kNativeMsbFirst : t.reverseEndian;
+			if(isNaN(a + s, t.byteWidth, reverse) && isNaN(b + s, t.byteWidth, reverse))
+			{
+				i = s + t.byteWidth - 1;
+				continue;
+			}
+		}
+		return i;
+	}
+	return -1;
+}
+
+static void describe(char *text, size_t size, const VerifyCase &c, const Trial &t, ASIOConvertISA isa,
+	long inOffset, long outOffset, const char *what, long where)
+{
+	snprintf(text, size, "%s %s: %s at %ld, %ld frames, offsets %ld/%ld%s, width %ld, channels %ld, "
+		"shift %ld, type %ld, scale %g", c.name, ASIOGetConvertISAName(isa), what, where, t.frames,
+		inOffset, outOffset, t.inPlace ? " in place" : "", t.byteWidth, t.channels, t.shift, t.sampleType, t.scale);
+}
+
+// runs one trial on isa and on the reference, false and the first failure noted in
+// result if they differ
+static bool runTrial(const VerifyCase &c, const Trial &t, ASIOConvertISA isa, const unsigned char *input,
+	long inOffset, long outOffset, ASIOVerifyResult *result)
+{
+	long inSize = t.frames * t.inBytes + t.inExtra;
+	long outSize = t.frames * t.outBytes;
+	long region = t.inPlace && inSize > outSize ? inSize : outSize;
+	long size = outOffset + region + kGuardBytes;
+
+	std::vector<unsigned char> in(inOffset + inSize + kGuardBytes);
+	std::vector<unsigned char> out[2];
+	unsigned char state[2][kStateBytes];
+	long clipped[2];
+	memcpy(&in[inOffset], input, inSize);
+	for(int i = 0; i < 2; i++)
+	{
+		out[i].assign(size, kGuardFill);
+		memset(state[i], 0, kStateBytes);
+		if(t.inPlace)
+			memcpy(&out[i][outOffset], input, inSize);
+	}
+
+	// out[0] is the tested one, out[1] the reference
+	ASIOSelectConvertKernels(isa);
+	ASIOSelectDSPKernels(isa);
+	unsigned char *source = t.inPlace ? &out[0][outOffset] : &in[inOffset];
+	clipped[0] = c.run(t, source, &out[0][outOffset], state[0]);
+	if(c.reference)
+		clipped[1] = c.reference(t, &in[inOffset], &out[1][outOffset], state[1]);
+	else
+	{
+		ASIOSelectConvertKernels(kASIOConvertScalar);
+		ASIOSelectDSPKernels(kASIOConvertScalar);
+		source = t.inPlace ? &out[1][outOffset] : &in[inOffset];
+		clipped[1] = c.run(t, source, &out[1][outOffset], state[1]);
+	}
+
+	result->trials++;
+	long difference = firstDifference(c, t, &out[0][0], &out[1][0], size, outOffset, outOffset + outSize,
+		outOffset + region);
+	const char *what = "byte";
+	if(difference < 0 && clipped[0] != clipped[1])
+	{
+		what = "clip count";
+		difference = clipped[0];
+	}
+	if(difference < 0 && memcmp(state[0], state[1], kStateBytes) != 0)
+	{
+		what = "state";
+		difference = 0;
+	}
+	if(difference < 0)
+		return true;
+	if(!result->failures++)
+		describe(result->firstFailure, sizeof(result->firstFailure), c, t, isa, inOffset, outOffset, what, difference);
+	return false;
+}
+
+
+//-------------------------------------------------------------------------------------------
+
+bool ASIOVerifyConversions(unsigned int seed, long iterations, ASIOVerifyResult *result)
+{
+	VerifyRandom r = { seed ? seed : 0x2545f491 };
+	ASIOConvertISA supported = ASIOGetSupportedConvertISA();
+	std::vector<unsigned char> input;
+	memset(result, 0, sizeof(*result));
+
+	for(long i = 0; i < iterations; i++)
+	{
+		for(long n = 0; n < numCases; n++)
+		{
+			const VerifyCase &c = cases[n];
+			Trial t;
+			memset(&t, 0, sizeof(t));
+			t.variant = c.variant;
+			// mostly short, the SIMD tails, sometimes past the cache blocks of the interleave
+			t.frames = randomBelow(r, 8) == 0 ? randomBelow(r, 1100) : randomBelow(r, 80);
+			c.setup(t, r);
+
+			long inSize = t.frames * t.inBytes + t.inExtra;
+			input.resize(inSize + 8);
+			fillInput(c.input, &input[0], inSize, r);
+			long inOffset = randomBelow(r, 16) * t.align;
+			long outOffset = randomBelow(r, 16) * t.align;
+
+			int isa = c.reference ? kASIOConvertScalar : kASIOConvertSSE2;
+			for(; isa <= supported; isa++)
+				runTrial(c, t, (ASIOConvertISA)isa, &input[0], inOffset, outOffset, result);
+		}
+	}
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+	return result->failures == 0;
+}
+
+bool ASIOVerifyConversionBytes(const unsigned char *data, size_t size, ASIOVerifyResult *result)
+{
+	enum { kHeader = 9 };
+	memset(result, 0, sizeof(*result));
+	if(size < kHeader)
+		return true;
+
+	const VerifyCase &c = cases[data[0] % numCases];
+	int isa = data[1] % (ASIOGetSupportedConvertISA() + 1);
+	Trial t;
+	memset(&t, 0, sizeof(t));
+	t.variant = c.variant;
+	t.frames = (data[2] | data[3] << 8) % 1100;
+	VerifyRandom r = { (unsigned int)(data[5] | data[6] << 8 | data[7] << 16 | data[8] << 24) | 1u };
+	c.setup(t, r);
+
+	// the rest of the data as it is, zeros after its end
+	long inSize = t.frames * t.inBytes + t.inExtra;
+	std::vector<unsigned char> input(inSize + 8, 0);
+	size_t available = size - kHeader;
+	memcpy(&input[0], data + kHeader, available < (size_t)inSize ? available : (size_t)inSize);
+
+	runTrial(c, t, (ASIOConvertISA)isa, &input[0], (data[4] & 15) * t.align, (data[4] >> 4) * t.align, result);
+	ASIOSelectConvertKernels(kASIOConvertAuto);
+	ASIOSelectDSPKernels(kASIOConvertAuto);
+	return result->failures == 0;
+}
+
+#if ASIO_FUZZ
+extern "C" int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size)
+{
+	ASIOVerifyResult result;
+	if(!ASIOVerifyConversionBytes(data, size, &result))
+	{
+		fprintf(stderr, "%s\n", result.firstFailure);
+		abort();
+	}
+	return 0;
+}
+#endif
@@ -0,0 +1,46 @@
+#ifndef __ASIOConvertVerify__
+#define __ASIOConvertVerify__
+
+// Differential check of the sample conversions, for turning on new kernels with
+// confidence:
+//
+//   - every ASIOConvertSamples method against a reference written from the sample
+//     values, without the pointer aliasing and ASIO_LITTLE_ENDIAN branches of the
+//     converters themselves
+//   - every kernel of every supported instruction set against the scalar kernel
+//
+// Each trial draws a length, the alignment of both buffers, the parameters and input
+// with edge values (full scale, just beyond it, NaN, infinities, denormals, the
+// extreme integers). Outputs have to match bit for bit, including the bytes around
+// the destination, the returned clip counts and the requantizer state. The only
+// exception is the sign and payload of NaN sums in the mix, fir and polyphase kernels.
+//
+// Both entry points switch the kernel selection and restore kASIOConvertAuto, call
+// them before any audio is running. They allocate.
+//
+// Not part of the sdk library: ASIO-Bench compiles it for -verify, a fuzz build
+// compiles it with the fuzz entry below.
+//
+// Built with ASIO_FUZZ defined to 1, ASIOConvertVerify.cpp also defines the libFuzzer
+// entry point LLVMFuzzerTestOneInput, which aborts on the first mismatch:
+//   clang++ -std=c++14 -O1 -g -fsanitize=fuzzer,address,undefined -DASIO_FUZZ=1 ...
+
+#include <stddef.h>
+
+typedef struct ASIOVerifyResult
+{
+	long trials;			// conversions run and compared
+	long failures;
+	char firstFailure[192];	// conversion, instruction set, frames, offsets and parameters
+} ASIOVerifyResult;
+
+// iterations rounds of a random trial of every conversion on every instruction set up
+// to the supported one. true when nothing differed.
+bool ASIOVerifyConversions(unsigned int seed, long iterations, ASIOVerifyResult *result);
+
+// one trial from fuzzer input: the first bytes select the conversion, the instruction
+// set, the length, the offsets and the parameters, the rest is the input as it is.
+// true when the outputs matched or the input was too short to select a trial.
+bool ASIOVerifyConversionBytes(const unsigned char *data, size_t size, ASIOVerifyResult *result);
+
+#endif
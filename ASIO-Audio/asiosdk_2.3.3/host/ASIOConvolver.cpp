@@ -0,0 +1,412 @@
+#include "ginclude.h"
+#include "ASIOConvolver.h"
+#include "ASIODSPKernels.h"
+#include "ASIODenormals.h"
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------
+
+ASIOConvolver::ASIOConvolver()
+	: numChannels(0), blockSize(0), numLevels(0), wakeCount(0)
+{
+	for(long l = 0; l < kMaxLevels; l++)
+	{
+		Level& v = levels[l];
+		v.size = v.numPartitions = v.count = v.stride = 0;
+		v.busy.store(false);
+		for(long b = 0; b < 2; b++)
+			v.slots[b].state.store(kFree);
+	}
+	late.store(0);
+	computedInline.store(0);
+	running.store(false);
+}
+
+ASIOConvolver::~ASIOConvolver()
+{
+	stop();
+}
+
+bool ASIOConvolver::setup(long numChannels, long blockSize, long irLength)
+{
+	if(running.load() || numChannels < 1 || blockSize < kMinBlockSize || blockSize > kMaxBlockSize ||
+		irLength < 1)
+		return false;
+	this->numChannels = numChannels;
+	this->blockSize = blockSize;
+
+	// each level ends where the next one starts, at twice its partition size. The last
+	// one takes the rest.
+	long offset = 0;
+	long size = blockSize;
+	numLevels = 0;
+	while(offset < irLength)
+	{
+		Level& v = levels[numLevels];
+		long fftSize = 32;
+		while(fftSize < 2 * size)
+			fftSize *= 2;
+		long next = size * kGrowth;
+		bool last = irLength <= 2 * next || fftSize * kGrowth > kMaxFFTSize || numLevels + 1 == kMaxLevels;
+		long end = last ? irLength : 2 * next;
+		v.size = size;
+		v.numPartitions = (end - offset + size - 1) / size;
+		v.count = (fftSize / 2 + 1 + 15) & ~15L;
+		v.stride = 2 * v.count;
+		v.fft.setup(fftSize);
+
+		size_t spectra = (size_t)numChannels * v.numPartitions * v.stride;
+		v.filters.assign(spectra, 0.f);
+		v.spectra.assign(spectra, 0.f);
+		v.history.assign((size_t)numChannels * fftSize, 0.f);
+		v.newest.assign(numChannels, 0);
+		v.next.assign(numChannels, 0);
+		v.sum.assign(v.stride, 0.f);
+		v.time.assign(fftSize, 0.f);
+		v.x.assign(v.numPartitions, 0);
+		v.h.assign(v.numPartitions, 0);
+		v.gather.assign((size_t)numChannels * size, 0.f);
+		for(long b = 0; b < 2; b++)
+		{
+			v.slots[b].input.assign((size_t)numChannels * size, 0.f);
+			v.slots[b].output.assign((size_t)numChannels * size, 0.f);
+		}
+		numLevels++;
+		offset = end;
+		size = next;
+	}
+	headOutput.assign((size_t)numChannels * blockSize, 0.f);
+	reset();
+	return true;
+}
+
+bool ASIOConvolver::setImpulse(long channel, const float *ir, long length)
+{
+	if(running.load() || channel < 0 || channel >= numChannels || length < 0)
+		return false;
+	long offset = 0;
+	for(long l = 0; l < numLevels; l++)
+	{
+		Level& v = levels[l];
+		long fftSize = v.fft.getSize();
+		float scale = 1.f / fftSize;
+		float* t = &v.time[0];
+		for(long p = 0; p < v.numPartitions; p++, offset += v.size)
+		{
+			memset(t, 0, fftSize * sizeof(float));
+			long n = length - offset;
+			n = n < 0 ? 0 : n > v.size ? v.size : n;
+			for(long i = 0; i < n; i++)
+				t[i] = ir[offset + i] * scale;
+			float* spectrum = &v.filters[((size_t)channel * v.numPartitions + p) * v.stride];
+			v.fft.forward(t, spectrum, spectrum + v.count);
+		}
+	}
+	reset();
+	return true;
+}
+
+void ASIOConvolver::reset()
+{
+	if(running.load())
+		return;
+	for(long l = 0; l < numLevels; l++)
+	{
+		Level& v = levels[l];
+		memset(&v.spectra[0], 0, v.spectra.size() * sizeof(float));
+		memset(&v.history[0], 0, v.history.size() * sizeof(float));
+		for(long ch = 0; ch < numChannels; ch++)
+		{
+			v.newest[ch] = 0;
+			v.next[ch] = 0;
+		}
+		v.gathered = 0;
+		v.posted = 0;
+		v.due = false;
+		v.reading = -1;
+		v.readPosition = 0;
+		for(long b = 0; b < 2; b++)
+		{
+			v.slots[b].state.store(kFree);
+			v.slots[b].sequence.store(0);
+			v.slots[b].progress = 0;
+		}
+	}
+	late.store(0);
+	computedInline.store(0);
+}
+
+//-------------------------------------------------------------------------------------------
+// overlap-save of one channel: the history slides by a partition, its spectrum replaces the
+// oldest one and the products with the partitions of the filter are summed, the last size
+// samples of their inverse are the output. Jobs the buffer switch dropped count as silence.
+
+void ASIOConvolver::compute(Level &v, long channel, const float *input, float *output, unsigned long sequence)
+{
+	long fftSize = v.fft.getSize();
+	long numPartitions = v.numPartitions;
+	float* history = &v.history[(size_t)channel * fftSize];
+	float* spectra = &v.spectra[(size_t)channel * numPartitions * v.stride];
+	const float* filters = &v.filters[(size_t)channel * numPartitions * v.stride];
+	long& newest = v.newest[channel];
+
+	unsigned long missed = sequence - v.next[channel];
+	if(missed)
+	{
+		long shift = missed < (unsigned long)(fftSize / v.size) ? (long)missed * v.size : fftSize;
+		memmove(history, history + shift, (fftSize - shift) * sizeof(float));
+		memset(history + fftSize - shift, 0, shift * sizeof(float));
+		for(unsigned long m = 0; m < missed && m < (unsigned long)numPartitions; m++)
+		{
+			newest = newest + 1 == numPartitions ? 0 : newest + 1;
+			memset(spectra + newest * v.stride, 0, v.stride * sizeof(float));
+		}
+	}
+	v.next[channel] = sequence + 1;
+
+	memmove(history, history + v.size, (fftSize - v.size) * sizeof(float));
+	memcpy(history + fftSize - v.size, input, v.size * sizeof(float));
+	newest = newest + 1 == numPartitions ? 0 : newest + 1;
+	float* spectrum = spectra + newest * v.stride;
+	v.fft.forward(history, spectrum, spectrum + v.count);
+
+	for(long p = 0, s = newest; p < numPartitions; p++, s = s ? s - 1 : numPartitions - 1)
+	{
+		v.x[p] = spectra + s * v.stride;
+		v.h[p] = filters + p * v.stride;
+	}
+	float* sum = &v.sum[0];
+	ASIOGetDSPKernels()->multiplySpectra(&v.x[0], &v.h[0], numPartitions, sum, v.count);
+	v.fft.inverse(sum, sum + v.count, &v.time[0]);
+	memcpy(output, &v.time[fftSize - v.size], v.size * sizeof(float));
+}
+
+// the channels of a job from its progress on, the caller holds busy and set it running.
+// With yield it stops between channels when a shorter level has a job waiting and posts
+// the rest again, false then.
+bool ASIOConvolver::runJob(long level, Slot &s, bool yield)
+{
+	Level& v = levels[level];
+	while(s.progress < numChannels)
+	{
+		long ch = s.progress;
+		compute(v, ch, &s.input[(size_t)ch * v.size], &s.output[(size_t)ch * v.size],
+			s.sequence.load(std::memory_order_relaxed));
+		s.progress++;
+		if(!yield || s.progress == numChannels)
+			continue;
+		for(long l = 1; l < level; l++)
+		{
+			if(levels[l].slots[0].state.load(std::memory_order_relaxed) == kPosted ||
+				levels[l].slots[1].state.load(std::memory_order_relaxed) == kPosted)
+			{
+				s.state.store(kPosted, std::memory_order_release);
+				return false;
+			}
+		}
+	}
+	s.state.store(kDone, std::memory_order_release);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// buffer switch
+
+void ASIOConvolver::process(const float *const *sources, float *const *dests, long frames)
+{
+	if(!numLevels || frames != blockSize)
+	{
+		for(long ch = 0; ch < numChannels && frames > 0; ch++)
+			memset(dests[ch], 0, frames * sizeof(float));
+		return;
+	}
+
+	// the inputs first, the dests may be the sources
+	for(long l = 0; l < numLevels; l++)
+	{
+		Level& v = levels[l];
+		for(long ch = 0; ch < numChannels; ch++)
+			memcpy(&v.gather[(size_t)ch * v.size + v.gathered], sources[ch], frames * sizeof(float));
+		v.gathered += frames;
+	}
+
+	Level& head = levels[0];
+	for(long ch = 0; ch < numChannels; ch++)
+	{
+		float* out = &headOutput[(size_t)ch * frames];
+		compute(head, ch, &head.gather[(size_t)ch * frames], out, head.next[ch]);
+		memcpy(dests[ch], out, frames * sizeof(float));
+	}
+	head.gathered = 0;
+
+	for(long l = 1; l < numLevels; l++)
+	{
+		Level& v = levels[l];
+		if(v.due)
+			beginOutput(l);
+		if(v.reading >= 0)
+		{
+			for(long ch = 0; ch < numChannels; ch++)
+			{
+				const float* tail = &v.slots[v.reading].output[(size_t)ch * v.size + v.readPosition];
+				float* d = dests[ch];
+				for(long i = 0; i < frames; i++)
+					d[i] += tail[i];
+			}
+		}
+		v.readPosition += frames;
+	}
+
+	long wakeUps = 0;
+	for(long l = 1; l < numLevels; l++)
+	{
+		if(levels[l].gathered == levels[l].size)
+			post(levels[l], wakeUps);
+	}
+	if(wakeUps && running.load(std::memory_order_relaxed))
+	{
+		{
+			std::lock_guard<std::mutex> lock(wakeLock);
+			wakeCount += wakeUps;
+		}
+		wake.notify_all();
+	}
+}
+
+// the partition posted two before the newest one starts at this buffer. Its job must be done,
+// when it's still waiting the buffer switch computes it.
+void ASIOConvolver::beginOutput(long level)
+{
+	Level& v = levels[level];
+	v.due = false;
+	v.reading = -1;
+	v.readPosition = 0;
+	if(v.posted < 2)
+		return;
+	unsigned long sequence = v.posted - 2;
+	long index = (long)(sequence & 1);
+	Slot& s = v.slots[index];
+	long state = s.sequence.load(std::memory_order_relaxed) == sequence ? s.state.load(std::memory_order_acquire) : (long)kFree;
+	if(state == kPosted)
+	{
+		bool idle = false;
+		if(v.busy.compare_exchange_strong(idle, true, std::memory_order_acquire))
+		{
+			long posted = kPosted;
+			if(s.state.compare_exchange_strong(posted, kRunning, std::memory_order_acquire))
+			{
+				runJob(level, s, false);
+				computedInline.fetch_add(1, std::memory_order_relaxed);
+			}
+			v.busy.store(false, std::memory_order_release);
+			state = s.state.load(std::memory_order_acquire);
+		}
+	}
+	if(state == kDone)
+		v.reading = index;
+	else
+		late.fetch_add(1, std::memory_order_relaxed);
+}
+
+// a complete partition to its slot. The job two before in the same slot is done or late:
+// one that never ran is taken back, one that still runs keeps the slot and this job is
+// dropped, it counts as late when its output is due.
+void ASIOConvolver::post(Level &v, long &wakeUps)
+{
+	unsigned long sequence = v.posted++;
+	v.gathered = 0;
+	v.due = true;
+	Slot& s = v.slots[sequence & 1];
+	long state = kPosted;
+	if(!s.state.compare_exchange_strong(state, kFree, std::memory_order_acquire) && state == kRunning)
+		return;
+	memcpy(&s.input[0], &v.gather[0], v.gather.size() * sizeof(float));
+	s.sequence.store(sequence, std::memory_order_relaxed);
+	s.progress = 0;
+	s.state.store(kPosted, std::memory_order_release);
+	wakeUps++;
+}
+
+//-------------------------------------------------------------------------------------------
+// workers
+
+bool ASIOConvolver::start(long numThreads)
+{
+	if(running.load() || numThreads < 1)
+		return false;
+	if(numThreads > numLevels - 1)
+		numThreads = numLevels - 1;
+	running.store(true);
+	wakeCount = 0;
+	for(long i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&ASIOConvolver::run, this));
+	return true;
+}
+
+void ASIOConvolver::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+		running.store(false);
+	}
+	wake.notify_all();
+	for(size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+	workers.clear();
+}
+
+void ASIOConvolver::run()
+{
+	// a DSP thread of its own, see ASIODenormals.h
+	ASIOSetDenormalMode(kASIODenormalsOff);
+	for(;;)
+	{
+		processPending();
+		std::unique_lock<std::mutex> lock(wakeLock);
+		wake.wait(lock, [this]() { return wakeCount > 0 || !running.load(); });
+		if(!running.load())
+			return;
+		wakeCount--;
+	}
+}
+
+// the oldest waiting job of the shortest level first, over again after each one. The
+// buffer switch may take a posted job back and post the next one to the same slot
+// between the choice and the compare exchange, which then takes the newer job: it is
+// complete and waiting as well, its sequence only stays put from kRunning on.
+long ASIOConvolver::processPending()
+{
+	long jobs = 0;
+	for(long l = 1; l < numLevels; )
+	{
+		Level& v = levels[l];
+		bool idle = false;
+		if(!v.busy.compare_exchange_strong(idle, true, std::memory_order_acquire))
+		{
+			l++;
+			continue;
+		}
+		Slot* s = 0;
+		unsigned long oldest = 0;
+		for(long b = 0; b < 2; b++)
+		{
+			Slot& c = v.slots[b];
+			if(c.state.load(std::memory_order_acquire) != kPosted)
+				continue;
+			unsigned long sequence = c.sequence.load(std::memory_order_relaxed);
+			if(!s || (long)(sequence - oldest) < 0)
+			{
+				s = &c;
+				oldest = sequence;
+			}
+		}
+		long posted = kPosted;
+		bool ran = s && s->state.compare_exchange_strong(posted, kRunning, std::memory_order_acquire);
+		bool done = ran && runJob(l, *s, true);
+		v.busy.store(false, std::memory_order_release);
+		if(done)
+			jobs++;
+		l = ran ? 1 : l + 1;
+	}
+	return jobs;
+}
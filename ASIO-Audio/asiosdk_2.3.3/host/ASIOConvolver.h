@@ -0,0 +1,160 @@
+#ifndef __ASIOConvolver__
+#define __ASIOConvolver__
+
+// Convolution of float channels with impulse responses of several seconds, room correction
+// and cabinets, at buffer sizes down to 16 frames. The impulse response is cut into
+// partitions that grow by 4 from level to level, each level convolves by overlap-save on
+// the real FFT of ASIOFFT.h with a spectrum per partition and the multiplySpectra kernel
+// of ASIODSPKernels.h:
+//
+//   level 0   partitions of the block size, computed in the buffer switch, no latency
+//   level l   partitions of blockSize * 4^l starting at twice that, computed by workers
+//
+// A tail level gets the input of one partition from the buffer switch and has the length
+// of a partition in frames to compute it, its output is due the buffer switch after the
+// next partition is complete. The buffer switch never waits: a job no worker has taken
+// by then it computes itself, one that is still running is skipped and counted as late.
+// Workers take the shortest partitions first and look for shorter ones between channels.
+//
+// Feedback free, but tails decaying into denormals still slow the FFTs down, every thread
+// that runs process() or processPending() should have them off, see ASIODenormals.h.
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ASIOFFT.h"
+
+class ASIOConvolver
+{
+public:
+	enum
+	{
+		kMaxLevels = 8
+	};
+
+	ASIOConvolver();
+	~ASIOConvolver();
+
+	// blockSize frames per process() call from 16 to 8192, irLength the longest impulse
+	// response in samples. Plans the levels and allocates everything, the impulse responses
+	// start silent. Call it before the buffers run and before start().
+	bool setup(long numChannels, long blockSize, long irLength);
+
+	// the impulse response of one channel, length up to the irLength of setup(). Transforms
+	// all its partitions and resets, only while neither process() nor a worker runs.
+	bool setImpulse(long channel, const float *ir, long length);
+
+	// input history and jobs back to silence, the same restriction
+	void reset();
+
+	long getNumChannels() const { return numChannels; }
+	long getBlockSize() const { return blockSize; }
+	long getNumLevels() const { return numLevels; }
+
+	// frames per partition of a level, a tail level computes one every that many frames
+	// and has as long for it
+	long getPartitionSize(long level) const { return level >= 0 && level < numLevels ? levels[level].size : 0; }
+	long getNumPartitions(long level) const { return level >= 0 && level < numLevels ? levels[level].numPartitions : 0; }
+
+	// frames of every channel, sources[i] and dests[i] are the buffers of channel i and may
+	// be the same. The partitions need frames to be the blockSize of setup(), any other
+	// count writes silence and leaves the state alone. Buffer switch.
+	void process(const float *const *sources, float *const *dests, long frames);
+
+	// starts numThreads workers, no more than there are tail levels, and stops them
+	bool start(long numThreads);
+	void stop();
+
+	// the work of the workers on the calling thread, for a host that runs it itself
+	// instead of start(). Computes every job posted so far, returns how many.
+	long processPending();
+
+	// tail jobs that weren't done when the buffer switch needed them, their output was
+	// left out. Any thread.
+	unsigned long getLate() const { return late.load(std::memory_order_relaxed); }
+
+	// tail jobs no worker had taken by then, the buffer switch computed them
+	unsigned long getInline() const { return computedInline.load(std::memory_order_relaxed); }
+
+private:
+	enum
+	{
+		kMinBlockSize = 16,
+		kMaxBlockSize = 8192,
+		kGrowth = 4,			// partition size from one level to the next
+		kMaxFFTSize = 65536,
+
+		// Slot::state
+		kFree = 0,
+		kPosted,				// waits for a thread, channels before progress are done
+		kRunning,
+		kDone
+	};
+
+	// one job of a tail level, the buffer switch fills and posts it, a worker or the
+	// buffer switch computes it
+	typedef struct Slot
+	{
+		std::atomic<long> state;
+		std::atomic<unsigned long> sequence;	// of the job, partitions since setup() or reset(),
+											// stored before the state goes to kPosted
+		long progress;					// channels computed
+		std::vector<float> input;		// size frames of every channel
+		std::vector<float> output;
+	} Slot;
+
+	typedef struct Level
+	{
+		long size;						// frames per partition and per job
+		long numPartitions;
+		long count;						// bins of a spectrum, size + 1 rounded up to 16
+		long stride;					// floats of a spectrum, the real parts then the imaginary
+		ASIOFFT fft;					// 2 * size rounded up to a power of 2
+
+		// of the thread that holds busy
+		std::vector<float> filters;		// numPartitions spectra per channel, scaled by 1 / fft size
+		std::vector<float> spectra;		// the inputs of the last numPartitions jobs per channel
+		std::vector<float> history;		// fft size input samples per channel
+		std::vector<long> newest;		// per channel, the spectrum of the last job
+		std::vector<unsigned long> next;	// per channel, the sequence of the next job
+		std::vector<float> sum;
+		std::vector<float> time;
+		std::vector<const float*> x;
+		std::vector<const float*> h;
+		std::atomic<bool> busy;
+
+		// of the buffer switch
+		std::vector<float> gather;		// the input of the next job
+		long gathered;
+		unsigned long posted;			// jobs
+		bool due;						// the output of posted - 2 starts with the next buffer
+		long reading;					// slot whose output is mixed in, -1 for none
+		long readPosition;
+		Slot slots[2];
+	} Level;
+
+	void compute(Level &v, long channel, const float *input, float *output, unsigned long sequence);
+	bool runJob(long level, Slot &s, bool yield);
+	void beginOutput(long level);
+	void post(Level &v, long &wake);
+	void run();
+
+	long numChannels;
+	long blockSize;
+	long numLevels;
+	Level levels[kMaxLevels];
+	std::vector<float> headOutput;		// of level 0, blockSize frames per channel
+	std::atomic<unsigned long> late;
+	std::atomic<unsigned long> computedInline;
+
+	// workers sleep on wake between jobs, process() only takes the lock to count posts
+	std::atomic<bool> running;
+	std::vector<std::thread> workers;
+	std::mutex wakeLock;
+	std::condition_variable wake;
+	long wakeCount;
+};
+
+#endif
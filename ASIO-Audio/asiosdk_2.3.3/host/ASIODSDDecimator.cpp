@@ -0,0 +1,200 @@
+#include "ginclude.h"
+#include "asio.h"
+#include "ASIODSDDecimator.h"
+#include "ASIODSPKernels.h"
+#include "ASIOFilterDesign.h"
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------
+// filters
+
+static const double kDSD64Rate = 2822400.;
+
+// stage 1 passes up to about 70 kHz and stops the images of 352.8 kHz that
+// would fold back into the audio band
+static const double kStage1Cutoff = 140000.;
+static const double kStage1Beta = 10.;
+static const long kStage1BytesDSD64 = 16;
+
+static const double kHalfbandBeta = 8.;
+
+// idle pattern of a DSD stream, the history starts as silence
+static const unsigned char kDSDSilence = 0x69;
+
+
+//-------------------------------------------------------------------------------------------
+
+ASIODSDDecimator::ASIODSDDecimator()
+	: sampleType(0), decimation(0), bytesPerOutput(0), tableBytes(0), numStages(0)
+{
+}
+
+bool ASIODSDDecimator::setup(long type, double dsdRate, double pcmRate, long numChannels)
+{
+	long multiple = (long)(dsdRate / kDSD64Rate + .5);
+	if(type != ASIOSTDSDInt8LSB1 && type != ASIOSTDSDInt8MSB1 && type != ASIOSTDSDInt8NER8)
+		return false;
+	if((multiple != 1 && multiple != 2 && multiple != 4) || dsdRate != multiple * kDSD64Rate)
+		return false;
+	if((pcmRate != 88200. && pcmRate != 176400.) || numChannels < 0)
+		return false;
+
+	sampleType = type;
+	bytesPerOutput = multiple;
+	tableBytes = kStage1BytesDSD64 * multiple;
+	numStages = pcmRate == 176400. ? 1 : 2;
+	decimation = 8 * bytesPerOutput << numStages;
+
+	// stage 1, h[a] weighs the sample a positions before the newest
+	long length = tableBytes * 8;
+	std::vector<double> h(length);
+	ASIODesignLowpass(&h[0], length, kStage1Cutoff / dsdRate, kStage1Beta);
+	tables.resize(tableBytes * 256);
+	for(long j = 0; j < tableBytes; j++)
+	{
+		for(long v = 0; v < 256; v++)
+		{
+			// the byte j positions back, its first sample is the oldest. Summed by
+			// age so that both bit orders get the same tables.
+			double partial = 0.;
+			for(long k = 0; k < 8; k++)
+			{
+				long b = type == ASIOSTDSDInt8MSB1 ? k : 7 - k;
+				partial += (v >> b & 1) ? h[8 * j + k] : -h[8 * j + k];
+			}
+			tables[(j << 8) + v] = (float)partial;
+		}
+	}
+
+	// the halfbands, the last one defines the passband. Before it a shorter one
+	// only has to keep the images away from what the last one passes.
+	for(long s = 0; s < numStages; s++)
+	{
+		Halfband& hb = halfbands[s];
+		hb.halfLength = s == numStages - 1 ? 16 : 8;
+		hb.taps.resize(2 * hb.halfLength);
+		ASIODesignHalfband(&hb.taps[0], hb.halfLength, kHalfbandBeta);
+	}
+
+	channels.resize(numChannels);
+	for(long i = 0; i < numChannels; i++)
+	{
+		Channel& c = channels[i];
+		c.bytes.resize(tableBytes - 1 + kChunkBytes);
+		for(long s = 0; s < numStages; s++)
+		{
+			c.stages[s].even.resize(2 * halfbands[s].halfLength + kChunkBytes / 2 + 1);
+			c.stages[s].odd.resize(2 * halfbands[s].halfLength + kChunkBytes / 2 + 1);
+		}
+	}
+	reset();
+	return true;
+}
+
+void ASIODSDDecimator::reset()
+{
+	for(size_t i = 0; i < channels.size(); i++)
+	{
+		Channel& c = channels[i];
+		memset(&c.bytes[0], kDSDSilence, c.bytes.size());
+		c.phase = 0;
+		for(long s = 0; s < numStages; s++)
+		{
+			HalfbandState& st = c.stages[s];
+			memset(&st.even[0], 0, st.even.size() * sizeof(float));
+			memset(&st.odd[0], 0, st.odd.size() * sizeof(float));
+			st.evenCount = st.oddCount = 2 * halfbands[s].halfLength - 1;
+		}
+	}
+}
+
+long ASIODSDDecimator::process(long channel, const void *source, float *dest, long frames)
+{
+	if(channel < 0 || channel >= (long)channels.size())
+		return 0;
+	Channel& c = channels[channel];
+	const unsigned char* in = (const unsigned char*)source;
+	unsigned char* window = &c.bytes[tableBytes - 1];
+	float buffer[kChunkBytes];
+	long bytes = frames / 8;
+	long written = 0;
+	while(bytes > 0)
+	{
+		long n = bytes < kChunkBytes ? bytes : (long)kChunkBytes;
+		if(sampleType == ASIOSTDSDInt8NER8)
+		{
+			// packed to the LSB1 order, the tables are the same
+			for(long i = 0; i < n; i++, in += 8)
+			{
+				unsigned char b = 0;
+				for(int k = 0; k < 8; k++)
+					b |= (unsigned char)((in[k] & 1) << k);
+				window[i] = b;
+			}
+		}
+		else
+		{
+			memcpy(window, in, n);
+			in += n;
+		}
+
+		// each stage reads its input before it writes, they can share the buffer
+		long count = stage1(c, n, buffer);
+		for(long s = 0; s < numStages; s++)
+			count = halfband(halfbands[s], c.stages[s], buffer, count, s == numStages - 1 ? dest + written : buffer);
+		written += count;
+
+		memmove(&c.bytes[0], &c.bytes[n], tableBytes - 1);
+		bytes -= n;
+	}
+	return written;
+}
+
+long ASIODSDDecimator::stage1(Channel &c, long count, float *dest)
+{
+	const unsigned char* window = &c.bytes[tableBytes - 1];
+	const float* t = &tables[0];
+	long written = 0;
+	for(long p = 0; p < count; p++)
+	{
+		if(++c.phase < bytesPerOutput)
+			continue;
+		c.phase = 0;
+		// window[p] is the newest byte, table j weighs the byte j positions back
+		const unsigned char* b = window + p;
+		float even = 0.f, odd = 0.f;
+		for(long j = 0; j < tableBytes; j += 2)
+		{
+			even += t[(j << 8) + b[-j]];
+			odd += t[((j + 1) << 8) + b[-j - 1]];
+		}
+		dest[written++] = even + odd;
+	}
+	return written;
+}
+
+// y[n] = sum of g[k] * x[2n + k], with the even samples against the even taps
+// and the odd ones only against the center tap at 2 * halfLength - 1
+long ASIODSDDecimator::halfband(const Halfband &h, HalfbandState &s, const float *source, long count, float *dest)
+{
+	static const float center = .5f;
+	for(long i = 0; i < count; i++)
+	{
+		if(s.evenCount == s.oddCount)
+			s.even[s.evenCount++] = source[i];
+		else
+			s.odd[s.oddCount++] = source[i];
+	}
+	long taps = 2 * h.halfLength;
+	long n = s.evenCount - (taps - 1);
+	if(n <= 0)
+		return 0;
+	const ASIODSPKernels* k = ASIOGetDSPKernels();
+	k->fir(&h.taps[0], taps, &s.even[0], dest, n, false);
+	k->fir(&center, 1, &s.odd[h.halfLength - 1], dest, n, true);
+	memmove(&s.even[0], &s.even[n], (s.evenCount - n) * sizeof(float));
+	memmove(&s.odd[0], &s.odd[n], (s.oddCount - n) * sizeof(float));
+	s.evenCount -= n;
+	s.oddCount -= n;
+	return n;
+}
@@ -0,0 +1,85 @@
+#ifndef __ASIODSDDecimator__
+#define __ASIODSDDecimator__
+
+// DSD to PCM for the inputs of a driver in DSD mode (kAsioSetIoFormat with
+// kASIODSDFormat). DSD64, 128 or 256 is decimated to 176.4 or 88.2 kHz float
+// samples in up to three stages:
+//
+//   1. a 128 tap (DSD64) linear phase FIR that outputs 352.8 kHz. The 1 bit
+//      samples are summed a byte at a time, every byte position of the filter
+//      has a table of the 256 possible partial sums.
+//   2. a halfband FIR to 176.4 kHz
+//   3. for 88.2 kHz, a second halfband FIR
+//
+// The halfband stages run on the fir kernel of ASIODSPKernels.h. Full
+// scale is 100% modulation, the SACD reference level of 50% is -6 dBFS.
+
+#include <vector>
+
+class ASIODSDDecimator
+{
+public:
+	ASIODSDDecimator();
+	~ASIODSDDecimator() {}
+
+	// sampleType is ASIOSTDSDInt8LSB1, ASIOSTDSDInt8MSB1 or ASIOSTDSDInt8NER8 (one
+	// sample in bit 0 of each byte), dsdRate 2822400, 5644800 or 11289600 and
+	// pcmRate 88200 or 176400. Allocates all buffers, call it before the buffers run.
+	// false for other combinations.
+	bool setup(long sampleType, double dsdRate, double pcmRate, long numChannels);
+
+	// restarts all channels from silence
+	void reset();
+
+	// dsd samples per pcm sample, 0 before setup
+	long getDecimation() const { return decimation; }
+
+	// one buffer half of one channel. frames are dsd samples, a multiple of 8, dest
+	// holds frames / getDecimation() + 1 samples. Returns the number of pcm samples
+	// written, frames / getDecimation() when every call passes a multiple of it.
+	long process(long channel, const void *source, float *dest, long frames);
+
+private:
+	enum
+	{
+		kChunkBytes = 256,		// packed input bytes per pass through the stages
+		kMaxStages = 2
+	};
+
+	// halfband FIR decimating by 2, only the even taps and the center are nonzero
+	typedef struct Halfband
+	{
+		std::vector<float> taps;	// the even taps, 2 * halfLength
+		long halfLength;
+	} Halfband;
+
+	// input of one halfband stage of one channel, split in the even and odd samples
+	typedef struct HalfbandState
+	{
+		std::vector<float> even;
+		std::vector<float> odd;
+		long evenCount;
+		long oddCount;
+	} HalfbandState;
+
+	typedef struct Channel
+	{
+		std::vector<unsigned char> bytes;	// tableBytes - 1 bytes of history, then the chunk
+		long phase;							// bytes since the last stage 1 output
+		HalfbandState stages[kMaxStages];
+	} Channel;
+
+	long stage1(Channel &c, long count, float *dest);
+	long halfband(const Halfband &h, HalfbandState &s, const float *source, long count, float *dest);
+
+	long sampleType;
+	long decimation;
+	long bytesPerOutput;	// stage 1 decimates by 8 * bytesPerOutput
+	long tableBytes;		// stage 1 filter length in bytes
+	std::vector<float> tables;	// tableBytes x 256 partial sums
+	Halfband halfbands[kMaxStages];
+	long numStages;
+	std::vector<Channel> channels;
+};
+
+#endif
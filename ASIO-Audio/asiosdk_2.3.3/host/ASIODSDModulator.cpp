@@ -0,0 +1,186 @@
+#include "ginclude.h"
+#include "asio.h"
+#include "ASIODSDModulator.h"
+#include "ASIODSPKernels.h"
+#include "ASIOFilterDesign.h"
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------
+// filters
+
+static const double kDSD64Rate = 2822400.;
+static const double kLinearRate = 352800.;
+static const double kHalfbandBeta = 8.;
+
+// 1.4 of pcm full scale, 70% modulation
+static const float kMaxInput = 1.4f;
+static const double kInputGain = .5;
+
+// NTF(z) = B(z) / A(z), order 7. B has its zeros on the unit circle at the roots of
+// the Legendre polynomial P7 scaled to pi / 64, A is the Butterworth highpass that
+// gives max |NTF| = 1.3. The modulator runs
+//   v = x + sum of c[k] * s[n - k], c = b - a
+//   y = sign(v), e = y - v
+//   s[n] = e - sum of a[k] * s[n - k]
+// which makes y = x + NTF * e. In simulation it stays stable up to 74% modulation
+// or more from dc to 20 kHz.
+static const double a[7] =
+{
+	-6.4737547313342017, 17.979709100400509, -27.76946167990199, 25.758433672487222,
+	-14.349100916449128, 4.444740210468213, -0.59056542164166603
+};
+
+static const double c[7] =
+{
+	-0.52235343610867258, 3.0008359988885296, -7.1916327796097441, 9.2026607870245059,
+	-6.6314441828399069, 2.5513679569746603, -0.40943457835833363
+};
+
+// |v| stays below 3 while the loop is stable, beyond that it has run away
+static const double kUnstable = 8.;
+
+
+//-------------------------------------------------------------------------------------------
+
+ASIODSDModulator::ASIODSDModulator()
+	: sampleType(0), interpolation(0), linearSteps(0), numStages(0)
+{
+}
+
+bool ASIODSDModulator::setup(long type, double pcmRate, double dsdRate, long numChannels)
+{
+	long multiple = (long)(dsdRate / kDSD64Rate + .5);
+	if(type != ASIOSTDSDInt8LSB1 && type != ASIOSTDSDInt8MSB1)
+		return false;
+	if((multiple != 1 && multiple != 2) || dsdRate != multiple * kDSD64Rate)
+		return false;
+	if((pcmRate != 88200. && pcmRate != 176400.) || numChannels < 0)
+		return false;
+
+	sampleType = type;
+	numStages = pcmRate == 176400. ? 1 : 2;
+	linearSteps = (long)(dsdRate / kLinearRate);
+	interpolation = linearSteps << numStages;
+
+	// the first halfband defines the passband, after it a shorter one only
+	// has to remove the images of what the first one passed
+	for(long s = 0; s < numStages; s++)
+	{
+		Halfband& hb = halfbands[s];
+		hb.halfLength = s == 0 ? 16 : 8;
+		hb.taps.resize(2 * hb.halfLength);
+		ASIODesignHalfband(&hb.taps[0], hb.halfLength, kHalfbandBeta);
+		for(long j = 0; j < 2 * hb.halfLength; j++)
+			hb.taps[j] *= 2.f;
+	}
+
+	channels.resize(numChannels);
+	for(long i = 0; i < numChannels; i++)
+	{
+		for(long s = 0; s < numStages; s++)
+			channels[i].history[s].resize(2 * halfbands[s].halfLength - 1 + (kChunkFrames << s));
+	}
+	reset();
+	return true;
+}
+
+void ASIODSDModulator::reset()
+{
+	for(size_t i = 0; i < channels.size(); i++)
+	{
+		Channel& c = channels[i];
+		for(long s = 0; s < numStages; s++)
+			memset(&c.history[s][0], 0, c.history[s].size() * sizeof(float));
+		c.last = 0.f;
+		memset(c.state, 0, sizeof(c.state));
+		c.restarts = 0;
+	}
+}
+
+unsigned long ASIODSDModulator::getRestarts(long channel) const
+{
+	if(channel < 0 || channel >= (long)channels.size())
+		return 0;
+	return channels[channel].restarts;
+}
+
+void ASIODSDModulator::process(long channel, const float *source, void *dest, long frames)
+{
+	if(channel < 0 || channel >= (long)channels.size())
+		return;
+	Channel& c = channels[channel];
+	unsigned char* out = (unsigned char*)dest;
+	float buffer[kChunkFrames << kMaxStages];
+	while(frames > 0)
+	{
+		long n = frames < kChunkFrames ? frames : (long)kChunkFrames;
+		const float* in = source;
+		long count = n;
+		for(long s = 0; s < numStages; s++)
+		{
+			count = halfband(halfbands[s], c.history[s], in, count, buffer);
+			in = buffer;
+		}
+		modulate(c, buffer, count, out);
+		out += count * linearSteps / 8;
+		source += n;
+		frames -= n;
+	}
+}
+
+// y[2n] = sum of 2 * g[2j] * x[n - j] and y[2n + 1] = x[n - halfLength + 1], the
+// even taps are symmetric so the correlation of the kernel needs no reversal
+long ASIODSDModulator::halfband(const Halfband &h, std::vector<float> &history, const float *source, long count, float *dest)
+{
+	long taps = 2 * h.halfLength;
+	float* x = &history[0];
+	float filtered[kChunkFrames << (kMaxStages - 1)];
+	memcpy(x + taps - 1, source, count * sizeof(float));
+	ASIOGetDSPKernels()->fir(&h.taps[0], taps, x, filtered, count, false);
+	for(long i = 0; i < count; i++)
+	{
+		dest[2 * i] = filtered[i];
+		dest[2 * i + 1] = x[i + h.halfLength];
+	}
+	memmove(x, x + count, (taps - 1) * sizeof(float));
+	return 2 * count;
+}
+
+void ASIODSDModulator::modulate(Channel &ch, const float *source, long count, unsigned char *dest)
+{
+	double s1 = ch.state[0], s2 = ch.state[1], s3 = ch.state[2], s4 = ch.state[3];
+	double s5 = ch.state[4], s6 = ch.state[5], s7 = ch.state[6];
+	const double step = 1. / linearSteps;
+	const bool msb = sampleType == ASIOSTDSDInt8MSB1;
+	double last = ch.last;
+	for(long p = 0; p < count; p++)
+	{
+		float clamped = source[p] > kMaxInput ? kMaxInput : source[p] < -kMaxInput ? -kMaxInput : source[p];
+		double next = clamped * kInputGain;
+		double slope = (next - last) * step;
+		for(long i = 0; i < linearSteps; i += 8)
+		{
+			unsigned int byte = 0;
+			for(int k = 0; k < 8; k++)
+			{
+				double x = last + slope * (double)(i + k + 1);
+				double v = x + c[0] * s1 + c[1] * s2 + c[2] * s3 + c[3] * s4 + c[4] * s5 + c[5] * s6 + c[6] * s7;
+				double y = v >= 0. ? 1. : -1.;
+				double s0 = (y - v) - (a[0] * s1 + a[1] * s2 + a[2] * s3 + a[3] * s4 + a[4] * s5 + a[5] * s6 + a[6] * s7);
+				s7 = s6; s6 = s5; s5 = s4; s4 = s3; s3 = s2; s2 = s1; s1 = s0;
+				if(v >= 0.)
+					byte |= msb ? 0x80u >> k : 1u << k;
+				if(v > kUnstable || v < -kUnstable)
+				{
+					s1 = s2 = s3 = s4 = s5 = s6 = s7 = 0.;
+					ch.restarts++;
+				}
+			}
+			*dest++ = (unsigned char)byte;
+		}
+		last = next;
+	}
+	ch.last = (float)last;
+	ch.state[0] = s1; ch.state[1] = s2; ch.state[2] = s3; ch.state[3] = s4;
+	ch.state[4] = s5; ch.state[5] = s6; ch.state[6] = s7;
+}
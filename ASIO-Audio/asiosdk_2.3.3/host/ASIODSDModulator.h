@@ -0,0 +1,78 @@
+#ifndef __ASIODSDModulator__
+#define __ASIODSDModulator__
+
+// PCM to DSD for the outputs of a driver in DSD mode (kAsioSetIoFormat with
+// kASIODSDFormat). 88.2 or 176.4 kHz float samples are interpolated to the DSD64
+// or DSD128 rate and requantized to 1 bit by a 7th order sigma-delta modulator:
+//
+//   1. one or two halfband FIRs to 352.8 kHz, on the fir kernel of ASIODSPKernels.h
+//   2. linear interpolation to the DSD rate
+//   3. error feedback modulator, noise transfer function with zeros spread over
+//      the lowest 1/128 of the DSD rate (22.05 kHz at DSD64, 44.1 kHz at DSD128)
+//      and poles that keep its out of band gain at 1.3
+//
+// PCM full scale is the SACD reference level of 50% modulation, samples are
+// limited to 1.4 (70%) where a 1 bit modulator of this order is still stable.
+// ASIODSDDecimator reads the stream back 6 dB lower.
+
+#include <vector>
+
+class ASIODSDModulator
+{
+public:
+	ASIODSDModulator();
+	~ASIODSDModulator() {}
+
+	// sampleType is ASIOSTDSDInt8LSB1 or ASIOSTDSDInt8MSB1, pcmRate 88200 or 176400 and
+	// dsdRate 2822400 or 5644800. Allocates all buffers, call it before the buffers run.
+	// false for other combinations.
+	bool setup(long sampleType, double pcmRate, double dsdRate, long numChannels);
+
+	// restarts all channels from silence
+	void reset();
+
+	// dsd samples per pcm sample, 0 before setup
+	long getInterpolation() const { return interpolation; }
+
+	// one buffer half of one channel, frames pcm samples from source to
+	// frames * getInterpolation() dsd samples packed into dest
+	void process(long channel, const float *source, void *dest, long frames);
+
+	// how often the modulator of a channel went unstable and was restarted
+	unsigned long getRestarts(long channel) const;
+
+private:
+	enum
+	{
+		kChunkFrames = 64,		// pcm samples per pass through the stages
+		kMaxStages = 2,
+		kOrder = 7
+	};
+
+	// halfband FIR interpolating by 2, the even taps scaled by 2 for the gain
+	typedef struct Halfband
+	{
+		std::vector<float> taps;
+		long halfLength;
+	} Halfband;
+
+	typedef struct Channel
+	{
+		std::vector<float> history[kMaxStages];	// 2 * halfLength - 1 samples, then the chunk
+		float last;								// 352.8 kHz sample the interpolation starts from
+		double state[kOrder];					// modulator, the newest first
+		unsigned long restarts;
+	} Channel;
+
+	long halfband(const Halfband &h, std::vector<float> &history, const float *source, long count, float *dest);
+	void modulate(Channel &c, const float *source, long count, unsigned char *dest);
+
+	long sampleType;
+	long interpolation;
+	long linearSteps;		// dsd samples per 352.8 kHz sample
+	Halfband halfbands[kMaxStages];
+	long numStages;
+	std::vector<Channel> channels;
+};
+
+#endif
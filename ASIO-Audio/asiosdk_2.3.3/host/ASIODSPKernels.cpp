@@ -0,0 +1,234 @@
+#include "ginclude.h"
+#include "ASIODSPKernels.h"
+#include <math.h>
+
+static ASIODSPKernels kernels;
+static bool kernelsSelected = false;
+
+
+//-------------------------------------------------------------------------------------------
+// kernel selection, the levels of ASIOGetSupportedConvertISA()
+
+ASIOConvertISA ASIOSelectDSPKernels(ASIOConvertISA isa)
+{
+	ASIOConvertISA supported = ASIOGetSupportedConvertISA();
+	if(isa > supported)
+		isa = supported;
+
+	ASIOInstallScalarDSPKernels(&kernels);
+#if ASIO_CONVERT_X86
+	if(isa >= kASIOConvertSSE2)
+		ASIOInstallSSE2DSPKernels(&kernels);
+	if(isa >= kASIOConvertAVX2)
+		ASIOInstallAVX2DSPKernels(&kernels);
+	if(isa >= kASIOConvertAVX512)
+		ASIOInstallAVX512DSPKernels(&kernels);
+#endif
+	kernels.isa = isa;
+	kernelsSelected = true;
+	return isa;
+}
+
+const ASIODSPKernels *ASIOGetDSPKernels()
+{
+	if(!kernelsSelected)
+		ASIOSelectDSPKernels(kASIOConvertAuto);
+	return &kernels;
+}
+
+
+
+//-------------------------------------------------------------------------------------------
+// filters
+
+void ASIOFirScalar(const float *taps, long numTaps, const float *source, float *dest,
+	long frames, bool accumulate)
+{
+	for(long i = 0; i < frames; i++)
+	{
+		float sum = accumulate ? dest[i] : 0.f;
+		for(long j = 0; j < numTaps; j++)
+			sum += taps[j] * source[i + j];
+		dest[i] = sum;
+	}
+}
+
+long ASIOPolyphaseScalar(const float *bank, long numTaps, long numPhases, long step,
+	long *phase, const float *source, float *dest, long frames)
+{
+	long p = *phase;
+	long x = 0;
+	for(long i = 0; i < frames; i++)
+	{
+		const float* h = bank + p * numTaps;
+		const float* in = source + x;
+		float s[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+		for(long j = 0; j < numTaps; j += 8)
+		{
+			for(long k = 0; k < 8; k++)
+				s[k] += h[j + k] * in[j + k];
+		}
+		dest[i] = ((s[0] + s[4]) + (s[2] + s[6])) + ((s[1] + s[5]) + (s[3] + s[7]));
+		p += step;
+		x += p / numPhases;
+		p %= numPhases;
+	}
+	*phase = p;
+	return x;
+}
+
+void ASIOFFTPassScalar(const float *x, float *y, long size, long n, long s, const float *twiddles)
+{
+	const float* xr = x;
+	const float* xi = x + size;
+	float* yr = y;
+	float* yi = y + size;
+	if(n == 2)
+	{
+		for(long q = 0; q < s; q++)
+		{
+			float ar = xr[q], ai = xi[q], br = xr[q + s], bi = xi[q + s];
+			yr[q] = ar + br;
+			yi[q] = ai + bi;
+			yr[q + s] = ar - br;
+			yi[q + s] = ai - bi;
+		}
+		return;
+	}
+	long m = n / 4;
+	const float* w1r = twiddles;
+	const float* w1i = twiddles + m;
+	const float* w2r = twiddles + 2 * m;
+	const float* w2i = twiddles + 3 * m;
+	const float* w3r = twiddles + 4 * m;
+	const float* w3i = twiddles + 5 * m;
+	for(long p = 0; p < m; p++)
+	{
+		for(long q = 0; q < s; q++)
+		{
+			long i = q + s * p;
+			long o = q + s * 4 * p;
+			float a0r = xr[i], a0i = xi[i];
+			float a1r = xr[i + s * m], a1i = xi[i + s * m];
+			float a2r = xr[i + 2 * s * m], a2i = xi[i + 2 * s * m];
+			float a3r = xr[i + 3 * s * m], a3i = xi[i + 3 * s * m];
+			float t0r = a0r + a2r, t0i = a0i + a2i;
+			float t1r = a0r - a2r, t1i = a0i - a2i;
+			float t2r = a1r + a3r, t2i = a1i + a3i;
+			float t3r = a1r - a3r, t3i = a1i - a3i;
+			yr[o] = t0r + t2r;
+			yi[o] = t0i + t2i;
+			// t1 - i t3, t0 - t2 and t1 + i t3 times their twiddles
+			float br = t1r + t3i, bi = t1i - t3r;
+			yr[o + s] = br * w1r[p] - bi * w1i[p];
+			yi[o + s] = br * w1i[p] + bi * w1r[p];
+			br = t0r - t2r;
+			bi = t0i - t2i;
+			yr[o + 2 * s] = br * w2r[p] - bi * w2i[p];
+			yi[o + 2 * s] = br * w2i[p] + bi * w2r[p];
+			br = t1r - t3i;
+			bi = t1i + t3r;
+			yr[o + 3 * s] = br * w3r[p] - bi * w3i[p];
+			yi[o + 3 * s] = br * w3i[p] + bi * w3r[p];
+		}
+	}
+}
+
+// spectrum by spectrum over all bins, every bin still sums in the order of p
+void ASIOMultiplySpectraScalar(const float *const *x, const float *const *h, long numSpectra,
+	float *sum, long count)
+{
+	float* sr = sum;
+	float* si = sum + count;
+	for(long k = 0; k < count; k++)
+		sr[k] = si[k] = 0.f;
+	for(long p = 0; p < numSpectra; p++)
+	{
+		const float* xr = x[p];
+		const float* xi = x[p] + count;
+		const float* hr = h[p];
+		const float* hi = h[p] + count;
+		for(long k = 0; k < count; k++)
+		{
+			sr[k] += xr[k] * hr[k] - xi[k] * hi[k];
+			si[k] += xr[k] * hi[k] + xi[k] * hr[k];
+		}
+	}
+}
+
+// frame by frame through all stages, like the SIMD kernels
+void ASIOBiquadScalar(const float *coefficients, float *state, float *block, long numStages, long frames)
+{
+	for(long i = 0; i < frames; i++)
+	{
+		float* x = block + i * 16;
+		for(long s = 0; s < numStages; s++)
+		{
+			const float* c = coefficients + s * 80;
+			float* z = state + s * 32;
+			for(long ch = 0; ch < 16; ch++)
+			{
+				float y = c[ch] * x[ch] + z[ch];
+				z[ch] = (c[16 + ch] * x[ch] - c[48 + ch] * y) + z[16 + ch];
+				z[16 + ch] = c[32 + ch] * x[ch] - c[64 + ch] * y;
+				x[ch] = y;
+			}
+		}
+	}
+}
+
+float ASIOMeterScalar(const float *source, long frames, float *sumSquares)
+{
+	float peak = 0.f;
+	for(long i = 0; i < frames; i++)
+	{
+		float a = fabsf(source[i]);
+		peak = a > peak ? a : peak;
+	}
+	if(sumSquares)
+	{
+		float s[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+		for(long i = 0; i < frames; i++)
+			s[i & 7] += source[i] * source[i];
+		*sumSquares = ((s[0] + s[4]) + (s[2] + s[6])) + ((s[1] + s[5]) + (s[3] + s[7]));
+	}
+	return peak;
+}
+
+float ASIOTruePeakScalar(const float *taps, const float *source, long frames)
+{
+	float peak = 0.f;
+	for(long i = 0; i < frames; i++)
+	{
+		const float* x = source + i;
+		float s = 0.f;
+		float d = 0.f;
+		float c = 0.f;
+		for(long j = 0; j < 6; j++)
+		{
+			float u = x[j] + x[11 - j];
+			float v = x[j] - x[11 - j];
+			s += taps[j] * u;
+			d += taps[6 + j] * v;
+			c += taps[12 + j] * u;
+		}
+		// the same comparisons as maxps
+		float ac = fabsf(c);
+		float half = .5f * (fabsf(s) + fabsf(d));
+		float level = ac > half ? ac : half;
+		peak = level > peak ? level : peak;
+	}
+	return peak;
+}
+
+void ASIOInstallScalarDSPKernels(ASIODSPKernels *k)
+{
+	k->isa = kASIOConvertScalar;
+	k->fir = ASIOFirScalar;
+	k->polyphase = ASIOPolyphaseScalar;
+	k->fftPass = ASIOFFTPassScalar;
+	k->multiplySpectra = ASIOMultiplySpectraScalar;
+	k->biquad = ASIOBiquadScalar;
+	k->meter = ASIOMeterScalar;
+	k->truePeak = ASIOTruePeakScalar;
+}
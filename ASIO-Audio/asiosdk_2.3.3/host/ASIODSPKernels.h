@@ -0,0 +1,124 @@
+#ifndef __ASIODSPKernels__
+#define __ASIODSPKernels__
+
+// Runtime dispatched signal processing kernels behind the filters, the FFT, the
+// convolver and the meters. They share the instruction sets and the CPUID check of
+// ASIOConvertKernels.h but have a table of their own, selected separately. The scalar
+// kernels in ASIODSPKernels.cpp are the reference, every SIMD variant has to produce
+// bit identical output for all inputs.
+
+#include "ASIOConvertKernels.h"
+
+// FIR filter in correlation form, dest[i] = sum of taps[j] * source[i + j] for j = 0..numTaps - 1,
+// summed in the order of j. source holds frames + numTaps - 1 samples. With accumulate the sum
+// starts at dest[i] instead of 0, a polyphase filter makes one call per phase.
+// NaN sums have the sign and payload of whichever operand the compiler put first.
+typedef void (*ASIOFirKernel)(const float *taps, long numTaps, const float *source, float *dest,
+	long frames, bool accumulate);
+
+// polyphase FIR of a resampler, numPhases filters of numTaps taps one after the other in bank.
+// Output i is the dot product of the taps of phase p with source[x..x + numTaps), then p
+// advances by step and x by the multiples of numPhases it passes. p starts at *phase and x
+// at 0. numTaps is a multiple of 8, the products are summed in 8 partial sums (sum k takes
+// the taps j = k mod 8 in the order of j) that are added as
+// ((s0 + s4) + (s2 + s6)) + ((s1 + s5) + (s3 + s7)). Returns x after the last output and
+// updates *phase. NaN sums have the sign and payload of whichever operand came first.
+typedef long (*ASIOPolyphaseKernel)(const float *bank, long numTaps, long numPhases, long step,
+	long *phase, const float *source, float *dest, long frames);
+
+// one pass of a Stockham FFT over size complex values, x and y hold the real parts and then
+// the imaginary parts. The pass splits sub-transforms of length n at stride s, n * s = size.
+// With m = n / 4 and a[k] = x[q + s * (p + k * m)] for p < m and q < s it writes
+//   y[q + s * 4p]       = (a0 + a2) + (a1 + a3)
+//   y[q + s * (4p + 1)] = ((a0 - a2) - i (a1 - a3)) w^p
+//   y[q + s * (4p + 2)] = ((a0 + a2) - (a1 + a3)) w^2p
+//   y[q + s * (4p + 3)] = ((a0 - a2) + i (a1 - a3)) w^3p
+// where w = exp(-2 pi i / n). twiddles holds the real and the imaginary parts of w^p, w^2p
+// and w^3p, 6 arrays of m. The products are (ar wr - ai wi) + i (ar wi + ai wr). n = 2 is
+// the radix 2 pass y[q] = x[q] + x[q + s], y[q + s] = x[q] - x[q + s] without twiddles.
+typedef void (*ASIOFFTPassKernel)(const float *x, float *y, long size, long n, long s, const float *twiddles);
+
+// the sum of numSpectra products of spectra of a partitioned convolution, bin by bin. Each
+// spectrum holds count real parts, then count imaginary parts, count is a multiple of 16.
+// sum[k] is the complex sum of x[p][k] h[p][k] in the order of p starting at 0, each product
+// (xr hr - xi hi) + i (xr hi + xi hr). sum may not overlap the spectra.
+typedef void (*ASIOSpectrumKernel)(const float *const *x, const float *const *h, long numSpectra,
+	float *sum, long count);
+
+// numStages biquads in series on 16 channels, the samples of each frame side by side in
+// block[frame * 16 + channel], filtered in place. Stage s of each channel is a transposed
+// direct form II evaluated as written:
+//   y = b0 x + z1
+//   z1 = (b1 x - a1 y) + z2
+//   z2 = b2 x - a2 y
+// coefficients holds b0, b1, b2, a1 and a2 of stage s in 5 arrays of 16 from s * 80 on,
+// state z1 and z2 in 2 arrays of 16 from s * 32 on.
+typedef void (*ASIOBiquadKernel)(const float *coefficients, float *state, float *block, long numStages,
+	long frames);
+
+// levels of frames samples for the meters. Returns the largest magnitude, NaN samples don't
+// count. With sumSquares the squares are summed in 8 partial sums (sample i into sum i mod 8,
+// in the order of i) that are added like in the polyphase kernel, into *sumSquares.
+// A NaN sum has the sign and payload of whichever operand came first.
+typedef float (*ASIOMeterKernel)(const float *source, long frames, float *sumSquares);
+
+// largest magnitude between the samples of a 4 times oversampling, NaN doesn't count. Of the
+// 4 phases of 12 taps, the one with the samples is left out, a and its mirror b (b[j] = a[11 - j])
+// and the symmetric c are left. taps holds a[j] + a[11 - j], a[j] - a[11 - j] and c[j] for
+// j = 0..5. Output i sums u[j] = x[i + j] + x[i + 11 - j] and v[j] = x[i + j] - x[i + 11 - j] for
+// the 3 dot products s = sum of (a + b) u, d = sum of (a - b) v and c = sum of c u in the order
+// of j, its level is the larger of |c| and .5 * (|s| + |d|), which is max(|a x|, |b x|).
+// source holds frames + 11 samples.
+typedef float (*ASIOTruePeakKernel)(const float *taps, const float *source, long frames);
+
+typedef struct ASIODSPKernels
+{
+	ASIOConvertISA isa;
+
+	// filters, see ASIODSDDecimator.h and ASIOResampler.h
+	ASIOFirKernel fir;
+	ASIOPolyphaseKernel polyphase;
+
+	// spectrum, see ASIOFFT.h
+	ASIOFFTPassKernel fftPass;
+
+	// convolution, see ASIOConvolver.h
+	ASIOSpectrumKernel multiplySpectra;
+
+	// equalizers and crossovers, see ASIOBiquadBank.h
+	ASIOBiquadKernel biquad;
+
+	// levels, see ASIOMeter.h
+	ASIOMeterKernel meter;
+	ASIOTruePeakKernel truePeak;
+} ASIODSPKernels;
+
+// select the kernels once at startup, before any audio is running, like
+// ASIOSelectConvertKernels(). Requests above the supported level are lowered, the
+// selected level is returned.
+ASIOConvertISA ASIOSelectDSPKernels(ASIOConvertISA isa);
+const ASIODSPKernels *ASIOGetDSPKernels();
+
+//-------------------------------------------------------------------------------------------
+// scalar reference kernels, also used for the tails of the SIMD kernels
+
+void ASIOFirScalar(const float *taps, long numTaps, const float *source, float *dest,
+	long frames, bool accumulate);
+void ASIOFFTPassScalar(const float *x, float *y, long size, long n, long s, const float *twiddles);
+void ASIOMultiplySpectraScalar(const float *const *x, const float *const *h, long numSpectra,
+	float *sum, long count);
+void ASIOBiquadScalar(const float *coefficients, float *state, float *block, long numStages, long frames);
+float ASIOMeterScalar(const float *source, long frames, float *sumSquares);
+float ASIOTruePeakScalar(const float *taps, const float *source, long frames);
+long ASIOPolyphaseScalar(const float *bank, long numTaps, long numPhases, long step,
+	long *phase, const float *source, float *dest, long frames);
+
+// each installer only replaces the kernels it implements
+void ASIOInstallScalarDSPKernels(ASIODSPKernels *kernels);
+#if ASIO_CONVERT_X86
+void ASIOInstallSSE2DSPKernels(ASIODSPKernels *kernels);
+void ASIOInstallAVX2DSPKernels(ASIODSPKernels *kernels);
+void ASIOInstallAVX512DSPKernels(ASIODSPKernels *kernels);
+#endif
+
+#endif
@@ -0,0 +1,333 @@
+#include "ginclude.h"
+#include "ASIODSPSIMD.h"
+
+#if ASIO_CONVERT_X86
+
+// AVX2 kernels, 8 or 16 outputs, bins or channels per iteration
+
+//-------------------------------------------------------------------------------------------
+// filters, 16 outputs per iteration. No FMA, the product is rounded before the add like
+// in the reference.
+
+static ASIO_AVX2 void firAVX2(const float *taps, long numTaps, const float *source, float *dest,
+	long frames, bool accumulate)
+{
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m256 a = accumulate ? _mm256_loadu_ps(dest + i) : _mm256_setzero_ps();
+		__m256 b = accumulate ? _mm256_loadu_ps(dest + i + 8) : _mm256_setzero_ps();
+		const float* x = source + i;
+		for(long j = 0; j < numTaps; j++)
+		{
+			__m256 t = _mm256_broadcast_ss(taps + j);
+			a = _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_loadu_ps(x + j)));
+			b = _mm256_add_ps(b, _mm256_mul_ps(t, _mm256_loadu_ps(x + j + 8)));
+		}
+		_mm256_storeu_ps(dest + i, a);
+		_mm256_storeu_ps(dest + i + 8, b);
+	}
+	ASIOFirScalar(taps, numTaps, source + n, dest + n, frames - n, accumulate);
+}
+
+// the 8 partial sums of one output, added in the order of the reference
+static inline ASIO_AVX2 float reducePolyphase(__m256 s)
+{
+	__m128 t = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+	t = _mm_add_ps(t, _mm_movehl_ps(t, t));
+	return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+// two outputs per iteration, one accumulator each. A single one would wait for
+// the latency of every add.
+static ASIO_AVX2 long polyphaseAVX2(const float *bank, long numTaps, long numPhases, long step,
+	long *phase, const float *source, float *dest, long frames)
+{
+	long p = *phase;
+	long x = 0;
+	long i = 0;
+	for(; i + 2 <= frames; i += 2)
+	{
+		long p1 = p + step;
+		long x1 = x + p1 / numPhases;
+		p1 %= numPhases;
+		const float* h0 = bank + p * numTaps;
+		const float* h1 = bank + p1 * numTaps;
+		const float* in0 = source + x;
+		const float* in1 = source + x1;
+		__m256 a = _mm256_setzero_ps();
+		__m256 b = _mm256_setzero_ps();
+		for(long j = 0; j < numTaps; j += 8)
+		{
+			a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_loadu_ps(h0 + j), _mm256_loadu_ps(in0 + j)));
+			b = _mm256_add_ps(b, _mm256_mul_ps(_mm256_loadu_ps(h1 + j), _mm256_loadu_ps(in1 + j)));
+		}
+		dest[i] = reducePolyphase(a);
+		dest[i + 1] = reducePolyphase(b);
+		p = p1 + step;
+		x = x1 + p / numPhases;
+		p %= numPhases;
+	}
+	*phase = p;
+	return x + ASIOPolyphaseScalar(bank, numTaps, numPhases, step, phase, source + x, dest + i, frames - i);
+}
+
+static inline ASIO_AVX2 void fftButterfly8(const __m256 a[8], const __m256 w[6], __m256 y[8])
+{
+	__m256 t0r = _mm256_add_ps(a[0], a[2]);
+	__m256 t0i = _mm256_add_ps(a[4], a[6]);
+	__m256 t1r = _mm256_sub_ps(a[0], a[2]);
+	__m256 t1i = _mm256_sub_ps(a[4], a[6]);
+	__m256 t2r = _mm256_add_ps(a[1], a[3]);
+	__m256 t2i = _mm256_add_ps(a[5], a[7]);
+	__m256 t3r = _mm256_sub_ps(a[1], a[3]);
+	__m256 t3i = _mm256_sub_ps(a[5], a[7]);
+	y[0] = _mm256_add_ps(t0r, t2r);
+	y[4] = _mm256_add_ps(t0i, t2i);
+	__m256 br = _mm256_add_ps(t1r, t3i);
+	__m256 bi = _mm256_sub_ps(t1i, t3r);
+	y[1] = _mm256_sub_ps(_mm256_mul_ps(br, w[0]), _mm256_mul_ps(bi, w[1]));
+	y[5] = _mm256_add_ps(_mm256_mul_ps(br, w[1]), _mm256_mul_ps(bi, w[0]));
+	br = _mm256_sub_ps(t0r, t2r);
+	bi = _mm256_sub_ps(t0i, t2i);
+	y[2] = _mm256_sub_ps(_mm256_mul_ps(br, w[2]), _mm256_mul_ps(bi, w[3]));
+	y[6] = _mm256_add_ps(_mm256_mul_ps(br, w[3]), _mm256_mul_ps(bi, w[2]));
+	br = _mm256_sub_ps(t1r, t3i);
+	bi = _mm256_add_ps(t1i, t3r);
+	y[3] = _mm256_sub_ps(_mm256_mul_ps(br, w[4]), _mm256_mul_ps(bi, w[5]));
+	y[7] = _mm256_add_ps(_mm256_mul_ps(br, w[5]), _mm256_mul_ps(bi, w[4]));
+}
+
+// 4 rows of 8 to 8 rows of 4, row j in the low half of r[j] and row 4 + j in the high one
+// after the transposes within the halves, then paired up to 2 rows per register
+static inline ASIO_AVX2 void transpose4x8(__m256 r[4])
+{
+	__m256 a0 = _mm256_unpacklo_ps(r[0], r[1]);
+	__m256 a1 = _mm256_unpacklo_ps(r[2], r[3]);
+	__m256 a2 = _mm256_unpackhi_ps(r[0], r[1]);
+	__m256 a3 = _mm256_unpackhi_ps(r[2], r[3]);
+	__m256 b0 = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 b1 = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 b2 = _mm256_shuffle_ps(a2, a3, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 b3 = _mm256_shuffle_ps(a2, a3, _MM_SHUFFLE(3, 2, 3, 2));
+	r[0] = _mm256_permute2f128_ps(b0, b1, 0x20);
+	r[1] = _mm256_permute2f128_ps(b2, b3, 0x20);
+	r[2] = _mm256_permute2f128_ps(b0, b1, 0x31);
+	r[3] = _mm256_permute2f128_ps(b2, b3, 0x31);
+}
+
+// 8 lanes over q or over p in the first pass like fftPass4(), which takes the rest
+static ASIO_AVX2 void fftPassAVX2(const float *x, float *y, long size, long n, long s, const float *twiddles)
+{
+	long m = n / 4;
+	const float* xi = x + size;
+	float* yi = y + size;
+	__m256 a[8];
+	__m256 w[6];
+	__m256 b[8];
+	if(n == 2 && s % 8 == 0)
+	{
+		for(long q = 0; q < s; q += 8)
+		{
+			__m256 ar = _mm256_loadu_ps(x + q);
+			__m256 ai = _mm256_loadu_ps(xi + q);
+			__m256 br = _mm256_loadu_ps(x + q + s);
+			__m256 bi = _mm256_loadu_ps(xi + q + s);
+			_mm256_storeu_ps(y + q, _mm256_add_ps(ar, br));
+			_mm256_storeu_ps(yi + q, _mm256_add_ps(ai, bi));
+			_mm256_storeu_ps(y + q + s, _mm256_sub_ps(ar, br));
+			_mm256_storeu_ps(yi + q + s, _mm256_sub_ps(ai, bi));
+		}
+	}
+	else if(n > 2 && s % 8 == 0)
+	{
+		for(long p = 0; p < m; p++)
+		{
+			for(long j = 0; j < 6; j++)
+				w[j] = _mm256_broadcast_ss(twiddles + j * m + p);
+			for(long q = 0; q < s; q += 8)
+			{
+				long i = q + s * p;
+				long o = q + s * 4 * p;
+				for(long k = 0; k < 4; k++)
+				{
+					a[k] = _mm256_loadu_ps(x + i + k * s * m);
+					a[4 + k] = _mm256_loadu_ps(xi + i + k * s * m);
+				}
+				fftButterfly8(a, w, b);
+				for(long k = 0; k < 4; k++)
+				{
+					_mm256_storeu_ps(y + o + k * s, b[k]);
+					_mm256_storeu_ps(yi + o + k * s, b[4 + k]);
+				}
+			}
+		}
+	}
+	else if(n > 2 && s == 1 && m % 8 == 0)
+	{
+		for(long p = 0; p < m; p += 8)
+		{
+			for(long j = 0; j < 6; j++)
+				w[j] = _mm256_loadu_ps(twiddles + j * m + p);
+			for(long k = 0; k < 4; k++)
+			{
+				a[k] = _mm256_loadu_ps(x + p + k * m);
+				a[4 + k] = _mm256_loadu_ps(xi + p + k * m);
+			}
+			fftButterfly8(a, w, b);
+			transpose4x8(b);
+			transpose4x8(b + 4);
+			for(long j = 0; j < 4; j++)
+			{
+				_mm256_storeu_ps(y + 4 * p + 8 * j, b[j]);
+				_mm256_storeu_ps(yi + 4 * p + 8 * j, b[4 + j]);
+			}
+		}
+	}
+	else
+		fftPass4(x, y, size, n, s, twiddles);
+}
+
+// multiplySpectraSSE2() with 16 bins in vectors of 8
+static ASIO_AVX2 void multiplySpectraAVX2(const float *const *x, const float *const *h, long numSpectra,
+	float *sum, long count)
+{
+	for(long k = 0; k < count; k += 16)
+	{
+		__m256 sr0 = _mm256_setzero_ps(), sr1 = _mm256_setzero_ps();
+		__m256 si0 = _mm256_setzero_ps(), si1 = _mm256_setzero_ps();
+		for(long p = 0; p < numSpectra; p++)
+		{
+			const float* a = x[p] + k;
+			const float* b = h[p] + k;
+			__m256 xr0 = _mm256_loadu_ps(a), xr1 = _mm256_loadu_ps(a + 8);
+			__m256 xi0 = _mm256_loadu_ps(a + count), xi1 = _mm256_loadu_ps(a + count + 8);
+			__m256 hr0 = _mm256_loadu_ps(b), hr1 = _mm256_loadu_ps(b + 8);
+			__m256 hi0 = _mm256_loadu_ps(b + count), hi1 = _mm256_loadu_ps(b + count + 8);
+			sr0 = _mm256_add_ps(sr0, _mm256_sub_ps(_mm256_mul_ps(xr0, hr0), _mm256_mul_ps(xi0, hi0)));
+			sr1 = _mm256_add_ps(sr1, _mm256_sub_ps(_mm256_mul_ps(xr1, hr1), _mm256_mul_ps(xi1, hi1)));
+			si0 = _mm256_add_ps(si0, _mm256_add_ps(_mm256_mul_ps(xr0, hi0), _mm256_mul_ps(xi0, hr0)));
+			si1 = _mm256_add_ps(si1, _mm256_add_ps(_mm256_mul_ps(xr1, hi1), _mm256_mul_ps(xi1, hr1)));
+		}
+		_mm256_storeu_ps(sum + k, sr0);
+		_mm256_storeu_ps(sum + k + 8, sr1);
+		_mm256_storeu_ps(sum + count + k, si0);
+		_mm256_storeu_ps(sum + count + k + 8, si1);
+	}
+}
+
+// biquadSSE2() with 2 vectors of 8
+static ASIO_AVX2 void biquadAVX2(const float *coefficients, float *state, float *block, long numStages, long frames)
+{
+	for(long i = 0; i < frames; i++)
+	{
+		float* b = block + i * 16;
+		__m256 x0 = _mm256_loadu_ps(b);
+		__m256 x1 = _mm256_loadu_ps(b + 8);
+		for(long s = 0; s < numStages; s++)
+		{
+			const float* c = coefficients + s * 80;
+			float* z = state + s * 32;
+			__m256 y0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(c), x0), _mm256_loadu_ps(z));
+			__m256 y1 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(c + 8), x1), _mm256_loadu_ps(z + 8));
+			__m256 z0 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(c + 16), x0), _mm256_mul_ps(_mm256_loadu_ps(c + 48), y0));
+			__m256 z1 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(c + 24), x1), _mm256_mul_ps(_mm256_loadu_ps(c + 56), y1));
+			_mm256_storeu_ps(z, _mm256_add_ps(z0, _mm256_loadu_ps(z + 16)));
+			_mm256_storeu_ps(z + 8, _mm256_add_ps(z1, _mm256_loadu_ps(z + 24)));
+			_mm256_storeu_ps(z + 16, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(c + 32), x0), _mm256_mul_ps(_mm256_loadu_ps(c + 64), y0)));
+			_mm256_storeu_ps(z + 24, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(c + 40), x1), _mm256_mul_ps(_mm256_loadu_ps(c + 72), y1)));
+			x0 = y0;
+			x1 = y1;
+		}
+		_mm256_storeu_ps(b, x0);
+		_mm256_storeu_ps(b + 8, x1);
+	}
+}
+
+// one accumulator holds the 8 partial sums, two peaks hide the latency of maxps
+static ASIO_AVX2 float meterAVX2(const float *source, long frames, float *sumSquares)
+{
+	const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	__m256 peak0 = _mm256_setzero_ps();
+	__m256 peak1 = _mm256_setzero_ps();
+	__m256 sum = _mm256_setzero_ps();
+	long n = frames & ~15L;
+	for(long i = 0; i < n; i += 16)
+	{
+		__m256 a = _mm256_loadu_ps(source + i);
+		__m256 b = _mm256_loadu_ps(source + i + 8);
+		peak0 = _mm256_max_ps(_mm256_and_ps(a, abs), peak0);
+		peak1 = _mm256_max_ps(_mm256_and_ps(b, abs), peak1);
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(a, a));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(b, b));
+	}
+	if(frames - n >= 8)
+	{
+		__m256 a = _mm256_loadu_ps(source + n);
+		peak0 = _mm256_max_ps(_mm256_and_ps(a, abs), peak0);
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(a, a));
+		n += 8;
+	}
+	__m256 m = _mm256_max_ps(peak0, peak1);
+	__m128 peak = _mm_max_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1));
+	peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+	peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 1, 1, 1)));
+	float p = _mm_cvtss_f32(peak);
+	float tail = ASIOMeterScalar(source + n, frames - n, 0);
+	p = tail > p ? tail : p;
+	if(sumSquares)
+	{
+		float s[8];
+		_mm256_storeu_ps(s, sum);
+		for(long i = n; i < frames; i++)
+			s[i - n] += source[i] * source[i];
+		*sumSquares = ((s[0] + s[4]) + (s[2] + s[6])) + ((s[1] + s[5]) + (s[3] + s[7]));
+	}
+	return p;
+}
+
+// 8 outputs per iteration
+static ASIO_AVX2 float truePeakAVX2(const float *taps, const float *source, long frames)
+{
+	const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	__m256 peak = _mm256_setzero_ps();
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		const float* x = source + i;
+		__m256 s = _mm256_setzero_ps();
+		__m256 d = _mm256_setzero_ps();
+		__m256 c = _mm256_setzero_ps();
+		for(long j = 0; j < 6; j++)
+		{
+			__m256 x0 = _mm256_loadu_ps(x + j);
+			__m256 x1 = _mm256_loadu_ps(x + 11 - j);
+			__m256 u = _mm256_add_ps(x0, x1);
+			__m256 v = _mm256_sub_ps(x0, x1);
+			s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_broadcast_ss(taps + j), u));
+			d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_broadcast_ss(taps + 6 + j), v));
+			c = _mm256_add_ps(c, _mm256_mul_ps(_mm256_broadcast_ss(taps + 12 + j), u));
+		}
+		__m256 half = _mm256_mul_ps(_mm256_set1_ps(.5f), _mm256_add_ps(_mm256_and_ps(s, abs), _mm256_and_ps(d, abs)));
+		peak = _mm256_max_ps(_mm256_max_ps(_mm256_and_ps(c, abs), half), peak);
+	}
+	__m128 p4 = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+	p4 = _mm_max_ps(p4, _mm_movehl_ps(p4, p4));
+	p4 = _mm_max_ss(p4, _mm_shuffle_ps(p4, p4, _MM_SHUFFLE(1, 1, 1, 1)));
+	float p = _mm_cvtss_f32(p4);
+	float tail = ASIOTruePeakScalar(taps, source + n, frames - n);
+	return tail > p ? tail : p;
+}
+
+void ASIOInstallAVX2DSPKernels(ASIODSPKernels *k)
+{
+	k->fir = firAVX2;
+	k->polyphase = polyphaseAVX2;
+	k->fftPass = fftPassAVX2;
+	k->multiplySpectra = multiplySpectraAVX2;
+	k->biquad = biquadAVX2;
+	k->meter = meterAVX2;
+	k->truePeak = truePeakAVX2;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "ginclude.h"
+#include "ASIODSPSIMD.h"
+
+#if ASIO_CONVERT_X86
+
+// AVX-512F kernels, 16 channels, samples or bins per vector. AVX-512F has fused multiply add,
+// GCC and Clang would fuse the products and sums of the intrinsics into it and round
+// differently from the reference, MSVC doesn't contract.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+//-------------------------------------------------------------------------------------------
+// convolution
+
+// multiplySpectraSSE2() with 16 bins per vector, 32 at a time and the last 16 alone
+static ASIO_AVX512 void multiplySpectraAVX512(const float *const *x, const float *const *h, long numSpectra,
+	float *sum, long count)
+{
+	long k = 0;
+	for(; k + 32 <= count; k += 32)
+	{
+		__m512 sr0 = _mm512_setzero_ps(), sr1 = _mm512_setzero_ps();
+		__m512 si0 = _mm512_setzero_ps(), si1 = _mm512_setzero_ps();
+		for(long p = 0; p < numSpectra; p++)
+		{
+			const float* a = x[p] + k;
+			const float* b = h[p] + k;
+			__m512 xr0 = _mm512_loadu_ps(a), xr1 = _mm512_loadu_ps(a + 16);
+			__m512 xi0 = _mm512_loadu_ps(a + count), xi1 = _mm512_loadu_ps(a + count + 16);
+			__m512 hr0 = _mm512_loadu_ps(b), hr1 = _mm512_loadu_ps(b + 16);
+			__m512 hi0 = _mm512_loadu_ps(b + count), hi1 = _mm512_loadu_ps(b + count + 16);
+			sr0 = _mm512_add_ps(sr0, _mm512_sub_ps(_mm512_mul_ps(xr0, hr0), _mm512_mul_ps(xi0, hi0)));
+			sr1 = _mm512_add_ps(sr1, _mm512_sub_ps(_mm512_mul_ps(xr1, hr1), _mm512_mul_ps(xi1, hi1)));
+			si0 = _mm512_add_ps(si0, _mm512_add_ps(_mm512_mul_ps(xr0, hi0), _mm512_mul_ps(xi0, hr0)));
+			si1 = _mm512_add_ps(si1, _mm512_add_ps(_mm512_mul_ps(xr1, hi1), _mm512_mul_ps(xi1, hr1)));
+		}
+		_mm512_storeu_ps(sum + k, sr0);
+		_mm512_storeu_ps(sum + k + 16, sr1);
+		_mm512_storeu_ps(sum + count + k, si0);
+		_mm512_storeu_ps(sum + count + k + 16, si1);
+	}
+	if(k < count)
+	{
+		__m512 sr = _mm512_setzero_ps(), si = _mm512_setzero_ps();
+		for(long p = 0; p < numSpectra; p++)
+		{
+			const float* a = x[p] + k;
+			const float* b = h[p] + k;
+			__m512 xr = _mm512_loadu_ps(a), xi = _mm512_loadu_ps(a + count);
+			__m512 hr = _mm512_loadu_ps(b), hi = _mm512_loadu_ps(b + count);
+			sr = _mm512_add_ps(sr, _mm512_sub_ps(_mm512_mul_ps(xr, hr), _mm512_mul_ps(xi, hi)));
+			si = _mm512_add_ps(si, _mm512_add_ps(_mm512_mul_ps(xr, hi), _mm512_mul_ps(xi, hr)));
+		}
+		_mm512_storeu_ps(sum + k, sr);
+		_mm512_storeu_ps(sum + count + k, si);
+	}
+}
+
+//-------------------------------------------------------------------------------------------
+// filters
+
+// biquadSSE2() with one vector of 16
+static ASIO_AVX512 void biquadAVX512(const float *coefficients, float *state, float *block, long numStages, long frames)
+{
+	for(long i = 0; i < frames; i++)
+	{
+		float* b = block + i * 16;
+		__m512 x = _mm512_loadu_ps(b);
+		for(long s = 0; s < numStages; s++)
+		{
+			const float* c = coefficients + s * 80;
+			float* z = state + s * 32;
+			__m512 y = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(c), x), _mm512_loadu_ps(z));
+			__m512 z1 = _mm512_sub_ps(_mm512_mul_ps(_mm512_loadu_ps(c + 16), x), _mm512_mul_ps(_mm512_loadu_ps(c + 48), y));
+			_mm512_storeu_ps(z, _mm512_add_ps(z1, _mm512_loadu_ps(z + 16)));
+			_mm512_storeu_ps(z + 16, _mm512_sub_ps(_mm512_mul_ps(_mm512_loadu_ps(c + 32), x), _mm512_mul_ps(_mm512_loadu_ps(c + 64), y)));
+			x = y;
+		}
+		_mm512_storeu_ps(b, x);
+	}
+}
+
+void ASIOInstallAVX512DSPKernels(ASIODSPKernels *k)
+{
+	k->multiplySpectra = multiplySpectraAVX512;
+	k->biquad = biquadAVX512;
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include "ginclude.h"
+#include "ASIODSPSIMD.h"
+
+#if ASIO_CONVERT_X86
+
+// SSE2 kernels, the products and sums in the order of the reference so that the
+// results stay bit identical
+
+//-------------------------------------------------------------------------------------------
+// filters, 8 outputs per iteration in two accumulators, the taps in the same order as the
+// reference
+
+static ASIO_SSE2 void firSSE2(const float *taps, long numTaps, const float *source, float *dest,
+	long frames, bool accumulate)
+{
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		__m128 a = accumulate ? _mm_loadu_ps(dest + i) : _mm_setzero_ps();
+		__m128 b = accumulate ? _mm_loadu_ps(dest + i + 4) : _mm_setzero_ps();
+		const float* x = source + i;
+		for(long j = 0; j < numTaps; j++)
+		{
+			__m128 t = _mm_set1_ps(taps[j]);
+			a = _mm_add_ps(a, _mm_mul_ps(t, _mm_loadu_ps(x + j)));
+			b = _mm_add_ps(b, _mm_mul_ps(t, _mm_loadu_ps(x + j + 4)));
+		}
+		_mm_storeu_ps(dest + i, a);
+		_mm_storeu_ps(dest + i + 4, b);
+	}
+	ASIOFirScalar(taps, numTaps, source + n, dest + n, frames - n, accumulate);
+}
+
+// one output at a time, taps 0..3 and 4..7 of each group in two accumulators
+static ASIO_SSE2 long polyphaseSSE2(const float *bank, long numTaps, long numPhases, long step,
+	long *phase, const float *source, float *dest, long frames)
+{
+	long p = *phase;
+	long x = 0;
+	for(long i = 0; i < frames; i++)
+	{
+		const float* h = bank + p * numTaps;
+		const float* in = source + x;
+		__m128 lo = _mm_setzero_ps();
+		__m128 hi = _mm_setzero_ps();
+		for(long j = 0; j < numTaps; j += 8)
+		{
+			lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(h + j), _mm_loadu_ps(in + j)));
+			hi = _mm_add_ps(hi, _mm_mul_ps(_mm_loadu_ps(h + j + 4), _mm_loadu_ps(in + j + 4)));
+		}
+		// s0 + s4 .. s3 + s7, then the even and the odd ones
+		__m128 t = _mm_add_ps(lo, hi);
+		t = _mm_add_ps(t, _mm_movehl_ps(t, t));
+		_mm_store_ss(dest + i, _mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+		p += step;
+		x += p / numPhases;
+		p %= numPhases;
+	}
+	*phase = p;
+	return x;
+}
+
+static ASIO_SSE2 void fftPassSSE2(const float *x, float *y, long size, long n, long s, const float *twiddles)
+{
+	fftPass4(x, y, size, n, s, twiddles);
+}
+
+// 8 bins at a time in 4 sums that stay in registers over all spectra
+static ASIO_SSE2 void multiplySpectraSSE2(const float *const *x, const float *const *h, long numSpectra,
+	float *sum, long count)
+{
+	for(long k = 0; k < count; k += 8)
+	{
+		__m128 sr0 = _mm_setzero_ps(), sr1 = _mm_setzero_ps();
+		__m128 si0 = _mm_setzero_ps(), si1 = _mm_setzero_ps();
+		for(long p = 0; p < numSpectra; p++)
+		{
+			const float* a = x[p] + k;
+			const float* b = h[p] + k;
+			__m128 xr0 = _mm_loadu_ps(a), xr1 = _mm_loadu_ps(a + 4);
+			__m128 xi0 = _mm_loadu_ps(a + count), xi1 = _mm_loadu_ps(a + count + 4);
+			__m128 hr0 = _mm_loadu_ps(b), hr1 = _mm_loadu_ps(b + 4);
+			__m128 hi0 = _mm_loadu_ps(b + count), hi1 = _mm_loadu_ps(b + count + 4);
+			sr0 = _mm_add_ps(sr0, _mm_sub_ps(_mm_mul_ps(xr0, hr0), _mm_mul_ps(xi0, hi0)));
+			sr1 = _mm_add_ps(sr1, _mm_sub_ps(_mm_mul_ps(xr1, hr1), _mm_mul_ps(xi1, hi1)));
+			si0 = _mm_add_ps(si0, _mm_add_ps(_mm_mul_ps(xr0, hi0), _mm_mul_ps(xi0, hr0)));
+			si1 = _mm_add_ps(si1, _mm_add_ps(_mm_mul_ps(xr1, hi1), _mm_mul_ps(xi1, hr1)));
+		}
+		_mm_storeu_ps(sum + k, sr0);
+		_mm_storeu_ps(sum + k + 4, sr1);
+		_mm_storeu_ps(sum + count + k, si0);
+		_mm_storeu_ps(sum + count + k + 4, si1);
+	}
+}
+
+// the 16 channels in 4 vectors, each frame through all stages. The 4 recursions and
+// those of the next frame in the earlier stages overlap.
+static ASIO_SSE2 void biquadSSE2(const float *coefficients, float *state, float *block, long numStages, long frames)
+{
+	for(long i = 0; i < frames; i++)
+	{
+		float* b = block + i * 16;
+		__m128 x[4];
+		for(long v = 0; v < 4; v++)
+			x[v] = _mm_loadu_ps(b + 4 * v);
+		for(long s = 0; s < numStages; s++)
+		{
+			const float* c = coefficients + s * 80;
+			float* z = state + s * 32;
+			for(long v = 0; v < 4; v++)
+			{
+				long o = 4 * v;
+				__m128 y = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c + o), x[v]), _mm_loadu_ps(z + o));
+				__m128 z1 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(c + 16 + o), x[v]), _mm_mul_ps(_mm_loadu_ps(c + 48 + o), y));
+				_mm_storeu_ps(z + o, _mm_add_ps(z1, _mm_loadu_ps(z + 16 + o)));
+				_mm_storeu_ps(z + 16 + o, _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(c + 32 + o), x[v]), _mm_mul_ps(_mm_loadu_ps(c + 64 + o), y)));
+				x[v] = y;
+			}
+		}
+		for(long v = 0; v < 4; v++)
+			_mm_storeu_ps(b + 4 * v, x[v]);
+	}
+}
+
+// samples 0..3 and 4..7 of each group in two accumulators, the tail goes on in
+// the partial sums of the reference
+static ASIO_SSE2 float meterSSE2(const float *source, long frames, float *sumSquares)
+{
+	const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 peak = _mm_setzero_ps();
+	__m128 lo = _mm_setzero_ps();
+	__m128 hi = _mm_setzero_ps();
+	long n = frames & ~7L;
+	for(long i = 0; i < n; i += 8)
+	{
+		__m128 a = _mm_loadu_ps(source + i);
+		__m128 b = _mm_loadu_ps(source + i + 4);
+		// maxps returns its second operand for NaN
+		peak = _mm_max_ps(_mm_and_ps(a, abs), peak);
+		peak = _mm_max_ps(_mm_and_ps(b, abs), peak);
+		lo = _mm_add_ps(lo, _mm_mul_ps(a, a));
+		hi = _mm_add_ps(hi, _mm_mul_ps(b, b));
+	}
+	peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+	peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 1, 1, 1)));
+	float p = _mm_cvtss_f32(peak);
+	float tail = ASIOMeterScalar(source + n, frames - n, 0);
+	p = tail > p ? tail : p;
+	if(sumSquares)
+	{
+		float s[8];
+		_mm_storeu_ps(s, lo);
+		_mm_storeu_ps(s + 4, hi);
+		for(long i = n; i < frames; i++)
+			s[i - n] += source[i] * source[i];
+		*sumSquares = ((s[0] + s[4]) + (s[2] + s[6])) + ((s[1] + s[5]) + (s[3] + s[7]));
+	}
+	return p;
+}
+
+// 4 outputs per iteration
+static ASIO_SSE2 float truePeakSSE2(const float *taps, const float *source, long frames)
+{
+	const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 peak = _mm_setzero_ps();
+	long n = frames & ~3L;
+	for(long i = 0; i < n; i += 4)
+	{
+		const float* x = source + i;
+		__m128 s = _mm_setzero_ps();
+		__m128 d = _mm_setzero_ps();
+		__m128 c = _mm_setzero_ps();
+		for(long j = 0; j < 6; j++)
+		{
+			__m128 x0 = _mm_loadu_ps(x + j);
+			__m128 x1 = _mm_loadu_ps(x + 11 - j);
+			__m128 u = _mm_add_ps(x0, x1);
+			__m128 v = _mm_sub_ps(x0, x1);
+			s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(taps[j]), u));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(taps[6 + j]), v));
+			c = _mm_add_ps(c, _mm_mul_ps(_mm_set1_ps(taps[12 + j]), u));
+		}
+		__m128 half = _mm_mul_ps(_mm_set1_ps(.5f), _mm_add_ps(_mm_and_ps(s, abs), _mm_and_ps(d, abs)));
+		peak = _mm_max_ps(_mm_max_ps(_mm_and_ps(c, abs), half), peak);
+	}
+	peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+	peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 1, 1, 1)));
+	float p = _mm_cvtss_f32(peak);
+	float tail = ASIOTruePeakScalar(taps, source + n, frames - n);
+	return tail > p ? tail : p;
+}
+
+void ASIOInstallSSE2DSPKernels(ASIODSPKernels *k)
+{
+	k->fir = firSSE2;
+	k->polyphase = polyphaseSSE2;
+	k->fftPass = fftPassSSE2;
+	k->multiplySpectra = multiplySpectraSSE2;
+	k->biquad = biquadSSE2;
+	k->meter = meterSSE2;
+	k->truePeak = truePeakSSE2;
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef __ASIODSPSIMD__
+#define __ASIODSPSIMD__
+
+// helpers shared by the SSE2, AVX2 and AVX-512 signal processing kernels, on top of
+// the ones of the conversions
+
+#include "ASIOConvertSIMD.h"
+#include "ASIODSPKernels.h"
+
+#if ASIO_CONVERT_X86
+
+//-------------------------------------------------------------------------------------------
+// fft
+
+// the radix 4 butterfly of the fftPass kernel on 4 lanes, a[k] and y[k] the real and
+// a[4 + k] and y[4 + k] the imaginary parts, w the 6 twiddle arrays of the kernel
+static inline ASIO_SSE2 void fftButterfly4(const __m128 a[8], const __m128 w[6], __m128 y[8])
+{
+	__m128 t0r = _mm_add_ps(a[0], a[2]);
+	__m128 t0i = _mm_add_ps(a[4], a[6]);
+	__m128 t1r = _mm_sub_ps(a[0], a[2]);
+	__m128 t1i = _mm_sub_ps(a[4], a[6]);
+	__m128 t2r = _mm_add_ps(a[1], a[3]);
+	__m128 t2i = _mm_add_ps(a[5], a[7]);
+	__m128 t3r = _mm_sub_ps(a[1], a[3]);
+	__m128 t3i = _mm_sub_ps(a[5], a[7]);
+	y[0] = _mm_add_ps(t0r, t2r);
+	y[4] = _mm_add_ps(t0i, t2i);
+	__m128 br = _mm_add_ps(t1r, t3i);
+	__m128 bi = _mm_sub_ps(t1i, t3r);
+	y[1] = _mm_sub_ps(_mm_mul_ps(br, w[0]), _mm_mul_ps(bi, w[1]));
+	y[5] = _mm_add_ps(_mm_mul_ps(br, w[1]), _mm_mul_ps(bi, w[0]));
+	br = _mm_sub_ps(t0r, t2r);
+	bi = _mm_sub_ps(t0i, t2i);
+	y[2] = _mm_sub_ps(_mm_mul_ps(br, w[2]), _mm_mul_ps(bi, w[3]));
+	y[6] = _mm_add_ps(_mm_mul_ps(br, w[3]), _mm_mul_ps(bi, w[2]));
+	br = _mm_sub_ps(t1r, t3i);
+	bi = _mm_add_ps(t1i, t3r);
+	y[3] = _mm_sub_ps(_mm_mul_ps(br, w[4]), _mm_mul_ps(bi, w[5]));
+	y[7] = _mm_add_ps(_mm_mul_ps(br, w[5]), _mm_mul_ps(bi, w[4]));
+}
+
+static inline ASIO_SSE2 void transpose4x32(__m128 r[4])
+{
+	__m128 a0 = _mm_unpacklo_ps(r[0], r[1]);
+	__m128 a1 = _mm_unpacklo_ps(r[2], r[3]);
+	__m128 a2 = _mm_unpackhi_ps(r[0], r[1]);
+	__m128 a3 = _mm_unpackhi_ps(r[2], r[3]);
+	r[0] = _mm_movelh_ps(a0, a1);
+	r[1] = _mm_movehl_ps(a1, a0);
+	r[2] = _mm_movelh_ps(a2, a3);
+	r[3] = _mm_movehl_ps(a3, a2);
+}
+
+// the fftPass kernel 4 lanes at a time: over q when s is a multiple of 4, over p in the
+// first pass (s = 1) with m a multiple of 4, the reference for the rest
+static inline ASIO_SSE2 void fftPass4(const float *x, float *y, long size, long n, long s, const float *twiddles)
+{
+	const float* xi = x + size;
+	float* yi = y + size;
+	if(n == 2)
+	{
+		if(s % 4)
+		{
+			ASIOFFTPassScalar(x, y, size, n, s, twiddles);
+			return;
+		}
+		for(long q = 0; q < s; q += 4)
+		{
+			__m128 ar = _mm_loadu_ps(x + q);
+			__m128 ai = _mm_loadu_ps(xi + q);
+			__m128 br = _mm_loadu_ps(x + q + s);
+			__m128 bi = _mm_loadu_ps(xi + q + s);
+			_mm_storeu_ps(y + q, _mm_add_ps(ar, br));
+			_mm_storeu_ps(yi + q, _mm_add_ps(ai, bi));
+			_mm_storeu_ps(y + q + s, _mm_sub_ps(ar, br));
+			_mm_storeu_ps(yi + q + s, _mm_sub_ps(ai, bi));
+		}
+		return;
+	}
+	long m = n / 4;
+	__m128 a[8];
+	__m128 w[6];
+	__m128 b[8];
+	if(s % 4 == 0)
+	{
+		for(long p = 0; p < m; p++)
+		{
+			for(long j = 0; j < 6; j++)
+				w[j] = _mm_set1_ps(twiddles[j * m + p]);
+			for(long q = 0; q < s; q += 4)
+			{
+				long i = q + s * p;
+				long o = q + s * 4 * p;
+				for(long k = 0; k < 4; k++)
+				{
+					a[k] = _mm_loadu_ps(x + i + k * s * m);
+					a[4 + k] = _mm_loadu_ps(xi + i + k * s * m);
+				}
+				fftButterfly4(a, w, b);
+				for(long k = 0; k < 4; k++)
+				{
+					_mm_storeu_ps(y + o + k * s, b[k]);
+					_mm_storeu_ps(yi + o + k * s, b[4 + k]);
+				}
+			}
+		}
+	}
+	else if(s == 1 && m % 4 == 0)
+	{
+		// lane j of b[k] goes to 4 (p + j) + k, a transpose puts each p in a row
+		for(long p = 0; p < m; p += 4)
+		{
+			for(long j = 0; j < 6; j++)
+				w[j] = _mm_loadu_ps(twiddles + j * m + p);
+			for(long k = 0; k < 4; k++)
+			{
+				a[k] = _mm_loadu_ps(x + p + k * m);
+				a[4 + k] = _mm_loadu_ps(xi + p + k * m);
+			}
+			fftButterfly4(a, w, b);
+			transpose4x32(b);
+			transpose4x32(b + 4);
+			for(long j = 0; j < 4; j++)
+			{
+				_mm_storeu_ps(y + 4 * (p + j), b[j]);
+				_mm_storeu_ps(yi + 4 * (p + j), b[4 + j]);
+			}
+		}
+	}
+	else
+		ASIOFFTPassScalar(x, y, size, n, s, twiddles);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+#include "ginclude.h"
+#include "ASIODenormals.h"
+#include "ASIOConvertKernels.h"
+#include <string.h>
+
+#if ASIO_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+#if ASIO_CONVERT_X86
+enum
+{
+	kMXCSRDenormalsAreZero = 0x0040,
+	kMXCSRFlushToZero = 0x8000
+};
+
+// MXCSR_MASK of the fxsave area has the DAZ bit when the cpu has it, 0 there
+// stands for the default mask without it
+static ASIO_TARGET("fxsr") bool hasDenormalsAreZero()
+{
+#if defined(_MSC_VER)
+	__declspec(align(16)) unsigned char area[512];
+#else
+	unsigned char area[512] __attribute__((aligned(16)));
+#endif
+	memset(area, 0, sizeof(area));
+	_fxsave(area);
+	unsigned int mask;
+	memcpy(&mask, area + 28, sizeof(mask));
+	return (mask & kMXCSRDenormalsAreZero) != 0;
+}
+
+static long detectModes()
+{
+	if(ASIOGetSupportedConvertISA() < kASIOConvertSSE2)
+		return kASIODenormalsOn;
+	return kASIOFlushToZero | (hasDenormalsAreZero() ? kASIODenormalsAreZero : 0);
+}
+
+// detected once, the first call from any thread
+static long supportedModes()
+{
+	static const long modes = detectModes();
+	return modes;
+}
+#endif
+
+long ASIOGetDenormalMode()
+{
+#if ASIO_CONVERT_X86
+	if(!supportedModes())
+		return kASIODenormalsOn;
+	unsigned int csr = _mm_getcsr();
+	return ((csr & kMXCSRFlushToZero) ? kASIOFlushToZero : 0) |
+		((csr & kMXCSRDenormalsAreZero) ? kASIODenormalsAreZero : 0);
+#else
+	return kASIODenormalsOn;
+#endif
+}
+
+long ASIOSetDenormalMode(long mode)
+{
+#if ASIO_CONVERT_X86
+	mode &= supportedModes();
+	if(!supportedModes())
+		return kASIODenormalsOn;
+	unsigned int csr = _mm_getcsr();
+	unsigned int bits = ((mode & kASIOFlushToZero) ? kMXCSRFlushToZero : 0) |
+		((mode & kASIODenormalsAreZero) ? kMXCSRDenormalsAreZero : 0);
+	unsigned int wanted = (csr & ~(kMXCSRFlushToZero | kMXCSRDenormalsAreZero)) | bits;
+	if(wanted != csr)
+		_mm_setcsr(wanted);
+	return mode;
+#else
+	(void)mode;
+	return kASIODenormalsOn;
+#endif
+}
+
+void ASIOFlushDenormals(float *state, long count)
+{
+	for(long i = 0; i < count; i++)
+		state[i] = ASIOFlushDenormal(state[i]);
+}
+
+void ASIOFlushDenormals(double *state, long count)
+{
+	for(long i = 0; i < count; i++)
+		state[i] = ASIOFlushDenormal(state[i]);
+}
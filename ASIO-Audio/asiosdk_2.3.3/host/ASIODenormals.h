@@ -0,0 +1,54 @@
+#ifndef __ASIODenormals__
+#define __ASIODenormals__
+
+// Denormal protection for the threads that run DSP. Feedback filters and reverb
+// tails decaying into denormals run 10 to 100 times slower on x86 unless the
+// thread flushes them:
+//
+//   FTZ   results that would be denormal become zero
+//   DAZ   denormal inputs are read as zero, for samples and state that already are
+//
+// Both are bits of the per thread MXCSR register, so every thread has to set them
+// itself: the buffer switch thread of the driver and every worker the host starts
+// for DSP. With them set, float32 to float64 conversions and the mix kernels turn
+// denormal samples into zeros of the same sign.
+//
+// ASIOFlushDenormal() is the portable alternative for state variables, for code that
+// can't rely on the thread it runs on.
+
+#include <math.h>
+
+enum ASIODenormalMode
+{
+	kASIODenormalsOn = 0,			// IEEE gradual underflow
+	kASIOFlushToZero = 1,			// FTZ
+	kASIODenormalsAreZero = 2,		// DAZ
+	kASIODenormalsOff = kASIOFlushToZero | kASIODenormalsAreZero
+};
+
+// the modes of the calling thread, kASIODenormals... bits
+long ASIOGetDenormalMode();
+
+// sets the modes of the calling thread to mode, as far as the cpu has them: DAZ is
+// missing on the first SSE2 cpus, both on cpus without SSE. Returns the mode in
+// effect. Only writes the register when the mode changes, so the buffer switch
+// can call it every time.
+long ASIOSetDenormalMode(long mode);
+
+// state below -300 dB to zero, long before it gets denormal
+inline float ASIOFlushDenormal(float x)
+{
+	return fabsf(x) < 1e-15f ? 0.f : x;
+}
+
+inline double ASIOFlushDenormal(double x)
+{
+	return fabs(x) < 1e-15 ? 0. : x;
+}
+
+// the same for count state variables, once per buffer is enough for filters whose
+// state can't decay from -300 dB into denormals within one buffer
+void ASIOFlushDenormals(float *state, long count);
+void ASIOFlushDenormals(double *state, long count);
+
+#endif
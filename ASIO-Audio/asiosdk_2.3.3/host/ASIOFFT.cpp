@@ -0,0 +1,142 @@
+#include "ginclude.h"
+#include "ASIOFFT.h"
+#include "ASIOConvertKernels.h"
+#include "ASIODSPKernels.h"
+#include <math.h>
+
+//-------------------------------------------------------------------------------------------
+
+ASIOFFT::ASIOFFT()
+	: size(0)
+{
+}
+
+bool ASIOFFT::setup(long size)
+{
+	if(size < kMinSize || size > kMaxSize || (size & (size - 1)))
+		return false;
+	this->size = size;
+	const double pi = 3.14159265358979323846;
+	long half = size / 2;
+
+	twiddles.clear();
+	for(long n = half; n >= 4; n /= 4)
+	{
+		long m = n / 4;
+		size_t base = twiddles.size();
+		twiddles.resize(base + 6 * m);
+		for(long k = 1; k <= 3; k++)
+		{
+			for(long p = 0; p < m; p++)
+			{
+				double a = -2. * pi * (double)(k * p) / (double)n;
+				twiddles[base + (2 * k - 2) * m + p] = (float)cos(a);
+				twiddles[base + (2 * k - 1) * m + p] = (float)sin(a);
+			}
+		}
+	}
+
+	split.resize(size);
+	for(long k = 0; k < half; k++)
+	{
+		double a = -2. * pi * (double)k / (double)size;
+		split[k] = (float)cos(a);
+		split[half + k] = (float)sin(a);
+	}
+
+	work[0].assign(size, 0.f);
+	work[1].assign(size, 0.f);
+	return true;
+}
+
+void ASIOFFT::forward(const float *input, float *re, float *im)
+{
+	if(!size)
+		return;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	long half = size / 2;
+
+	float* x = &work[0][0];
+	float* y = &work[1][0];
+	void* parts[2] = { x, x + half };
+	k->deinterleave(input, parts, 2, sizeof(float), half);
+
+	x = transform(x, y);
+
+	// the transform Z of the complex sequence holds the even samples E = (Z[k] + Z*[half - k]) / 2
+	// and the odd ones O = (Z[k] - Z*[half - k]) / 2i, the real transform is E + O exp(-2 pi i k / size)
+	const float* zr = x;
+	const float* zi = x + half;
+	const float* wr = &split[0];
+	const float* wi = &split[half];
+	re[0] = zr[0] + zi[0];
+	im[0] = 0.f;
+	re[half] = zr[0] - zi[0];
+	im[half] = 0.f;
+	for(long i = 1; i < half; i++)
+	{
+		float er = .5f * (zr[i] + zr[half - i]);
+		float ei = .5f * (zi[i] - zi[half - i]);
+		float orr = .5f * (zi[i] + zi[half - i]);
+		float oi = .5f * (zr[half - i] - zr[i]);
+		re[i] = er + (wr[i] * orr - wi[i] * oi);
+		im[i] = ei + (wr[i] * oi + wi[i] * orr);
+	}
+}
+
+void ASIOFFT::inverse(const float *re, const float *im, float *output)
+{
+	if(!size)
+		return;
+	const ASIOConvertKernels* k = ASIOGetConvertKernels();
+	long half = size / 2;
+
+	// Z[k] = E + i O exp(2 pi i k / size) with E = X[k] + X*[half - k] and O = X[k] - X*[half - k],
+	// twice the even and odd transforms. Z goes in swapped, the imaginary parts first.
+	float* x = &work[0][0];
+	float* y = &work[1][0];
+	float* zi = x;
+	float* zr = x + half;
+	const float* wr = &split[0];
+	const float* wi = &split[half];
+	zr[0] = re[0] + re[half];
+	zi[0] = re[0] - re[half];
+	for(long i = 1; i < half; i++)
+	{
+		float er = re[i] + re[half - i];
+		float ei = im[i] - im[half - i];
+		float orr = re[i] - re[half - i];
+		float oi = im[i] + im[half - i];
+		zr[i] = er - (wr[i] * oi - wi[i] * orr);
+		zi[i] = ei + (wr[i] * orr + wi[i] * oi);
+	}
+
+	// the forward transform of the swapped values is the inverse one swapped, the real
+	// parts now come second
+	x = transform(x, y);
+	const void* parts[2] = { x + half, x };
+	k->interleave(parts, output, 2, sizeof(float), half);
+}
+
+float *ASIOFFT::transform(float *x, float *y)
+{
+	const ASIODSPKernels* k = ASIOGetDSPKernels();
+	long half = size / 2;
+	const float* t = twiddles.empty() ? 0 : &twiddles[0];
+	long n = half;
+	long s = 1;
+	for(; n >= 4; n /= 4, s *= 4)
+	{
+		k->fftPass(x, y, half, n, s, t);
+		t += 6 * (n / 4);
+		float* swap = x;
+		x = y;
+		y = swap;
+	}
+	if(n == 2)
+	{
+		k->fftPass(x, y, half, 2, s, 0);
+		x = y;
+	}
+	return x;
+}
@@ -0,0 +1,56 @@
+#ifndef __ASIOFFT__
+#define __ASIOFFT__
+
+// Real FFT for the spectrum analyzer and the convolver, 16 to 65536 points. The size real
+// samples are read as size / 2 complex values, the even samples the real and the odd ones
+// the imaginary parts, transformed by radix 4 Stockham passes on the fftPass kernel of
+// ASIODSPKernels.h (one radix 2 pass when size / 2 is an odd power of 2) and split
+// into the size / 2 + 1 bins of the real transform. Stockham passes write the result in
+// order, there is no bit reversal.
+//
+// The inverse runs the same passes backwards: the bins are joined into size / 2 complex
+// values and transformed with their real and imaginary parts swapped, which turns the
+// forward transform into the inverse one without touching the twiddles.
+
+#include <vector>
+
+class ASIOFFT
+{
+public:
+	ASIOFFT();
+	~ASIOFFT() {}
+
+	// size a power of 2 from 16 to 65536. Computes the twiddles and allocates all
+	// buffers, false for other sizes.
+	bool setup(long size);
+
+	long getSize() const { return size; }
+	long getNumBins() const { return size ? size / 2 + 1 : 0; }
+
+	// size samples to getNumBins() bins, re[k] + i im[k] = sum of input[j] exp(-2 pi i j k / size)
+	void forward(const float *input, float *re, float *im);
+
+	// getNumBins() bins back to size samples, the inverse of forward() times size:
+	// output[j] = sum of (re[k] + i im[k]) exp(2 pi i j k / size) over all size bins, the
+	// ones above size / 2 the conjugates of those below. The imaginary parts of bin 0 and
+	// size / 2 are ignored.
+	void inverse(const float *re, const float *im, float *output);
+
+private:
+	enum
+	{
+		kMinSize = 16,
+		kMaxSize = 65536
+	};
+
+	// the passes over size / 2 complex values in x, y is the other buffer. Returns the
+	// one with the result.
+	float *transform(float *x, float *y);
+
+	long size;
+	std::vector<float> twiddles;	// 6 arrays of n / 4 for each radix 4 pass, n = size / 2, size / 8, ..
+	std::vector<float> split;		// cos and sin of -2 pi k / size for k < size / 2
+	std::vector<float> work[2];		// size / 2 real parts, then size / 2 imaginary parts
+};
+
+#endif
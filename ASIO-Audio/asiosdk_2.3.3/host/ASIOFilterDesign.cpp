@@ -0,0 +1,132 @@
+#include "ASIOFilterDesign.h"
+#include <math.h>
+#include <vector>
+
+static const double kPi = 3.14159265358979323846;
+
+static double besselI0(double x)
+{
+	double sum = 1., term = 1.;
+	for(int k = 1; k < 50; k++)
+	{
+		term *= (x / (2. * k)) * (x / (2. * k));
+		sum += term;
+		if(term < sum * 1e-17)
+			break;
+	}
+	return sum;
+}
+
+double ASIOSinc(double x)
+{
+	return x == 0. ? 1. : sin(kPi * x) / (kPi * x);
+}
+
+double ASIOKaiser(double d, long taps, double beta)
+{
+	double r = d / ((taps - 1) * .5);
+	if(r * r > 1.)
+		return 0.;
+	return besselI0(beta * sqrt(1. - r * r)) / besselI0(beta);
+}
+
+void ASIODesignLowpass(double *taps, long length, double cutoff, double beta)
+{
+	double sum = 0.;
+	for(long i = 0; i < length; i++)
+	{
+		double d = i - (length - 1) * .5;
+		taps[i] = 2. * cutoff * ASIOSinc(2. * cutoff * d) * ASIOKaiser(d, length, beta);
+		sum += taps[i];
+	}
+	for(long i = 0; i < length; i++)
+		taps[i] /= sum;
+}
+
+void ASIODesignHalfband(float *evenTaps, long halfLength, double beta)
+{
+	long taps = 4 * halfLength - 1;
+	std::vector<double> even(2 * halfLength);
+	double sum = 0.;
+	for(long j = 0; j < 2 * halfLength; j++)
+	{
+		double d = 2. * j - (2 * halfLength - 1);
+		even[j] = .5 * ASIOSinc(d * .5) * ASIOKaiser(d, taps, beta);
+		sum += even[j];
+	}
+	for(long j = 0; j < 2 * halfLength; j++)
+		evenTaps[j] = (float)(even[j] * .5 / sum);
+}
+
+void ASIODesignBiquad(double *coefficients, ASIOBiquadType type, double frequency, double q,
+	double gainDecibels)
+{
+	double w = 2. * kPi * frequency;
+	double cw = cos(w);
+	double alpha = sin(w) / (2. * q);
+	double a = pow(10., gainDecibels / 40.);
+	double b0, b1, b2, a0, a1, a2;
+	switch(type)
+	{
+	case kASIOBiquadLowpass:
+		b0 = b2 = (1. - cw) * .5;
+		b1 = 1. - cw;
+		a0 = 1. + alpha;
+		a1 = -2. * cw;
+		a2 = 1. - alpha;
+		break;
+	case kASIOBiquadHighpass:
+		b0 = b2 = (1. + cw) * .5;
+		b1 = -(1. + cw);
+		a0 = 1. + alpha;
+		a1 = -2. * cw;
+		a2 = 1. - alpha;
+		break;
+	case kASIOBiquadBandpass:
+		b0 = alpha;
+		b1 = 0.;
+		b2 = -alpha;
+		a0 = 1. + alpha;
+		a1 = -2. * cw;
+		a2 = 1. - alpha;
+		break;
+	case kASIOBiquadNotch:
+		b0 = b2 = 1.;
+		b1 = -2. * cw;
+		a0 = 1. + alpha;
+		a1 = -2. * cw;
+		a2 = 1. - alpha;
+		break;
+	case kASIOBiquadPeak:
+		b0 = 1. + alpha * a;
+		b1 = -2. * cw;
+		b2 = 1. - alpha * a;
+		a0 = 1. + alpha / a;
+		a1 = -2. * cw;
+		a2 = 1. - alpha / a;
+		break;
+	case kASIOBiquadLowShelf:
+	case kASIOBiquadHighShelf:
+	{
+		// the high shelf is the low one with the signs of cos(w), b1 and a1 turned
+		double s = type == kASIOBiquadLowShelf ? 1. : -1.;
+		double r = 2. * sqrt(a) * alpha;
+		b0 = a * ((a + 1.) - s * (a - 1.) * cw + r);
+		b1 = s * 2. * a * ((a - 1.) - s * (a + 1.) * cw);
+		b2 = a * ((a + 1.) - s * (a - 1.) * cw - r);
+		a0 = (a + 1.) + s * (a - 1.) * cw + r;
+		a1 = -s * 2. * ((a - 1.) + s * (a + 1.) * cw);
+		a2 = (a + 1.) + s * (a - 1.) * cw - r;
+		break;
+	}
+	default:
+		b0 = a0 = 1.;
+		b1 = b2 = a1 = a2 = 0.;
+		break;
+	}
+	coefficients[0] = b0 / a0;
+	coefficients[1] = b1 / a0;
+	coefficients[2] = b2 / a0;
+	coefficients[3] = a1 / a0;
+	coefficients[4] = a2 / a0;
+}
@@ -0,0 +1,43 @@
+#ifndef __ASIOFilterDesign__
+#define __ASIOFilterDesign__
+
+// FIR design for the resampling stages, Kaiser windowed sinc, and biquads for
+// the equalizers. Runs when a converter or filter is set up, not in the buffer
+// switch.
+
+// sin(pi x) / (pi x)
+double ASIOSinc(double x);
+
+// Kaiser window of a filter of length taps, d is the distance from its center
+double ASIOKaiser(double d, long taps, double beta);
+
+// linear phase lowpass of length taps, cutoff in fractions of the sample rate
+// and dc gain 1
+void ASIODesignLowpass(double *taps, long length, double cutoff, double beta);
+
+// halfband lowpass of length 4 * halfLength - 1 with the cutoff at a quarter of
+// the sample rate. Only its even taps are stored, 2 * halfLength of them, the
+// center tap at 2 * halfLength - 1 is .5 and the other odd taps are 0. The even
+// taps are symmetric and sum to .5, the dc gain is 1.
+void ASIODesignHalfband(float *evenTaps, long halfLength, double beta);
+
+enum ASIOBiquadType
+{
+	kASIOBiquadLowpass = 0,
+	kASIOBiquadHighpass,
+	kASIOBiquadBandpass,		// 0 dB at the center
+	kASIOBiquadNotch,
+	kASIOBiquadPeak,
+	kASIOBiquadLowShelf,
+	kASIOBiquadHighShelf
+};
+
+// biquad of the Audio EQ Cookbook (R. Bristow-Johnson) normalized to a0 = 1, the
+// coefficients b0, b1, b2, a1 and a2 of ASIOBiquadKernel. frequency in fractions of
+// the sample rate below .5, gain in dB for the peak and the shelves. q = 1 / sqrt(2)
+// gives Butterworth low and highpasses, two of them in series a Linkwitz-Riley
+// crossover of 4th order.
+void ASIODesignBiquad(double *coefficients, ASIOBiquadType type, double frequency, double q,
+	double gainDecibels);
+
+#endif
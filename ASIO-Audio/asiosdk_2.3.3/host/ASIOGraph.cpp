@@ -0,0 +1,688 @@
+#include "ginclude.h"
+#include "ASIOGraph.h"
+#include "ASIOConvertKernels.h"
+#include "ASIODenormals.h"
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#if ASIO_CONVERT_X86
+#include <emmintrin.h>
+#endif
+#if WINDOWS
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// workers wake up this long before the next buffer is due and spin until twice as long
+// after it, then they sleep until process() wakes them
+static const long long kSpinLeadNanoseconds = 100000;
+
+//-------------------------------------------------------------------------------------------
+// the steps compile() adds, sums and gains are one weighted mix on the mixToFloat kernel
+
+void ASIOGraph::mixStep(void *state, const float *const *inputs, float *const *outputs, long frames)
+{
+	const Mix *m = (const Mix*)state;
+	ASIOGetConvertKernels()->mixToFloat(inputs, m->gains, m->numSources, outputs[0], 4, false, frames);
+}
+
+static void copyStep(void *, const float *const *inputs, float *const *outputs, long frames)
+{
+	memcpy(outputs[0], inputs[0], frames * sizeof(float));
+}
+
+static inline long long nanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// every 64th time the cpu goes to another thread, with more threads than cpus the one
+// that has the work may be waiting for it
+static inline void spinPause(long &spins)
+{
+	if(!(++spins & 63))
+		std::this_thread::yield();
+	else
+	{
+#if ASIO_CONVERT_X86
+		_mm_pause();
+#endif
+	}
+}
+
+// one cpu per worker, the driver's thread keeps whichever it has
+static void pinThread(long cpu)
+{
+#if WINDOWS
+	SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void)cpu;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+
+ASIOGraph::ASIOGraph()
+	: numBuffers(0), maxFrames(0), numWorkers(0), frames(0)
+{
+	for(long i = 0; i < kMaxThreads; i++)
+	{
+		workers[i].top.store(0);
+		workers[i].bottom.store(0);
+		workers[i].mask = 0;
+	}
+	remaining.store(0);
+	period.store(0);
+	periodStart.store(0);
+	periodLength.store(0);
+	running.store(false);
+	sleepers.store(0);
+}
+
+ASIOGraph::~ASIOGraph()
+{
+	stop();
+}
+
+void ASIOGraph::clear()
+{
+	stop();
+	nodes.clear();
+	connections.clear();
+	steps.clear();
+	ports.clear();
+	gains.clear();
+	mixes.clear();
+	storage.clear();
+	successors.clear();
+	roots.clear();
+	numBuffers = 0;
+	maxFrames = 0;
+}
+
+long ASIOGraph::addSource(const float *buffer)
+{
+	if(!buffer)
+		return -1;
+	Node n = { kSource, 0, 0, 0, 1, buffer, 0, 1.f };
+	nodes.push_back(n);
+	return (long)nodes.size() - 1;
+}
+
+long ASIOGraph::addSink(float *buffer)
+{
+	if(!buffer)
+		return -1;
+	Node n = { kSink, 0, 0, 1, 0, 0, buffer, 1.f };
+	nodes.push_back(n);
+	return (long)nodes.size() - 1;
+}
+
+long ASIOGraph::addNode(ASIOGraphProcess process, void *state, long numInputs, long numOutputs)
+{
+	if(!process || numInputs < 0 || numOutputs < 0)
+		return -1;
+	Node n = { kProcess, process, state, numInputs, numOutputs, 0, 0, 1.f };
+	nodes.push_back(n);
+	return (long)nodes.size() - 1;
+}
+
+long ASIOGraph::addGain(float gain)
+{
+	Node n = { kGain, 0, 0, 1, 1, 0, 0, gain };
+	nodes.push_back(n);
+	return (long)nodes.size() - 1;
+}
+
+bool ASIOGraph::connect(long from, long fromPort, long to, long toPort)
+{
+	if(from < 0 || from >= (long)nodes.size() || to < 0 || to >= (long)nodes.size())
+		return false;
+	if(fromPort < 0 || fromPort >= nodes[from].numOutputs || toPort < 0 || toPort >= nodes[to].numInputs)
+		return false;
+	Connection c = { from, fromPort, to, toPort };
+	connections.push_back(c);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// compile
+
+namespace
+{
+	// a channel of the plan: the output of a step, an external buffer or silence
+	struct Value
+	{
+		long producer;			// op, -1 for a source or silence
+		float *external;		// the buffer when it isn't one of the intermediate ones
+		long readers;			// ops
+		long buffer;			// intermediate buffer, -1 for none
+	};
+
+	struct Op
+	{
+		long node;				// -1 for the sums and copies compile() adds
+		long mix;				// Mix of a sum or gain, -1 for none
+		long sink;				// node of the sink a copy writes, -1 for none
+		bool removed;			// a copy into a sink its input writes directly
+		std::vector<long> inputs;
+		std::vector<long> outputs;
+	};
+}
+
+bool ASIOGraph::compile(long maxFrames)
+{
+	if(running.load())
+		return false;
+	steps.clear();
+	ports.clear();
+	gains.clear();
+	mixes.clear();
+	storage.clear();
+	successors.clear();
+	roots.clear();
+	numBuffers = 0;
+	this->maxFrames = 0;
+	if(maxFrames <= 0)
+		return false;
+
+	// the connections into every input port, the ports of all nodes numbered one after
+	// the other
+	long numNodes = (long)nodes.size();
+	std::vector<long> firstInput(numNodes + 1, 0);
+	for(long i = 0; i < numNodes; i++)
+		firstInput[i + 1] = firstInput[i] + nodes[i].numInputs;
+	std::vector<std::vector<long> > into(firstInput[numNodes]);
+	std::vector<std::vector<long> > outOf(numNodes);
+	std::vector<long> pending(numNodes, 0);
+	for(size_t c = 0; c < connections.size(); c++)
+	{
+		const Connection &k = connections[c];
+		into[firstInput[k.to] + k.toPort].push_back((long)c);
+		outOf[k.from].push_back((long)c);
+		pending[k.to]++;
+	}
+
+	// Kahn's algorithm, nodes without inputs in the order they were added
+	std::vector<long> order;
+	order.reserve(numNodes);
+	for(long i = 0; i < numNodes; i++)
+	{
+		if(!pending[i])
+			order.push_back(i);
+	}
+	for(size_t o = 0; o < order.size(); o++)
+	{
+		const std::vector<long> &out = outOf[order[o]];
+		for(size_t c = 0; c < out.size(); c++)
+		{
+			if(!--pending[connections[out[c]].to])
+				order.push_back(connections[out[c]].to);
+		}
+	}
+	if((long)order.size() != numNodes)
+		return false;
+
+	// the ops in that order, value 0 is silence. The gains of all sums are 1, they are
+	// stored once for the widest one after those of the gain nodes.
+	std::vector<Value> values(1);
+	values[0].producer = -1;
+	values[0].external = 0;
+	values[0].readers = 0;
+	values[0].buffer = -1;
+	std::vector<Op> ops;
+	std::vector<long> firstOutput(numNodes, 0);
+	std::vector<long> outputValues;
+	std::vector<long> mixGains;		// index into gains per mix
+	long widestSum = 0;
+	for(size_t c = 0; c < into.size(); c++)
+	{
+		if((long)into[c].size() > widestSum)
+			widestSum = (long)into[c].size();
+	}
+	long numGains = 0;
+	for(long i = 0; i < numNodes; i++)
+		numGains += nodes[i].type == kGain;
+	gains.reserve(numGains + widestSum);
+
+	for(long o = 0; o < numNodes; o++)
+	{
+		long i = order[o];
+		const Node &n = nodes[i];
+		Op op;
+		op.node = i;
+		op.mix = -1;
+		op.sink = -1;
+		op.removed = false;
+
+		for(long p = 0; p < n.numInputs; p++)
+		{
+			const std::vector<long> &from = into[firstInput[i] + p];
+			long v = 0;
+			if(from.size() == 1)
+				v = outputValues[firstOutput[connections[from[0]].from] + connections[from[0]].fromPort];
+			else if(from.size() > 1)
+			{
+				Op sum;
+				sum.node = -1;
+				sum.mix = (long)mixes.size();
+				sum.sink = -1;
+				sum.removed = false;
+				for(size_t c = 0; c < from.size(); c++)
+					sum.inputs.push_back(outputValues[firstOutput[connections[from[c]].from] + connections[from[c]].fromPort]);
+				Mix m = { (long)from.size(), 0 };
+				mixes.push_back(m);
+				mixGains.push_back(numGains);
+				Value s = { (long)ops.size(), 0, 0, -1 };
+				sum.outputs.push_back((long)values.size());
+				values.push_back(s);
+				ops.push_back(sum);
+				v = (long)values.size() - 1;
+			}
+			op.inputs.push_back(v);
+		}
+
+		firstOutput[i] = (long)outputValues.size();
+		if(n.type == kSource)
+		{
+			Value s = { -1, (float*)n.source, 0, -1 };
+			outputValues.push_back((long)values.size());
+			values.push_back(s);
+			continue;
+		}
+		if(n.type == kSink)
+		{
+			Value s = { (long)ops.size(), n.sink, 0, -1 };
+			op.node = -1;
+			op.sink = i;
+			op.outputs.push_back((long)values.size());
+			values.push_back(s);
+		}
+		else
+		{
+			if(n.type == kGain)
+			{
+				op.mix = (long)mixes.size();
+				Mix m = { 1, 0 };
+				mixes.push_back(m);
+				mixGains.push_back((long)gains.size());
+				gains.push_back(n.gain);
+			}
+			for(long p = 0; p < n.numOutputs; p++)
+			{
+				Value s = { (long)ops.size(), 0, 0, -1 };
+				op.outputs.push_back((long)values.size());
+				outputValues.push_back((long)values.size());
+				values.push_back(s);
+			}
+		}
+		ops.push_back(op);
+	}
+
+	gains.resize(numGains + widestSum, 1.f);
+	for(size_t m = 0; m < mixes.size(); m++)
+		mixes[m].gains = &gains[mixGains[m]];
+
+	for(size_t p = 0; p < ops.size(); p++)
+	{
+		for(size_t j = 0; j < ops[p].inputs.size(); j++)
+			values[ops[p].inputs[j]].readers++;
+	}
+
+	// an op whose output only goes into a sink writes the sink's buffer
+	for(size_t p = 0; p < ops.size(); p++)
+	{
+		Op &op = ops[p];
+		if(op.sink < 0)
+			continue;
+		Value &v = values[op.inputs[0]];
+		if(v.producer >= 0 && !v.external && v.readers == 1)
+		{
+			v.external = values[op.outputs[0]].external;
+			op.removed = true;
+		}
+	}
+
+	// the steps in the order of the ops
+	std::vector<long> opStep(ops.size(), -1);
+	long numSteps = 0;
+	for(size_t p = 0; p < ops.size(); p++)
+	{
+		if(!ops[p].removed)
+			opStep[p] = numSteps++;
+	}
+
+	// intermediate buffers from the first free one, freed after their last reader. A
+	// step waits for the producers of its inputs and for the steps that used the buffers
+	// it gets before it.
+	std::vector<long> unused;
+	std::vector<std::vector<long> > users;
+	std::vector<std::vector<long> > predecessors(numSteps);
+	for(size_t p = 0; p < ops.size(); p++)
+	{
+		Op &op = ops[p];
+		if(op.removed)
+			continue;
+		long step = opStep[p];
+		std::vector<long> &waits = predecessors[step];
+		for(size_t j = 0; j < op.outputs.size(); j++)
+		{
+			Value &v = values[op.outputs[j]];
+			if(v.external)
+				continue;
+			if(unused.empty())
+			{
+				v.buffer = numBuffers++;
+				users.push_back(std::vector<long>());
+			}
+			else
+			{
+				v.buffer = unused.back();
+				unused.pop_back();
+			}
+			waits.insert(waits.end(), users[v.buffer].begin(), users[v.buffer].end());
+			users[v.buffer].assign(1, step);
+		}
+		for(size_t j = 0; j < op.inputs.size(); j++)
+		{
+			Value &v = values[op.inputs[j]];
+			if(v.producer >= 0)
+				waits.push_back(opStep[v.producer]);
+			if(v.buffer >= 0)
+				users[v.buffer].push_back(step);
+		}
+		for(size_t j = 0; j < op.inputs.size(); j++)
+		{
+			Value &v = values[op.inputs[j]];
+			if(v.buffer >= 0 && !--v.readers)
+				unused.push_back(v.buffer);
+		}
+		for(size_t j = 0; j < op.outputs.size(); j++)
+		{
+			Value &v = values[op.outputs[j]];
+			if(v.buffer >= 0 && !v.readers)
+				unused.push_back(v.buffer);
+		}
+	}
+
+	// the buffers 64 byte aligned, silence after the last one
+	long stride = (maxFrames + 15) & ~15L;
+	storage.assign((size_t)stride * (numBuffers + 1) + 16, 0.f);
+	float *buffers = (float*)(((uintptr_t)&storage[0] + 63) & ~(uintptr_t)63);
+	values[0].buffer = numBuffers;
+
+	for(size_t p = 0; p < ops.size(); p++)
+	{
+		const Op &op = ops[p];
+		if(op.removed)
+			continue;
+		Step s;
+		if(op.node >= 0 && nodes[op.node].type == kProcess)
+		{
+			s.process = nodes[op.node].process;
+			s.state = nodes[op.node].state;
+		}
+		else if(op.mix >= 0)
+		{
+			s.process = mixStep;
+			s.state = &mixes[op.mix];
+		}
+		else
+		{
+			s.process = copyStep;
+			s.state = 0;
+		}
+		s.numInputs = (long)op.inputs.size();
+		s.numOutputs = (long)op.outputs.size();
+		s.ports = (long)ports.size();
+		s.numPredecessors = 0;
+		s.successors = 0;
+		s.numSuccessors = 0;
+		for(size_t j = 0; j < op.inputs.size(); j++)
+		{
+			const Value &v = values[op.inputs[j]];
+			ports.push_back(v.external ? v.external : buffers + (size_t)v.buffer * stride);
+		}
+		for(size_t j = 0; j < op.outputs.size(); j++)
+		{
+			const Value &v = values[op.outputs[j]];
+			ports.push_back(v.external ? v.external : buffers + (size_t)v.buffer * stride);
+		}
+		steps.push_back(s);
+	}
+
+	// the waits of every step once, turned around into the steps each one releases
+	std::vector<std::vector<long> > released(numSteps);
+	for(long i = 0; i < numSteps; i++)
+	{
+		std::vector<long> &waits = predecessors[i];
+		std::sort(waits.begin(), waits.end());
+		waits.erase(std::unique(waits.begin(), waits.end()), waits.end());
+		if(!waits.empty() && waits.back() == i)
+			waits.pop_back();
+		steps[i].numPredecessors = (long)waits.size();
+		for(size_t j = 0; j < waits.size(); j++)
+			released[waits[j]].push_back(i);
+		if(waits.empty())
+			roots.push_back(i);
+	}
+	for(long i = 0; i < numSteps; i++)
+	{
+		steps[i].successors = (long)successors.size();
+		steps[i].numSuccessors = (long)released[i].size();
+		successors.insert(successors.end(), released[i].begin(), released[i].end());
+	}
+	std::vector<std::atomic<long> >(numSteps).swap(this->pending);
+	this->maxFrames = maxFrames;
+	return true;
+}
+
+void ASIOGraph::process(long frames)
+{
+	if(frames <= 0 || frames > maxFrames)
+		return;
+	if(!numWorkers)
+	{
+		const Step *s = steps.empty() ? 0 : &steps[0];
+		float *const *p = ports.empty() ? 0 : &ports[0];
+		for(size_t i = 0; i < steps.size(); i++, s++)
+			s->process(s->state, p + s->ports, p + s->ports + s->numInputs, frames);
+		return;
+	}
+
+	// the last buffer is done on every thread, nothing of it is touched anymore
+	this->frames = frames;
+	for(size_t i = 0; i < steps.size(); i++)
+		pending[i].store(steps[i].numPredecessors, std::memory_order_relaxed);
+	remaining.store((long)steps.size(), std::memory_order_relaxed);
+	for(size_t i = roots.size(); i-- > 0; )
+		push(0, roots[i]);
+
+	long long now = nanoseconds();
+	long long last = periodStart.load(std::memory_order_relaxed);
+	periodLength.store(last ? now - last : 0, std::memory_order_relaxed);
+	periodStart.store(now, std::memory_order_relaxed);
+
+	// a worker that checked period before this goes to sleep counted, see run()
+	period.fetch_add(1, std::memory_order_seq_cst);
+	if(sleepers.load(std::memory_order_seq_cst))
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+		wake.notify_all();
+	}
+	runSteps(0);
+}
+
+bool ASIOGraph::start(long numWorkers)
+{
+	if(running.load() || numWorkers < 1 || numWorkers >= kMaxThreads || steps.empty())
+		return false;
+	long long capacity = 1;
+	while(capacity < (long long)steps.size())
+		capacity <<= 1;
+	for(long i = 0; i <= numWorkers; i++)
+	{
+		Worker &w = workers[i];
+		std::vector<std::atomic<long> >((size_t)capacity).swap(w.tasks);
+		w.mask = capacity - 1;
+		w.top.store(0);
+		w.bottom.store(0);
+	}
+	periodStart.store(0);
+	periodLength.store(0);
+	running.store(true);
+	this->numWorkers = numWorkers;
+	for(long i = 1; i <= numWorkers; i++)
+		workers[i].thread = std::thread(&ASIOGraph::run, this, i);
+	return true;
+}
+
+void ASIOGraph::stop()
+{
+	if(!running.load())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+		running.store(false);
+	}
+	wake.notify_all();
+	for(long i = 1; i <= numWorkers; i++)
+		workers[i].thread.join();
+	numWorkers = 0;
+}
+
+//-------------------------------------------------------------------------------------------
+// the deques, after Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient
+// Work-Stealing for Weak Memory Models"
+
+void ASIOGraph::push(long worker, long step)
+{
+	Worker &w = workers[worker];
+	long long b = w.bottom.load(std::memory_order_relaxed);
+	w.tasks[(size_t)(b & w.mask)].store(step, std::memory_order_relaxed);
+	w.bottom.store(b + 1, std::memory_order_release);
+}
+
+long ASIOGraph::take(long worker)
+{
+	Worker &w = workers[worker];
+	long long b = w.bottom.load(std::memory_order_relaxed) - 1;
+	w.bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long t = w.top.load(std::memory_order_relaxed);
+	if(t > b)
+	{
+		w.bottom.store(b + 1, std::memory_order_relaxed);
+		return -1;
+	}
+	long step = w.tasks[(size_t)(b & w.mask)].load(std::memory_order_relaxed);
+	if(t == b)
+	{
+		// the last one, a thief may be after it as well
+		if(!w.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			step = -1;
+		w.bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return step;
+}
+
+long ASIOGraph::steal(long worker)
+{
+	for(long i = 1; i <= numWorkers; i++)
+	{
+		Worker &w = workers[(worker + i) % (numWorkers + 1)];
+		long long t = w.top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long b = w.bottom.load(std::memory_order_acquire);
+		if(t >= b)
+			continue;
+		long step = w.tasks[(size_t)(t & w.mask)].load(std::memory_order_relaxed);
+		if(w.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return step;
+	}
+	return -1;
+}
+
+//-------------------------------------------------------------------------------------------
+
+// steps of the current buffer until all of them are done, on any thread
+void ASIOGraph::runSteps(long worker)
+{
+	float *const *p = ports.empty() ? 0 : &ports[0];
+	long spins = 0;
+	for(;;)
+	{
+		long i = take(worker);
+		if(i < 0)
+			i = steal(worker);
+		if(i < 0)
+		{
+			if(!remaining.load(std::memory_order_acquire))
+				return;
+			spinPause(spins);
+			continue;
+		}
+		const Step &s = steps[i];
+		s.process(s.state, p + s.ports, p + s.ports + s.numInputs, frames);
+		for(long j = 0; j < s.numSuccessors; j++)
+		{
+			long next = successors[s.successors + j];
+			if(pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				push(worker, next);
+		}
+		remaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+void ASIOGraph::run(long worker)
+{
+	// a DSP thread of its own, see ASIODenormals.h
+	ASIOSetDenormalMode(kASIODenormalsOff);
+	unsigned int cpus = std::thread::hardware_concurrency();
+	pinThread(cpus ? worker % cpus : 0);
+
+	unsigned long seen = period.load();
+	while(running.load(std::memory_order_relaxed))
+	{
+		// asleep until shortly before the next buffer is due, when the driver keeps time
+		long long length = periodLength.load(std::memory_order_relaxed);
+		long long due = periodStart.load(std::memory_order_relaxed) + length;
+		if(length && period.load(std::memory_order_acquire) == seen && nanoseconds() < due - kSpinLeadNanoseconds)
+		{
+			std::unique_lock<std::mutex> lock(wakeLock);
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+			wake.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(due - kSpinLeadNanoseconds)),
+				[&]() { return period.load(std::memory_order_seq_cst) != seen || !running.load(); });
+			sleepers.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		// then spinning around the time it is due
+		long long spinUntil = (length ? due : nanoseconds()) + 2 * kSpinLeadNanoseconds;
+		long spins = 0;
+		while(period.load(std::memory_order_acquire) == seen && running.load(std::memory_order_relaxed) &&
+			nanoseconds() < spinUntil)
+			spinPause(spins);
+
+		// and sleeping again when it didn't come
+		if(period.load(std::memory_order_acquire) == seen)
+		{
+			std::unique_lock<std::mutex> lock(wakeLock);
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+			wake.wait(lock, [&]() { return period.load(std::memory_order_seq_cst) != seen || !running.load(); });
+			sleepers.fetch_sub(1, std::memory_order_relaxed);
+			continue;
+		}
+		seen = period.load(std::memory_order_acquire);
+		runSteps(worker);
+	}
+}
@@ -0,0 +1,188 @@
+#ifndef __ASIOGraph__
+#define __ASIOGraph__
+
+// Processing graph of float channels between the buffers of the buffer switch. Nodes
+// have numbered input and output ports of one channel each, connections go from an
+// output port to an input port:
+//
+//   source    one output, an external buffer such as a host input buffer
+//   sink      one input, written into an external buffer such as a host output buffer
+//   node      a process function with a state pointer, numInputs in and numOutputs out
+//   gain      one in and one out, a node of its own
+//
+// An input port with several connections gets their sum, one without any gets silence,
+// an output port may feed any number of inputs. compile() sorts the nodes topologically
+// and flattens the graph into a plan: an array of steps, each a function pointer, its
+// state and the buffers of its ports, with the sums and copies it needs as steps of
+// their own. The intermediate buffers are allocated there and reused as soon as their
+// last reader ran, an output that goes into nothing but a sink is written into the
+// sink's buffer directly. process() walks the steps, nothing is looked up, allocated or dispatched
+// virtually in the buffer switch.
+//
+// A process function gets buffers that never overlap: no output is one of its inputs.
+// The external buffers of sources and sinks have to be different from each other.
+//
+// With start() the steps of one buffer are spread over a pool of workers and the thread
+// of process(), which joins in as worker 0 and returns when the last step is done. The
+// plan knows what every step waits for: the steps that write its inputs, and the readers
+// of whatever was in the buffers it writes before. Steps whose count reaches zero go
+// onto the deque of the thread that finished the last one, each thread runs its own
+// deque newest first and steals the oldest of the others' when it runs dry. Between
+// buffers the workers sleep until shortly before the next one is due, then spin, so the
+// one after a regular period finds them awake without a wakeup. Workers are pinned to a
+// cpu each, on Windows at time critical priority, and run with denormals off.
+// A node's state is only ever used by one step, but steps of different nodes may run at
+// the same time: nodes that share anything have to be connected.
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+typedef void (*ASIOGraphProcess)(void *state, const float *const *inputs, float *const *outputs, long frames);
+
+class ASIOGraph
+{
+public:
+	enum
+	{
+		kMaxThreads = 32		// workers and the thread of process()
+	};
+
+	ASIOGraph();
+	~ASIOGraph();
+
+	// no nodes, no plan
+	void clear();
+
+	// the id of the new node, -1 for arguments out of range. Buffers and states have
+	// to outlive the plan.
+	long addSource(const float *buffer);
+	long addSink(float *buffer);
+	long addNode(ASIOGraphProcess process, void *state, long numInputs, long numOutputs);
+	long addGain(float gain);
+
+	// false for ports that don't exist
+	bool connect(long from, long fromPort, long to, long toPort);
+
+	// builds the plan for up to maxFrames per process(), false when the graph has a
+	// cycle. Allocates, call it before the buffers run and while no workers do.
+	bool compile(long maxFrames);
+
+	// frames up to the maxFrames of compile(), buffer switch
+	void process(long frames);
+
+	// starts numWorkers workers for the plan, up to kMaxThreads - 1, and stops them.
+	// After compile() and before the buffers run.
+	bool start(long numWorkers);
+	void stop();
+	long getNumWorkers() const { return numWorkers; }
+
+	long getNumNodes() const { return (long)nodes.size(); }
+	long getNumSteps() const { return (long)steps.size(); }
+	long getNumBuffers() const { return numBuffers; }
+
+private:
+	enum
+	{
+		// Node::type
+		kSource = 0,
+		kSink,
+		kProcess,
+		kGain
+	};
+
+	typedef struct Connection
+	{
+		long from;
+		long fromPort;
+		long to;
+		long toPort;
+	} Connection;
+
+	typedef struct Node
+	{
+		long type;
+		ASIOGraphProcess process;
+		void *state;
+		long numInputs;
+		long numOutputs;
+		const float *source;		// of a source
+		float *sink;				// of a sink
+		float gain;					// of a gain
+	} Node;
+
+	typedef struct Step
+	{
+		ASIOGraphProcess process;
+		void *state;
+		long numInputs;
+		long numOutputs;
+		long ports;					// index into ports, the inputs then the outputs
+		long numPredecessors;		// steps it waits for
+		long successors;			// index into successors, the steps that wait for it
+		long numSuccessors;
+	} Step;
+
+	// Chase-Lev deque of step numbers, the owner pushes and takes at the bottom, the
+	// others steal at the top. Each step is pushed once per buffer, a ring of numSteps never
+	// overflows.
+	typedef struct alignas(64) Worker
+	{
+		std::atomic<long long> top;
+		std::atomic<long long> bottom;
+		std::vector<std::atomic<long> > tasks;
+		long long mask;
+		std::thread thread;
+	} Worker;
+
+	// state of a sum or gain step
+	typedef struct Mix
+	{
+		long numSources;
+		const float *gains;
+	} Mix;
+
+	static void mixStep(void *state, const float *const *inputs, float *const *outputs, long frames);
+
+	void push(long worker, long step);
+	long take(long worker);
+	long steal(long worker);
+	void runSteps(long worker);
+	void run(long worker);
+
+	std::vector<Node> nodes;
+	std::vector<Connection> connections;
+
+	// the plan
+	std::vector<Step> steps;
+	std::vector<float*> ports;
+	std::vector<float> gains;		// of the gain nodes, then ones for the sums
+	std::vector<Mix> mixes;
+	std::vector<float> storage;		// the intermediate buffers and silence
+	long numBuffers;
+	long maxFrames;
+	std::vector<long> successors;
+	std::vector<long> roots;		// steps without predecessors
+
+	// the workers, process() is the owner of workers[0]. A buffer begins when process()
+	// has pushed the roots and moves period on, it is done when remaining is zero.
+	long numWorkers;
+	long frames;					// of the buffer, read after a step was taken
+	Worker workers[kMaxThreads];
+	std::vector<std::atomic<long> > pending;	// predecessors not done, per step
+	std::atomic<long> remaining;
+	std::atomic<unsigned long> period;
+	std::atomic<long long> periodStart;		// ns of the steady clock
+	std::atomic<long long> periodLength;	// between the last two, 0 before
+	std::atomic<bool> running;
+
+	// workers that found no buffer in time wait on wake, process() only takes the lock
+	// when one does
+	std::atomic<long> sleepers;
+	std::mutex wakeLock;
+	std::condition_variable wake;
+};
+
+#endif
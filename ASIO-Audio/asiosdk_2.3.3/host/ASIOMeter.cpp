@@ -0,0 +1,174 @@
+#include "ginclude.h"
+#include "ASIOMeter.h"
+#include "ASIODSPKernels.h"
+#include "ASIOFilterDesign.h"
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------
+// ballistics
+
+static const double kReleaseDecibelsPerSecond = 13.3;	// 20 dB in 1.5 s
+static const double kRmsSeconds = .3;
+
+// 47 taps at 4 times the rate, the cutoff at the original Nyquist frequency puts
+// zeros on every fourth tap from the center
+static const long kFilterLength = 47;
+static const double kFilterBeta = 5.65;					// 60 dB
+
+
+//-------------------------------------------------------------------------------------------
+
+ASIOMeter::ASIOMeter()
+	: releasePerFrame(0.), rmsPerFrame(0.)
+{
+	memset(taps, 0, sizeof(taps));
+	for(long r = 0; r < kMaxReaders; r++)
+	{
+		readers[r].open.store(0);
+		readers[r].middle.store(1);
+		readers[r].back = 2;
+		readers[r].front = 0;
+	}
+}
+
+bool ASIOMeter::setup(long numChannels, double sampleRate)
+{
+	if(numChannels < 0 || sampleRate <= 0.)
+		return false;
+	releasePerFrame = -kReleaseDecibelsPerSecond / 20. * log(10.) / sampleRate;
+	rmsPerFrame = -1. / (kRmsSeconds * sampleRate);
+
+	// the center tap 23 is in phase 3, which leaves the samples as they are. Phase 2
+	// is phase 0 backwards, phase 1 is symmetric.
+	double h[kFilterLength];
+	ASIODesignLowpass(h, kFilterLength, .125, kFilterBeta);
+	for(long j = 0; j < kPhaseTaps / 2; j++)
+	{
+		double a = 4. * h[4 * j];
+		double b = 4. * h[4 * (kPhaseTaps - 1 - j)];
+		taps[j] = (float)(a + b);
+		taps[6 + j] = (float)(a - b);
+		taps[12 + j] = (float)(4. * h[1 + 4 * j]);
+	}
+
+	channels.resize(numChannels);
+	for(long i = 0; i < numChannels; i++)
+		channels[i].history.resize(kPhaseTaps - 1 + kChunkFrames);
+	for(long r = 0; r < kMaxReaders; r++)
+	{
+		for(long b = 0; b < 3; b++)
+			readers[r].buffers[b].assign(numChannels, ASIOMeterLevels());
+	}
+	reset();
+	return true;
+}
+
+void ASIOMeter::reset()
+{
+	for(size_t i = 0; i < channels.size(); i++)
+	{
+		Channel& c = channels[i];
+		memset(&c.history[0], 0, c.history.size() * sizeof(float));
+		memset(&c.levels, 0, sizeof(c.levels));
+		c.meanSquare = 0.;
+		c.frames = 0;
+	}
+}
+
+void ASIOMeter::process(long channel, const float *source, long frames)
+{
+	if(channel < 0 || channel >= (long)channels.size() || frames <= 0)
+		return;
+	Channel& c = channels[channel];
+	const ASIODSPKernels* k = ASIOGetDSPKernels();
+	float peak = 0.f;
+	float truePeak = 0.f;
+	double sum = 0.;
+	for(long done = 0; done < frames; )
+	{
+		long n = frames - done;
+		if(n > kChunkFrames)
+			n = kChunkFrames;
+		float squares;
+		float p = k->meter(source + done, n, &squares);
+		peak = p > peak ? p : peak;
+		sum += squares;
+
+		float* history = &c.history[0];
+		memcpy(history + kPhaseTaps - 1, source + done, n * sizeof(float));
+		p = k->truePeak(taps, history, n);
+		truePeak = p > truePeak ? p : truePeak;
+		memmove(history, history + n, (kPhaseTaps - 1) * sizeof(float));
+		done += n;
+	}
+	truePeak = peak > truePeak ? peak : truePeak;
+
+	if(c.frames != frames)
+	{
+		c.frames = frames;
+		c.release = (float)exp(releasePerFrame * frames);
+		c.decay = exp(rmsPerFrame * frames);
+	}
+	ASIOMeterLevels& l = c.levels;
+	l.peak = l.peak * c.release > peak ? l.peak * c.release : peak;
+	l.truePeak = l.truePeak * c.release > truePeak ? l.truePeak * c.release : truePeak;
+	if(truePeak > l.maxTruePeak)
+		l.maxTruePeak = truePeak;
+	if(truePeak > 1.f)
+		l.overs++;
+
+	// NaN or infinite samples would stick in the average, they leave it alone
+	if(sum <= DBL_MAX)
+	{
+		c.meanSquare = c.meanSquare * c.decay + (1. - c.decay) * sum / frames;
+		l.rms = (float)sqrt(c.meanSquare);
+	}
+}
+
+void ASIOMeter::publish()
+{
+	for(long i = 0; i < kMaxReaders; i++)
+	{
+		Reader& r = readers[i];
+		if(!r.open.load(std::memory_order_relaxed))
+			continue;
+		ASIOMeterLevels* levels = &r.buffers[r.back][0];
+		for(size_t ch = 0; ch < channels.size(); ch++)
+			levels[ch] = channels[ch].levels;
+		r.back = r.middle.exchange(r.back | kFresh, std::memory_order_acq_rel) & 3;
+	}
+}
+
+long ASIOMeter::openReader()
+{
+	for(long i = 0; i < kMaxReaders; i++)
+	{
+		long closed = 0;
+		if(readers[i].open.compare_exchange_strong(closed, 1, std::memory_order_acquire))
+			return i;
+	}
+	return -1;
+}
+
+void ASIOMeter::closeReader(long reader)
+{
+	if(reader >= 0 && reader < kMaxReaders)
+		readers[reader].open.store(0, std::memory_order_release);
+}
+
+bool ASIOMeter::read(long reader, ASIOMeterLevels *levels, long numChannels)
+{
+	if(reader < 0 || reader >= kMaxReaders)
+		return false;
+	Reader& r = readers[reader];
+	bool fresh = (r.middle.load(std::memory_order_relaxed) & kFresh) != 0;
+	if(fresh)
+		r.front = r.middle.exchange(r.front, std::memory_order_acq_rel) & 3;
+	if(numChannels > (long)channels.size())
+		numChannels = (long)channels.size();
+	if(numChannels > 0)
+		memcpy(levels, &r.buffers[r.front][0], numChannels * sizeof(ASIOMeterLevels));
+	return fresh;
+}
@@ -0,0 +1,102 @@
+#ifndef __ASIOMeter__
+#define __ASIOMeter__
+
+// Level meters of float channels, computed in the buffer switch and read by any
+// number of other threads:
+//
+//   peak        largest sample magnitude, held and released by 13.3 dB/s
+//   true peak   the same between the samples, 4 times oversampled by a 47 tap
+//               Kaiser windowed sinc on the truePeak kernel of ASIODSPKernels.h
+//   rms         300 ms exponential average of the squares
+//
+// Levels are linear, 1 is full scale. The buffer switch calls process() for every
+// channel, then publish(). Each reader thread opens a reader and polls it at its own
+// rate: publish() hands every open reader a copy of all levels through a triple
+// buffer of its own, neither side ever waits for the other or retries.
+
+#include <vector>
+#include <atomic>
+
+typedef struct ASIOMeterLevels
+{
+	float peak;
+	float truePeak;
+	float rms;
+	float maxTruePeak;		// since reset()
+	unsigned long overs;	// process() calls with a true peak above full scale, since reset()
+} ASIOMeterLevels;
+
+class ASIOMeter
+{
+public:
+	enum
+	{
+		kMaxReaders = 4
+	};
+
+	ASIOMeter();
+	~ASIOMeter() {}
+
+	// designs the oversampling filter and allocates all buffers, call it before the
+	// buffers run and before any reader is opened
+	bool setup(long numChannels, double sampleRate);
+
+	// all levels of the buffer switch side back to silence, readers see it with the
+	// next publish()
+	void reset();
+
+	long getNumChannels() const { return (long)channels.size(); }
+
+	// one buffer of one channel, buffer switch. Channels can be processed on
+	// different threads as long as publish() comes after all of them.
+	void process(long channel, const float *source, long frames);
+
+	// the levels of all channels to every open reader, buffer switch
+	void publish();
+
+	// any thread other than the buffer switch, -1 when all readers are open
+	long openReader();
+	void closeReader(long reader);
+
+	// the levels of the first numChannels channels as of the latest publish(), only
+	// from the thread that opened the reader. true when they changed since the last
+	// read.
+	bool read(long reader, ASIOMeterLevels *levels, long numChannels);
+
+private:
+	enum
+	{
+		kChunkFrames = 256,		// samples per pass through the oversampling filter
+		kPhaseTaps = 12,
+		kFresh = 4				// in Reader::middle, published and not read yet
+	};
+
+	typedef struct Channel
+	{
+		std::vector<float> history;		// kPhaseTaps - 1 samples, then the chunk
+		ASIOMeterLevels levels;
+		double meanSquare;
+		long frames;					// of the last buffer, the decays below are for it
+		float release;
+		double decay;
+	} Channel;
+
+	// triple buffer, back belongs to publish() and front to the reader, middle is
+	// swapped by both
+	typedef struct Reader
+	{
+		std::atomic<long> open;
+		std::atomic<long> middle;
+		long back;
+		long front;
+		std::vector<ASIOMeterLevels> buffers[3];
+	} Reader;
+
+	double releasePerFrame;		// log of the peak release per sample
+	double rmsPerFrame;			// log of the rms decay per sample
+	float taps[18];				// of the truePeak kernel
+	std::vector<Channel> channels;
+	Reader readers[kMaxReaders];
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "ginclude.h"
+#include "ASIOProfiler.h"
+#include <math.h>
+#include <chrono>
+
+//-------------------------------------------------------------------------------------------
+
+static inline long long nanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the callback is the only writer, a plain increment without a locked instruction
+static inline void increment(std::atomic<unsigned long long> &counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+//-------------------------------------------------------------------------------------------
+
+ASIOProfiler::ASIOProfiler()
+	: budgetNanoseconds(0.), bufferSize(0)
+{
+	reset();
+}
+
+bool ASIOProfiler::setup(double sampleRate, long bufferSize)
+{
+	if(sampleRate <= 0. || bufferSize <= 0)
+		return false;
+	budgetNanoseconds = 1e9 * bufferSize / sampleRate;
+	this->bufferSize = bufferSize;
+	reset();
+	return true;
+}
+
+void ASIOProfiler::reset()
+{
+	for(long i = 0; i < kBuckets; i++)
+	{
+		load.counts[i].store(0, std::memory_order_relaxed);
+		period.counts[i].store(0, std::memory_order_relaxed);
+	}
+	load.max.store(0, std::memory_order_relaxed);
+	period.max.store(0, std::memory_order_relaxed);
+	callbacks.store(0, std::memory_order_relaxed);
+	overruns.store(0, std::memory_order_relaxed);
+	missed.store(0, std::memory_order_relaxed);
+	entered = 0;
+	lastEntered = 0;
+	lastPosition = 0.;
+	lastValid = false;
+}
+
+// values below 128 have a bucket each, above that the top 7 bits pick one of 64
+// buckets per power of 2
+long ASIOProfiler::bucketOf(unsigned long long value)
+{
+	if(value >> kMaxMagnitude)
+		value = (1ULL << kMaxMagnitude) - 1;
+	long magnitude = 0;
+	for(unsigned long long v = value >> kSubBits; v; v >>= 1)
+		magnitude++;
+	return magnitude * kHalf + (long)(value >> magnitude);
+}
+
+unsigned long long ASIOProfiler::highestOf(long bucket)
+{
+	long magnitude = bucket < 2 * kHalf ? 0 : bucket / kHalf - 1;
+	unsigned long long sub = (unsigned long long)(bucket - magnitude * kHalf);
+	return ((sub + 1) << magnitude) - 1;
+}
+
+void ASIOProfiler::record(Histogram &h, unsigned long long value)
+{
+	increment(h.counts[bucketOf(value)]);
+	if(value > h.max.load(std::memory_order_relaxed))
+		h.max.store(value, std::memory_order_relaxed);
+}
+
+void ASIOProfiler::enter(double samplePosition, bool valid)
+{
+	entered = nanoseconds();
+	if(lastEntered)
+		record(period, (unsigned long long)(entered - lastEntered));
+	lastEntered = entered;
+
+	// a position that went back is a restart, not a loss
+	if(valid && lastValid && bufferSize > 0)
+	{
+		double periods = floor((samplePosition - lastPosition) / bufferSize + .5);
+		if(periods > 1.)
+			missed.store(missed.load(std::memory_order_relaxed) + (unsigned long long)(periods - 1.),
+				std::memory_order_relaxed);
+	}
+	lastPosition = samplePosition;
+	lastValid = valid;
+}
+
+void ASIOProfiler::leave()
+{
+	long long elapsed = nanoseconds() - entered;
+	if(elapsed < 0)
+		elapsed = 0;
+	record(load, (unsigned long long)elapsed);
+	if(elapsed > budgetNanoseconds)
+		increment(overruns);
+	increment(callbacks);
+}
+
+double ASIOProfiler::percentile(const Histogram &h, unsigned long long total, double fraction) const
+{
+	if(!total || budgetNanoseconds <= 0.)
+		return 0.;
+	unsigned long long rank = (unsigned long long)ceil(fraction * total);
+	if(rank < 1)
+		rank = 1;
+	unsigned long long max = h.max.load(std::memory_order_relaxed);
+	unsigned long long count = 0;
+	for(long i = 0; i < kBuckets; i++)
+	{
+		count += h.counts[i].load(std::memory_order_relaxed);
+		if(count >= rank)
+		{
+			unsigned long long highest = highestOf(i);
+			return 100. * (highest < max ? highest : max) / budgetNanoseconds;
+		}
+	}
+	return 100. * max / budgetNanoseconds;
+}
+
+void ASIOProfiler::getStats(ASIOProfilerStats *stats) const
+{
+	// the totals are summed from the buckets themselves, a percentile never runs past
+	// the counts it walks
+	unsigned long long loadTotal = 0, periodTotal = 0;
+	for(long i = 0; i < kBuckets; i++)
+	{
+		loadTotal += load.counts[i].load(std::memory_order_relaxed);
+		periodTotal += period.counts[i].load(std::memory_order_relaxed);
+	}
+	double scale = budgetNanoseconds > 0. ? 100. / budgetNanoseconds : 0.;
+
+	stats->budget = getBudget();
+	stats->callbacks = callbacks.load(std::memory_order_relaxed);
+	stats->overruns = overruns.load(std::memory_order_relaxed);
+	stats->missed = missed.load(std::memory_order_relaxed);
+	stats->loadP50 = percentile(load, loadTotal, .5);
+	stats->loadP99 = percentile(load, loadTotal, .99);
+	stats->loadP999 = percentile(load, loadTotal, .999);
+	stats->loadMax = scale * load.max.load(std::memory_order_relaxed);
+	stats->periodP50 = percentile(period, periodTotal, .5);
+	stats->periodP99 = percentile(period, periodTotal, .99);
+	stats->periodP999 = percentile(period, periodTotal, .999);
+	stats->periodMax = scale * period.max.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,92 @@
+#ifndef __ASIOProfiler__
+#define __ASIOProfiler__
+
+// Time budget of the buffer switch. enter() and leave() timestamp every callback on
+// the steady clock, the time in between and the period since the last enter() go into
+// two HDR histograms: 64 linear sub-buckets per power of 2, every value is kept to
+// within 1.6 % up to 2^40 ns. Missed periods are told by the sample position: a jump
+// of more than one buffer means the driver went on without us.
+//
+// The buffer switch is the only writer, its counts are relaxed atomics that any other
+// thread reads at any time. A read while the callback runs may be one callback behind
+// in some buckets, never torn.
+
+#include <atomic>
+
+typedef struct ASIOProfilerStats
+{
+	double budget;					// seconds, the buffer duration
+	unsigned long long callbacks;
+	unsigned long long overruns;	// callbacks that took longer than the budget
+	unsigned long long missed;		// periods the sample position skipped
+
+	// percent of the budget, the upper end of the bucket of the percentile
+	double loadP50;
+	double loadP99;
+	double loadP999;
+	double loadMax;
+	double periodP50;				// from enter() to enter(), 100 when the driver keeps time
+	double periodP99;
+	double periodP999;
+	double periodMax;
+} ASIOProfilerStats;
+
+class ASIOProfiler
+{
+public:
+	ASIOProfiler();
+	~ASIOProfiler() {}
+
+	// the budget is bufferSize / sampleRate, resets. Before the buffers run.
+	bool setup(double sampleRate, long bufferSize);
+
+	// all counts to zero, the buffer switch may not run
+	void reset();
+
+	// first and last thing of the buffer switch. samplePosition is of this buffer,
+	// valid false when the driver has none.
+	void enter(double samplePosition, bool valid);
+	void leave();
+
+	// any thread
+	void getStats(ASIOProfilerStats *stats) const;
+
+	double getBudget() const { return budgetNanoseconds * 1e-9; }
+
+private:
+	enum
+	{
+		kSubBits = 7,
+		kHalf = 1 << (kSubBits - 1),
+		kMaxMagnitude = 40,			// 2^40 ns, 18 minutes
+		kBuckets = (kMaxMagnitude - kSubBits + 2) * kHalf
+	};
+
+	typedef struct Histogram
+	{
+		std::atomic<unsigned long long> counts[kBuckets];
+		std::atomic<unsigned long long> max;
+	} Histogram;
+
+	static long bucketOf(unsigned long long value);
+	static unsigned long long highestOf(long bucket);
+	static void record(Histogram &h, unsigned long long value);
+	double percentile(const Histogram &h, unsigned long long total, double fraction) const;
+
+	double budgetNanoseconds;
+	long bufferSize;
+
+	// of the buffer switch
+	long long entered;				// ns of the steady clock, of this callback
+	long long lastEntered;			// of the one before, 0 for none
+	double lastPosition;
+	bool lastValid;
+
+	Histogram load;
+	Histogram period;
+	std::atomic<unsigned long long> callbacks;
+	std::atomic<unsigned long long> overruns;
+	std::atomic<unsigned long long> missed;
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "ginclude.h"
+#include "ASIOResampler.h"
+#include "ASIODSPKernels.h"
+#include "ASIOFilterDesign.h"
+#include <math.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------
+// filters
+
+typedef struct ResamplerPreset
+{
+	long taps;				// per phase, upsampling
+	double attenuation;		// stopband, dB
+} ResamplerPreset;
+
+static const ResamplerPreset presets[] =
+{
+	{ 32, 70. },
+	{ 64, 100. },
+	{ 128, 130. },
+};
+
+static long gcd(long a, long b)
+{
+	while(b)
+	{
+		long t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+
+//-------------------------------------------------------------------------------------------
+
+ASIOResampler::ASIOResampler()
+	: numPhases(0), step(0), numTaps(0), capacity(0)
+{
+}
+
+bool ASIOResampler::setup(double sourceRate, double destRate, long numChannels, ASIOResamplerQuality quality)
+{
+	if(sourceRate < 1. || destRate < 1. || sourceRate > 1e7 || destRate > 1e7)
+		return false;
+	if(floor(sourceRate) != sourceRate || floor(destRate) != destRate || numChannels < 0)
+		return false;
+	if(quality < kASIOResamplerDraft || quality > kASIOResamplerBest)
+		return false;
+	long g = gcd((long)sourceRate, (long)destRate);
+	if((long)destRate / g > kMaxPhases)
+		return false;
+
+	numPhases = (long)destRate / g;
+	step = (long)sourceRate / g;
+
+	// the transition band in fractions of the lower rate only depends on the taps per
+	// phase at that rate (Kaiser: (A - 8) / (14.36 * taps)), downsampling needs more
+	// of them at the input rate
+	const ResamplerPreset& preset = presets[quality];
+	double ratio = step > numPhases ? (double)step / numPhases : 1.;
+	numTaps = ((long)ceil(preset.taps * ratio) + 7) & ~7L;
+	double transition = (preset.attenuation - 8.) / (14.36 * preset.taps);
+	double beta = .1102 * (preset.attenuation - 8.7);
+
+	// cutoff in the middle of the transition, in fractions of the upsampled rate
+	double lower = sourceRate < destRate ? sourceRate : destRate;
+	double cutoff = lower * (.5 - transition * .5) / (sourceRate * numPhases);
+	long length = numPhases * numTaps;
+	std::vector<double> h(length);
+	ASIODesignLowpass(&h[0], length, cutoff, beta);
+
+	// phase p weighs the input sample j positions before the newest of its window
+	// with h[p + j * L], stored oldest first. The gain of L makes up for the zeros
+	// of the upsampling.
+	bank.resize(length);
+	for(long p = 0; p < numPhases; p++)
+	{
+		for(long i = 0; i < numTaps; i++)
+			bank[p * numTaps + i] = (float)(numPhases * h[p + numPhases * (numTaps - 1 - i)]);
+	}
+
+	capacity = numTaps + step / numPhases + 1 + kChunkFrames;
+	channels.resize(numChannels);
+	for(long i = 0; i < numChannels; i++)
+		channels[i].buffer.resize(capacity);
+	reset();
+	return true;
+}
+
+void ASIOResampler::reset()
+{
+	for(size_t i = 0; i < channels.size(); i++)
+	{
+		// numTaps - 1 samples of silence, the first window ends at the first input
+		Channel& c = channels[i];
+		memset(&c.buffer[0], 0, c.buffer.size() * sizeof(float));
+		c.count = numTaps - 1;
+		c.position = 0;
+		c.phase = 0;
+	}
+}
+
+long ASIOResampler::getMaxOutput(long frames) const
+{
+	if(!step)
+		return 0;
+	return (long)(((long long)frames * numPhases + step - 1) / step) + 1;
+}
+
+double ASIOResampler::getLatency() const
+{
+	if(!numPhases)
+		return 0.;
+	return (double)(numPhases * numTaps - 1) / (2. * numPhases);
+}
+
+long ASIOResampler::process(long channel, const float *source, float *dest, long frames)
+{
+	if(channel < 0 || channel >= (long)channels.size())
+		return 0;
+	Channel& c = channels[channel];
+	const ASIODSPKernels* k = ASIOGetDSPKernels();
+	long written = 0;
+	while(frames > 0)
+	{
+		long n = capacity - c.count;
+		if(n > frames)
+			n = frames;
+		memcpy(&c.buffer[c.count], source, n * sizeof(float));
+		c.count += n;
+		source += n;
+		frames -= n;
+
+		// output i starts its window at position + (phase + i * M) / L, all of them
+		// that end in the buffer
+		long starts = c.count - numTaps - c.position + 1;
+		if(starts > 0)
+		{
+			long outputs = (long)(((long long)starts * numPhases - c.phase + step - 1) / step);
+			c.position += k->polyphase(&bank[0], numTaps, numPhases, step, &c.phase,
+				&c.buffer[c.position], dest + written, outputs);
+			written += outputs;
+		}
+
+		// keep what the next windows need
+		if(c.position >= c.count)
+		{
+			c.position -= c.count;
+			c.count = 0;
+		}
+		else
+		{
+			memmove(&c.buffer[0], &c.buffer[c.position], (c.count - c.position) * sizeof(float));
+			c.count -= c.position;
+			c.position = 0;
+		}
+	}
+	return written;
+}
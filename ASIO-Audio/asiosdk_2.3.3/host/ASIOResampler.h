@@ -0,0 +1,77 @@
+#ifndef __ASIOResampler__
+#define __ASIOResampler__
+
+// Sample rate conversion of float channels between two integer rates, for
+// streams that don't run at the device rate and for a device that follows an
+// external clock (sampleRateDidChange). The ratio is reduced to L / M, the input
+// is upsampled by L, lowpass filtered and decimated by M in one polyphase FIR:
+// every output is one of the L phases of the filter against the input, on the
+// polyphase kernel of ASIODSPKernels.h.
+//
+// The lowpass is a Kaiser windowed sinc whose stopband starts at half the lower
+// of the two rates. The presets trade its length for passband and attenuation:
+//
+//   draft    32 taps per phase,  70 dB, passband up to .36 of the lower rate
+//   good     64 taps per phase, 100 dB, .40
+//   best    128 taps per phase, 130 dB, .43
+//
+// Downsampling stretches the filter by the ratio so the band edges stay put.
+
+#include <vector>
+
+enum ASIOResamplerQuality
+{
+	kASIOResamplerDraft = 0,
+	kASIOResamplerGood,
+	kASIOResamplerBest
+};
+
+class ASIOResampler
+{
+public:
+	ASIOResampler();
+	~ASIOResampler() {}
+
+	// integer rates whose ratio reduces to at most 1024 phases, 44100 to 48000 is
+	// 160 / 147. Designs the filter and allocates all buffers, call it before the
+	// buffers run. false for other rates.
+	bool setup(double sourceRate, double destRate, long numChannels, ASIOResamplerQuality quality);
+
+	// restarts all channels from silence
+	void reset();
+
+	// the most samples process() writes for frames input samples, frames * L / M
+	// rounded up plus one
+	long getMaxOutput(long frames) const;
+
+	// group delay of the filter in input samples
+	double getLatency() const;
+
+	// one block of one channel, any number of frames. Returns the number of samples
+	// written to dest. Channels that get the same frames stay in step.
+	long process(long channel, const float *source, float *dest, long frames);
+
+private:
+	enum
+	{
+		kChunkFrames = 256,		// input samples per pass through the filter
+		kMaxPhases = 1024
+	};
+
+	typedef struct Channel
+	{
+		std::vector<float> buffer;	// input, the window of the next output starts at position
+		long count;					// samples in buffer
+		long position;				// can be beyond count when downsampling skips samples
+		long phase;
+	} Channel;
+
+	long numPhases;			// L
+	long step;				// M
+	long numTaps;			// per phase, a multiple of 8
+	long capacity;			// of the channel buffers
+	std::vector<float> bank;	// numPhases filters of numTaps taps
+	std::vector<Channel> channels;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "ginclude.h"
+#include "ASIOTelemetry.h"
+#include <string.h>
+#include <thread>
+
+//-------------------------------------------------------------------------------------------
+
+ASIOTelemetry::ASIOTelemetry()
+{
+	sequence.store(0);
+	for(long i = 0; i < kWords; i++)
+		words[i].store(0);
+}
+
+void ASIOTelemetry::publish(const ASIOTelemetrySnapshot &snapshot)
+{
+	unsigned long long w[kWords];
+	w[kWords - 1] = 0;
+	memcpy(w, &snapshot, sizeof(snapshot));
+
+	// the odd sequence has to be visible before any word changes, the release fence
+	// keeps the stores below from moving up
+	unsigned long s = sequence.load(std::memory_order_relaxed);
+	sequence.store(s + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for(long i = 0; i < kWords; i++)
+		words[i].store(w[i], std::memory_order_relaxed);
+	sequence.store(s + 2, std::memory_order_release);
+}
+
+bool ASIOTelemetry::read(ASIOTelemetrySnapshot *snapshot) const
+{
+	unsigned long long w[kWords];
+	for(long attempt = 1; ; attempt++)
+	{
+		unsigned long s = sequence.load(std::memory_order_acquire);
+		if(s == 0)
+			return false;
+		if(!(s & 1))
+		{
+			for(long i = 0; i < kWords; i++)
+				w[i] = words[i].load(std::memory_order_relaxed);
+
+			// the loads above may not move below the second look at the sequence
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(sequence.load(std::memory_order_relaxed) == s)
+				break;
+		}
+		// a writer that was preempted in the middle gets the cpu back
+		if(attempt % kSpins == 0)
+			std::this_thread::yield();
+	}
+	memcpy(snapshot, w, sizeof(*snapshot));
+	return true;
+}
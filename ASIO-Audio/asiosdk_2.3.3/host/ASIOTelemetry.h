@@ -0,0 +1,51 @@
+#ifndef __ASIOTelemetry__
+#define __ASIOTelemetry__
+
+// The time info of the latest buffer switch for any number of other threads, a seqlock.
+// publish() never waits: it makes the sequence odd, stores the snapshot and makes it
+// even again. read() copies the snapshot and starts over when the sequence was odd or
+// has moved meanwhile, which only happens when it overlapped a publish(). The snapshot
+// is held in 64 bit atomic words, a reader never sees half of a double, and the block
+// has cache lines of its own so that the buffer switch's other data isn't pulled along
+// by polling readers.
+
+#include <atomic>
+#include "asio.h"
+
+typedef struct ASIOTelemetrySnapshot
+{
+	ASIOTime time;				// as the driver passed it
+	double nanoSeconds;			// system time of the buffer, 0 when the driver had none
+	double samples;				// sample position, the same
+	double tcSamples;			// time code samples, the same
+	unsigned long sysRefTime;	// ms, when the buffer switch was called
+	unsigned long index;		// buffer half
+} ASIOTelemetrySnapshot;
+
+class alignas(64) ASIOTelemetry
+{
+public:
+	ASIOTelemetry();
+	~ASIOTelemetry() {}
+
+	// the buffer switch, one thread at a time
+	void publish(const ASIOTelemetrySnapshot &snapshot);
+
+	// any thread, false while nothing was published
+	bool read(ASIOTelemetrySnapshot *snapshot) const;
+
+	// publish() calls so far, any thread
+	unsigned long getPublished() const { return sequence.load(std::memory_order_relaxed) / 2; }
+
+private:
+	enum
+	{
+		kWords = (sizeof(ASIOTelemetrySnapshot) + 7) / 8,
+		kSpins = 64				// read() attempts before it yields to the writer
+	};
+
+	std::atomic<unsigned long> sequence;	// odd while publish() stores
+	std::atomic<unsigned long long> words[kWords];
+};
+
+#endif
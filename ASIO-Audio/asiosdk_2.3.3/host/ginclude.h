@@ -22,6 +22,20 @@
 	#define ASIO_LITTLE_ENDIAN 1
 	#define ASIO_CPU_X86 1
 	//
+#elif defined(__linux__)
+	#undef BEOS 
+	#undef MAC 
+	#undef WINDOWS
+	#undef SGI
+	//
+	#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		#define ASIO_BIG_ENDIAN 1
+	#else
+		#define ASIO_LITTLE_ENDIAN 1
+	#endif
+	#if defined(__i386__) || defined(__x86_64__)
+		#define ASIO_CPU_X86 1
+	#endif
 #else
 	#define MAC 1
 	#undef BEOS 